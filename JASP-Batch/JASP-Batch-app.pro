@@ -0,0 +1,71 @@
+QT += core xml
+QT -= gui
+
+include(../JASP.pri)
+
+CONFIG += c++11
+linux:CONFIG += -pipe
+
+DESTDIR = ..
+TARGET = JASPBatch
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+target.path = $$INSTALLPATH
+INSTALLS += target
+
+DEPENDPATH = ..
+PRE_TARGETDEPS += ../libJASP-Batch-Desktop.a ../libJASP-Common.a
+
+LIBS += -L.. -lJASP-Batch-Desktop -lJASP-Common
+
+windows:CONFIG(ReleaseBuild) {
+    LIBS += -llibboost_filesystem-vc141-mt-1_64 -llibboost_system-vc141-mt-1_64 -larchive.dll
+}
+
+windows:CONFIG(DebugBuild) {
+    LIBS += -llibboost_filesystem-vc141-mt-gd-1_64 -llibboost_system-vc141-mt-gd-1_64 -larchive.dll
+}
+
+   macx:LIBS += -lboost_filesystem-clang-mt-1_64 -lboost_system-clang-mt-1_64 -larchive -lz
+windows:LIBS += -lole32 -loleaut32 -lws2_32 -lmswsock -lbcrypt
+windows:INCLUDEPATH += $$[QT_INSTALL_HEADERS]/QtZlib #Qt comes with zlib, used for .zsav
+
+linux {
+    LIBS += -larchive -lz
+    exists(/app/lib/*)	{ LIBS += -L/app/lib }
+    LIBS += -lboost_filesystem -lboost_system -lrt
+}
+
+$$JASPTIMER_USED {
+    windows:CONFIG(ReleaseBuild)    LIBS += -llibboost_timer-vc141-mt-1_64
+    windows:CONFIG(DebugBuild)      LIBS += -llibboost_timer-vc141-mt-gd-1_64
+    linux:                          LIBS += -lboost_timer
+    macx:                           LIBS += -lboost_timer-clang-mt-1_64
+}
+
+   macx:INCLUDEPATH += ../../boost_1_64_0
+windows:INCLUDEPATH += ../../boost_1_64_0
+
+INCLUDEPATH += $$PWD/../JASP-Common/ $$PWD/../JASP-Desktop/
+
+macx:QMAKE_CXXFLAGS_WARN_ON += -Wno-unused-parameter -Wno-unused-local-typedef
+macx:QMAKE_CXXFLAGS += -Wno-c++11-extensions
+macx:QMAKE_CXXFLAGS += -Wno-c++11-long-long
+macx:QMAKE_CXXFLAGS += -Wno-c++11-extra-semi
+macx:QMAKE_CXXFLAGS += -stdlib=libc++
+
+windows:QMAKE_CXXFLAGS += -DBOOST_USE_WINDOWS_H -DNOMINMAX -D__WIN32__ -DBOOST_INTERPROCESS_BOOTSTAMP_IS_SESSION_MANAGER_BASED
+
+!isEmpty($$[ENVIRONMENT_CRYPTKEY]) {
+    DEFINES+="ENVIRONMENT_CRYPTKEY=$$[ENVIRONMENT_CRYPTKEY]"
+}
+
+SOURCES += \
+    main.cpp \
+    batchrunner.cpp
+
+HEADERS += \
+    batchrunner.h
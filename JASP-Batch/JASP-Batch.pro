@@ -0,0 +1,4 @@
+# JASPBatch links against the same sources as JASP-Desktop, through a static library built from JASP-Desktop-core.pri (the part of JASP-Desktop.pri without an interface)
+TEMPLATE = subdirs
+CONFIG += ordered
+SUBDIRS += JASP-Desktop-staticlib.pro JASP-Batch-app.pro
@@ -0,0 +1,46 @@
+# JASPBatch runs under a QCoreApplication, so only the part of JASP-Desktop without an interface is built, see JASP-Desktop-core.pri
+QT += core xml
+QT -= gui
+
+include(../JASP.pri)
+
+include(../R_HOME.pri)
+
+CONFIG += c++11
+linux:CONFIG += -pipe
+
+# Directories and a name of its own, so neither the JASP-Desktop build nor the static library of JASP-Tests is overwritten
+DESTDIR = ..
+OBJECTS_DIR = desktop-staticlib
+MOC_DIR = desktop-staticlib
+RCC_DIR = desktop-staticlib
+UI_DIR	= desktop-staticlib
+
+TARGET = JASP-Batch-Desktop
+TEMPLATE = lib
+CONFIG += staticlib
+
+DEPENDPATH = ..
+
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$PWD/../JASP-Common/
+
+   macx:INCLUDEPATH += ../../boost_1_64_0
+windows:INCLUDEPATH += ../../boost_1_64_0
+
+windows:INCLUDEPATH += $$[QT_INSTALL_HEADERS]/QtZlib #Qt comes with zlib, used for .zsav
+
+macx:QMAKE_CXXFLAGS_WARN_ON += -Wno-unused-parameter -Wno-unused-local-typedef
+macx:QMAKE_CXXFLAGS += -Wno-c++11-extensions
+macx:QMAKE_CXXFLAGS += -Wno-c++11-long-long
+macx:QMAKE_CXXFLAGS += -Wno-c++11-extra-semi
+macx:QMAKE_CXXFLAGS += -stdlib=libc++
+
+windows:QMAKE_CXXFLAGS += -DBOOST_USE_WINDOWS_H -DNOMINMAX -D__WIN32__ -DBOOST_INTERPROCESS_BOOTSTAMP_IS_SESSION_MANAGER_BASED
+
+!isEmpty($$[ENVIRONMENT_CRYPTKEY]) {
+    DEFINES+="ENVIRONMENT_CRYPTKEY=$$[ENVIRONMENT_CRYPTKEY]"
+}
+
+include(../JASP-Desktop/JASP-Desktop-core.pri)
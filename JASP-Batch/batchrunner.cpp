@@ -0,0 +1,394 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "batchrunner.h"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QSettings>
+
+#include <boost/nowide/fstream.hpp>
+
+#include <iostream>
+
+#include "appinfo.h"
+#include "datasetloader.h"
+#include "exporters/dataexporter.h"
+#include "exporters/jaspexporter.h"
+#include "processinfo.h"
+#include "qutils.h"
+#include "tempfiles.h"
+#include "utils.h"
+#include "variablespage/labelfiltergenerator.h"
+
+using namespace std;
+
+Q_DECLARE_METATYPE(Column::ColumnType)
+
+BatchRunner::BatchRunner(QObject *parent) : QObject(parent)
+{
+	tempfiles_init(ProcessInfo::currentPID());
+	qRegisterMetaType<Column::ColumnType>();
+
+	_package				= new DataSetPackage();
+	_analyses				= new Analyses();
+	_engineSync				= new EngineSync(_analyses, _package, this);
+	_computedColumnsModel	= new ComputedColumnsModel(_analyses, this);
+	_timer					= new QTimer(this);
+
+	// The same connections MainWindow makes, minus everything that only updates the interface
+	connect(_analyses,				&Analyses::requestComputedColumnCreation,		_computedColumnsModel,	&ComputedColumnsModel::requestComputedColumnCreation	);
+	connect(_analyses,				&Analyses::requestComputedColumnDestruction,	_computedColumnsModel,	&ComputedColumnsModel::requestComputedColumnDestruction	);
+	connect(_computedColumnsModel,	&ComputedColumnsModel::sendComputeCode,			_engineSync,			&EngineSync::computeColumn,								Qt::QueuedConnection);
+	connect(_engineSync,			&EngineSync::computeColumnSucceeded,			_computedColumnsModel,	&ComputedColumnsModel::computeColumnSucceeded			);
+	connect(_engineSync,			&EngineSync::computeColumnFailed,				_computedColumnsModel,	&ComputedColumnsModel::computeColumnFailed				);
+	connect(_engineSync,			&EngineSync::processNewFilterResult,			this,					&BatchRunner::filterResult								);
+	connect(_engineSync,			&EngineSync::processFilterErrorMsg,				this,					&BatchRunner::filterError								);
+	connect(_engineSync,			&EngineSync::engineTerminated,					this,					&BatchRunner::engineTerminated							);
+	connect(_timer,					&QTimer::timeout,								this,					&BatchRunner::checkProgress								);
+
+	connect(_computedColumnsModel,	&ComputedColumnsModel::dataSetChanged,			this,	[this](DataSet *dataSet)	{ _package->setDataSet(dataSet);	});
+	connect(_computedColumnsModel,	&ComputedColumnsModel::refreshColumn,			this,	[](Column *column)			{ column->incRevision();			});
+
+	_package->dataChanged.connect([this](DataSetPackage *, vector<string> &changedColumns, vector<string> &missingColumns, map<string, string> &changeNameColumns, bool rowCountChanged)
+	{
+		_computedColumnsModel->packageSynchronized(changedColumns, missingColumns, changeNameColumns, rowCountChanged);
+	});
+
+	QString missingvaluestring = QSettings().value("MissingValueList", "").toString();
+	if (missingvaluestring != "")
+		Utils::setEmptyValues(fromQstringToStdVector(missingvaluestring, "|"));
+}
+
+BatchRunner::~BatchRunner()
+{
+	delete _engineSync; // Before the data set, the engines might still be looking at it
+	_engineSync = NULL;
+
+	if (_package->dataSet() != NULL)
+		DataSetLoader::freeDataSet(_package->dataSet());
+
+	delete _analyses;
+	delete _package;
+}
+
+void BatchRunner::start()
+{
+	try
+	{
+		if (_timeout > 0)
+			QTimer::singleShot(_timeout * 1000, this, &BatchRunner::timedOut);
+
+		load();
+
+		_engineSync->start(_engineCount);
+		emit _engineSync->ppiChanged(_ppi);
+
+		sendFilter();
+
+		_clock.start();
+		_timer->start(10);
+	}
+	catch (std::exception &e)
+	{
+		fail(e.what());
+	}
+}
+
+void BatchRunner::load()
+{
+	auto progress = [](const string &stage, int progress) { cout << stage << " " << progress << "%" << endl; };
+
+	DataSetLoader::loadPackage(_package, fq(_projectPath), ".jasp", progress);
+
+	_resultsMeta = _package->analysesData().isObject() ? _package->analysesData().get("meta", Json::nullValue) : Json::nullValue;
+
+	_computedColumnsModel->setDataSetPackage(_package);
+
+	if (_dataPath != "")
+	{
+		// Just like synchronizing in the interface, columns are matched by name and the computed columns that depend on changed ones are recomputed.
+		DataSetLoader::syncPackage(_package, fq(_dataPath), "", progress);
+
+		_package->setDataFilePath(fq(_dataPath));
+		_package->setDataFileTimestamp(QFileInfo(_dataPath).lastModified().toTime_t());
+	}
+}
+
+void BatchRunner::sendFilter()
+{
+	Json::Value constructorJson;
+	Json::Reader().parse(_package->filterConstructorJson(), constructorJson);
+
+	// The R code of the drag and drop filter is only generated by its QML, so it cannot be applied here.
+	if (constructorJson.get("formulas", Json::arrayValue).size() > 0)
+		throw runtime_error("This file uses the drag and drop filter, that can only be applied in JASP itself.");
+
+	_engineSync->sendFilter(tq(labelFilterGenerator(_package).generateFilter()), tq(_package->dataFilter()), _filterRequestId);
+}
+
+void BatchRunner::filterResult(int requestId)
+{
+	if (requestId != _filterRequestId || !_package->dataSet()->filter().publish(requestId))
+		return;
+
+	_filterApplied = true;
+}
+
+void BatchRunner::filterError(QString error, int requestId)
+{
+	if (requestId != _filterRequestId)
+		return;
+
+	if (_filterApplied)
+		cout << "The filter gave a warning: " << fq(error) << endl;
+	else
+		fail("The filter failed: " + fq(error));
+}
+
+void BatchRunner::engineTerminated()
+{
+	fail("An engine terminated unexpectedly.");
+}
+
+bool BatchRunner::computedColumnsPending()
+{
+	for (ComputedColumn *column : *_package->computedColumnsPointer())
+		if (column->isInvalidated())
+			return true;
+
+	return false;
+}
+
+void BatchRunner::createAnalyses()
+{
+	Json::Value analysesData = _package->analysesData();
+	if (analysesData.isObject())
+		analysesData = analysesData.get("analyses", Json::arrayValue);
+
+	for (Json::Value &analysisData : analysesData)
+	{
+		try
+		{
+			QString module = tq(analysisData.get("module", "Common").asString());
+			if (module.isEmpty())
+				module = "Common";
+
+			Json::Value &optionsJson	= analysisData["options"];
+			Json::Value &versionJson	= analysisData["version"];
+			Version version				= versionJson.isNull() ? AppInfo::version : Version(versionJson.asString());
+
+			// Everything is run again, the results in the file belong to the old data.
+			Analysis *analysis = _analyses->create(module, tq(analysisData["name"].asString()), analysisData["id"].asInt(), version, &optionsJson, Analysis::Empty);
+
+			analysis->setUserData(analysisData["userdata"]);
+			analysis->setResults(analysisData["results"]);
+		}
+		catch (std::exception &e)
+		{
+			cout << "Analysis " << analysisData["id"].asInt() << " (" << analysisData["name"].asString() << ") could not be loaded: " << e.what() << endl;
+			_failedCount++;
+		}
+	}
+
+	for (ComputedColumn *column : *_package->computedColumnsPointer())
+		if (column->analysisId() != -1)
+			column->setAnalysis(_analyses->get(column->analysisId()));
+
+	cout << "Running " << _analyses->count() << " analyses on " << _engineCount << " engines." << endl;
+}
+
+void BatchRunner::checkProgress()
+{
+	if (_stage == Stage::preparing)
+	{
+		if (_filterApplied && !computedColumnsPending())
+		{
+			createAnalyses();
+			_clock.restart();
+			_stage = Stage::running;
+		}
+
+		return;
+	}
+
+	if (_stage != Stage::running)
+		return;
+
+	bool allDone = true;
+
+	for (Analysis *analysis : *_analyses)
+	{
+		if (analysis == NULL)
+			continue;
+
+		Timing &timing = _timings[analysis->id()];
+
+		switch (analysis->status())
+		{
+		case Analysis::Initing:
+		case Analysis::Running:
+			if (timing.started == -1)
+				timing.started = _clock.elapsed();
+			allDone = false;
+			break;
+
+		case Analysis::InitedAndWaiting:
+			analysis->scheduleRun(); // Nobody is going to press its run button
+			allDone = false;
+			break;
+
+		case Analysis::Complete:
+		case Analysis::Error:
+		case Analysis::Exception:
+		case Analysis::Aborted:
+			if (timing.finished == -1)
+			{
+				timing.finished = _clock.elapsed();
+
+				qint64 started = timing.started == -1 ? timing.finished : timing.started;
+				cout << "Analysis " << analysis->id() << " (" << analysis->name() << ") is " << analysis->asJSON()["status"].asString() << ", it waited " << started << " ms and ran " << (timing.finished - started) << " ms." << endl;
+			}
+			break;
+
+		default:
+			// Back to empty means it was refreshed, for instance because a computed column it uses changed
+			timing.finished = -1;
+			allDone = false;
+			break;
+		}
+	}
+
+	if (allDone && !computedColumnsPending())
+		finish();
+}
+
+void BatchRunner::finish()
+{
+	_stage = Stage::done;
+	_timer->stop();
+
+	for (Analysis *analysis : *_analyses)
+		if (analysis != NULL && analysis->status() != Analysis::Complete)
+			_failedCount++;
+
+	try
+	{
+		if (_resultsPath != "")	writeResults();
+		if (_outputPath != "")	save();
+		if (_exportPath != "")	exportData();
+	}
+	catch (std::exception &e)
+	{
+		fail(e.what());
+		return;
+	}
+
+	cout << "Done in " << _clock.elapsed() << " ms, " << _failedCount << " analyses did not complete." << endl;
+
+	QCoreApplication::exit(_failedCount == 0 ? 0 : 1);
+}
+
+void BatchRunner::save()
+{
+	Json::Value analysesDataList = Json::arrayValue;
+
+	for (Analysis *analysis : *_analyses)
+		if (analysis != NULL && analysis->isVisible())
+		{
+			Json::Value analysisData	= analysis->asJSON();
+			analysisData["options"]		= analysis->options()->asJSON();
+			analysisData["userdata"]	= analysis->userData();
+			analysesDataList.append(analysisData);
+		}
+
+	Json::Value analysesData	= Json::objectValue;
+	analysesData["analyses"]	= analysesDataList;
+	analysesData["meta"]		= _resultsMeta;
+
+	_package->setAnalysesData(analysesData);
+	_package->setAnalysesHTML(""); // Rendering the results to html takes the results view of the interface, JASP makes a new one the next time it saves.
+
+	JASPExporter().saveDataSet(fq(_outputPath), _package, [](const string &, int) {});
+
+	cout << "Saved " << fq(_outputPath) << endl;
+}
+
+void BatchRunner::exportData()
+{
+	DataExporter				exporter(true);
+	std::vector<std::string>	columns;
+
+	for (const QString &column : _exportColumns)
+		columns.push_back(fq(column));
+
+	exporter.setFileType(Utils::getTypeFromFileName(fq(_exportPath)) == Utils::txt ? Utils::txt : Utils::csv);
+	exporter.setRowRange(_exportFirstRow, _exportEndRow);
+	exporter.setColumns(columns);
+	exporter.saveDataSet(fq(_exportPath), _package, [](const string &, int) {});
+
+	cout << "Exported the data to " << fq(_exportPath) << endl;
+}
+
+void BatchRunner::writeResults()
+{
+	Json::Value analysesList = Json::arrayValue;
+
+	for (Analysis *analysis : *_analyses)
+		if (analysis != NULL)
+		{
+			Json::Value analysisData	= analysis->asJSON();
+			const Timing &timing		= _timings[analysis->id()];
+
+			analysisData["options"]					= analysis->options()->asJSON();
+			analysisData["timing"]["startedMs"]		= Json::Int64(timing.started);
+			analysisData["timing"]["finishedMs"]	= Json::Int64(timing.finished);
+			analysesList.append(analysisData);
+		}
+
+	Json::Value results		= Json::objectValue;
+	results["project"]		= fq(_projectPath);
+	results["dataFile"]		= _package->dataFilePath();
+	results["analyses"]		= analysesList;
+
+	boost::nowide::ofstream out(fq(_resultsPath).c_str(), ios_base::out | ios_base::trunc);
+
+	if (!out.is_open())
+		throw runtime_error("Could not write results to " + fq(_resultsPath));
+
+	out << results.toStyledString();
+
+	cout << "Wrote results to " << fq(_resultsPath) << endl;
+}
+
+void BatchRunner::timedOut()
+{
+	fail("Not done after " + to_string(_timeout) + " seconds, giving up.", 3);
+}
+
+void BatchRunner::fail(const string &message, int exitCode)
+{
+	if (_stage == Stage::done)
+		return;
+
+	_stage = Stage::done;
+	_timer->stop();
+
+	cout << "Error: " << message << endl;
+
+	QCoreApplication::exit(exitCode);
+}
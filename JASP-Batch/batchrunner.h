@@ -0,0 +1,117 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include <limits>
+#include <map>
+
+#include "analyses.h"
+#include "datasetpackage.h"
+#include "enginesync.h"
+#include "computedcolumnsmodel.h"
+
+/* The BatchRunner does what MainWindow does when a .jasp file is opened and refreshed, without any interface:
+ * it loads the project, optionally synchronizes it with another data file, applies the filter,
+ * recomputes the computed columns and then reruns every analysis on a pool of engines.
+ * Once they are all done it writes the updated project, the results and/or the data and quits the application
+ * with 0 if every analysis completed, 1 if some didn't, 2 if something went wrong and 3 if it took too long.
+ */
+class BatchRunner : public QObject
+{
+	Q_OBJECT
+
+public:
+	BatchRunner(QObject *parent = NULL);
+	~BatchRunner();
+
+	void setProject(		QString path)	{ _projectPath	= path;		}
+	void setDataFile(		QString path)	{ _dataPath		= path;		}
+	void setOutput(			QString path)	{ _outputPath	= path;		}
+	void setResultsFile(	QString path)	{ _resultsPath	= path;		}
+	void setDataExport(		QString path)	{ _exportPath	= path;		}
+	void setEngineCount(	int count)		{ _engineCount	= count;	}
+	void setPPI(			int ppi)		{ _ppi			= ppi;		}
+	void setTimeout(		int seconds)	{ _timeout		= seconds;	}	///< Gives up with exit code 3 when not done after this many seconds, 0 waits forever
+
+	// Only export the rows from firstRow up to (but not including) endRow and/or only these columns, see DataExporter.
+	void setExportRows(size_t firstRow, size_t endRow)		{ _exportFirstRow = firstRow; _exportEndRow = endRow;	}
+	void setExportColumns(const QStringList &columnNames)	{ _exportColumns = columnNames;							}
+public slots:
+	void start();
+
+private slots:
+	void checkProgress();
+	void timedOut();
+	void filterResult(int requestId);
+	void filterError(QString error, int requestId);
+	void engineTerminated();
+
+private:
+	enum class Stage { preparing, running, done };
+
+	struct Timing
+	{
+		qint64	started		= -1,	///< Milliseconds since the analyses were created, when an engine first picked it up
+				finished	= -1;
+	};
+
+	void	load();
+	void	sendFilter();
+	void	createAnalyses();
+	bool	computedColumnsPending();
+	void	finish();
+	void	save();
+	void	exportData();
+	void	writeResults();
+	void	fail(const std::string &message, int exitCode = 2);
+
+	DataSetPackage			*_package;
+	Analyses				*_analyses;
+	EngineSync				*_engineSync;
+	ComputedColumnsModel	*_computedColumnsModel;
+	QTimer					*_timer;
+	QElapsedTimer			_clock;
+
+	Stage					_stage			= Stage::preparing;
+	bool					_filterApplied	= false;
+	std::map<int, Timing>	_timings;
+	Json::Value				_resultsMeta	= Json::nullValue;
+
+	QString					_projectPath,
+							_dataPath,
+							_outputPath,
+							_resultsPath,
+							_exportPath;
+	QStringList				_exportColumns;
+	size_t					_exportFirstRow	= 0,
+							_exportEndRow	= std::numeric_limits<size_t>::max();
+	int						_engineCount	= 4,
+							_ppi			= 96,
+							_timeout		= 0,
+							_failedCount	= 0;
+	static const int		_filterRequestId = 1;
+};
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,127 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLocale>
+#include <QTimer>
+
+#include <iostream>
+#include <limits>
+
+#include "batchrunner.h"
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication::setOrganizationName("JASP");
+	QCoreApplication::setOrganizationDomain("jasp-stats.org");
+	QCoreApplication::setApplicationName("JASP"); // So the missing values set in JASP are used here too
+
+	QLocale::setDefault(QLocale(QLocale::English)); // make decimal points == .
+
+	QCoreApplication app(argc, argv);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Reruns all analyses of a JASP file without the interface.");
+	parser.addHelpOption();
+	parser.addPositionalArgument("project", "The .jasp file to run.");
+
+	QCommandLineOption	dataOption(		"data",		"Synchronize the project with this data file first.",							"file"),
+						outputOption(	"output",	"Save the updated project as this .jasp file.",									"file"),
+						resultsOption(	"results",	"Write the options, results and timing of every analysis to this json file.",	"file"),
+						exportOption(	"export-data",	"Export the data, with the computed columns, to this .csv or .txt file.",	"file"),
+						rowsOption(		"rows",		"Only export these rows, counting from 1 (for instance 1-100).",				"first-last"),
+						columnsOption(	"columns",	"Only export these columns, in this order, separated by commas.",				"names"),
+						enginesOption(	"engines",	"How many engines to start, one of them only prepares analyses (default 4).",	"count", "4"),
+						ppiOption(		"ppi",		"Resolution of the plots (default 96).",										"ppi", "96"),
+						timeoutOption(	"timeout",	"Give up, with exit code 3, when not done after this many seconds (default 0, no limit).",	"seconds", "0");
+
+	parser.addOptions({ dataOption, outputOption, resultsOption, exportOption, rowsOption, columnsOption, enginesOption, ppiOption, timeoutOption });
+	parser.process(app);
+
+	if (parser.positionalArguments().size() != 1 || (!parser.isSet(outputOption) && !parser.isSet(resultsOption) && !parser.isSet(exportOption)))
+	{
+		std::cout << "Give one .jasp file and at least one of --output, --results and --export-data." << std::endl;
+		parser.showHelp(1);
+	}
+
+	int engineCount = parser.value(enginesOption).toInt();
+
+	if (engineCount < 1)
+	{
+		std::cout << "There has to be at least one engine." << std::endl;
+		return 1;
+	}
+
+	bool	timeoutOk	= false;
+	int		timeout		= parser.value(timeoutOption).toInt(&timeoutOk);
+
+	if (!timeoutOk || timeout < 0 || timeout > std::numeric_limits<int>::max() / 1000)
+	{
+		std::cout << "--timeout takes a number of seconds, 0 for no limit." << std::endl;
+		return 1;
+	}
+
+	size_t firstRow = 0, endRow = std::numeric_limits<size_t>::max();
+
+	if (parser.isSet(rowsOption))
+	{
+		QStringList	range	= parser.value(rowsOption).split('-');
+		bool		firstOk	= false,
+					lastOk	= false;
+
+		if (range.size() == 2)
+		{
+			firstRow	= range[0].toULongLong(&firstOk) - 1;
+			endRow		= range[1].toULongLong(&lastOk);
+		}
+
+		if (!firstOk || !lastOk || firstRow >= endRow)
+		{
+			std::cout << "--rows takes the first and last row to export, counting from 1, like 1-100." << std::endl;
+			return 1;
+		}
+	}
+
+	try
+	{
+		BatchRunner runner;
+
+		runner.setProject(		parser.positionalArguments().first()	);
+		runner.setDataFile(		parser.value(dataOption)				);
+		runner.setOutput(		parser.value(outputOption)				);
+		runner.setResultsFile(	parser.value(resultsOption)				);
+		runner.setDataExport(	parser.value(exportOption)				);
+		runner.setExportRows(	firstRow, endRow						);
+		runner.setEngineCount(	engineCount								);
+		runner.setPPI(			parser.value(ppiOption).toInt()			);
+		runner.setTimeout(		timeout									);
+
+		if (parser.isSet(columnsOption))
+			runner.setExportColumns(parser.value(columnsOption).split(','));
+
+		QTimer::singleShot(0, &runner, &BatchRunner::start);
+
+		return app.exec();
+	}
+	catch (std::exception &e)
+	{
+		std::cout << "Error: " << e.what() << std::endl;
+	}
+
+	return 2;
+}
@@ -0,0 +1,68 @@
+QT += core gui webenginewidgets svg network printsupport xml
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+include(../JASP.pri)
+
+CONFIG += c++11
+
+linux:CONFIG += -pipe
+
+DESTDIR = ..
+
+TARGET = JASPBenchmarks
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+INCLUDEPATH += ../JASP-Desktop/ \
+	../JASP-Common/ \
+	../JASP-Engine/
+
+   macx:INCLUDEPATH += ../../boost_1_64_0
+windows:INCLUDEPATH += ../../boost_1_64_0
+
+PRE_TARGETDEPS += ../libJASP-Desktop.a
+LIBS += -L.. -lJASP-Desktop
+
+PRE_TARGETDEPS += ../libJASP-Common.a
+LIBS += -L.. -lJASP-Common
+
+# rbridge_readDataSet is benchmarked in process, so the engine side links like JASP-Engine does (R is never started)
+LIBS += -L.. -l$$JASP_R_INTERFACE_NAME
+
+include(../R_HOME.pri)
+
+windows:LIBS += -lboost_filesystem-mgw48-mt-1_64 -lboost_system-mgw48-mt-1_64 -larchive.dll
+   macx:LIBS += -lboost_filesystem-clang-mt-1_64 -lboost_system-clang-mt-1_64 -larchive -lz
+  linux:LIBS += -lboost_filesystem    -lboost_system    -larchive -lz -lrt
+
+linux: LIBS += -L$$_R_HOME/lib -lR -lrt # because linux JASP-R-Interface is staticlib
+macx:  LIBS += -L$$_R_HOME/lib -lR
+
+windows:LIBS += -lole32 -loleaut32 -lbcrypt
+
+QMAKE_CXXFLAGS_WARN_ON += -Wno-unused-parameter -Wno-unused-local-typedef
+macx:QMAKE_CXXFLAGS += -Wno-c++11-extensions
+macx:QMAKE_CXXFLAGS += -Wno-c++11-long-long
+macx:QMAKE_CXXFLAGS += -Wno-c++11-extra-semi
+macx:QMAKE_CXXFLAGS += -stdlib=libc++
+
+win32:QMAKE_CXXFLAGS += -DBOOST_USE_WINDOWS_H -DNOMINMAX -D__WIN32__
+
+macx | windows { DEFINES += JASP_NOT_LINUX }
+
+SOURCES += \
+	main.cpp \
+	benchmarks.cpp \
+	databenchmarks.cpp \
+	datasetgenerator.cpp \
+	ipcbenchmarks.cpp \
+	../JASP-Engine/columncache.cpp \
+	../JASP-Engine/rbridge.cpp \
+	../JASP-Engine/r_functionwhitelist.cpp \
+	../JASP-Engine/r_lexer.cpp
+
+HEADERS += \
+	benchmarks.h \
+	datasetgenerator.h
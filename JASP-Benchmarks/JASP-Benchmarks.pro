@@ -0,0 +1,3 @@
+TEMPLATE = subdirs
+CONFIG += ordered
+SUBDIRS += ../JASP-Tests/JASP-Desktop-staticlib.pro JASP-Benchmarks-app.pro
@@ -0,0 +1,78 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "benchmarks.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+using namespace std;
+
+static volatile double _benchmarkSink = 0;
+
+void benchmarkKeep(double value)
+{
+	_benchmarkSink = _benchmarkSink + value;
+}
+
+void Benchmarks::run(const string &name, const Json::Value &parameters, Body body, Setup setup)
+{
+	if (!wanted(name))
+		return;
+
+	vector<double>	milliseconds;
+	Work			work;
+
+	for (int repetition = 0; repetition <= _repetitions; repetition++)
+	{
+		if (setup)
+			setup();
+
+		auto start	= chrono::steady_clock::now();
+		work		= body();
+		auto end	= chrono::steady_clock::now();
+
+		if (repetition > 0)
+			milliseconds.push_back(chrono::duration<double, milli>(end - start).count());
+	}
+
+	vector<double> sorted = milliseconds;
+	sort(sorted.begin(), sorted.end());
+
+	double	median	= sorted[sorted.size() / 2],
+			mean	= accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+
+	Json::Value result		= Json::objectValue;
+	result["name"]			= name;
+	result["parameters"]	= parameters;
+	result["repetitions"]	= int(sorted.size());
+	result["minMs"]			= sorted.front();
+	result["medianMs"]		= median;
+	result["meanMs"]		= mean;
+	result["maxMs"]			= sorted.back();
+	result["items"]			= work.items;
+
+	if (median > 0 && work.items > 0)	result["itemsPerSecond"]	= work.items / median * 1000.0;
+	if (median > 0 && work.bytes > 0)	result["megabytesPerSecond"]	= work.bytes / (1024.0 * 1024.0) / median * 1000.0;
+
+	_results.append(result);
+
+	cerr << name << ": median " << median << " ms over " << sorted.size() << " runs" << endl;
+}
@@ -0,0 +1,67 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <functional>
+#include <string>
+
+#include "jsonredirect.h"
+#include "datasetgenerator.h"
+
+/* Benchmarks runs every benchmark a fixed number of times after a warm up run and keeps the results as json,
+ * so they can be compared between versions by a script instead of by eye.
+ * A benchmark body returns how many items (rows, cells, messages) it went through, and optionally how many bytes, which gives the throughput.
+ */
+class Benchmarks
+{
+public:
+	struct Work
+	{
+		Work(double items = 0, double bytes = 0) : items(items), bytes(bytes) {}
+
+		double	items,
+				bytes;
+	};
+
+	typedef std::function<Work()>	Body;
+	typedef std::function<void()>	Setup;
+
+	Benchmarks(int repetitions, const std::string &only) : _repetitions(repetitions), _only(only) {}
+
+	bool		wanted(const std::string &name) const { return _only == "" || name.find(_only) != std::string::npos; }
+
+	///Runs setup (untimed) and body repetitions + 1 times, the first run only warms up.
+	void		run(const std::string &name, const Json::Value &parameters, Body body, Setup setup = Setup());
+
+	Json::Value	results() const { return _results; }
+
+private:
+	int			_repetitions;
+	std::string	_only;
+	Json::Value	_results = Json::arrayValue;
+};
+
+///Writing what a benchmark computed here keeps the compiler from optimizing the work away.
+void benchmarkKeep(double value);
+
+void benchmarkImportersAndExporters(	Benchmarks &benchmarks, const DataSetSpec &spec, const std::string &workDir);
+void benchmarkDataSet(					Benchmarks &benchmarks, const DataSetSpec &spec, const std::string &workDir);
+void benchmarkIPCChannel(				Benchmarks &benchmarks);
+
+#endif // BENCHMARKS_H
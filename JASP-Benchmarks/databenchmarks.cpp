@@ -0,0 +1,283 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "benchmarks.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "datasetloader.h"
+#include "datasettablemodel.h"
+#include "exporters/arrowexporter.h"
+#include "exporters/dataexporter.h"
+#include "exporters/jaspexporter.h"
+#include "exporters/odsexporter.h"
+#include "rbridge.h"
+#include "utils.h"
+
+using namespace std;
+
+static void noProgress(const string &, int) {}
+
+static void unload(DataSetPackage &package)
+{
+	if (package.dataSet() != NULL)
+		DataSetLoader::freeDataSet(package.dataSet());
+
+	package.reset();
+}
+
+static void load(DataSetPackage &package, const string &path)
+{
+	unload(package);
+	DataSetLoader::loadPackage(&package, path, "", noProgress);
+}
+
+static double cellCount(DataSetPackage &package)
+{
+	return double(package.dataSet()->rowCount()) * package.dataSet()->columnCount();
+}
+
+void benchmarkImportersAndExporters(Benchmarks &benchmarks, const DataSetSpec &spec, const string &workDir)
+{
+	DataSetPackage	package;
+	Json::Value		parameters	= spec.toJson();
+	double			cells		= double(spec.rows) * spec.columns;
+
+	auto importFile = [&](const string &name, const string &path)
+	{
+		benchmarks.run("import/" + name, parameters, [&]()
+		{
+			load(package, path);
+			return Benchmarks::Work{ cells, double(Utils::getFileSize(path)) };
+		});
+	};
+
+	auto exportFile = [&](const string &name, Exporter &&exporter, Utils::FileType fileType, const string &path)
+	{
+		exporter.setFileType(fileType);
+
+		if (!benchmarks.wanted("export/" + name))
+		{
+			exporter.saveDataSet(path, &package, noProgress); // The imports below still need the file
+			return;
+		}
+
+		benchmarks.run("export/" + name, parameters, [&]()
+		{
+			exporter.saveDataSet(path, &package, noProgress);
+			return Benchmarks::Work{ cells, double(Utils::getFileSize(path)) };
+		});
+	};
+
+	const string	generatedCsv	= workDir + "/generated.csv",
+					generatedSav	= workDir + "/generated.sav",
+					exportedCsv		= workDir + "/exported.csv",
+					exportedOds		= workDir + "/exported.ods",
+					exportedArrow	= workDir + "/exported.arrow",
+					exportedJasp	= workDir + "/exported.jasp";
+
+	importFile("csv", generatedCsv);
+	importFile("sav", generatedSav);
+
+	// The exports all start from the same csv import, so they write exactly the same data
+	load(package, generatedCsv);
+
+	exportFile("csv",	DataExporter(false),	Utils::csv,		exportedCsv);
+	exportFile("ods",	ODSExporter(),			Utils::ods,		exportedOds);
+	exportFile("arrow",	ArrowExporter(),		Utils::arrow,	exportedArrow);
+	exportFile("jasp",	JASPExporter(),			Utils::jasp,	exportedJasp);
+
+	importFile("ods",	exportedOds);
+	importFile("arrow",	exportedArrow);
+	importFile("jasp",	exportedJasp);
+
+	benchmarks.run("roundtrip/jasp", parameters, [&]()
+	{
+		JASPExporter().saveDataSet(exportedJasp, &package, noProgress);
+		load(package, exportedJasp);
+		return Benchmarks::Work{ cells, double(Utils::getFileSize(exportedJasp)) };
+	});
+
+	unload(package);
+}
+
+void benchmarkDataSet(Benchmarks &benchmarks, const DataSetSpec &spec, const string &workDir)
+{
+	DataSetPackage package;
+	load(package, workDir + "/generated.csv");
+
+	DataSet			*dataSet	= package.dataSet();
+	Json::Value		parameters	= spec.toJson();
+	double			cells		= cellCount(package);
+	int				rowCount	= int(dataSet->rowCount()),
+					columnCount	= int(dataSet->columnCount());
+	std::mt19937	random(spec.seed);
+
+	benchmarks.run("column/iterate", parameters, [&]()
+	{
+		double sum = 0;
+
+		for (Column &column : dataSet->columns())
+			if (column.columnType() == Column::ColumnTypeScale)	for (double value : column.AsDoubles)	sum += value;
+			else												for (int value : column.AsInts)			sum += value;
+
+		benchmarkKeep(sum);
+		return Benchmarks::Work{ cells, 0 };
+	});
+
+	const size_t	lookups = 1000000;
+	vector<int>		randomRows(lookups);
+
+	std::uniform_int_distribution<int> pickRow(0, rowCount - 1);
+	for (int &row : randomRows)
+		row = pickRow(random);
+
+	benchmarks.run("column/randomAccess", parameters, [&]()
+	{
+		double sum = 0;
+
+		for (size_t i = 0; i < lookups; i++)
+		{
+			Column &column = dataSet->column(i % columnCount);
+
+			if (column.columnType() == Column::ColumnTypeScale)	sum += column.AsDoubles[randomRows[i]];
+			else												sum += column.AsInts[randomRows[i]];
+		}
+
+		benchmarkKeep(sum);
+		return Benchmarks::Work{ double(lookups), 0 };
+	});
+
+	benchmarks.run("column/displayValue", parameters, [&]()
+	{
+		size_t length = 0;
+
+		for (size_t i = 0; i < lookups / 10; i++)
+			length += dataSet->column(i % columnCount)[randomRows[i]].size();
+
+		benchmarkKeep(length);
+		return Benchmarks::Work{ double(lookups / 10), 0 };
+	});
+
+	// Keys that exist in the labels of each column that has them, picked at random
+	vector<pair<Column*, int>> labelKeys;
+
+	for (size_t i = 0; i < lookups; i++)
+	{
+		Column &column = dataSet->column(i % columnCount);
+
+		if (column.columnType() != Column::ColumnTypeScale && column.labels().size() > 0)
+			labelKeys.push_back(make_pair(&column, column.labels()[random() % column.labels().size()].value()));
+	}
+
+	benchmarks.run("labels/valueFromKey", parameters, [&]()
+	{
+		size_t length = 0;
+
+		for (const pair<Column*, int> &key : labelKeys)
+			length += key.first->labels().getValueFromKey(key.second).size();
+
+		benchmarkKeep(length);
+		return Benchmarks::Work{ double(labelKeys.size()), 0 };
+	});
+
+	benchmarks.run("labels/labelObjectFromKey", parameters, [&]()
+	{
+		size_t length = 0;
+
+		for (const pair<Column*, int> &key : labelKeys)
+			length += key.first->labels().getLabelObjectFromKey(key.second).text().size();
+
+		benchmarkKeep(length);
+		return Benchmarks::Work{ double(labelKeys.size()), 0 };
+	});
+
+	// What the data view asks for while scrolling: windows of rows at random places, every cell of them
+	DataSetTableModel model;
+	model.setDataSetPackage(&package);
+
+	const int	windowRows	= 50,
+				windows		= 100;
+
+	benchmarks.run("datasettablemodel/data", parameters, [&]()
+	{
+		size_t length = 0;
+
+		for (int window = 0; window < windows; window++)
+		{
+			int top = randomRows[window] > rowCount - windowRows ? 0 : randomRows[window];
+
+			for (int row = top; row < top + windowRows && row < rowCount; row++)
+				for (int column = 0; column < columnCount; column++)
+				{
+					QModelIndex index = model.index(row, column);
+
+					length += model.data(index, Qt::DisplayRole).toString().size();
+					length += model.data(index, int(DataSetTableModel::specialRoles::lines)).toInt();
+				}
+		}
+
+		benchmarkKeep(length);
+		return Benchmarks::Work{ double(windows) * windowRows * columnCount, 0 };
+	});
+
+	model.clearDataSet();
+
+	// rbridge_readDataSet doesn't need R, only a data set to read from
+	rbridge_setDataSetSource([&]() { return package.dataSet(); });
+
+	vector<RBridgeColumnType> columnTypes(columnCount);
+	for (int column = 0; column < columnCount; column++)
+	{
+		columnTypes[column].name = strdup(dataSet->column(column).name().c_str());
+		columnTypes[column].type = Column::ColumnTypeUnknown; // as it is
+	}
+
+	auto readDataSet = [&]()
+	{
+		rbridge_readDataSet(columnTypes.data(), columnCount, true);
+		freeRBridgeColumns();
+
+		return Benchmarks::Work{ double(dataSet->filteredRowCount()) * columnCount, double(dataSet->filteredRowCount()) * columnCount * sizeof(double) };
+	};
+
+	auto invalidateCache = [&]()
+	{
+		for (Column &column : dataSet->columns())
+			column.incRevision();
+	};
+
+	benchmarks.run("rbridge/readDataSet/materialize",	parameters, readDataSet, invalidateCache);
+	benchmarks.run("rbridge/readDataSet/cached",		parameters, readDataSet);
+
+	// Half the rows pass the filter
+	vector<bool> filterResult(rowCount);
+	for (int row = 0; row < rowCount; row++)
+		filterResult[row] = row % 2 == 0;
+
+	dataSet->filter().stage(filterResult, 1);
+	dataSet->filter().publish(1);
+
+	benchmarks.run("rbridge/readDataSet/materializeFiltered", parameters, readDataSet, invalidateCache);
+
+	for (RBridgeColumnType &columnType : columnTypes)
+		free(columnType.name);
+
+	unload(package);
+}
@@ -0,0 +1,198 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "datasetgenerator.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+
+#include <boost/nowide/fstream.hpp>
+
+using namespace std;
+
+Json::Value DataSetSpec::toJson() const
+{
+	Json::Value json	= Json::objectValue;
+
+	json["rows"]		= Json::UInt(rows);
+	json["columns"]		= Json::UInt(columns);
+	json["scale"]		= scale;
+	json["ordinal"]		= ordinal;
+	json["nominal"]		= nominal;
+	json["nominalText"]	= nominalText;
+	json["missing"]		= missing;
+	json["cardinality"]	= cardinality;
+	json["seed"]		= seed;
+
+	return json;
+}
+
+DataSetGenerator::DataSetGenerator(const DataSetSpec &spec) : _spec(spec)
+{
+	double total = spec.scale + spec.ordinal + spec.nominal + spec.nominalText;
+
+	if (total <= 0 || spec.cardinality < 1 || spec.cardinality > 9999999)
+		throw runtime_error("The type mix has to add up to something and the cardinality has to be between 1 and 9999999.");
+
+	for (size_t column = 0; column < spec.columns; column++)
+	{
+		// The types are spread over the columns in the proportions of the mix, so a data set of a few columns still gets all of them.
+		double position = (column + 0.5) / spec.columns * total;
+
+		Column::ColumnType type =	position < spec.scale									? Column::ColumnTypeScale	:
+									position < spec.scale + spec.ordinal					? Column::ColumnTypeOrdinal	:
+									position < spec.scale + spec.ordinal + spec.nominal		? Column::ColumnTypeNominal	:
+																							  Column::ColumnTypeNominalText;
+
+		std::mt19937								random(spec.seed * 7919 + column);
+		std::normal_distribution<double>			normal(50, 10);
+		std::uniform_int_distribution<int>			level(1, spec.cardinality);
+		std::uniform_real_distribution<double>		chance(0, 1);
+
+		vector<double> values(spec.rows);
+
+		for (double &value : values)
+		{
+			if (chance(random) < spec.missing)		value = NAN;
+			else if (type == Column::ColumnTypeScale)	value = round(normal(random) * 10000) / 10000;
+			else									value = level(random);
+		}
+
+		_types.push_back(type);
+		_values.push_back(std::move(values));
+	}
+}
+
+string DataSetGenerator::textValue(int level) const
+{
+	return "L" + std::to_string(level);
+}
+
+void DataSetGenerator::writeCsv(const string &path) const
+{
+	boost::nowide::ofstream out(path.c_str(), ios_base::out | ios_base::trunc | ios_base::binary);
+
+	if (!out.is_open())
+		throw runtime_error("Could not write " + path);
+
+	for (size_t column = 0; column < _spec.columns; column++)
+		out << (column > 0 ? "," : "") << columnName(column);
+	out << "\n";
+
+	char buffer[64];
+
+	for (size_t row = 0; row < _spec.rows; row++)
+	{
+		for (size_t column = 0; column < _spec.columns; column++)
+		{
+			if (column > 0)
+				out << ",";
+
+			double value = _values[column][row];
+
+			if (std::isnan(value))
+				continue;
+
+			switch (_types[column])
+			{
+			case Column::ColumnTypeScale:		snprintf(buffer, sizeof(buffer), "%.4f", value); out << buffer;	break;
+			case Column::ColumnTypeNominalText:	out << textValue(int(value));									break;
+			default:							out << int(value);												break;
+			}
+		}
+
+		out << "\n";
+	}
+}
+
+// Only what the .sav importer needs: the header, a variable record per column, their measures and the uncompressed cases.
+void DataSetGenerator::writeSav(const string &path) const
+{
+	boost::nowide::ofstream out(path.c_str(), ios_base::out | ios_base::trunc | ios_base::binary);
+
+	if (!out.is_open())
+		throw runtime_error("Could not write " + path);
+
+	auto writeInt		= [&](int32_t value)						{ out.write(reinterpret_cast<const char *>(&value), sizeof(value));		};
+	auto writeDouble	= [&](double value)							{ out.write(reinterpret_cast<const char *>(&value), sizeof(value));		};
+	auto writeChars		= [&](const string &text, size_t width)		{ string padded = text; padded.resize(width, ' '); out.write(padded.data(), width);	};
+
+	const int32_t	columns		= int32_t(_spec.columns),
+					stringWidth	= 8;
+
+	out.write("$FL2", 4);
+	writeChars("@(#) SPSS DATA FILE JASP-Benchmarks", 60);
+	writeInt(2);					// layout code
+	writeInt(columns);				// nominal case size, every column takes one 8 byte segment
+	writeInt(0);					// not compressed
+	writeInt(0);					// no weight variable
+	writeInt(int32_t(_spec.rows));
+	writeDouble(100.0);				// bias
+	writeChars("01 Jan 18", 9);
+	writeChars("00:00:00", 8);
+	writeChars("", 64);				// file label
+	out.write("\0\0\0", 3);
+
+	for (int32_t column = 0; column < columns; column++)
+	{
+		bool	isText	= _types[column] == Column::ColumnTypeNominalText;
+		int32_t	format	= isText ? (1 << 16) | (stringWidth << 8) : (5 << 16) | (8 << 8) | (_types[column] == Column::ColumnTypeScale ? 4 : 0);
+
+		writeInt(2);
+		writeInt(isText ? stringWidth : 0);
+		writeInt(0);				// no variable label
+		writeInt(0);				// no missing values
+		writeInt(format);			// print
+		writeInt(format);			// write
+		writeChars(columnName(column), 8);
+	}
+
+	// Variable display parameters: measure, width and alignment per column
+	writeInt(7);
+	writeInt(11);
+	writeInt(4);
+	writeInt(columns * 3);
+
+	for (int32_t column = 0; column < columns; column++)
+	{
+		switch (_types[column])
+		{
+		case Column::ColumnTypeScale:	writeInt(3);	break;
+		case Column::ColumnTypeOrdinal:	writeInt(2);	break;
+		default:						writeInt(1);	break;
+		}
+
+		writeInt(8);
+		writeInt(_types[column] == Column::ColumnTypeNominalText ? 0 : 1);
+	}
+
+	writeInt(999);
+	writeInt(0);
+
+	for (size_t row = 0; row < _spec.rows; row++)
+		for (size_t column = 0; column < _spec.columns; column++)
+		{
+			double value = _values[column][row];
+
+			if (_types[column] == Column::ColumnTypeNominalText)	writeChars(std::isnan(value) ? "" : textValue(int(value)), stringWidth);
+			else													writeDouble(std::isnan(value) ? -DBL_MAX : value); // -DBL_MAX is SPSS' system missing value
+		}
+}
@@ -0,0 +1,66 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef DATASETGENERATOR_H
+#define DATASETGENERATOR_H
+
+#include <string>
+#include <vector>
+
+#include "column.h"
+#include "jsonredirect.h"
+
+///What the synthetic data set looks like, the same spec and seed always give the same data.
+struct DataSetSpec
+{
+	size_t		rows			= 100000,
+				columns			= 20;
+	double		scale			= 0.4,	///< The type mix, as fractions of the columns, in this order.
+				ordinal			= 0.2,
+				nominal			= 0.2,
+				nominalText		= 0.2,
+				missing			= 0.01;	///< Fraction of empty cells
+	int			cardinality		= 10;	///< Number of distinct values of the columns that aren't scale
+	unsigned	seed			= 1;
+
+	Json::Value toJson() const;
+};
+
+/* DataSetGenerator makes the values of a DataSetSpec and writes them as a csv or as an (uncompressed) .sav file,
+ * those are then read by the importers like any other file, which is how the benchmarks get their data sets.
+ * Every column gets its own random generator seeded from the spec, so a column doesn't change when others are added.
+ */
+class DataSetGenerator
+{
+public:
+	DataSetGenerator(const DataSetSpec &spec);
+
+	void	writeCsv(const std::string &path) const;
+	void	writeSav(const std::string &path) const;
+
+	Column::ColumnType	columnType(size_t column)	const { return _types[column];		}
+	std::string			columnName(size_t column)	const { return "V" + std::to_string(column + 1); }
+
+private:
+	std::string			textValue(int level)	const;
+
+	DataSetSpec								_spec;
+	std::vector<Column::ColumnType>			_types;
+	std::vector<std::vector<double>>		_values; ///< Per column, NaN for missing, levels are 1..cardinality
+};
+
+#endif // DATASETGENERATOR_H
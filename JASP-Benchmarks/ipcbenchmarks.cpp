@@ -0,0 +1,112 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "benchmarks.h"
+
+#include <thread>
+
+#include "ipcchannel.h"
+#include "processinfo.h"
+
+using namespace std;
+
+// The first character of a message tells the engine side what to do with it: echo it back, only acknowledge it or stop.
+static const char echoMessage = 'e', ackMessage = 'a', stopMessage = 's';
+
+static void waitForReply(IPCChannel &channel, string &reply)
+{
+	while (!channel.receive(reply, 1000)) {}
+}
+
+void benchmarkIPCChannel(Benchmarks &benchmarks)
+{
+	if (!benchmarks.wanted("ipc/"))
+		return;
+
+	// Both ends live in this process, the slave answers from its own thread like an engine would from its own process
+	string		name	= "JASP-Benchmark-IPC-" + std::to_string(ProcessInfo::currentPID());
+	IPCChannel	master(name, 0, false),
+				slave(name, 0, true);
+
+	thread engine([&]()
+	{
+		string message, ack(1, ackMessage);
+
+		while (true)
+		{
+			if (!slave.receive(message, 1000))
+				continue;
+
+			if		(message[0] == stopMessage)	break;
+			else if (message[0] == echoMessage)	slave.send(message);
+			else								slave.send(ack);
+		}
+	});
+
+	string reply;
+
+	const int roundTrips = 10000;
+	string ping(64, 'x');
+	ping[0] = echoMessage;
+
+	benchmarks.run("ipc/latency", Json::objectValue, [&]()
+	{
+		for (int i = 0; i < roundTrips; i++)
+		{
+			master.send(ping);
+			waitForReply(master, reply);
+		}
+
+		return Benchmarks::Work{ double(roundTrips), double(roundTrips) * ping.size() * 2 };
+	});
+
+	// The shared memory starts small and grows on the first big message, the warm up run takes that hit
+	for (size_t megabytes : { 1, 16 })
+	{
+		const int	messages	= megabytes == 1 ? 200 : 20;
+		string		message(megabytes * 1024 * 1024, 'x');
+		message[0] = ackMessage;
+
+		Json::Value parameters		= Json::objectValue;
+		parameters["megabytes"]		= Json::UInt(megabytes);
+
+		benchmarks.run("ipc/bandwidth/" + std::to_string(megabytes) + "MB", parameters, [&]()
+		{
+			for (int i = 0; i < messages; i++)
+			{
+				master.send(message);
+				waitForReply(master, reply);
+			}
+
+			return Benchmarks::Work{ double(messages), double(messages) * message.size() };
+		});
+	}
+
+	string stop(1, stopMessage);
+	master.send(stop);
+	engine.join();
+
+	// tempfiles only cleans shared memory up on the next start of the desktop, and this isn't the desktop
+	boost::interprocess::shared_memory_object::remove((name + "#0").c_str());
+	boost::interprocess::shared_memory_object::remove((name + "_MasterToSlave").c_str());
+	boost::interprocess::shared_memory_object::remove((name + "_SlaveToMaster").c_str());
+
+#if !defined(__APPLE__) && !defined(__WIN32__)
+	boost::interprocess::named_semaphore::remove((name + "#0-mm0").c_str());
+	boost::interprocess::named_semaphore::remove((name + "#0-sm0").c_str());
+#endif
+}
@@ -0,0 +1,134 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLocale>
+#include <QSysInfo>
+
+#include <iostream>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include "appinfo.h"
+#include "benchmarks.h"
+#include "datasetgenerator.h"
+#include "processinfo.h"
+#include "tempfiles.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+	QLocale::setDefault(QLocale(QLocale::English)); // make decimal points == .
+
+	QCoreApplication app(argc, argv); // The table model and the importers expect one
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Times the data and IPC hot paths of JASP on a generated data set and writes the results as json.");
+	parser.addHelpOption();
+
+	DataSetSpec spec;
+
+	QCommandLineOption	outputOption(		"output",		"Write the results to this json file instead of to the standard output.",		"file"),
+						rowsOption(			"rows",			"Rows of the generated data set.",												"rows",			QString::number(spec.rows)),
+						columnsOption(		"columns",		"Columns of the generated data set.",											"columns",		QString::number(spec.columns)),
+						mixOption(			"mix",			"Fractions of scale, ordinal, nominal and nominal text columns.",				"s,o,n,t",		"0.4,0.2,0.2,0.2"),
+						missingOption(		"missing",		"Fraction of empty cells.",														"fraction",		QString::number(spec.missing)),
+						cardinalityOption(	"cardinality",	"Distinct values of the columns that aren't scale.",							"count",		QString::number(spec.cardinality)),
+						seedOption(			"seed",			"Seed of the generated data set.",												"seed",			QString::number(spec.seed)),
+						repetitionsOption(	"repetitions",	"Timed runs of every benchmark, after one warm up run.",						"count",		"5"),
+						onlyOption(			"only",			"Only run the benchmarks whose name contains this, for instance import/ or ipc/.",	"filter");
+
+	parser.addOptions({ outputOption, rowsOption, columnsOption, mixOption, missingOption, cardinalityOption, seedOption, repetitionsOption, onlyOption });
+	parser.process(app);
+
+	QStringList mix		= parser.value(mixOption).split(',');
+	int repetitions		= parser.value(repetitionsOption).toInt();
+
+	if (mix.size() != 4 || repetitions < 1)
+	{
+		cerr << "The mix needs four fractions and there has to be at least one repetition." << endl;
+		parser.showHelp(1);
+	}
+
+	spec.rows			= parser.value(rowsOption).toULongLong();
+	spec.columns		= parser.value(columnsOption).toULongLong();
+	spec.scale			= mix[0].toDouble();
+	spec.ordinal		= mix[1].toDouble();
+	spec.nominal		= mix[2].toDouble();
+	spec.nominalText	= mix[3].toDouble();
+	spec.missing		= parser.value(missingOption).toDouble();
+	spec.cardinality	= parser.value(cardinalityOption).toInt();
+	spec.seed			= parser.value(seedOption).toUInt();
+
+	if (spec.rows == 0 || spec.columns == 0)
+	{
+		cerr << "The data set needs at least one row and one column." << endl;
+		return 1;
+	}
+
+	tempfiles_init(ProcessInfo::currentPID());
+
+	int result = 0;
+
+	try
+	{
+		string workDir = tempfiles_sessionDirName() + "/benchmarks";
+		boost::filesystem::create_directories(workDir);
+
+		DataSetGenerator generator(spec);
+		generator.writeCsv(workDir + "/generated.csv");
+		generator.writeSav(workDir + "/generated.sav");
+
+		Benchmarks benchmarks(repetitions, parser.value(onlyOption).toStdString());
+
+		benchmarkImportersAndExporters(	benchmarks, spec, workDir);
+		benchmarkDataSet(				benchmarks, spec, workDir);
+		benchmarkIPCChannel(			benchmarks);
+
+		Json::Value output		= Json::objectValue;
+		output["jaspVersion"]	= AppInfo::version.asString();
+		output["buildDate"]		= AppInfo::builddate;
+		output["platform"]		= QSysInfo::prettyProductName().toStdString() + " " + QSysInfo::currentCpuArchitecture().toStdString();
+		output["dataSet"]		= spec.toJson();
+		output["repetitions"]	= repetitions;
+		output["benchmarks"]	= benchmarks.results();
+
+		if (parser.isSet(outputOption))
+		{
+			boost::nowide::ofstream out(parser.value(outputOption).toStdString().c_str(), ios_base::out | ios_base::trunc);
+
+			if (!out.is_open())
+				throw runtime_error("Could not write " + parser.value(outputOption).toStdString());
+
+			out << output.toStyledString();
+		}
+		else
+			cout << output.toStyledString();
+	}
+	catch (exception &e)
+	{
+		cerr << "Benchmarks failed: " << e.what() << endl;
+		result = 1;
+	}
+
+	tempfiles_deleteAll();
+
+	return result;
+}
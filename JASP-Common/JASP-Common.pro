@@ -14,7 +14,7 @@ include(../JASP.pri)
 windows:INCLUDEPATH += ../../boost_1_64_0
 
 
-windows:LIBS += -lole32 -loleaut32 -larchive.dll
+windows:LIBS += -lole32 -loleaut32 -lbcrypt -larchive.dll
 
 macx:QMAKE_CXXFLAGS_WARN_ON += -Wno-unused-parameter -Wno-unused-local-typedef
 macx:QMAKE_CXXFLAGS += -Wno-c++11-extensions
@@ -36,12 +36,17 @@ SOURCES += \
 	base64/cdecode.cpp \
 	base64/cencode.cpp \
 	column.cpp \
+	columnnamematcher.cpp \
 	columns.cpp \
+	columnstats.cpp \
 	datablock.cpp \
 	dataset.cpp \
+	datasetedit.cpp \
 	datasetpackage.cpp \
+	datasetshipper.cpp \
 	dirs.cpp \
 	filereader.cpp \
+	filterbitset.cpp \
 	ipcchannel.cpp \
 	label.cpp \
 	labels.cpp \
@@ -60,13 +65,18 @@ SOURCES += \
 	options/optionvariable.cpp \
 	options/optionvariables.cpp \
 	options/optionvariablesgroups.cpp \
+	hmac.cpp \
+	parallel.cpp \
 	processinfo.cpp \
 	sharedmemory.cpp \
+	socketchannel.cpp \
 	tempfiles.cpp \
+	tracing.cpp \
 	utils.cpp \
 	version.cpp \
     computedcolumn.cpp \
     computedcolumns.cpp \
+    constructorevaluator.cpp \
     enginedefinitions.cpp \
     options/optioncomputedcolumn.cpp \
     timers.cpp
@@ -91,13 +101,19 @@ HEADERS += \
 	boost/nowide/system.hpp \
 	boost/nowide/windows.hpp \
 	column.h \
+	columnnamematcher.h \
 	columns.h \
+	columnstats.h \
 	common.h \
 	datablock.h \
 	dataset.h \
+	datasetedit.h \
 	datasetpackage.h \
+	datasetshipper.h \
 	dirs.h \
+	enginechannel.h \
 	filereader.h \
+	filterbitset.h \
 	ipcchannel.h \
 	label.h \
 	labels.h \
@@ -119,15 +135,20 @@ HEADERS += \
 	options/optionvariable.h \
 	options/optionvariables.h \
 	options/optionvariablesgroups.h \
+	hmac.h \
+	parallel.h \
 	processinfo.h \
 	sharedmemory.h \
+	socketchannel.h \
 	tempfiles.h \
+	tracing.h \
 	utils.h \
 	version.h \
     options/optionvariablei.h \
     jsonredirect.h \
     computedcolumn.h \
     computedcolumns.h \
+    constructorevaluator.h \
     enginedefinitions.h \
     options/optioncomputedcolumn.h \
     timers.h
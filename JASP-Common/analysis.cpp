@@ -23,13 +23,14 @@
 #include "options/options.h"
 #include "tempfiles.h"
 #include "appinfo.h"
+#include "tracing.h"
 
 using namespace boost::uuids;
 using namespace boost;
 using namespace std;
 
-Analysis::Analysis(int id, string module, string name, string title, Json::Value &requiresInit, Json::Value &dataKey, Json::Value &stateKey, Json::Value &resultsMeta, Json::Value optionsJson, const Version &version, Json::Value *data, bool autorun, bool usedata, bool useJaspResults)
-	: _id(id), _module(module), _name(name), _title(title), _requiresInit(requiresInit), _dataKey(dataKey), _stateKey(stateKey), _resultsMeta(resultsMeta), _autorun(autorun), _usedata(usedata), _jaspResultsAnalysis(useJaspResults), _version(version)
+Analysis::Analysis(int id, string module, string name, string title, Json::Value &requiresInit, Json::Value &dataKey, Json::Value &stateKey, Json::Value &resultsMeta, Json::Value optionsJson, const Version &version, Json::Value *data, bool autorun, bool usedata, bool useJaspResults, bool readsOnlyUsedVariables)
+	: _id(id), _module(module), _name(name), _title(title), _requiresInit(requiresInit), _dataKey(dataKey), _stateKey(stateKey), _resultsMeta(resultsMeta), _autorun(autorun), _usedata(usedata), _jaspResultsAnalysis(useJaspResults), _readsOnlyUsedVariables(readsOnlyUsedVariables), _version(version)
 {
 	_options = new Options();
 
@@ -161,6 +162,8 @@ void Analysis::optionsChangedHandler(Option *option)
 
 	_status = Empty;
 	_revision++;
+
+	JASPTRACE_SCOPE_ANALYSIS("Analysis::optionsChanged", _id, _revision);
 	optionsChanged(this);
 }
 
@@ -38,7 +38,7 @@ public:
 
 	enum Status { Empty, Initing, Inited, InitedAndWaiting, Running, Complete, Aborting, Aborted, Error, SaveImg, EditImg, Exception };
 
-	Analysis(int id, std::string module, std::string name, std::string title, Json::Value &requiresInit, Json::Value &dataKey, Json::Value &stateKey, Json::Value &resultsMeta, Json::Value optionsJson, const Version &version, Json::Value *data, bool isAutorun = true, bool usedata = true, bool useJaspResults = false);
+	Analysis(int id, std::string module, std::string name, std::string title, Json::Value &requiresInit, Json::Value &dataKey, Json::Value &stateKey, Json::Value &resultsMeta, Json::Value optionsJson, const Version &version, Json::Value *data, bool isAutorun = true, bool usedata = true, bool useJaspResults = false, bool readsOnlyUsedVariables = false);
 
 	virtual ~Analysis();
 
@@ -81,8 +81,10 @@ public:
 			bool		isAutorun()				const	{ return _autorun;				}
 			bool		useData()				const	{ return _usedata;				}
 			bool		usesJaspResults()		const	{ return _jaspResultsAnalysis;	}
+			bool		readsOnlyUsedVariables()	const	{ return _readsOnlyUsedVariables;	}	///< Whether the R code reads no other columns than usedVariables(), so other columns can change without changing its results
 			Status		status()				const	{ return _status;				}
 			int			revision()				const	{ return _revision;				}
+	const	Version		&version()				const	{ return _version;				}
 			bool		isVisible()				const	{ return _visible;				}
 			bool		isRefreshBlocked()		const	{ return _refreshBlocked;		}
 	const	Json::Value	&getSaveImgOptions()	const	{ return _saveImgOptions;		}
@@ -139,7 +141,8 @@ private:
 				_resultsMeta;
 	bool		_autorun,
 				_usedata,
-				_jaspResultsAnalysis;
+				_jaspResultsAnalysis,
+				_readsOnlyUsedVariables;
 	Version		_version;
 	int			_revision		= 0;
 
@@ -47,10 +47,11 @@ Analysis *AnalysisLoader::load(int id, string moduleName, string analysisName, c
 		bool usesJaspResults		= analysisDesc.get("jaspResults",	false).asBool();
 		bool autorun				= analysisDesc.get("autorun",		false).asBool();
 		bool usedata				= analysisDesc.get("usedata",		true).asBool();
+		bool readsOnlyUsedVariables	= analysisDesc.get("readsOnlyUsedVariables",	false).asBool();
 
 		file.close();
 
-		return new Analysis(id, moduleName, analysisName, analysisTitle, requiresInit, dataKey, stateKey, resultsMeta, optionsJson, version, data, autorun, usedata, usesJaspResults);
+		return new Analysis(id, moduleName, analysisName, analysisTitle, requiresInit, dataKey, stateKey, resultsMeta, optionsJson, version, data, autorun, usedata, usesJaspResults, readsOnlyUsedVariables);
 	}
 
 	throw runtime_error(analysisName + " does not exist in your JASP version.");
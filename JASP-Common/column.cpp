@@ -25,6 +25,8 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <cmath>
+#include <algorithm>
+#include <unordered_map>
 #include <iostream>
 
 using namespace boost::interprocess;
@@ -44,6 +46,7 @@ Column &Column::operator=(const Column &column)
 		this->_columnType = column._columnType;
 		this->_blocks = column._blocks;
 		this->_labels = column._labels;
+		this->_revision++;
 	}
 
 	return *this;
@@ -82,68 +85,80 @@ void Column::_convertVectorIntToDouble(vector<int> &intValues, vector<double> &d
 
 }
 
-bool Column::_resetEmptyValuesForNominal(std::map<int, string> &emptyValuesMap)
+Column::RowsPerValue Column::_emptyRowsPerOrgValue(const std::map<int, string> &emptyValuesMap)
 {
-	bool hasChanged = false;
-	std::map<int, string> emptyValuesMapOrg = emptyValuesMap;
-	int row = 0;
-	bool hasEmptyValues = !emptyValuesMap.empty();
-	bool changeToNominalText = false;
-	Ints::iterator ints = AsInts.begin();
-	Ints::iterator end = AsInts.end();
+	RowsPerValue rowsPerValue;
 
-	set<int> uniqueValues = _labels.getIntValues();
+	for (const auto &emptyValue : emptyValuesMap)
+		rowsPerValue[emptyValue.second].push_back(emptyValue.first);
 
-	for (; ints != end; ints++)
-	{
-		int intValue = *ints;
-		if (intValue == INT_MIN && hasEmptyValues)
+	return rowsPerValue;
+}
+
+bool Column::_resetEmptyValuesForNominal(std::map<int, string> &emptyValuesMap)
+{
+	// Every original string of the empty rows and every level is checked only once, and only the rows with one that changed are touched.
+	RowsPerValue						emptyRows	= _emptyRowsPerOrgValue(emptyValuesMap);
+	vector<pair<const vector<int>*, int>>	notEmptyAnymore;
+
+	for (const auto &rowsWithValue : emptyRows)
+		if (!isEmptyValue(rowsWithValue.first))
 		{
-			auto search = emptyValuesMap.find(row);
-			if (search != emptyValuesMap.end())
+			int intValue;
+			if (!Utils::getIntValue(rowsWithValue.first, intValue))
 			{
-				string orgValue = search->second;
-				if (!isEmptyValue(orgValue))
-				{
-					// This value is not empty anymore
-					if (Utils::getIntValue(orgValue, intValue))
-					{
-						*ints = intValue;
-						uniqueValues.insert(intValue);
-						hasChanged = true;
-						emptyValuesMap.erase(search);
-					}
-					else
-					{
-						// The original value is not an integer, this column cannot be nominal anymore
-						// Let's make it a nominal text.
-						changeToNominalText = true;
-						break;
-					}
-				}
+				// The original value is not an integer, this column cannot be nominal anymore
+				// Let's make it a nominal text.
+				setColumnType(Column::ColumnTypeNominalText);
+				return _resetEmptyValuesForNominalText(emptyValuesMap, false);
 			}
+
+			notEmptyAnymore.push_back(make_pair(&rowsWithValue.second, intValue));
 		}
-		else if (intValue != INT_MIN && isEmptyValue(intValue))
+
+	bool				hasChanged		= false;
+	set<int>			uniqueValues	= _labels.getIntValues();
+	map<int, string>	nowEmpty;
+
+	for (int value : uniqueValues)
+		if (value != INT_MIN && isEmptyValue(value))
 		{
-			// This value is now considered as empty
-			*ints = INT_MIN;
-			uniqueValues.erase(intValue);
-			hasChanged = true;
 			std::ostringstream strs;
-			strs << intValue;
-			emptyValuesMap.insert(make_pair(row, strs.str()));
+			strs << value;
+			nowEmpty[value] = strs.str();
 		}
-		row++;
-	}
 
-	if (changeToNominalText)
+	if (!nowEmpty.empty())
 	{
-		setColumnType(Column::ColumnTypeNominalText);
-		emptyValuesMap.clear();
-		emptyValuesMap.insert(emptyValuesMapOrg.begin(), emptyValuesMapOrg.end());
-		hasChanged = _resetEmptyValuesForNominalText(emptyValuesMap, false);
+		int row = 0;
+		for (Ints::iterator ints = AsInts.begin(); ints != AsInts.end(); ints++, row++)
+		{
+			auto empty = nowEmpty.find(*ints);
+			if (empty != nowEmpty.end())
+			{
+				// This value is now considered as empty
+				*ints = INT_MIN;
+				emptyValuesMap.insert(make_pair(row, empty->second));
+			}
+		}
+
+		for (const auto &empty : nowEmpty)
+			uniqueValues.erase(empty.first);
+
+		hasChanged = true;
 	}
-	else if (hasChanged)
+
+	for (const auto &rowsWithValue : notEmptyAnymore)
+		for (int row : *rowsWithValue.first)
+			if (row < int(_rowCount) && AsInts[row] == INT_MIN)
+			{
+				AsInts[row] = rowsWithValue.second;
+				uniqueValues.insert(rowsWithValue.second);
+				emptyValuesMap.erase(row);
+				hasChanged = true;
+			}
+
+	if (hasChanged)
 		_labels.syncInts(uniqueValues);
 
 	return hasChanged;
@@ -151,57 +166,31 @@ bool Column::_resetEmptyValuesForNominal(std::map<int, string> &emptyValuesMap)
 
 bool Column::_resetEmptyValuesForScale(std::map<int, string> &emptyValuesMap)
 {
-	bool hasChanged = false;
-	int row = 0;
-	bool hasEmptyValues = !emptyValuesMap.empty();
-	bool changeToNominalText = false;
-	Doubles::iterator doubles = AsDoubles.begin();
-	Doubles::iterator end = AsDoubles.end();
+	// As for nominal: the original strings of the empty rows are checked once each, only their rows are touched.
+	RowsPerValue							emptyRows			= _emptyRowsPerOrgValue(emptyValuesMap);
+	vector<pair<const vector<int>*, double>>	notEmptyAnymore;
+	bool									changeToNominalText	= false;
 
-	for (; doubles != end; doubles++)
-	{
-		double doubleValue = *doubles;
-		if (std::isnan(doubleValue) && hasEmptyValues)
+	for (const auto &rowsWithValue : emptyRows)
+		if (!isEmptyValue(rowsWithValue.first))
 		{
-			auto search = emptyValuesMap.find(row);
-			if (search != emptyValuesMap.end())
+			double doubleValue;
+			if (!Utils::getDoubleValue(rowsWithValue.first, doubleValue))
 			{
-				string orgValue = search->second;
-				if (!isEmptyValue(orgValue))
-				{
-					// This value is not empty anymore
-					if (Utils::getDoubleValue(orgValue, doubleValue))
-					{
-						*doubles = doubleValue;
-						hasChanged = true;
-					}
-					else
-					{
-						changeToNominalText = true;
-						break;
-					}
-				}
+				changeToNominalText = true;
+				break;
 			}
+
+			notEmptyAnymore.push_back(make_pair(&rowsWithValue.second, doubleValue));
 		}
-		else if (!std::isnan(doubleValue) && isEmptyValue(doubleValue))
-		{
-			// This value is now considered as empty
-			*doubles = NAN;
-			hasChanged = true;
-			std::ostringstream strs;
-			strs << doubleValue;
-			emptyValuesMap.insert(make_pair(row, strs.str()));
-		}
-		row++;
-	}
 
 	if (changeToNominalText)
 	{
 		// Cannot use _resetEmptyValuesForNominalText since the AsInts are not set.
 		// So use setColumnAsNominalText
 		vector<string> values;
-		row = 0;
-		for (doubles = AsDoubles.begin(); doubles != end; doubles++)
+		int row = 0;
+		for (Doubles::iterator doubles = AsDoubles.begin(); doubles != AsDoubles.end(); doubles++)
 		{
 			double doubleValue = *doubles;
 			if (std::isnan(doubleValue))
@@ -228,12 +217,61 @@ bool Column::_resetEmptyValuesForScale(std::map<int, string> &emptyValuesMap)
 		map<int, string> newEmptyValues = setColumnAsNominalText(values);
 		emptyValuesMap.clear();
 		emptyValuesMap.insert(newEmptyValues.begin(), newEmptyValues.end());
-		hasChanged = true;
+
+		return true;
 	}
 
+	bool			hasChanged = false;
+	vector<double>	nowEmpty;
+
+	// NaN is always empty already, and would never compare equal anyway.
+	for (double emptyValue : Utils::getDoubleEmptyValues())
+		if (!std::isnan(emptyValue))
+			nowEmpty.push_back(emptyValue);
+
+	if (!nowEmpty.empty())
+	{
+		int row = 0;
+		for (Doubles::iterator doubles = AsDoubles.begin(); doubles != AsDoubles.end(); doubles++, row++)
+		{
+			double doubleValue = *doubles;
+			if (std::find(nowEmpty.begin(), nowEmpty.end(), doubleValue) != nowEmpty.end())
+			{
+				// This value is now considered as empty
+				*doubles = NAN;
+				hasChanged = true;
+				std::ostringstream strs;
+				strs << doubleValue;
+				emptyValuesMap.insert(make_pair(row, strs.str()));
+			}
+		}
+	}
+
+	for (const auto &rowsWithValue : notEmptyAnymore)
+		for (int row : *rowsWithValue.first)
+			if (row < int(_rowCount) && std::isnan(AsDoubles[row]))
+			{
+				AsDoubles[row] = rowsWithValue.second;
+				emptyValuesMap.erase(row);
+				hasChanged = true;
+			}
+
 	return hasChanged;
 }
 
+bool Column::_emptyValuesChangedForNominalText(const std::map<int, string> &emptyValuesMap)
+{
+	for (const auto &emptyValue : _emptyRowsPerOrgValue(emptyValuesMap))
+		if (!isEmptyValue(emptyValue.first))
+			return true;
+
+	for (size_t level = 0; level < _labels.size(); level++)
+		if (isEmptyValue(_labels.getValueFromRow(level)))
+			return true;
+
+	return false;
+}
+
 bool Column::_resetEmptyValuesForNominalText(std::map<int, string> &emptyValuesMap, bool tryToConvert)
 {
 	bool hasChanged = false;
@@ -246,8 +284,12 @@ bool Column::_resetEmptyValuesForNominalText(std::map<int, string> &emptyValuesM
 	vector<double> doubleValues;
 	set<int> uniqueIntValues;
 	map<int, string> intLabels;
+	map<int, string> valuePerKey; // Labels::getValueFromKey searches all the labels, so look them up once
 	bool canBeConvertedToIntegers = tryToConvert, canBeConvertedToDoubles = tryToConvert;
 
+	for (size_t level = 0; level < _labels.size(); level++)
+		valuePerKey[_labels[level].value()] = _labels.getValueFromRow(level);
+
 	for (; ints != end; ints++)
 	{
 		int key = *ints;
@@ -332,7 +374,8 @@ bool Column::_resetEmptyValuesForNominalText(std::map<int, string> &emptyValuesM
 		}
 		else
 		{
-			string orgValue = _labels.getValueFromKey(key);
+			auto found = valuePerKey.find(key);
+			string orgValue = found != valuePerKey.end() ? found->second : _labels.getValueFromKey(key);
 			values.push_back(orgValue);
 			if (isEmptyValue(orgValue))
 			{
@@ -412,12 +455,48 @@ bool Column::_resetEmptyValuesForNominalText(std::map<int, string> &emptyValuesM
 
 bool Column::resetEmptyValues(std::map<int, string> &emptyValuesMap)
 {
+	bool hasChanged;
+
 	if (_columnType == Column::ColumnTypeOrdinal || _columnType == Column::ColumnTypeNominal)
-		return _resetEmptyValuesForNominal(emptyValuesMap);
+		hasChanged = _resetEmptyValuesForNominal(emptyValuesMap);
 	else if (_columnType == Column::ColumnTypeScale)
-		return _resetEmptyValuesForScale(emptyValuesMap);
-	else
-		return _resetEmptyValuesForNominalText(emptyValuesMap);
+		hasChanged = _resetEmptyValuesForScale(emptyValuesMap);
+	else // Rebuilding a nominal text column (and trying to convert it) is only worth it when one of its values actually became or stopped being empty
+		hasChanged = _emptyValuesChangedForNominalText(emptyValuesMap) && _resetEmptyValuesForNominalText(emptyValuesMap);
+
+	if (hasChanged)
+		_revision++;
+
+	return hasChanged;
+}
+
+size_t Column::labelsNeededToResetEmptyValues(const std::map<int, string> &emptyValuesMap)
+{
+	// The labels are always removed before new ones are added, so the old ones plus every (not empty) original value bound them.
+	set<string>	orgValues;
+	bool		changeToNominalText = false;
+
+	for (const auto &emptyValue : emptyValuesMap)
+		if (!isEmptyValue(emptyValue.second) && orgValues.insert(emptyValue.second).second)
+		{
+			double doubleValue;
+			if (!Utils::getDoubleValue(emptyValue.second, doubleValue))
+				changeToNominalText = true;
+		}
+
+	if (_columnType != Column::ColumnTypeScale)
+		return _labels.size() + orgValues.size();
+
+	if (!changeToNominalText)
+		return 0;
+
+	// A scale column that becomes nominal text gets a label for each of its values
+	set<double> values;
+	for (Doubles::iterator doubles = AsDoubles.begin(); doubles != AsDoubles.end(); doubles++)
+		if (!std::isnan(*doubles))
+			values.insert(*doubles);
+
+	return values.size() + orgValues.size();
 }
 
 void Column::setSharedMemory(managed_shared_memory *mem)
@@ -583,12 +662,16 @@ bool Column::changeColumnType(Column::ColumnType newColumnType)
 	if (newColumnType == _columnType)
 		return true;
 
+	_revision++;
+
 	bool success = true;
 	if (newColumnType == ColumnTypeScale)
 		success = _changeColumnToScale();
 	else
 		success = _changeColumnToNominalOrOrdinal(newColumnType);
 
+	stats(); // Between nominal and ordinal only the type changes, the other conversions went through a setter that already did this
+
 	return success;
 }
 
@@ -702,6 +785,8 @@ bool Column::setColumnAsNominalOrOrdinal(const vector<int> &values, const set<in
 
 bool Column::_setColumnAsNominalOrOrdinal(const vector<int> &values, bool is_ordinal)
 {
+	_revision++;
+
 	Ints::iterator	intInputItr			= AsInts.begin();
 	size_t			nb_values			= 0;
 	bool			changedSomething	= false;
@@ -730,6 +815,7 @@ bool Column::_setColumnAsNominalOrOrdinal(const vector<int> &values, bool is_ord
 	}
 
 	setColumnType(is_ordinal ? Column::ColumnTypeOrdinal : Column::ColumnTypeNominal);
+	_computeStats();
 
 	return changedSomething;
 
@@ -737,6 +823,8 @@ bool Column::_setColumnAsNominalOrOrdinal(const vector<int> &values, bool is_ord
 
 bool Column::setColumnAsScale(const std::vector<double> &values)
 {
+	_revision++;
+
 	bool changedSomething = false;
 	_labels.clear();
 	Doubles::iterator doubleInputItr = AsDoubles.begin();
@@ -754,49 +842,91 @@ bool Column::setColumnAsScale(const std::vector<double> &values)
 	}
 
 	setColumnType(Column::ColumnTypeScale);
+	_computeStats();
 
 	return changedSomething;
 }
 
 std::map<int, std::string> Column::setColumnAsNominalText(const std::vector<std::string> &values, const std::map<std::string, std::string>&labels, bool * changedSomething)
 {
-	if(changedSomething != NULL)
-		*changedSomething = false;
-
 	std::map<int, std::string>	emptyValuesMap;
-	std::set<std::string>		cases(values.begin(), values.end());
-	std::vector<std::string>	sortedCases(cases.begin(), cases.end());
+	std::vector<int>			levelPerRow;
+	std::vector<std::string>	levels = nominalTextLevels(values, levelPerRow, emptyValuesMap);
 
-	std::sort(sortedCases.begin(), sortedCases.end());
+	setColumnAsNominalText(levels, levelPerRow, labels, changedSomething);
 
-	sortedCases.erase(std::remove_if(sortedCases.begin(),	sortedCases.end(), [](std::string x){	return isEmptyValue(x);}), sortedCases.end());
+	return emptyValuesMap;
+}
 
-	std::map<std::string, int> map = _labels.syncStrings(sortedCases, labels, changedSomething);
+std::vector<std::string> Column::nominalTextLevels(const std::vector<std::string> &values, std::vector<int> &levelPerRow, std::map<int, std::string> &emptyValuesMap)
+{
+	std::unordered_map<std::string, int>	levelOfValue;
+	std::vector<std::string>				levels;
 
-	auto	intInputItr = AsInts.begin();
-	int		nb_values	= 0;
+	levelPerRow.clear();
+	levelPerRow.reserve(values.size());
 
-	for(const std::string &value : values)
+	for (size_t row = 0; row < values.size(); row++)
 	{
-		if(intInputItr == AsInts.end())
-			throw std::runtime_error("Column::setColumnAsNominalText ran out of Ints in assigning..");
+		const std::string &value = values[row];
 
 		if (isEmptyValue(value))
 		{
-			if(changedSomething != NULL && *intInputItr != INT_MIN)
-				*changedSomething = true;
-
-			*intInputItr = INT_MIN;
+			levelPerRow.push_back(INT_MIN);
 			if (!value.empty())
-				emptyValuesMap.insert(make_pair(nb_values, value));
+				emptyValuesMap.insert(make_pair(row, value));
 		}
 		else
 		{
-			if(changedSomething != NULL && *intInputItr != map[value])
-				*changedSomething = true;
-
-			*intInputItr = map[value];
+			levelPerRow.push_back(0);
+			levelOfValue.insert(make_pair(value, 0));
 		}
+	}
+
+	levels.reserve(levelOfValue.size());
+	for (const auto &valueLevel : levelOfValue)
+		levels.push_back(valueLevel.first);
+
+	std::sort(levels.begin(), levels.end());
+
+	for (size_t level = 0; level < levels.size(); level++)
+		levelOfValue[levels[level]] = level;
+
+	for (size_t row = 0; row < values.size(); row++)
+		if (levelPerRow[row] != INT_MIN)
+			levelPerRow[row] = levelOfValue[values[row]];
+
+	return levels;
+}
+
+void Column::setColumnAsNominalText(const std::vector<std::string> &levels, const std::vector<int> &levelPerRow, const std::map<std::string, std::string> &labels, bool * changedSomething)
+{
+	_revision++;
+
+	if(changedSomething != NULL)
+		*changedSomething = false;
+
+	std::map<std::string, int>	map = _labels.syncStrings(levels, labels, changedSomething);
+	std::vector<int>			keyPerLevel;
+
+	keyPerLevel.reserve(levels.size());
+	for (const std::string &level : levels)
+		keyPerLevel.push_back(map[level]);
+
+	auto	intInputItr = AsInts.begin();
+	int		nb_values	= 0;
+
+	for(int level : levelPerRow)
+	{
+		if(intInputItr == AsInts.end())
+			throw std::runtime_error("Column::setColumnAsNominalText ran out of Ints in assigning..");
+
+		int key = level == INT_MIN ? INT_MIN : keyPerLevel[level];
+
+		if(changedSomething != NULL && *intInputItr != key)
+			*changedSomething = true;
+
+		*intInputItr = key;
 
 		intInputItr++;
 		nb_values++;
@@ -813,8 +943,7 @@ std::map<int, std::string> Column::setColumnAsNominalText(const std::vector<std:
 	}
 
 	setColumnType(Column::ColumnTypeNominalText);
-
-	return emptyValuesMap;
+	_computeStats();
 }
 
 string Column::_getLabelFromKey(int key) const
@@ -848,6 +977,9 @@ void Column::setName(string name)
 
 void Column::setValue(int row, int value)
 {
+	bool statsWereCurrent = _stats.revision == _revision;
+	_revision++;
+
 	BlockMap::iterator itr = _blocks.upper_bound(row);
 
 	if (itr == _blocks.end())
@@ -860,11 +992,18 @@ void Column::setValue(int row, int value)
 	DataBlock *block = itr->second.get();
 
 	int blockIndex = row - blockId + DataBlock::capacity();
+	int oldValue = block->Data[blockIndex].i;
 	block->Data[blockIndex].i = value;
+
+	if (statsWereCurrent && _replaceInStats(oldValue, value))
+		_stats.revision = _revision;
 }
 
 void Column::setValue(int row, double value)
 {
+	bool statsWereCurrent = _stats.revision == _revision;
+	_revision++;
+
 	BlockMap::iterator itr = _blocks.upper_bound(row);
 
 	if (itr == _blocks.end())
@@ -877,7 +1016,76 @@ void Column::setValue(int row, double value)
 	DataBlock *block = itr->second.get();
 
 	int blockIndex = row - blockId + DataBlock::capacity();
+	double oldValue = block->Data[blockIndex].d;
 	block->Data[blockIndex].d = value;
+
+	if (statsWereCurrent && _replaceInStats(oldValue, value))
+		_stats.revision = _revision;
+}
+
+bool Column::_replaceInStats(double oldValue, double newValue)
+{
+	return _columnType == ColumnTypeScale && _stats.replace(oldValue, newValue, true);
+}
+
+bool Column::_replaceInStats(int oldKey, int newKey)
+{
+	if (_columnType == ColumnTypeScale || _columnType == ColumnTypeUnknown)
+		return false;
+
+	if (oldKey == newKey)
+		return true;
+
+	auto asValue = [&](int key) { return key == INT_MIN ? NAN : _columnType == ColumnTypeNominalText ? 0.0 : double(key); };
+
+	if (!_stats.replace(asValue(oldKey), asValue(newKey), false))
+		return false;
+
+	Label	*oldLabel = NULL,
+			*newLabel = NULL;
+
+	for (size_t i = 0; i < _labels.size(); i++)
+	{
+		if (oldKey != INT_MIN && _labels[i].value() == oldKey)	oldLabel = &_labels[i];
+		if (newKey != INT_MIN && _labels[i].value() == newKey)	newLabel = &_labels[i];
+	}
+
+	if ((oldKey != INT_MIN && oldLabel == NULL) || (newKey != INT_MIN && newLabel == NULL))
+		return false; // The labels aren't synced with the data yet, the next stats() sorts that out
+
+	if (oldLabel != NULL)
+	{
+		oldLabel->setCount(oldLabel->count() - 1);
+		if (oldLabel->count() == 0)
+			_stats.distinct--;
+	}
+
+	if (newLabel != NULL)
+	{
+		if (newLabel->count() == 0)
+			_stats.distinct++;
+		newLabel->setCount(newLabel->count() + 1);
+	}
+
+	return true;
+}
+
+const ColumnStats &Column::stats()
+{
+	if (statsOutdated())
+		_computeStats();
+
+	return _stats;
+}
+
+void Column::_computeStats()
+{
+	ColumnStats::LevelCounts levelCounts;
+
+	_stats.compute(*this, NULL, &levelCounts);
+
+	if (_columnType != ColumnTypeScale)
+		ColumnStats::setLabelCounts(*this, levelCounts);
 }
 
 bool Column::isValueEqual(int row, double value)
@@ -1174,10 +1382,13 @@ Column::ColumnType Column::columnTypeFromString(std::string type)
 void Column::setColumnType(Column::ColumnType columnType)
 {
 	_columnType = columnType;
+	_revision++;
 }
 
 void Column::_setRowCount(int rowCount)
 {
+	_revision++;
+
 	if (rowCount > this->rowCount())
 		append(rowCount - this->rowCount());
 	else if (rowCount < this->rowCount())
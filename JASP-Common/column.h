@@ -25,6 +25,7 @@
 #include <boost/container/string.hpp>
 #include <boost/container/vector.hpp>
 
+#include "columnstats.h"
 #include "datablock.h"
 #include "labels.h"
 
@@ -36,6 +37,8 @@ class Column
 	friend class ComputedColumn;
 	friend class ComputedColumns;
 	friend class DataSetLoader;
+	friend struct ColumnStats;
+	friend class DataSet;
 	friend class boost::iterator_core_access;
 
 	typedef unsigned long long ull;
@@ -56,6 +59,7 @@ public:
 	static bool isEmptyValue(const double& val);
 
 	bool resetEmptyValues(std::map<int, std::string>& emptyValuesMap);
+	size_t labelsNeededToResetEmptyValues(const std::map<int, std::string>& emptyValuesMap); ///< At most this many labels are in use at any point of resetEmptyValues
 
 
 	bool overwriteDataWithScale(std::vector<double> scalarData);
@@ -144,7 +148,7 @@ public:
 		_id = ++count;
 	}
 
-	Column(const Column& col) : _mem(col._mem), _name(col._name), _columnType(col._columnType), _rowCount(col._rowCount), _blocks(col._blocks), _labels(col._labels)
+	Column(const Column& col) : _mem(col._mem), _name(col._name), _columnType(col._columnType), _rowCount(col._rowCount), _blocks(col._blocks), _labels(col._labels), _stats(col._stats), _filteredStats(col._filteredStats)
 	{
 		_id = ++count;
 	}
@@ -153,6 +157,8 @@ public:
 
 	std::string name() const;
 	int id() const;
+	size_t revision() const { return _revision; } ///< Changes whenever the data, labels or type of this column (might have) changed
+	void incRevision() { _revision++; }
 	void setName(std::string name);
 
 	void setValue(int row, int value);
@@ -194,6 +200,12 @@ public:
 
 	size_t rowCount() const { return _rowCount; }
 
+	///The summary of this column, the setters and setValue keep it up to date, anything else that changed the column gets it recomputed here.
+	///That writes to the shared memory, so only whoever is changing the data set calls this, anyone else gets a copy through DataSet::columnStats.
+	const ColumnStats &stats();
+
+	bool statsOutdated() const { return _stats.revision != _revision; }
+
 	Labels& labels();
 
 	Column &operator=(const Column &columns);
@@ -204,6 +216,10 @@ public:
 
 	std::map<int, std::string>	setColumnAsNominalText(const std::vector<std::string> &values,	const std::map<std::string, std::string> &labels, bool * changedSomething = NULL);
 	std::map<int, std::string>	setColumnAsNominalText(const std::vector<std::string> &values, bool * changedSomething = NULL)	{ return setColumnAsNominalText(values, std::map<std::string, std::string>(), changedSomething); }
+	void						setColumnAsNominalText(const std::vector<std::string> &levels,	const std::vector<int> &levelPerRow,			const std::map<std::string, std::string> &labels, bool * changedSomething = NULL);
+
+	///Works out the sorted levels of a nominal text column, which level each row has (INT_MIN for empty) and the empty values. Doesn't touch any column so it can run on any thread, setColumnAsNominalText(levels, levelPerRow, ...) then puts it in a column.
+	static std::vector<std::string> nominalTextLevels(const std::vector<std::string> &values, std::vector<int> &levelPerRow, std::map<int, std::string> &emptyValuesMap);
 
 	bool						setColumnAsNominalOrOrdinal(const std::vector<int> &values,		const std::set<int> &uniqueValues,			bool is_ordinal = false);
 	bool						setColumnAsNominalOrOrdinal(const std::vector<int> &values,		std::map<int, std::string> &uniqueValues,	bool is_ordinal = false);
@@ -229,14 +245,26 @@ private:
 	Labels _labels;
 
 	int _id;
+	size_t _revision = 0;
+
+	ColumnStats _stats,
+				_filteredStats; ///< Only of the rows that pass the filter, kept by DataSet::columnStats
 	static int count;
 
 	void _setRowCount(int rowCount);
+	bool _replaceInStats(double oldValue, double newValue);
+	bool _replaceInStats(int oldKey, int newKey);
+	void _computeStats();
 	std::string _getLabelFromKey(int key) const;
 	std::string _getScaleValue(int row);
 
 	void _convertVectorIntToDouble(std::vector<int> &intValues, std::vector<double> &doubleValues);
 
+	typedef std::map<std::string, std::vector<int>> RowsPerValue;
+
+	static RowsPerValue _emptyRowsPerOrgValue(const std::map<int, std::string> &emptyValuesMap);
+
+	bool _emptyValuesChangedForNominalText(const std::map<int, std::string> &emptyValuesMap);
 	bool _resetEmptyValuesForNominal(std::map<int, std::string> &emptyValuesMap);
 	bool _resetEmptyValuesForScale(std::map<int, std::string> &emptyValuesMap);
 	bool _resetEmptyValuesForNominalText(std::map<int, std::string> &emptyValuesMap, bool tryToConvert = true);
@@ -0,0 +1,193 @@
+//
+// Copyright (C) 2013-2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "columnnamematcher.h"
+#include <queue>
+
+void ColumnNameMatcher::setNames(const std::vector<std::string> & names, const std::vector<std::string> & replacements)
+{
+	_names			= names;
+	_replacements	= replacements.size() == names.size() ? replacements : names;
+
+	_nodes.clear();
+	_nodes.push_back(Node()); //root
+
+	for(size_t nameIndex = 0; nameIndex < _names.size(); nameIndex++)
+	{
+		const std::string & name = _names[nameIndex];
+
+		if(name.empty())
+			continue;
+
+		int node = 0;
+
+		for(char c : name)
+		{
+			auto found = _nodes[node].children.find(c);
+
+			if(found != _nodes[node].children.end())
+				node = found->second;
+			else
+			{
+				int newNode = _nodes.size();
+				_nodes.push_back(Node());
+				_nodes[newNode].depth		= _nodes[node].depth + 1;
+				_nodes[node].children[c]	= newNode;
+				node						= newNode;
+			}
+		}
+
+		if(_nodes[node].name == -1) //if a name occurs twice the first one is used
+			_nodes[node].name = nameIndex;
+	}
+
+	//Breadth first so the fail links of the shallower nodes are known when we need them
+	std::queue<int> todo;
+
+	for(auto & child : _nodes[0].children)
+		todo.push(child.second);
+
+	while(!todo.empty())
+	{
+		int node = todo.front();
+		todo.pop();
+
+		Node & current	= _nodes[node];
+		current.output	= current.name != -1 ? node : _nodes[current.fail].output;
+
+		for(auto & child : current.children)
+		{
+			int fail = current.fail;
+
+			while(fail != 0 && _nodes[fail].children.count(child.first) == 0)
+				fail = _nodes[fail].fail;
+
+			_nodes[child.second].fail = this->child(fail, child.first);
+			todo.push(child.second);
+		}
+	}
+}
+
+int ColumnNameMatcher::child(int node, char c) const
+{
+	auto found = _nodes[node].children.find(c);
+	return found == _nodes[node].children.end() ? 0 : found->second;
+}
+
+std::vector<int> ColumnNameMatcher::findMatches(const std::string & text) const
+{
+	std::vector<int>	matchAt(text.size(), -1);
+	std::vector<size_t>	matchLength(text.size(), 0);
+	int					state = 0;
+
+	for(size_t pos = 0; pos < text.size(); pos++)
+	{
+		char c = text[pos];
+
+		while(state != 0 && _nodes[state].children.count(c) == 0)
+			state = _nodes[state].fail;
+
+		state = child(state, c);
+
+		for(int found = _nodes[state].output; found > 0; found = _nodes[_nodes[found].fail].output)
+		{
+			size_t	length	= _nodes[found].depth,
+					start	= pos + 1 - length,
+					end		= pos + 1;
+
+			if(_checkBoundaries)
+			{
+				bool	startIsFree	= start == 0			|| !isNameChar(text[start - 1]),
+						endIsFree	= end == text.size()	|| (!isNameChar(text[end]) && text[end] != '(');
+
+				if(!startIsFree || !endIsFree)
+					continue;
+			}
+
+			if(length > matchLength[start])
+			{
+				matchLength[start]	= length;
+				matchAt[start]		= _nodes[found].name;
+			}
+		}
+	}
+
+	//Now remove the matches that start inside an earlier one, going from left to right
+	for(size_t pos = 0; pos < text.size(); pos++)
+		if(matchAt[pos] != -1)
+			for(size_t inside = pos + 1; inside < pos + matchLength[pos]; inside++)
+				matchAt[inside] = -1;
+
+	return matchAt;
+}
+
+std::set<std::string> ColumnNameMatcher::findAll(const std::string & text) const
+{
+	std::set<std::string> found;
+
+	for(int name : findMatches(text))
+		if(name != -1)
+			found.insert(_names[name]);
+
+	return found;
+}
+
+std::string ColumnNameMatcher::replaceAll(const std::string & text, std::set<std::string> * namesFound) const
+{
+	std::vector<int>	matchAt = findMatches(text);
+	std::string			result;
+
+	result.reserve(text.size());
+
+	for(size_t pos = 0; pos < text.size();)
+		if(matchAt[pos] == -1)
+			result += text[pos++];
+		else
+		{
+			const std::string & name = _names[matchAt[pos]];
+
+			result += _replacements[matchAt[pos]];
+			pos += name.size();
+
+			if(namesFound != NULL)
+				namesFound->insert(name);
+		}
+
+	return result;
+}
+
+std::string ColumnNameMatcher::replaceAll(const std::string & text, const std::map<std::string, std::string> & replacements) const
+{
+	std::vector<int>	matchAt = findMatches(text);
+	std::string			result;
+
+	result.reserve(text.size());
+
+	for(size_t pos = 0; pos < text.size();)
+		if(matchAt[pos] == -1)
+			result += text[pos++];
+		else
+		{
+			const std::string & name	= _names[matchAt[pos]];
+			auto				replace	= replacements.find(name);
+
+			result += replace == replacements.end() ? name : replace->second;
+			pos += name.size();
+		}
+
+	return result;
+}
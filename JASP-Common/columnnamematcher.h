@@ -0,0 +1,66 @@
+//
+// Copyright (C) 2013-2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef COLUMNNAMEMATCHER_H
+#define COLUMNNAMEMATCHER_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/* ColumnNameMatcher finds all occurrences of a set of names (usually the columnnames of the dataset) in a piece of text in one pass, using an Aho-Corasick automaton that is built once in setNames.
+ * When two names overlap the leftmost one wins and of those starting at the same spot the longest, so "Height Ratio" is never mistaken for "Height".
+ * With checkBoundaries a name only matches when it is "free", so not preceded or followed by a character that could be part of an R name and not followed by "(".
+ * This avoids replacing part of another term (Imagine what happens when you use a columname such as "E" and a filter that includes the term TRUE, it does not end well..) or a function like rep or if.
+ */
+class ColumnNameMatcher
+{
+public:
+							ColumnNameMatcher(bool checkBoundaries = true) : _checkBoundaries(checkBoundaries) { setNames({}); }
+
+	///Builds the automaton for names, each of which will be replaced by the replacement at the same index (or by itself if replacements is empty)
+	void					setNames(const std::vector<std::string> & names, const std::vector<std::string> & replacements = {});
+	const std::vector<std::string> & names() const { return _names; }
+
+	std::set<std::string>	findAll(const std::string & text) const;
+	std::string				replaceAll(const std::string & text, std::set<std::string> * namesFound = NULL) const;
+	std::string				replaceAll(const std::string & text, const std::map<std::string, std::string> & replacements) const; ///< Only replaces the names in replacements, but the others are still matched so their parts are left alone
+
+private:
+	struct Node
+	{
+		std::map<char, int>	children;
+		int					fail		= 0,
+							output		= -1,	///< Nearest node (this one or following fail) where a name ends
+							name		= -1;	///< Index of the name ending here
+		size_t				depth		= 0;
+	};
+
+	///For every position in text where a name starts that should be used, the index of that name. Or -1 otherwise.
+	std::vector<int>		findMatches(const std::string & text) const;
+	int						child(int node, char c) const;
+
+	static bool				isNameChar(char c) { return c == '.' || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9'); }
+
+	bool					_checkBoundaries;
+	std::vector<Node>		_nodes;
+	std::vector<std::string> _names,
+							_replacements;
+};
+
+#endif // COLUMNNAMEMATCHER_H
@@ -0,0 +1,221 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "columnstats.h"
+#include "column.h"
+
+#include <algorithm>
+#include <climits>
+#include <unordered_map>
+#include <vector>
+
+double ColumnStats::variance() const
+{
+	size_t n = finite();
+
+	if (n < 2)
+		return NAN;
+
+	return std::max(0.0, (sumOfSquares - sum * sum / n) / (n - 1));
+}
+
+void ColumnStats::compute(const Column &column, const FilterBitset::Selection *selection, LevelCounts *levelCounts)
+{
+	unsigned long generation = filterGeneration;
+
+	*this				= ColumnStats();
+	revision			= column.revision();
+	filterGeneration	= generation;
+
+	const bool	isScale		= column.columnType() == Column::ColumnTypeScale,
+				isNumeric	= column.columnType() != Column::ColumnTypeNominalText;
+
+	LevelCounts						keyCounts;
+	std::vector<double>				present;	// Scale values that aren't missing, for the histogram
+	double							values[BLOCK_SIZE];
+	bool							haveShift	= false;
+	size_t							row			= 0;
+
+	// A block at a time: its values (missing as NaN) are gathered in values first, so the loop that sums them has no branches in it.
+	for (const Column::BlockEntry &entry : column._blocks)
+	{
+		const DataBlock	*block	= entry.second.get();
+		int				rows	= block->_rowCount,
+						n		= 0;
+
+		for (int i = 0; i < rows; i++, row++)
+		{
+			if (selection != NULL && !selection->passes(row))
+				continue;
+
+			if (isScale)
+				values[n++] = block->Data[i].d;
+			else
+			{
+				int key = block->Data[i].i;
+
+				if (key != INT_MIN)
+					keyCounts[key]++;
+
+				values[n++] = key == INT_MIN ? NAN : isNumeric ? double(key) : 0.0;
+			}
+		}
+
+		for (int i = 0; i < n && !haveShift; i++)
+			if (std::isfinite(values[i]))
+			{
+				shift		= values[i];
+				haveShift	= true;
+			}
+
+		size_t	blockCount		= 0,
+				blockFinite		= 0;
+		double	blockSum		= 0,
+				blockSquares	= 0,
+				blockMin		= INFINITY,
+				blockMax		= -INFINITY;
+
+		for (int i = 0; i < n; i++)
+		{
+			double	value		= values[i];
+			bool	isPresent	= value == value,
+					isFinite	= std::isfinite(value);
+			double	shifted		= isFinite ? value - shift : 0.0;
+
+			blockCount		+= isPresent;
+			blockFinite		+= isFinite;
+			blockSum		+= shifted;
+			blockSquares	+= shifted * shifted;
+			blockMin		= isFinite && value < blockMin ? value : blockMin;
+			blockMax		= isFinite && value > blockMax ? value : blockMax;
+		}
+
+		count			+= blockCount;
+		infinite		+= blockCount - blockFinite;
+		missing			+= n - blockCount;
+		sum				+= blockSum;
+		sumOfSquares	+= blockSquares;
+
+		if (blockFinite > 0)
+		{
+			min = std::isnan(min) || blockMin < min ? blockMin : min;
+			max = std::isnan(max) || blockMax > max ? blockMax : max;
+		}
+
+		if (isScale)
+			for (int i = 0; i < n; i++)
+				if (std::isfinite(values[i]))
+					present.push_back(values[i]);
+	}
+
+	if (!isNumeric)
+	{
+		min = max = NAN;
+		shift = sum = sumOfSquares = 0;
+	}
+
+	if (isScale && finite() > 0)
+	{
+		histogramMin	= min;
+		histogramWidth	= (max - min) / histogramBins;
+
+		for (double value : present)
+			histogram[histogramBin(value)]++;
+	}
+
+	if (!isScale)
+	{
+		distinct = keyCounts.size();
+
+		if (levelCounts != NULL)
+			levelCounts->swap(keyCounts);
+	}
+}
+
+void ColumnStats::setLabelCounts(Column &column, const LevelCounts &levelCounts)
+{
+	for (size_t i = 0; i < column.labels().size(); i++)
+	{
+		Label	&label	= column.labels()[i];
+		auto	found	= levelCounts.find(label.value());
+
+		label.setCount(found == levelCounts.end() ? 0 : found->second);
+	}
+}
+
+int ColumnStats::histogramBin(double value) const
+{
+	if (histogramWidth <= 0)
+		return 0;
+
+	return std::min(histogramBins - 1, std::max(0, int((value - histogramMin) / histogramWidth)));
+}
+
+void ColumnStats::add(double value, bool isScale)
+{
+	if (std::isnan(value))
+	{
+		missing++;
+		return;
+	}
+
+	count++;
+	sum				+= value - shift;
+	sumOfSquares	+= (value - shift) * (value - shift);
+	min				= std::min(min, value);
+	max				= std::max(max, value);
+
+	if (isScale)
+		histogram[histogramBin(value)]++;
+}
+
+bool ColumnStats::replace(double oldValue, double newValue, bool isScale)
+{
+	bool	oldPresent	= !std::isnan(oldValue),
+			newPresent	= !std::isnan(newValue);
+
+	if (oldPresent == newPresent && (!oldPresent || oldValue == newValue))
+		return true;
+
+	if (std::isinf(oldValue) || std::isinf(newValue))
+		return false; // Rare enough to just compute them again
+
+	if (finite() == 0)
+		return false; // There is no shift, min or histogram to work from yet
+
+	if (oldPresent && (oldValue == min || oldValue == max))
+		return false; // Whatever is the new extreme is somewhere in the column
+
+	if (isScale && newPresent && (newValue < histogramMin || newValue > histogramMin + histogramWidth * histogramBins))
+		return false; // The bins would have to move
+
+	if (oldPresent)
+	{
+		count--;
+		sum				-= oldValue - shift;
+		sumOfSquares	-= (oldValue - shift) * (oldValue - shift);
+
+		if (isScale)
+			histogram[histogramBin(oldValue)]--;
+	}
+	else
+		missing--;
+
+	add(newValue, isScale);
+
+	return true;
+}
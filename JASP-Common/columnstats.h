@@ -0,0 +1,77 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef COLUMNSTATS_H
+#define COLUMNSTATS_H
+
+#include <cmath>
+#include <cstddef>
+#include <unordered_map>
+
+#include "filterbitset.h"
+
+class Column;
+
+/* ColumnStats is the summary of a column that the variables page, the column header tooltips and simple descriptives need:
+ * count, missing, min, max, mean, variance, how many levels occur and a small histogram.
+ * It is a fixed size block without pointers so it is kept in the Column itself, in shared memory, where the engines can read it too.
+ * How often each level of a column that isn't scale occurs is kept in the count of its Label.
+ *
+ * The moments are sums of the value minus a shift (the first finite value seen), which keeps the variance accurate
+ * and allows Column::setValue to take the old value out and put the new one in without going over the column again.
+ * Infinite values are counted but kept out of min, max, the moments and the histogram, they would make all of those meaningless.
+ */
+struct ColumnStats
+{
+	static const int histogramBins = 16;
+
+	typedef std::unordered_map<int, size_t> LevelCounts; ///< How often each key occurs
+
+	size_t			revision			= size_t(-1),	///< The Column::revision() these were computed for, if it doesn't match they are outdated.
+					count				= 0,			///< Values that aren't missing
+					missing				= 0,
+					infinite			= 0,			///< Values (part of count) that are -Inf or Inf
+					distinct			= 0;			///< Levels that occur, only for columns that aren't scale.
+	unsigned long	filterGeneration	= 0;			///< The FilterBitset::generation() of filtered stats.
+	double			min					= NAN,			///< min, max and the moments are NaN/0 for nominal text, its values are only keys.
+					max					= NAN,
+					shift				= 0,
+					sum					= 0,			///< Of value - shift
+					sumOfSquares		= 0,			///< Of (value - shift)^2
+					histogramMin		= NAN,
+					histogramWidth		= 0;
+	size_t			histogram[histogramBins] = {};		///< Scale only: bins of histogramWidth from histogramMin, which were min and max when the stats were computed.
+
+	size_t	finite()	const { return count - infinite; }
+	double	mean()		const { return finite() == 0 ? NAN : shift + sum / finite(); }
+	double	variance()	const; ///< The sample variance of the finite values
+
+	///Goes over the whole column, or only over the rows that pass selection, only reading it. For a column that isn't scale levelCounts (if given) gets how often each key occurs.
+	void	compute(const Column &column, const FilterBitset::Selection *selection = NULL, LevelCounts *levelCounts = NULL);
+
+	///Sets the counts of the labels of column to levelCounts, which writes to the shared memory.
+	static void	setLabelCounts(Column &column, const LevelCounts &levelCounts);
+
+	///Takes oldValue out and puts newValue in (NaN is missing, nominal text passes 0 for any level), returns false if the stats can't be kept exact that way and have to be computed again.
+	bool	replace(double oldValue, double newValue, bool isScale);
+
+private:
+	void	add(double value, bool isScale);
+	int		histogramBin(double value) const;
+};
+
+#endif // COLUMNSTATS_H
@@ -1,4 +1,3 @@
-#include <regex>
 #include "computedcolumn.h"
 #include "analysis.h"
 
@@ -43,13 +42,11 @@ void ComputedColumn::setAnalysis(Analysis *analysis)
 	_analysisId = _analysis == NULL ? -1 : _analysis->id();
 }
 
-std::vector<std::string> ComputedColumn::_allColumnNames;
+ColumnNameMatcher ComputedColumn::_columnNameMatcher;
 
 void ComputedColumn::setAllColumnNames(std::set<std::string> names)
 {
-	std::vector<std::string> sortMe(names.begin(), names.end());
-	std::sort(sortMe.begin(), sortMe.end(), [](std::string & a, std::string & b) { return a.size() > b.size(); }); //Sort on stringlength so that we can check the columns in the code from bigger to small (findUsedColumnNames) so that we can have both something like "Height Ratio"  and "Height"
-	_allColumnNames = sortMe;
+	_columnNameMatcher.setNames(std::vector<std::string>(names.begin(), names.end()));
 }
 
 std::set<std::string> ComputedColumn::findUsedColumnNames(std::string searchThis)
@@ -63,70 +60,12 @@ std::set<std::string> ComputedColumn::findUsedColumnNames(std::string searchThis
 
 std::set<std::string> ComputedColumn::findUsedColumnNamesStatic(std::string searchThis)
 {
-	//sort of based on rbridge_encodeColumnNamesToBase64
-	static std::regex nonNameChar("[^\\.A-Za-z0-9]");
-	std::set<std::string> columnsFound;
-
-	size_t foundPos = -1;
-	for(const std::string & col : _allColumnNames)
-	{
-		while((foundPos = searchThis.find(col, foundPos + 1)) != std::string::npos)
-		{
-			size_t foundPosEnd = foundPos + col.length();
-			//First check if it is a "free columnname" aka is there some space or a kind in front of it. We would not want to replace a part of another term (Imagine what happens when you use a columname such as "E" and a filter that includes the term TRUE, it does not end well..)
-			bool startIsFree	= foundPos == 0							|| std::regex_match(searchThis.substr(foundPos - 1, 1),	nonNameChar);
-			bool endIsFree		= foundPosEnd == searchThis.length()	|| (std::regex_match(searchThis.substr(foundPosEnd, 1),	nonNameChar) && searchThis[foundPosEnd] != '('); //Check for "(" as well because maybe someone has a columnname such as rep or if or something weird like that
-
-			if(startIsFree && endIsFree)
-			{
-				columnsFound.insert(col);
-				searchThis.replace(foundPos, col.length(), ""); // remove the found entry
-			}
-
-		}
-	}
-
-	return columnsFound;
+	return _columnNameMatcher.findAll(searchThis);
 }
 
 void ComputedColumn::replaceChangedColumnNamesInRCode(std::map<std::string, std::string> changedNames)
 {
-	//sort of based on rbridge_encodeColumnNamesToBase64
-	static std::regex nonNameChar("[^\\.A-Za-z0-9]");
-
-	std::map<std::string, std::string> columnToEncode, encodeToColumn; //First we convert all columnNames we find into something generic (to avoid replacing part of cols like "Height Ratio" when replacing "Height"
-	const static std::string genericPrepender("!@#$%JASP_Column_PlaceHolder"); //I guess nobody will use this unless they are looking at these sources and feel like having a laugh?
-
-	int counter = 0;
-	for(const std::string & column : _allColumnNames)
-	{
-		std::string encoded = genericPrepender + std::to_string(counter++) + "!@#$%";
-		columnToEncode[column]  = encoded;
-		encodeToColumn[encoded] = changedNames.count(column) > 0 ? changedNames.at(column) : column;
-	}
-
-	std::string searchThis = _rCode;
-
-	size_t foundPos = -1;
-	for(const std::string & col : _allColumnNames)
-	{
-		while((foundPos = searchThis.find(col, foundPos + 1)) != std::string::npos)
-		{
-			size_t foundPosEnd = foundPos + col.length();
-			//First check if it is a "free columnname" aka is there some space or a kind in front of it. We would not want to replace a part of another term (Imagine what happens when you use a columname such as "E" and a filter that includes the term TRUE, it does not end well..)
-			bool startIsFree	= foundPos == 0							|| std::regex_match(searchThis.substr(foundPos - 1, 1),	nonNameChar);
-			bool endIsFree		= foundPosEnd == searchThis.length()	|| (std::regex_match(searchThis.substr(foundPosEnd, 1),	nonNameChar) && searchThis[foundPosEnd] != '('); //Check for "(" as well because maybe someone has a columnname such as rep or if or something weird like that
-
-			if(startIsFree && endIsFree)
-				searchThis.replace(foundPos, col.length(), columnToEncode[col]); // encode the found entry
-		}
-	}
-
-	for(auto encCol : encodeToColumn)
-		for(std::string::size_type pos = searchThis.find(encCol.first, 0); pos != std::string::npos; pos = searchThis.find(encCol.first, pos))
-			searchThis.replace(pos, encCol.first.length(), encCol.second); //Replacing em all with either the original columnName or the new columnname!
-
-	setRCode(searchThis);
+	setRCode(_columnNameMatcher.replaceAll(_rCode, changedNames)); //All names are matched in one go, so renaming "Height" doesn't touch "Height Ratio"
 }
 
 bool ComputedColumn::iShouldBeSentAgain()
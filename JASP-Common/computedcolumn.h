@@ -2,6 +2,7 @@
 #define COMPUTEDCOLUMN_H
 
 #include "columns.h"
+#include "columnnamematcher.h"
 #include "jsonredirect.h"
 #include <list>
 
@@ -38,6 +39,7 @@ public:
 			std::string				error()							const			{ return _error;							}
 			computedType			codeType()						const			{ return _codeType;							}
 			std::string				constructorJson()				const			{ return _constructorCode.toStyledString(); }
+			const Json::Value &		constructorCode()				const			{ return _constructorCode;					}
 			Analysis *				analysis()										{ return _analysis;							}
 
 			bool					isInvalidated()					const			{ return _invalidated;						}
@@ -77,7 +79,7 @@ private:
 			Json::Value						_constructorCode	= Json::objectValue;
 			Analysis						*_analysis			= NULL;
 
-	static	std::vector<std::string>		_allColumnNames;
+	static	ColumnNameMatcher				_columnNameMatcher;
 			std::set<std::string>			_dependsOnColumns;
 
 			Column							*_outputColumn;
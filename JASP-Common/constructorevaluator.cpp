@@ -0,0 +1,722 @@
+//
+// Copyright (C) 2013-2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "constructorevaluator.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <climits>
+#include <set>
+#include <map>
+#include "utils.h"
+
+ConstructorEvaluator::Values ConstructorEvaluator::Values::scalar(double value, valueType type)
+{
+	Values out;
+	out.type	= type;
+	out.numbers	= { value };
+	return out;
+}
+
+bool ConstructorEvaluator::evaluateInto(const Json::Value & constructorJson, Column & outputColumn)
+{
+	const Json::Value & formulas = constructorJson.get("formulas", Json::nullValue);
+
+	if(!formulas.isArray() || formulas.size() != 1)
+		throw notNative("expected exactly one formula");
+
+	Values result;
+
+	try							{ result = evaluate(formulas[0u]); }
+	catch(columnNotFound & e)	{ throw notNative(e.what()); }
+
+	switch(outputColumn.columnType())
+	{
+	case Column::ColumnTypeScale:		return writeScale(result, outputColumn);
+	case Column::ColumnTypeOrdinal:		return writeNominal(result, outputColumn, true);
+	case Column::ColumnTypeNominal:		return writeNominal(result, outputColumn, false);
+	case Column::ColumnTypeNominalText:	return writeNominalText(result, outputColumn);
+	default:							throw notNative("unknown column type of output");
+	}
+}
+
+ConstructorEvaluator::Values ConstructorEvaluator::evaluate(const Json::Value & node)
+{
+	if(!node.isObject())
+		throw notNative("formula is incomplete");
+
+	std::string nodeType = node.get("nodeType", "").asString();
+
+	if(nodeType == "Operator" || nodeType == "OperatorVertical")	return evaluateOperator(node);
+	else if(nodeType == "Function")									return evaluateFunction(node);
+	else if(nodeType == "Column")									return readColumn(node.get("columnName", "").asString());
+	else if(nodeType == "Number")
+	{
+		const Json::Value & value = node.get("value", Json::nullValue);
+
+		if(value.isNumeric())
+			return Values::scalar(value.asDouble());
+
+		double	parsed;
+		if(value.isString() && Utils::getDoubleValue(value.asString(), parsed))
+			return Values::scalar(parsed);
+
+		throw notNative("Number without a numeric value");
+	}
+	else if(nodeType == "String")
+	{
+		Values out;
+		out.type	= Values::valueType::string;
+		out.strings	= { node.get("text", "").asString() };
+		out.missing	= { false };
+		return out;
+	}
+
+	throw notNative("unknown nodeType '" + nodeType + "'");
+}
+
+ConstructorEvaluator::Values ConstructorEvaluator::readColumn(const std::string & columnName)
+{
+	Column	&	column = _columns.get(columnName);
+	Values		out;
+
+	if(column.columnType() == Column::ColumnTypeScale)
+	{
+		out.numbers.reserve(column.rowCount());
+
+		for(double value : column.AsDoubles)
+			out.numbers.push_back(value);
+
+		return out;
+	}
+
+	//Everything else is read as a factor by rbridge_readDataSet, with the texts of the labels as levels
+	const Labels & labels = column.labels();
+
+	if(labels.size() == 0)
+		throw notNative("column '" + columnName + "' has no labels");
+
+	std::map<int, size_t> keyToLevel;
+
+	for(const Label & label : labels)
+	{
+		keyToLevel[label.value()] = out.levels.size();
+		out.levels.push_back(label.text());
+	}
+
+	out.type = Values::valueType::factor;
+	out.strings.reserve(column.rowCount());
+	out.missing.reserve(column.rowCount());
+
+	for(int key : column.AsInts)
+	{
+		auto level = keyToLevel.find(key);
+
+		if(key == INT_MIN || level == keyToLevel.end())
+		{
+			out.strings.push_back("");
+			out.missing.push_back(true);
+		}
+		else
+		{
+			out.strings.push_back(out.levels[level->second]);
+			out.missing.push_back(false);
+		}
+	}
+
+	return out;
+}
+
+ConstructorEvaluator::Values ConstructorEvaluator::evaluateOperator(const Json::Value & node)
+{
+	std::string	op		= node.get("operator", "").asString();
+	Values		left	= evaluate(node.get("leftArgument",		Json::nullValue)),
+				right	= evaluate(node.get("rightArgument",	Json::nullValue));
+
+	static const std::set<std::string>	arithmeticOps	= { "+", "-", "*", "/", "^", "%%" },
+										compareOps		= { "==", "!=", "<", "<=", ">", ">=" },
+										logicalOps		= { "&", "|" };
+
+	if(arithmeticOps.count(op) > 0)	return arithmetic(op, left, right);
+	if(compareOps.count(op) > 0)	return compare(op, left, right);
+	if(logicalOps.count(op) > 0)	return logical(op, left, right);
+
+	throw notNative("operator '" + op + "'");
+}
+
+ConstructorEvaluator::Values ConstructorEvaluator::evaluateFunction(const Json::Value & node)
+{
+	std::string			functionName	= node.get("functionName", "").asString();
+	const Json::Value &	argsJson		= node.get("arguments", Json::arrayValue);
+	std::vector<Values>	args;
+
+	for(const Json::Value & arg : argsJson)
+		args.push_back(evaluate(arg.get("argument", Json::nullValue)));
+
+	static const std::set<std::string>	unaryMathFunctions	= { "sqrt", "abs", "log", "log2", "log10", "exp", "fishZ", "invFishZ" },
+										aggregateFunctions	= { "sum", "prod", "mean", "median", "min", "max", "sd", "var", "length" };
+
+	auto expectArgs = [&](size_t count)
+	{
+		if(args.size() != count)
+			throw notNative(functionName + " with " + std::to_string(args.size()) + " arguments");
+	};
+
+	if(unaryMathFunctions.count(functionName) > 0)
+	{
+		expectArgs(1);
+		return unaryMath(functionName, args[0]);
+	}
+
+	if(aggregateFunctions.count(functionName) > 0)
+	{
+		expectArgs(1);
+		return aggregate(functionName, args[0]);
+	}
+
+	if(functionName == "!")
+	{
+		expectArgs(1);
+		checkNumeric(args[0], functionName);
+
+		Values out;
+		out.type = Values::valueType::logical;
+		out.numbers.resize(args[0].size());
+
+		for(size_t i=0; i<out.numbers.size(); i++)
+			out.numbers[i] = std::isnan(args[0].numbers[i]) ? NAN : args[0].numbers[i] == 0 ? 1 : 0;
+
+		return out;
+	}
+
+	if(functionName == "ifelse")
+	{
+		expectArgs(3);
+		return ifElse(args[0], args[1], args[2]);
+	}
+
+	if(functionName == "replaceNA") //replaceNA <- function(column, replaceWith) { return(ifelse(is.na(column), replaceWith, column)) }
+	{
+		expectArgs(2);
+
+		Values isNA;
+		isNA.type = Values::valueType::logical;
+		isNA.numbers.resize(args[0].size());
+
+		for(size_t i=0; i<isNA.numbers.size(); i++)
+			isNA.numbers[i] = args[0].isText() ? args[0].missing[i] : std::isnan(args[0].numbers[i]);
+
+		return ifElse(isNA, args[1], args[0]);
+	}
+
+	if(functionName == "logb" || functionName == "round")
+	{
+		expectArgs(2);
+		checkNumeric(args[0], functionName);
+		checkNumeric(args[1], functionName);
+
+		const Values	&	x = args[0],
+						&	y = args[1];
+		size_t				n = x.size() == 0 || y.size() == 0 ? 0 : std::max(x.size(), y.size());
+		Values				out;
+
+		out.numbers.resize(n);
+
+		for(size_t i=0; i<n; i++)
+		{
+			double a = x.numbers[i % x.size()], b = y.numbers[i % y.size()];
+
+			if(functionName == "logb")
+			{
+				if(a < 0 || b < 0)
+					throw notNative("logb would produce NaNs");
+
+				out.numbers[i] = std::log(a) / std::log(b);
+			}
+			else if(std::isnan(b))
+				out.numbers[i] = NAN;
+			else if(!std::isfinite(a))
+				out.numbers[i] = a;
+			else
+			{
+				//Like R's fround: the digits are clamped to what a double can hold and only the fraction is scaled up, so the scale can't overflow
+				int		digits	= static_cast<int>(std::floor(std::min(std::max(b, -308.0), 308.0) + 0.5));
+				double	sign	= a < 0 ? -1.0 : 1.0,
+						value	= std::fabs(a);
+
+				if(digits == 0)
+					out.numbers[i] = sign * std::nearbyint(value);
+				else if(digits > 0)
+				{
+					double scale	= std::pow(10.0, digits),
+						   whole	= std::floor(value);
+					out.numbers[i]	= sign * (whole + std::nearbyint((value - whole) * scale) / scale);
+				}
+				else
+				{
+					double scale	= std::pow(10.0, -digits);
+					out.numbers[i]	= sign * std::nearbyint(value / scale) * scale;
+				}
+			}
+		}
+
+		return out;
+	}
+
+	throw notNative("function '" + functionName + "'");
+}
+
+void ConstructorEvaluator::checkNumeric(const Values & values, const std::string & where)
+{
+	if(!values.isNumeric())
+		throw notNative(where + " on non-numeric data");
+}
+
+ConstructorEvaluator::Values ConstructorEvaluator::arithmetic(const std::string & op, const Values & left, const Values & right)
+{
+	checkNumeric(left,	op);
+	checkNumeric(right,	op);
+
+	const std::vector<double>	&	l	= left.numbers,
+								&	r	= right.numbers;
+	size_t							n	= l.size() == 0 || r.size() == 0 ? 0 : std::max(l.size(), r.size());
+	Values							out;
+	std::vector<double>			&	o	= out.numbers;
+
+	o.resize(n);
+
+	auto apply = [&](double (*func)(double, double))
+	{
+		if(l.size() == n && r.size() == n)	for(size_t i=0; i<n; i++) o[i] = func(l[i],				r[i]);
+		else if(r.size() == 1)				for(size_t i=0; i<n; i++) o[i] = func(l[i],				r[0]);
+		else if(l.size() == 1)				for(size_t i=0; i<n; i++) o[i] = func(l[0],				r[i]);
+		else								for(size_t i=0; i<n; i++) o[i] = func(l[i % l.size()],	r[i % r.size()]);
+	};
+
+	if		(op == "+")		apply([](double a, double b) { return a + b;					});
+	else if	(op == "-")		apply([](double a, double b) { return a - b;					});
+	else if	(op == "*")		apply([](double a, double b) { return a * b;					});
+	else if	(op == "/")		apply([](double a, double b) { return a / b;					});
+	else if	(op == "^")		apply([](double a, double b) { return std::pow(a, b);			});
+	else if	(op == "%%")	apply([](double a, double b) { return a - std::floor(a / b) * b;	});
+
+	return out;
+}
+
+ConstructorEvaluator::Values ConstructorEvaluator::compare(const std::string & op, const Values & left, const Values & right)
+{
+	size_t	n = left.size() == 0 || right.size() == 0 ? 0 : std::max(left.size(), right.size());
+	Values	out;
+
+	out.type = Values::valueType::logical;
+	out.numbers.resize(n);
+
+	if(left.isNumeric() && right.isNumeric())
+	{
+		for(size_t i=0; i<n; i++)
+		{
+			double	a = left.numbers[i % left.size()],
+					b = right.numbers[i % right.size()];
+
+			bool	result;
+
+			if		(op == "==")	result = a == b;
+			else if	(op == "!=")	result = a != b;
+			else if	(op == "<")		result = a <  b;
+			else if	(op == "<=")	result = a <= b;
+			else if	(op == ">")		result = a >  b;
+			else					result = a >= b;
+
+			out.numbers[i] = std::isnan(a) || std::isnan(b) ? NAN : result;
+		}
+
+		return out;
+	}
+
+	//From here on R compares the texts, but the ordering depends on the locale (and on the levels of ordered factors) so we leave that to R
+	if(op != "==" && op != "!=")
+		throw notNative("ordering of text or factors");
+
+	if(left.type == Values::valueType::factor && right.type == Values::valueType::factor && left.levels != right.levels)
+		throw notNative("comparing factors with different levels");
+
+	Values	a = asText(left),
+			b = asText(right);
+
+	for(size_t i=0; i<n; i++)
+	{
+		size_t	ia = i % a.size(),
+				ib = i % b.size();
+
+		if(a.missing[ia] || b.missing[ib])	out.numbers[i] = NAN;
+		else								out.numbers[i] = (a.strings[ia] == b.strings[ib]) == (op == "==");
+	}
+
+	return out;
+}
+
+ConstructorEvaluator::Values ConstructorEvaluator::logical(const std::string & op, const Values & left, const Values & right)
+{
+	checkNumeric(left,	op);
+	checkNumeric(right,	op);
+
+	size_t	n = left.size() == 0 || right.size() == 0 ? 0 : std::max(left.size(), right.size());
+	Values	out;
+
+	out.type = Values::valueType::logical;
+	out.numbers.resize(n);
+
+	for(size_t i=0; i<n; i++)
+	{
+		double	a = left.numbers[i % left.size()],
+				b = right.numbers[i % right.size()];
+
+		bool	aNA = std::isnan(a),
+				bNA = std::isnan(b);
+
+		if(op == "&")
+		{
+			if((!aNA && a == 0) || (!bNA && b == 0))	out.numbers[i] = 0;
+			else if(aNA || bNA)							out.numbers[i] = NAN;
+			else										out.numbers[i] = 1;
+		}
+		else
+		{
+			if((!aNA && a != 0) || (!bNA && b != 0))	out.numbers[i] = 1;
+			else if(aNA || bNA)							out.numbers[i] = NAN;
+			else										out.numbers[i] = 0;
+		}
+	}
+
+	return out;
+}
+
+ConstructorEvaluator::Values ConstructorEvaluator::ifElse(const Values & test, const Values & yes, const Values & no)
+{
+	checkNumeric(test, "ifelse");
+
+	if(yes.type == Values::valueType::factor || no.type == Values::valueType::factor)
+		throw notNative("ifelse on factors"); //R would return the codes of the factor instead of the labels, rather not guess at that
+
+	bool anyYes = false, anyNo = false;
+
+	for(double t : test.numbers)
+		if(!std::isnan(t))
+		{
+			anyYes	= anyYes	|| t != 0;
+			anyNo	= anyNo		|| t == 0;
+		}
+
+	//Like R, the result starts out as logical and is promoted to the type of yes or no only if they are actually used.
+	Values::valueType resultType = Values::valueType::logical;
+
+	auto promote = [&](const Values & used)
+	{
+		if(used.type == Values::valueType::string || resultType == Values::valueType::string)	resultType = Values::valueType::string;
+		else if(used.type == Values::valueType::number)									resultType = Values::valueType::number;
+	};
+
+	if(anyYes)	promote(yes);
+	if(anyNo)	promote(no);
+
+	size_t	n = test.size();
+	Values	out;
+
+	out.type = resultType;
+
+	if(resultType == Values::valueType::string)
+	{
+		Values	yesText = asText(yes),
+				noText	= asText(no);
+
+		out.strings.resize(n);
+		out.missing.resize(n, true);
+
+		for(size_t i=0; i<n; i++)
+		{
+			double			t		= test.numbers[i];
+			const Values &	source	= t != 0 ? yesText : noText;
+
+			if(std::isnan(t) || source.size() == 0)
+				continue;
+
+			out.strings[i] = source.strings[i % source.size()];
+			out.missing[i] = source.missing[i % source.size()];
+		}
+	}
+	else
+	{
+		out.numbers.resize(n, NAN);
+
+		for(size_t i=0; i<n; i++)
+		{
+			double			t		= test.numbers[i];
+			const Values &	source	= t != 0 ? yes : no;
+
+			if(!std::isnan(t) && source.size() > 0)
+				out.numbers[i] = source.numbers[i % source.size()];
+		}
+	}
+
+	return out;
+}
+
+ConstructorEvaluator::Values ConstructorEvaluator::unaryMath(const std::string & functionName, const Values & arg)
+{
+	checkNumeric(arg, functionName);
+
+	Values out;
+	out.numbers.resize(arg.size());
+
+	double (*func)(double) = nullptr;
+
+	if		(functionName == "sqrt")		func = [](double x) { return std::sqrt(x);	};
+	else if	(functionName == "abs")			func = [](double x) { return std::fabs(x);	};
+	else if	(functionName == "log")			func = [](double x) { return std::log(x);	};
+	else if	(functionName == "log2")		func = [](double x) { return std::log2(x);	};
+	else if	(functionName == "log10")		func = [](double x) { return std::log10(x);	};
+	else if	(functionName == "exp")			func = [](double x) { return std::exp(x);	};
+	else if	(functionName == "fishZ")		func = [](double x) { return std::atanh(x);	};
+	else if	(functionName == "invFishZ")	func = [](double x) { return std::tanh(x);	};
+
+	for(size_t i=0; i<out.numbers.size(); i++)
+	{
+		double x		= arg.numbers[i];
+		out.numbers[i]	= func(x);
+
+		if(std::isnan(out.numbers[i]) && !std::isnan(x))
+			throw notNative(functionName + " would produce NaNs"); //R gives a warning for that and we want the user to see it
+	}
+
+	return out;
+}
+
+ConstructorEvaluator::Values ConstructorEvaluator::aggregate(const std::string & functionName, const Values & arg)
+{
+	if(functionName == "length")
+		return Values::scalar(arg.size());
+
+	checkNumeric(arg, functionName);
+
+	//The constructor adds na.rm=TRUE to all of these (see addNARMFunctions in Function.qml), so NA and NaN are dropped
+	std::vector<double> x;
+	x.reserve(arg.numbers.size());
+
+	for(double value : arg.numbers)
+		if(!std::isnan(value))
+			x.push_back(value);
+
+	if		(x.size() == 0 && functionName == "sum")	return Values::scalar(0);
+	else if	(x.size() == 0 && functionName == "prod")	return Values::scalar(1);
+	else if	(x.size() == 0)								throw notNative(functionName + " of nothing"); //min and max give a warning, the others NA or NaN
+
+	double result = 0;
+
+	if		(functionName == "sum")		{ for(double v : x) result += v; }
+	else if	(functionName == "prod")	{ result = 1; for(double v : x) result *= v; }
+	else if	(functionName == "min")		{ result = *std::min_element(x.begin(), x.end()); }
+	else if	(functionName == "max")		{ result = *std::max_element(x.begin(), x.end()); }
+	else if	(functionName == "median")
+	{
+		std::vector<double> sorted(x);
+		std::sort(sorted.begin(), sorted.end());
+
+		size_t half = sorted.size() / 2;
+		result = sorted.size() % 2 == 1 ? sorted[half] : (sorted[half - 1] + sorted[half]) / 2;
+	}
+	else //mean, sd or var
+	{
+		double mean = 0;
+		for(double v : x) mean += v;
+		mean /= x.size();
+
+		if(functionName == "mean")
+			result = mean;
+		else if(x.size() < 2)
+			result = NAN;
+		else
+		{
+			double sumSq = 0;
+			for(double v : x) sumSq += (v - mean) * (v - mean);
+
+			result = sumSq / (x.size() - 1);
+
+			if(functionName == "sd")
+				result = std::sqrt(result);
+		}
+	}
+
+	return Values::scalar(result);
+}
+
+ConstructorEvaluator::Values ConstructorEvaluator::asText(const Values & values)
+{
+	if(values.isText())
+		return values;
+
+	Values out;
+	out.type = Values::valueType::string;
+	out.strings.resize(values.size());
+	out.missing.resize(values.size(), false);
+
+	for(size_t i=0; i<values.size(); i++)
+	{
+		double value = values.numbers[i];
+
+		if(std::isnan(value))							out.missing[i]	= true;
+		else if(values.type == Values::valueType::logical)		out.strings[i]	= value != 0 ? "TRUE" : "FALSE";
+		else											out.strings[i]	= numberToString(value);
+	}
+
+	return out;
+}
+
+std::string ConstructorEvaluator::numberToString(double value)
+{
+	if(std::isnan(value))	return "NA";
+	if(std::isinf(value))	return value > 0 ? "Inf" : "-Inf";
+	if(value == 0)			return "0";
+
+	//R uses the least amount of significant digits (max 15) that still represents the value, and then chooses fixed or scientific notation depending on which one is shortest
+	char	buffer[64];
+	double	target;
+
+	snprintf(buffer, sizeof(buffer), "%.15g", value);
+	target = std::strtod(buffer, NULL);
+
+	int digits = 1;
+	for(; digits < 15; digits++)
+	{
+		snprintf(buffer, sizeof(buffer), "%.*g", digits, value);
+		if(std::strtod(buffer, NULL) == target)
+			break;
+	}
+
+	snprintf(buffer, sizeof(buffer), "%.*e", digits - 1, value);
+	std::string scientific(buffer);
+
+	int exponent	= static_cast<int>(std::floor(std::log10(std::fabs(target))));
+	int decimals	= std::max(0, digits - 1 - exponent);
+
+	snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+	std::string fixed(buffer);
+
+	return fixed.size() <= scientific.size() ? fixed : scientific;
+}
+
+bool ConstructorEvaluator::writeScale(const Values & result, Column & outputColumn)
+{
+	std::vector<double> scalarData;
+
+	if(result.type == Values::valueType::number)
+		scalarData = result.numbers;
+	else if(result.type == Values::valueType::logical)
+		scalarData.resize(result.size(), NAN); //.setColumnDataAsScale does as.numeric(as.character(x)) on anything that isn't a double, that turns logicals into NA
+	else
+	{
+		scalarData.resize(result.size(), NAN);
+
+		for(size_t i=0; i<result.size(); i++)
+			if(!result.missing[i])
+			{
+				std::string	text	= result.strings[i];
+				char		*end	= NULL;
+
+				text.erase(0, text.find_first_not_of(" \t\n\r"));
+				text.erase(text.find_last_not_of(" \t\n\r") + 1);
+
+				double		parsed	= std::strtod(text.c_str(), &end);
+
+				if(!text.empty() && end == text.c_str() + text.size())
+					scalarData[i] = parsed;
+			}
+	}
+
+	return outputColumn.overwriteDataWithScale(scalarData);
+}
+
+//Locales ignore punctuation at first, mix upper and lower case and have their own ideas about anything beyond ASCII. Digits with only lower or only upper case letters sort by their bytes everywhere though.
+bool ConstructorEvaluator::sortsAlikeInAnyLocale(const std::set<std::string> & texts)
+{
+	if(texts.size() < 2)
+		return true;
+
+	bool lower = false, upper = false;
+
+	for(const std::string & text : texts)
+		for(char c : text)
+		{
+			if		(c >= 'a' && c <= 'z')	lower = true;
+			else if	(c >= 'A' && c <= 'Z')	upper = true;
+			else if	(c < '0'  || c >  '9')	return false;
+		}
+
+	return !(lower && upper);
+}
+
+bool ConstructorEvaluator::writeNominal(const Values & result, Column & outputColumn, bool ordinal)
+{
+	std::vector<int>			data(result.size(), INT_MIN);
+	std::map<int, std::string>	levels;
+	std::vector<std::string>	levelNames;
+	Values						text = asText(result);
+
+	if(result.type == Values::valueType::factor)
+		levelNames = result.levels; //a factor is already an integer vector and is used as is
+	else
+	{
+		//as.factor(as.character(x)) sorts the levels, R does this with the collation of the locale and we simply use the bytes. So only when those can't disagree.
+		std::set<std::string> unique;
+		for(size_t i=0; i<text.size(); i++)
+			if(!text.missing[i])
+				unique.insert(text.strings[i]);
+
+		if(!sortsAlikeInAnyLocale(unique))
+			throw notNative("levels whose order depends on the locale");
+
+		levelNames = std::vector<std::string>(unique.begin(), unique.end());
+	}
+
+	std::map<std::string, int> levelToValue;
+	for(size_t i=0; i<levelNames.size(); i++)
+	{
+		int value = static_cast<int>(i) + 1;
+
+		levels[value] = levelNames[i];
+		if(levelToValue.count(levelNames[i]) == 0)
+			levelToValue[levelNames[i]] = value;
+	}
+
+	for(size_t i=0; i<text.size(); i++)
+		if(!text.missing[i])
+			data[i] = levelToValue[text.strings[i]];
+
+	return ordinal ? outputColumn.overwriteDataWithOrdinal(data, levels) : outputColumn.overwriteDataWithNominal(data, levels);
+}
+
+bool ConstructorEvaluator::writeNominalText(const Values & result, Column & outputColumn)
+{
+	Values						text = asText(result);
+	std::vector<std::string>	nominalData(text.size());
+
+	for(size_t i=0; i<text.size(); i++)
+		nominalData[i] = text.missing[i] ? "NA" : text.strings[i];
+
+	return outputColumn.overwriteDataWithNominal(nominalData);
+}
@@ -0,0 +1,89 @@
+//
+// Copyright (C) 2013-2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef CONSTRUCTOREVALUATOR_H
+#define CONSTRUCTOREVALUATOR_H
+
+#include "columns.h"
+#include "jsonredirect.h"
+#include <set>
+
+/* The ConstructorEvaluator runs the json-formula built with the drag and drop constructor of a computed column
+ * directly on the columns in shared memory, so no R-code needs to be generated, whitelisted and run by an engine.
+ * It mimics what R would do with the generated code: NA propagation, recycling of length one arguments, columns
+ * that are not scale behave as factors and the result is coerced in the same way as .setColumnDataAs* does.
+ *
+ * Whenever it encounters something it cannot do exactly like R (random distributions, cut, arithmetic on factors,
+ * anything that would make R give a warning or error, etc) it throws notNative and the R-code should be used instead.
+ */
+class ConstructorEvaluator
+{
+public:
+	struct notNative : public std::runtime_error
+	{
+		notNative(std::string why) : std::runtime_error("Cannot evaluate constructor natively: " + why) {}
+	};
+
+			ConstructorEvaluator(Columns & columns) : _columns(columns) {}
+
+	///Evaluates the formula in constructorJson and writes it to outputColumn (using its columnType), returns true if the data changed.
+	bool	evaluateInto(const Json::Value & constructorJson, Column & outputColumn);
+
+	static std::string	numberToString(double value); ///< Formats like R's as.character does
+
+private:
+	struct Values
+	{
+		enum class valueType { number, logical, string, factor };
+
+		valueType					type = valueType::number;
+		std::vector<double>			numbers;	///< For number and logical, NA is NaN and logicals are 0 or 1
+		std::vector<std::string>	strings;	///< For string and factor
+		std::vector<bool>			missing;	///< For string and factor
+		std::vector<std::string>	levels;		///< Only for factor, in the order of the labels
+
+		size_t	size()		const { return isText() ? strings.size() : numbers.size(); }
+		bool	isText()	const { return type == valueType::string || type == valueType::factor; }
+		bool	isNumeric()	const { return type == valueType::number || type == valueType::logical; }
+
+		static Values	scalar(double value, valueType type = valueType::number);
+	};
+
+	Values	evaluate(			const Json::Value & node);
+	Values	evaluateOperator(	const Json::Value & node);
+	Values	evaluateFunction(	const Json::Value & node);
+	Values	readColumn(			const std::string & columnName);
+
+	Values	arithmetic(	const std::string & op, const Values & left, const Values & right);
+	Values	compare(	const std::string & op, const Values & left, const Values & right);
+	Values	logical(	const std::string & op, const Values & left, const Values & right);
+	Values	ifElse(		const Values & test,	const Values & yes, const Values & no);
+	Values	unaryMath(	const std::string & functionName, const Values & arg);
+	Values	aggregate(	const std::string & functionName, const Values & arg);
+
+	static Values	asText(const Values & values);
+	static void		checkNumeric(const Values & values, const std::string & where);
+	static bool		sortsAlikeInAnyLocale(const std::set<std::string> & texts);
+
+	bool	writeScale(			const Values & result, Column & outputColumn);
+	bool	writeNominal(		const Values & result, Column & outputColumn, bool ordinal);
+	bool	writeNominalText(	const Values & result, Column & outputColumn);
+
+	Columns	&_columns;
+};
+
+#endif // CONSTRUCTOREVALUATOR_H
@@ -17,7 +17,17 @@
 
 #include "dataset.h"
 
+#include <thread>
+#include <exception>
+#include <algorithm>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include "processinfo.h"
+#include "parallel.h"
+
 using namespace std;
+
+typedef boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> changeLock;
 /* DataSet is implemented as a set of columns */
 
 
@@ -26,10 +36,7 @@ void DataSet::setRowCount(size_t newRowCount)
 	if(newRowCount != minRowCount() || newRowCount != maxRowCount())
 	{
 		_columns.setRowCount(newRowCount);
-
-		_filterVector.clear();
-		for(size_t i=0; i<newRowCount; i++)
-			_filterVector.push_back(true);
+		_filter.reset(newRowCount);
 	}
 }
 
@@ -42,14 +49,176 @@ void DataSet::setColumnCount(size_t newColumnCount)
 	}
 }
 
+static boost::posix_time::ptime inMilliseconds(int milliseconds)
+{
+	return boost::posix_time::microsec_clock::universal_time() + boost::posix_time::milliseconds(milliseconds);
+}
+
+void DataSet::beginChange()
+{
+	unsigned long	process	= ProcessInfo::currentPID();
+	size_t			thread	= std::hash<std::thread::id>()(std::this_thread::get_id());
+
+	changeLock lock(_changeMutex);
+
+	// Someone else is changing it, whoever that is notifies when done. Unless it died in the middle of it, which is only noticed by looking.
+	while (_changeDepth > 0 && (_changeProcess != process || _changeThread != thread))
+		if (!_changeDone.timed_wait(lock, inMilliseconds(250)) && _changeDepth > 0 && !ProcessInfo::isProcessRunning(_changeProcess))
+			abandonChange();
+
+	if (_changeDepth++ == 0)
+	{
+		_changeProcess	= process;
+		_changeThread	= thread;
+
+		changeLock statsLock(_statsMutex); // Whoever is copying or storing stats is done with it first
+		_version.fetch_add(1, std::memory_order_acq_rel);
+	}
+}
+
+void DataSet::endChange()
+{
+	changeLock lock(_changeMutex);
+
+	if (_changeDepth == 0 || --_changeDepth > 0)
+		return;
+
+	_changeProcess = 0;
+	_version.fetch_add(1, std::memory_order_acq_rel);
+	_changeDone.notify_all();
+}
+
+///Ends the change that is being made as if it were done, with _changeMutex locked.
+void DataSet::abandonChange()
+{
+	std::cout << "DataSet: process " << _changeProcess << " is gone in the middle of a change, the data set might be torn." << std::endl;
+
+	_changeDepth	= 0;
+	_changeProcess	= 0;
+
+	if (version() & 1)
+		_version.fetch_add(1, std::memory_order_acq_rel);
+
+	_changeDone.notify_all();
+}
+
+void DataSet::abandonChangesOf(unsigned long processId)
+{
+	// The mutex is only ever held for a moment, so if it stays locked it was held by the process that was killed and nobody is going to unlock it.
+	if (!_changeMutex.timed_lock(inMilliseconds(1000)))
+	{
+		std::cout << "DataSet: the change mutex was left locked, making a new one." << std::endl;
+
+		new (&_changeMutex)	boost::interprocess::interprocess_mutex();
+		new (&_changeDone)	boost::interprocess::interprocess_condition();
+
+		_changeMutex.lock();
+	}
+
+	changeLock lock(_changeMutex, boost::interprocess::accept_ownership);
+
+	if (!_statsMutex.timed_lock(inMilliseconds(1000)))
+	{
+		std::cout << "DataSet: the stats mutex was left locked, making a new one." << std::endl;
+		new (&_statsMutex) boost::interprocess::interprocess_mutex();
+	}
+	else
+		_statsMutex.unlock();
+
+	if (_changeDepth > 0 && _changeProcess == processId)
+		abandonChange();
+}
+
+unsigned long DataSet::stableVersion(int timeout)
+{
+	unsigned long current = version();
+
+	if ((current & 1) == 0)
+		return current;
+
+	boost::posix_time::ptime deadline = inMilliseconds(timeout);
+
+	changeLock lock(_changeMutex);
+
+	while ((current = version()) & 1)
+	{
+		if (_changeDone.timed_wait(lock, std::min(deadline, inMilliseconds(250))))
+			continue;
+
+		if (_changeDepth > 0 && !ProcessInfo::isProcessRunning(_changeProcess))
+			abandonChange();
+		else if (boost::posix_time::microsec_clock::universal_time() >= deadline)
+		{
+			std::cout << "DataSet::stableVersion gave up waiting for the change that is being made." << std::endl;
+			break;
+		}
+	}
+
+	return current;
+}
+
+bool DataSet::columnStats(Column &column, ColumnStats &stats, bool filtered)
+{
+	unsigned long pinned = version();
+
+	if (pinned & 1)
+		return false;
+
+	{
+		// No change can start while the lock is held, so if none was going on the stats can be copied whole
+		changeLock lock(_statsMutex, inMilliseconds(50));
+
+		if (!lock.owns() || changedSince(pinned))
+			return false;
+
+		const ColumnStats &kept = filtered ? column._filteredStats : column._stats;
+
+		if (kept.revision == column.revision() && (!filtered || kept.filterGeneration == _filter.generation()))
+		{
+			stats = kept;
+			return true;
+		}
+	}
+
+	// Computed without holding anything, a change that started meanwhile means they might be torn and they are not kept
+	ColumnStats::LevelCounts levelCounts;
+
+	stats = ColumnStats();
+
+	if (filtered)
+	{
+		FilterBitset::Pin pin(_filter);
+
+		stats.filterGeneration = pin.generation();
+		stats.compute(column, &pin.selection());
+	}
+	else
+		stats.compute(column, NULL, &levelCounts);
+
+	changeLock lock(_statsMutex, inMilliseconds(50));
+
+	if (!lock.owns() || changedSince(pinned))
+		return false;
+
+	if (filtered)
+		column._filteredStats = stats;
+	else
+	{
+		column._stats = stats;
+
+		if (column.columnType() != Column::ColumnTypeScale)
+			ColumnStats::setLabelCounts(column, levelCounts);
+	}
+
+	return true;
+}
+
 void DataSet::setSharedMemory(boost::interprocess::managed_shared_memory *mem)
 {
 	_mem = mem;
 	_columns.setSharedMemory(mem);
 
-	_filterVector = BoolVector(mem->get_segment_manager());
-	for(size_t i=0; i<maxRowCount(); i++)
-		_filterVector.push_back(true);
+	_filter.reset(maxRowCount());
 }
 
 
@@ -74,31 +243,42 @@ string DataSet::toString()
 	return ss.str();
 }
 
-vector<string> DataSet::resetEmptyValues(map<string, map<int, string> > emptyValuesPerColumnMap)
+// The columns are independent of each other, so they are reset in parallel. emptyValuesPerColumnMap is updated along with them and the names of the columns that changed are added to changedColumns.
+// When there isn't enough shared memory for the labels the reset needs, it throws before any column is touched, so it can simply be run again with more memory.
+void DataSet::resetEmptyValues(emptyValsType &emptyValuesPerColumnMap, vector<string> &changedColumns)
 {
-	vector<string> colChanged;
-	for (Columns::iterator col_it = _columns.begin(); col_it != _columns.end(); ++col_it)
+	size_t columns = columnCount();
+
+	// The map of each column is looked up here, because emptyValuesPerColumnMap itself cannot be changed from several threads.
+	vector<map<int, string>*> emptyValuesMaps;
+	for (size_t col = 0; col < columns; col++)
+		emptyValuesMaps.push_back(&emptyValuesPerColumnMap[_columns.at(col).name()]);
+
+	// Growing the labels is the only thing a reset allocates shared memory for, so room for them is made beforehand.
+	// If that fails nothing has been reset yet, and once it succeeded no column can fail halfway through its reset.
+	for (size_t col = 0; col < columns; col++)
 	{
-		Column& col = *col_it;
-		map<string, map<int, string> >::iterator it = emptyValuesPerColumnMap.find(col.name());
-		map<int, string> emptyValuesMap;
-		if (it != emptyValuesPerColumnMap.end())
-			emptyValuesMap = it->second;
-
-		if (col.resetEmptyValues(emptyValuesMap))
-			colChanged.push_back(col.name());
-		emptyValuesPerColumnMap[col.name()] = emptyValuesMap;
+		Column &column = _columns.at(col);
+		column.labels().reserve(column.labelsNeededToResetEmptyValues(*emptyValuesMaps[col]));
 	}
 
-	return colChanged;
-}
+	vector<char>	changed(columns, false);
+	exception_ptr	failure;
 
-void DataSet::setFilterVector(std::vector<bool> filterResult)
-{
-	_filteredRowCount = 0;
-	for(size_t i=0; i<filterResult.size(); i++)
-		if((_filterVector[i] = filterResult[i])) //economy
-			_filteredRowCount++;
+	auto resetter = [&](size_t col, bool)
+	{
+		changed[col] = _columns.at(col).resetEmptyValues(*emptyValuesMaps[col]);
+	};
+
+	try			{ Parallel::forEach(columns, resetter);	}
+	catch (...)	{ failure = current_exception();		}
+
+	for (size_t col = 0; col < columns; col++)
+		if (changed[col] && std::find(changedColumns.begin(), changedColumns.end(), _columns.at(col).name()) == changedColumns.end())
+			changedColumns.push_back(_columns.at(col).name());
+
+	if (failure)
+		rethrow_exception(failure);
 }
 
 bool DataSet::allColumnsPassFilter() const
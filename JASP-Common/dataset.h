@@ -19,12 +19,13 @@
 #define DATASET_H
 
 #include <map>
+#include <atomic>
+#include <functional>
 #include <iostream>
+#include <boost/interprocess/sync/interprocess_condition.hpp>
 #include "columns.h"
 #include "computedcolumns.h"
-
-typedef boost::interprocess::allocator<bool, boost::interprocess::managed_shared_memory::segment_manager> BoolAllocator;
-typedef boost::container::vector<bool, BoolAllocator> BoolVector;
+#include "filterbitset.h"
 
 class DataSet
 {
@@ -32,7 +33,7 @@ class DataSet
 
 public:
 
-	DataSet(boost::interprocess::managed_shared_memory *mem) : _columns(mem), _filterVector(mem->get_segment_manager()), _mem(mem) { }
+	DataSet(boost::interprocess::managed_shared_memory *mem) : _columns(mem), _filter(mem), _mem(mem) { }
 	~DataSet() {}
 
 	size_t minRowCount()	const { return _columns.minRowCount(); }
@@ -52,23 +53,67 @@ public:
 	void setSharedMemory(boost::interprocess::managed_shared_memory *mem);
 
 	std::string toString();
-	std::vector<std::string> resetEmptyValues(emptyValsType emptyValuesMap);
+	void resetEmptyValues(emptyValsType &emptyValuesMap, std::vector<std::string> &changedColumns);
 
-	void				setFilterVector(std::vector<bool> filterResult);
-	const BoolVector&	filterVector()		const	{ return _filterVector; }
-	int					filteredRowCount()	const	{ return _filteredRowCount; }
+	const FilterBitset&	filter()			const	{ return _filter; }
+	FilterBitset&		filter()					{ return _filter; }
+	int					filteredRowCount()	const	{ FilterBitset::Pin pin(_filter); return pin.selection().selectedCount(); }
 
 	bool allColumnsPassFilter()				const;
-	bool synchingData()						const	{ return _synchingData; }
-	void setSynchingData(bool newVal)				{ _synchingData = newVal;  std::cout << "dataset synching ? " << (newVal ? "yes" : "no") << std::endl; }
+
+	/* A copy of Column::stats() (bringing the counts of its labels up to date) or of the stats of only the rows that pass the filter.
+	 * Outdated ones (of an older column revision or filter generation) are computed and kept for the next time, without this being a change of the data set.
+	 * Returns false straight away instead of waiting while the data set is being changed, then there is nothing consistent to show yet.
+	 */
+	bool				columnStats(Column &column, ColumnStats &stats, bool filtered = false);
+
+	/* Changing the columns (a sync, resetting the empty values, a computed column) is bracketed by beginChange and endChange, through a DataSetChange.
+	 * Both bump the version, so it is odd while the columns are being changed and any reader can tell whether what it read belongs to a single version:
+	 * pin the version with stableVersion() before reading and check changedSince() afterwards, if it changed the data might be torn and has to be read again.
+	 * Only one thread (of any process) changes the data set at a time, that thread can nest changes and only the outermost one bumps the version.
+	 */
+	unsigned long	version()								const	{ return _version.load(std::memory_order_acquire);	}
+	bool			synchingData()							const	{ return version() & 1;								}
+	bool			changedSince(unsigned long pinned)		const	{ return version() != pinned;						}
+	unsigned long	stableVersion(int timeout = 10000);	///< The current version, if a change is being made this sleeps until it is done. After timeout ms it returns the odd version.
+	void			beginChange();						///< Waits for a change another thread or process is making
+	void			endChange();
+	void			abandonChangesOf(unsigned long processId);	///< For when that process was killed, it might have been in the middle of a change.
 
 private:
+	void			abandonChange();
+
 	Columns			_columns;
-	int				_filteredRowCount = 0;
-	BoolVector		_filterVector;
-	bool			_synchingData;
+	FilterBitset	_filter;
+
+	std::atomic<unsigned long>					_version		{0};	///< Lock-free, so it works across processes, see above
+	int											_changeDepth	= 0;	///< The ones below are guarded by _changeMutex
+	unsigned long								_changeProcess	= 0;	///< Who is changing the data set
+	size_t										_changeThread	= 0;
+	boost::interprocess::interprocess_mutex		_changeMutex;
+	boost::interprocess::interprocess_condition	_changeDone;
+	boost::interprocess::interprocess_mutex		_statsMutex;			///< Guards the stats of the columns outside of a change, a change only starts (the version only becomes odd) while holding it
 
 	boost::interprocess::managed_shared_memory *_mem;
 };
 
+/* DataSetChange brackets a change of the data set with beginChange and endChange, the change also ends when it throws.
+ * Give it a function that returns the data set if the change can enlarge the shared memory, because that moves the data set.
+ */
+class DataSetChange
+{
+public:
+	typedef std::function<DataSet*()> DataSetSource;
+
+	explicit	DataSetChange(DataSet *dataSet)			: DataSetChange([dataSet]() { return dataSet; }) {}
+	explicit	DataSetChange(DataSetSource dataSet)	: _dataSet(dataSet) { _dataSet()->beginChange(); }
+				~DataSetChange()						{ _dataSet()->endChange(); }
+
+				DataSetChange(const DataSetChange &)	= delete;
+	void		operator=(const DataSetChange &)		= delete;
+
+private:
+	DataSetSource _dataSet;
+};
+
 #endif // DATASET_H
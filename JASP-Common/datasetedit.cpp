@@ -0,0 +1,355 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "datasetedit.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <stdexcept>
+
+#include "utils.h"
+
+using namespace std;
+
+size_t DataSetChanges::cellCount() const
+{
+	size_t count = 0;
+
+	for (const auto &column : rows)
+		for (const pair<int, int> &range : column.second)
+			count += range.second - range.first + 1;
+
+	return count;
+}
+
+void DataSetEdit::setTexts(size_t column, int firstRow, const vector<string> &texts)
+{
+	_cells.reserve(_cells.size() + texts.size());
+
+	for (size_t i = 0; i < texts.size(); i++)
+		setText(column, firstRow + int(i), texts[i]);
+}
+
+void DataSetEdit::fill(size_t column, int firstRow, int lastRow, const string &text)
+{
+	for (int row = firstRow; row <= lastRow; row++)
+		setText(column, row, text);
+}
+
+DataSetChanges DataSetJournal::apply(DataSet *dataSet, DataSetEdit edit, emptyValsType *emptyValues)
+{
+	if (dataSet == NULL || edit.empty())
+		return DataSetChanges();
+
+	check(dataSet, edit, false, false);
+	resolve(dataSet, edit);
+
+	DataSetChanges changes = write(dataSet, edit, false, emptyValues);
+
+	_done.push_back(std::move(edit));
+	_undone.clear();
+
+	if (_done.size() > _maxEdits)
+		_done.pop_front();
+
+	return changes;
+}
+
+DataSetChanges DataSetJournal::undo(DataSet *dataSet, emptyValsType *emptyValues)
+{
+	if (dataSet == NULL || !canUndo())
+		return DataSetChanges();
+
+	check(dataSet, _done.back(), true, true);
+
+	DataSetChanges changes = write(dataSet, _done.back(), true, emptyValues);
+
+	_undone.push_back(std::move(_done.back()));
+	_done.pop_back();
+
+	return changes;
+}
+
+DataSetChanges DataSetJournal::redo(DataSet *dataSet, emptyValsType *emptyValues)
+{
+	if (dataSet == NULL || !canRedo())
+		return DataSetChanges();
+
+	check(dataSet, _undone.back(), true, false);
+
+	DataSetChanges changes = write(dataSet, _undone.back(), false, emptyValues);
+
+	_done.push_back(std::move(_undone.back()));
+	_undone.pop_back();
+
+	return changes;
+}
+
+// Everything that could go wrong is checked before anything is written, so an edit is applied completely or not at all.
+void DataSetJournal::check(DataSet *dataSet, const DataSetEdit &edit, bool journaled, bool undoing) const
+{
+	map<size_t, set<int>> labelKeys;
+
+	for (const DataSetEdit::Cell &cell : edit._cells)
+	{
+		if (cell.column >= dataSet->columnCount())
+			throw runtime_error("The edit is of a column that doesn't exist anymore.");
+
+		Column &column = dataSet->column(cell.column);
+
+		if (cell.row < 0 || size_t(cell.row) >= column.rowCount())
+			throw runtime_error("The edit is of row " + to_string(cell.row + 1) + " but column " + column.name() + " has only " + to_string(column.rowCount()) + " rows.");
+
+		if (!journaled)
+			continue;
+
+		// An edit that was applied before stores values as the column stored them then, that has to still be how it stores them
+		string	action	= undoing ? "undone." : "redone.";
+		bool	isScale	= column.columnType() == Column::ColumnTypeScale;
+
+		if (isScale != cell.isScale)
+			throw runtime_error("Column " + column.name() + " changed type since the edit, it can't be " + action);
+
+		int key = int(undoing ? cell.before : cell.after);
+
+		if (isScale || key == INT_MIN || column.labels().size() == 0)
+			continue;
+
+		// The labels the edit added itself are only there while it is done
+		auto added = edit._newLabels.find(cell.column);
+		if (!undoing && added != edit._newLabels.end() && added->second.count(key) > 0)
+			continue;
+
+		if (labelKeys.count(cell.column) == 0)
+			labelKeys[cell.column] = column.labels().getIntValues();
+
+		if (labelKeys[cell.column].count(key) == 0)
+			throw runtime_error("A level of column " + column.name() + " that the edit used is gone, it can't be " + action);
+	}
+}
+
+// Works out what each cell becomes as the column stores it and which labels have to be added for that, without changing anything yet.
+void DataSetJournal::resolve(DataSet *dataSet, DataSetEdit &edit) const
+{
+	DataSetEdit::NewLabels			&newLabels = edit._newLabels;
+	map<size_t, map<string, int>>	keyOfText;
+	map<size_t, set<int>>			keysInUse;
+	map<size_t, int>				nextKey;
+
+	auto labelsOf = [&](size_t columnIndex) -> map<string, int> &
+	{
+		if (keyOfText.count(columnIndex) == 0)
+		{
+			map<string, int>	&keys	= keyOfText[columnIndex];
+			int					&next	= nextKey[columnIndex];
+
+			next = 0;
+			for (const Label &label : dataSet->column(columnIndex).labels())
+			{
+				keys.insert(make_pair(label.text(), label.value()));
+				keysInUse[columnIndex].insert(label.value());
+				next = std::max(next, label.value() + 1);
+			}
+		}
+
+		return keyOfText[columnIndex];
+	};
+
+	for (DataSetEdit::Cell &cell : edit._cells)
+	{
+		Column &column	= dataSet->column(cell.column);
+		cell.isScale	= column.columnType() == Column::ColumnTypeScale;
+
+		if (!cell.asText)
+			continue;
+
+		bool empty = Column::isEmptyValue(cell.text);
+
+		if (empty)
+			cell.missingAfter = cell.text;
+
+		if (cell.isScale)
+		{
+			if (empty)											cell.after = NAN;
+			else if (!Utils::getDoubleValue(cell.text, cell.after))	throw runtime_error("Column " + column.name() + " only takes numbers, '" + cell.text + "' isn't one.");
+			continue;
+		}
+
+		if (empty)
+		{
+			cell.after = INT_MIN;
+			continue;
+		}
+
+		map<string, int> &keys = labelsOf(cell.column);
+
+		if (column.columnType() == Column::ColumnTypeNominalText)
+		{
+			if (keys.count(cell.text) == 0)
+			{
+				int key = nextKey[cell.column]++;
+				keys[cell.text]				= key;
+				newLabels[cell.column][key]	= cell.text;
+			}
+
+			cell.after = keys[cell.text];
+			continue;
+		}
+
+		// Nominal and ordinal columns store the value itself as the key, typing a label of one of them works too
+		int value;
+
+		if (keys.count(cell.text) > 0)							value = keys[cell.text];
+		else if (!Utils::getIntValue(cell.text, value))			throw runtime_error("Column " + column.name() + " only takes whole numbers, '" + cell.text + "' isn't one, it could be made nominal text first.");
+		else if (column.labels().size() > 0 && keysInUse[cell.column].count(value) == 0)
+		{
+			keysInUse[cell.column].insert(value);
+			newLabels[cell.column][value] = "";
+		}
+
+		cell.after = value;
+	}
+}
+
+DataSetChanges DataSetJournal::write(DataSet *dataSet, DataSetEdit &edit, bool undoing, emptyValsType *emptyValues) const
+{
+	DataSetChanges				changes;
+	map<size_t, vector<int>>	rowsPerColumn;
+
+	// Undone from the last cell to the first, so a cell that is in the edit more than once ends up as it was before all of them
+	auto cellAt = [&](size_t i) -> DataSetEdit::Cell & { return edit._cells[undoing ? edit._cells.size() - 1 - i : i]; };
+
+	auto put = [&](const DataSetEdit::Cell &cell, double value, const string &missingText)
+	{
+		Column &column = dataSet->column(cell.column);
+
+		if (cell.isScale)	column.setValue(cell.row, value);
+		else				column.setValue(cell.row, int(value));
+
+		if (emptyValues != NULL)
+		{
+			map<int, string> &missing = (*emptyValues)[column.name()];
+
+			if (missingText != "")	missing[cell.row] = missingText;
+			else					missing.erase(cell.row);
+		}
+	};
+
+	{
+		DataSetChange change(dataSet);
+
+		// Room for the new labels is made before anything changes, so adding them can't run out of shared memory halfway
+		if (!undoing)
+			for (const auto &columnLabels : edit._newLabels)
+			{
+				Labels &labels = dataSet->column(columnLabels.first).labels();
+				labels.reserve(labels.size() + columnLabels.second.size());
+			}
+
+		map<size_t, set<int>>	addedLabels;
+		size_t					written = 0;
+
+		try
+		{
+			// The new labels are there before the cells use them and, when undoing, only gone after no cell uses them anymore
+			if (!undoing)
+				for (const auto &columnLabels : edit._newLabels)
+				{
+					Labels			&labels	= dataSet->column(columnLabels.first).labels();
+					std::set<int>	present	= labels.getIntValues();
+
+					for (const pair<const int, string> &label : columnLabels.second)
+					{
+						if (present.count(label.first) > 0)	continue;
+						else if (label.second == "")		labels.add(label.first);
+						else								labels.add(label.first, label.second, true);
+
+						addedLabels[columnLabels.first].insert(label.first);
+					}
+
+					changes.columnsWithNewLabels.insert(columnLabels.first);
+				}
+
+			for (size_t i = 0; i < edit._cells.size(); i++)
+			{
+				DataSetEdit::Cell	&cell	= cellAt(i);
+				Column				&column	= dataSet->column(cell.column);
+
+				if (!undoing)
+				{
+					cell.before = cell.isScale ? column.AsDoubles[cell.row] : column.AsInts[cell.row];
+
+					if (emptyValues != NULL)
+					{
+						const map<int, string>	&missing	= (*emptyValues)[column.name()];
+						auto					typed		= missing.find(cell.row);
+
+						cell.missingBefore = typed == missing.end() ? "" : typed->second;
+					}
+				}
+
+				written = i + 1; // Before it is written, if that fails halfway what was there is put back as well
+				put(cell, undoing ? cell.before : cell.after, undoing ? cell.missingBefore : cell.missingAfter);
+
+				rowsPerColumn[cell.column].push_back(cell.row);
+			}
+
+			if (undoing)
+				for (const auto &columnLabels : edit._newLabels)
+				{
+					std::set<int> keys;
+
+					for (const pair<const int, string> &label : columnLabels.second)
+						keys.insert(label.first);
+
+					dataSet->column(columnLabels.first).labels().removeValues(keys);
+					changes.columnsWithNewLabels.insert(columnLabels.first);
+				}
+		}
+		catch (...)
+		{
+			// Whatever was written is put back, from the last cell to the first, so the edit isn't applied at all
+			while (written > 0)
+			{
+				const DataSetEdit::Cell &cell = cellAt(--written);
+				put(cell, undoing ? cell.after : cell.before, undoing ? cell.missingAfter : cell.missingBefore);
+			}
+
+			for (const auto &columnKeys : addedLabels)
+				dataSet->column(columnKeys.first).labels().removeValues(columnKeys.second);
+
+			throw;
+		}
+	}
+
+	for (auto &columnRows : rowsPerColumn)
+	{
+		vector<int>					&rows	= columnRows.second;
+		DataSetChanges::RowRanges	&ranges	= changes.rows[columnRows.first];
+
+		sort(rows.begin(), rows.end());
+
+		for (int row : rows)
+			if (!ranges.empty() && row <= ranges.back().second + 1)	ranges.back().second = std::max(ranges.back().second, row);
+			else													ranges.push_back(make_pair(row, row));
+
+		changes.columnNames.push_back(dataSet->column(columnRows.first).name());
+	}
+
+	return changes;
+}
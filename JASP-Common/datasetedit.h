@@ -0,0 +1,116 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef DATASETEDIT_H
+#define DATASETEDIT_H
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "dataset.h"
+
+///What changed in the data set through one edit, per column the rows as sorted ranges so the views and the engines only refresh those.
+struct DataSetChanges
+{
+	typedef std::vector<std::pair<int, int>> RowRanges; ///< First and last row, sorted and not overlapping or touching
+
+	std::map<size_t, RowRanges>	rows;				///< Per column index
+	std::vector<std::string>	columnNames;		///< Of the columns in rows, in the same order
+	std::set<size_t>			columnsWithNewLabels;
+
+	bool	empty()		const { return rows.empty(); }
+	size_t	cellCount()	const;
+};
+
+/* A DataSetEdit collects the cells one action of the user changes (typing in a cell, pasting a block, filling a range), they are then applied together by a DataSetJournal.
+ * Once applied it also holds what was there before, so it can be undone and redone as a whole.
+ * Values are stored as the column stores them: the value itself for a scale column and the key of the label otherwise, text is resolved to those when it is applied.
+ */
+class DataSetEdit
+{
+public:
+	struct Cell
+	{
+		Cell(size_t column, int row, double value) : column(column), row(row), after(value) {}
+		Cell(size_t column, int row, const std::string &text) : column(column), row(row), text(text), asText(true) {}
+
+		size_t		column;
+		int			row;
+		double		before		= 0,
+					after		= 0;	///< Keys of labels fit exactly in a double
+		bool		isScale		= false;
+		std::string	text,
+					missingBefore,
+					missingAfter;		///< The text of a missing value as it was typed, empty if the cell isn't missing or has no such text
+		bool		asText		= false;
+	};
+
+	void	setValue(size_t column, int row, double value)							{ _cells.push_back(Cell(column, row, value)); }
+	void	setValue(size_t column, int row, int key)								{ _cells.push_back(Cell(column, row, double(key))); }
+	void	setText(size_t column, int row, const std::string &text)				{ _cells.push_back(Cell(column, row, text)); }	///< As it would be shown, empty for a missing value, a new level gets a label.
+	void	setTexts(size_t column, int firstRow, const std::vector<std::string> &texts);										///< A range of rows of one column
+	void	fill(size_t column, int firstRow, int lastRow, const std::string &text);
+
+	bool						empty()	const { return _cells.empty(); }
+	size_t						size()	const { return _cells.size();  }
+	const std::vector<Cell>&	cells()	const { return _cells;		   }
+
+private:
+	friend class DataSetJournal;
+
+	typedef std::map<size_t, std::map<int, std::string>> NewLabels; ///< Per column the key and text of the labels an edit adds
+
+	std::vector<Cell>	_cells;
+	NewLabels			_newLabels;	///< Added when the edit is applied or redone and removed again when it is undone
+};
+
+/* DataSetJournal applies edits to a data set as a single DataSetChange and remembers them for undo and redo.
+ * Each of apply, undo and redo returns the coalesced changes of the whole edit and takes time in the size of the edit, not of the data set.
+ * Anything that changes the data set in another way (a sync, removing a column) should clear the journal, an edit that doesn't fit the data set anymore throws a std::runtime_error and changes nothing.
+ * Room for the labels an edit adds is made before anything is written, if writing fails anyway the cells written so far are put back before the exception is passed on.
+ * The text of a typed missing value is kept in emptyValues (see DataSetPackage::emptyValuesMap) so it is written back out on export, it may be NULL.
+ */
+class DataSetJournal
+{
+public:
+	DataSetJournal(size_t maxEdits = 100) : _maxEdits(maxEdits) {}
+
+	typedef std::map<std::string, std::map<int, std::string>> emptyValsType;
+
+	DataSetChanges	apply(DataSet *dataSet, DataSetEdit edit,	emptyValsType *emptyValues = NULL);
+	DataSetChanges	undo(DataSet *dataSet,						emptyValsType *emptyValues = NULL);
+	DataSetChanges	redo(DataSet *dataSet,						emptyValsType *emptyValues = NULL);
+
+	bool			canUndo()	const { return !_done.empty();		}
+	bool			canRedo()	const { return !_undone.empty();	}
+	void			clear()			  { _done.clear(); _undone.clear(); }
+
+private:
+	void			check(	DataSet *dataSet, const DataSetEdit &edit, bool journaled, bool undoing)	const;
+	void			resolve(DataSet *dataSet, DataSetEdit &edit)								const;
+	DataSetChanges	write(	DataSet *dataSet, DataSetEdit &edit, bool undoing, emptyValsType *emptyValues)	const;
+
+	size_t					_maxEdits;
+	std::deque<DataSetEdit>	_done,
+							_undone;
+};
+
+#endif // DATASETEDIT_H
@@ -39,10 +39,21 @@ void DataSetPackage::reset()
 	_filterConstructorJSON		= DEFAULT_FILTER_JSON;
 	_computedColumns			= ComputedColumns(this);
 
+	_edits.clear();
+
 	setModified(false);
 	resetEmptyValues();
 }
 
+void DataSetPackage::cellsWereEdited(const DataSetChanges &changes)
+{
+	if (changes.empty())
+		return;
+
+	setModified(true);
+	cellsChanged(this, changes);
+}
+
 void DataSetPackage::setModified(bool value)
 {
 	if (value != _isModified)
@@ -20,6 +20,7 @@
 
 #include "common.h"
 #include "dataset.h"
+#include "datasetedit.h"
 #include "version.h"
 #include <map>
 #include "boost/signals2.hpp"
@@ -54,6 +55,7 @@ public:
 	const	std::string&	warningMessage()				const	{ return _warningMessage;				}
 	const	Version&		archiveVersion()				const	{ return _archiveVersion;				}
 	const	emptyValsType&	emptyValuesMap()				const	{ return _emptyValuesMap;				}
+			emptyValsType&	emptyValuesMap()						{ return _emptyValuesMap;				}
 			bool			dataFileReadOnly()				const	{ return _dataFileReadOnly;				}
 			uint			dataFileTimestamp()				const	{ return _dataFileTimestamp;			}
 	const	Version&		dataArchiveVersion()			const	{ return _dataArchiveVersion;			}
@@ -92,11 +94,20 @@ public:
 
 			ComputedColumns	* computedColumnsPointer();
 
+			///Edits of cells by the user, each applied at once and announced through cellsChanged, throw a std::runtime_error if the edit doesn't fit the data.
+			void		applyEdit(const DataSetEdit &edit)	{ cellsWereEdited(_edits.apply(_dataSet, edit, &_emptyValuesMap));	}
+			void		undoEdit()							{ cellsWereEdited(_edits.undo(_dataSet, &_emptyValuesMap));			}
+			void		redoEdit()							{ cellsWereEdited(_edits.redo(_dataSet, &_emptyValuesMap));			}
+			bool		canUndoEdit()				const	{ return _edits.canUndo();							}
+			bool		canRedoEdit()				const	{ return _edits.canRedo();							}
+			void		clearEdits()						{ _edits.clear();									}
+
 			boost::signals2::signal<void (DataSetPackage *source)>																																									isModifiedChanged;
+			boost::signals2::signal<void (DataSetPackage *source, const DataSetChanges &changes)>																																	cellsChanged;
 			boost::signals2::signal<void (DataSetPackage *source, std::vector<std::string> &changedColumns, std::vector<std::string> &missingColumns, std::map<std::string, std::string> &changeNameColumns, bool rowCountChanged)>	dataChanged;
 
 private:
-
+			void		cellsWereEdited(const DataSetChanges &changes);
 
 	DataSet				*_dataSet = NULL;
 	emptyValsType		_emptyValuesMap;
@@ -123,6 +134,7 @@ private:
 	uint				_dataFileTimestamp;
 
 	ComputedColumns		_computedColumns;
+	DataSetJournal		_edits;
 	bool				_synchingData;
 };
 
@@ -0,0 +1,302 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "datasetshipper.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "sharedmemory.h"
+
+using namespace std;
+
+namespace
+{
+	struct Writer
+	{
+		string &out;
+
+		template<typename T> void put(T value)			{ out.append(reinterpret_cast<const char *>(&value), sizeof(T)); }
+		void putString(const string &text)				{ put<uint32_t>(uint32_t(text.size())); out.append(text); }
+	};
+
+	struct Reader
+	{
+		const string	&in;
+		size_t			pos = 0;
+
+		Reader(const string &in) : in(in) {}
+
+		template<typename T> T get()
+		{
+			if (pos + sizeof(T) > in.size())
+				throw runtime_error("A data set shipment ended too soon.");
+
+			T value;
+			memcpy(&value, in.data() + pos, sizeof(T));
+			pos += sizeof(T);
+
+			return value;
+		}
+
+		string getString()
+		{
+			uint32_t length = get<uint32_t>();
+
+			if (pos + length > in.size())
+				throw runtime_error("A data set shipment ended too soon.");
+
+			string text = in.substr(pos, length);
+			pos += length;
+
+			return text;
+		}
+	};
+}
+
+bool DataSetShipper::ship(DataSet *dataSet, string &shipment)
+{
+	shipment.clear();
+
+	if (dataSet == NULL)
+		return false;
+
+	// The filter that is shipped is held on to, so the desktop doesn't stage the next one into it meanwhile.
+	FilterBitset::Pin	filter(dataSet->filter());
+	size_t				rowCount		= dataSet->rowCount(),
+						columnCount		= dataSet->columnCount();
+	bool				rowsChanged		= rowCount != _rowCount,
+						columnsChanged	= columnCount != _shipped.size(),
+						filterChanged	= rowsChanged || filter.generation() != _filterGeneration;
+
+	vector<size_t> changed;
+
+	_shipped.resize(columnCount, Shipped{ -1, 0 });
+
+	for (size_t index = 0; index < columnCount; index++)
+	{
+		Column &column = dataSet->column(index);
+
+		if (rowsChanged || _shipped[index].columnId != column.id() || _shipped[index].revision != column.revision())
+			changed.push_back(index);
+	}
+
+	if (changed.empty() && !filterChanged && !columnsChanged && _shipments > 0)
+		return false;
+
+	Writer out{ shipment };
+
+	out.put<uint32_t>(uint32_t(columnCount));
+	out.put<uint64_t>(uint64_t(rowCount));
+	out.put<int32_t>(++_shipments);
+	out.put<uint8_t>(filterChanged);
+
+	if (filterChanged)
+	{
+		const FilterBitset::Selection &selection = filter.selection();
+
+		string bits((rowCount + 7) / 8, '\0');
+		for (size_t row = 0; row < rowCount; row++)
+			if (selection.passes(row))
+				bits[row / 8] |= char(1 << (row % 8));
+
+		shipment.append(bits);
+	}
+
+	out.put<uint32_t>(uint32_t(changed.size()));
+
+	for (size_t index : changed)
+	{
+		Column &column = dataSet->column(index);
+
+		out.put<uint32_t>(uint32_t(index));
+		out.putString(column.name());
+		out.put<int32_t>(column.columnType());
+
+		if (column.columnType() == Column::ColumnTypeScale)
+		{
+			shipment.reserve(shipment.size() + rowCount * sizeof(double));
+			for (double value : column.AsDoubles)
+				out.put<double>(value);
+		}
+		else
+		{
+			out.put<uint32_t>(uint32_t(column.labels().size()));
+
+			for (const Label &label : column.labels())
+			{
+				out.put<uint8_t>(label.hasIntValue());
+				out.put<int32_t>(label.value());
+				out.put<uint8_t>(label.filterAllows());
+				out.putString(label.text());
+			}
+
+			shipment.reserve(shipment.size() + rowCount * sizeof(int32_t));
+			for (int value : column.AsInts)
+				out.put<int32_t>(value);
+		}
+
+		_shipped[index] = Shipped{ column.id(), column.revision() };
+	}
+
+	_rowCount			= rowCount;
+	_filterGeneration	= filter.generation();
+
+	return true;
+}
+
+DataSet *DataSetShipper::receive(const string &shipment)
+{
+	if (_received == NULL)
+		_received = SharedMemory::createDataSet();
+
+	bool success = false;
+
+	do
+	{
+		try
+		{
+			apply(shipment);
+			success = true;
+		}
+		catch (boost::interprocess::bad_alloc &e)
+		{
+			// Applying it again is harmless, it only overwrites
+			_received = SharedMemory::enlargeDataSet(_received);
+		}
+	}
+	while (!success);
+
+	return _received;
+}
+
+void DataSetShipper::apply(const string &shipment)
+{
+	Reader		in(shipment);
+	uint32_t	columnCount	= in.get<uint32_t>();
+	size_t		rowCount	= size_t(in.get<uint64_t>());
+	int32_t		number		= in.get<int32_t>();
+	bool		hasFilter	= in.get<uint8_t>();
+	string		filterBits;
+
+	// Everything from the wire is checked against the size of the shipment before memory is reserved for it
+	if (hasFilter)
+	{
+		if (rowCount > (shipment.size() - in.pos) * 8)
+			throw runtime_error("A data set shipment ended too soon.");
+
+		size_t length = (rowCount + 7) / 8;
+
+		filterBits	= shipment.substr(in.pos, length);
+		in.pos		+= length;
+	}
+
+	uint32_t	columnsShipped	= in.get<uint32_t>();
+	size_t		columnsBefore	= _received->columnCount();
+
+	if (!hasFilter && rowCount != _received->rowCount())
+		throw runtime_error("A data set shipment changes the number of rows without shipping the filter.");
+
+	if (columnsShipped > columnCount || columnCount > columnsBefore + columnsShipped)
+		throw runtime_error("A data set shipment has more columns than it ships.");
+
+	if (columnsShipped > 0 && rowCount > (shipment.size() - in.pos) / sizeof(int32_t))
+		throw runtime_error("A data set shipment ended too soon.");
+
+	_received = SharedMemory::reserveMemory(_received, columnsShipped, rowCount, 0);
+	DataSetChange change(_received);
+
+	_received->setColumnCount(columnCount);
+	_received->setRowCount(rowCount);
+
+	for (uint32_t shipped = 0; shipped < columnsShipped; shipped++)
+	{
+		uint32_t index = in.get<uint32_t>();
+
+		if (index >= columnCount)
+			throw runtime_error("A data set shipment has a column that the data set doesn't.");
+
+		Column &column = _received->column(index);
+
+		column.setName(in.getString());
+		int32_t columnType = in.get<int32_t>();
+
+		switch (columnType)
+		{
+		case Column::ColumnTypeUnknown:
+		case Column::ColumnTypeNominal:
+		case Column::ColumnTypeNominalText:
+		case Column::ColumnTypeOrdinal:
+		case Column::ColumnTypeScale:
+			column.setColumnType(Column::ColumnType(columnType));
+			break;
+		default:
+			throw runtime_error("A data set shipment has a column of an unknown type.");
+		}
+
+		if (column.columnType() == Column::ColumnTypeScale)
+			for (double &value : column.AsDoubles)
+				value = in.get<double>();
+		else
+		{
+			// Each label takes at least its flags, value and the length of its text, so a count that doesn't fit in what is left can't be allocated for
+			const size_t	smallestLabel	= 2 * sizeof(uint8_t) + 2 * sizeof(uint32_t);
+			uint32_t		labelCount		= in.get<uint32_t>();
+
+			if (labelCount > (shipment.size() - in.pos) / smallestLabel)
+				throw runtime_error("A data set shipment ended too soon.");
+
+			vector<Label>	labels(labelCount);
+
+			for (Label &label : labels)
+			{
+				bool	hasIntValue		= in.get<uint8_t>();
+				int		value			= in.get<int32_t>();
+				bool	filterAllows	= in.get<uint8_t>();
+				string	text			= in.getString();
+
+				if (hasIntValue)
+				{
+					label = Label(value);
+					label.setLabel(text);
+					label.setFilterAllows(filterAllows);
+				}
+				else
+					label = Label(text, value, filterAllows);
+			}
+
+			column.labels().set(labels);
+
+			for (int &value : column.AsInts)
+				value = in.get<int32_t>();
+		}
+
+		column.incRevision(); // The values were written in place
+	}
+
+	if (hasFilter)
+	{
+		vector<bool> passes(rowCount);
+		for (size_t row = 0; row < rowCount; row++)
+			passes[row] = (filterBits[row / 8] >> (row % 8)) & 1;
+
+		_received->filter().stage(passes, number);
+		_received->filter().publish(number);
+	}
+}
@@ -0,0 +1,56 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef DATASETSHIPPER_H
+#define DATASETSHIPPER_H
+
+#include <string>
+#include <vector>
+
+#include "dataset.h"
+
+/* A DataSetShipper keeps the copy of the data set of an engine that can't map the shared memory of the desktop (a remote one) up to date.
+ * On the desktop, ship() encodes what changed since the last shipment: the columns whose revision changed (all of them the first time) and the filter if its generation did.
+ * On the engine, receive() writes such a shipment into a data set of its own, in the shared memory of the engine process, which rbridge then reads as usual.
+ * A shipment is binary and in the byte order of the machine, so both sides have to be little endian (which is anything JASP runs on).
+ */
+class DataSetShipper
+{
+public:
+	bool			ship(DataSet *dataSet, std::string &shipment);	///< Returns false if nothing changed since the last shipment
+	void			reset()											{ _shipped.clear(); _filterGeneration = 0; _rowCount = 0; }	///< Everything is shipped again next time, for a new connection
+
+	DataSet *		receive(const std::string &shipment);			///< Applies it to the data set of this process (created by the first one) and returns that, it moves when the memory has to grow.
+
+private:
+	void			apply(const std::string &shipment);
+
+	struct Shipped
+	{
+		int		columnId;
+		size_t	revision;
+	};
+
+	std::vector<Shipped>	_shipped;				///< Per column index
+	unsigned long			_filterGeneration	= 0;
+	size_t					_rowCount			= 0;
+	int						_shipments			= 0;
+	DataSet					*_received			= NULL;
+};
+
+#endif // DATASETSHIPPER_H
@@ -0,0 +1,55 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ENGINECHANNEL_H
+#define ENGINECHANNEL_H
+
+#include <functional>
+#include <string>
+
+/* An EngineChannel carries the messages between the desktop and one engine, plus the cancel request (see IPCChannel for what that means).
+ * IPCChannel does this through shared memory for the engines the desktop starts itself, those also read the data set straight from the shared memory.
+ * SocketChannel does it over TCP for an engine on another machine, which can't map that memory, so the data set is shipped to it as well (see DataSetShipper).
+ */
+class EngineChannel
+{
+public:
+	virtual			~EngineChannel() {}
+
+	virtual void	send(std::string &data)											= 0;
+	virtual bool	receive(std::string &data, int timeout = 0)						= 0;
+	virtual int		channelNumber()													= 0;
+
+	virtual void	requestCancel(int analysisId, int revision)						= 0;
+	virtual bool	cancelRequested(int &analysisId, int &revision)			const	= 0;
+			bool	cancelRequested()										const	{ int analysisId, revision; return cancelRequested(analysisId, revision); }
+	virtual void	clearCancel()													= 0;
+
+	virtual void	discardSent()													= 0; ///< Makes sure the other side never reads what was sent last, for when it is restarted.
+
+	virtual void	setKillable(bool)												{}					///< Set by the engine: only while R is evaluating is it sure not to hold a lock that it shares with the desktop
+	virtual bool	killable()												const	{ return true; }
+	virtual void	abandonLocks()													{}					///< For when the other side was killed, it might have held one of them
+
+	virtual bool	connected()												const	{ return true; }
+	virtual bool	sharesMemory()											const	{ return true; }	///< Whether the other side reads the data set from the shared memory of the desktop
+	virtual void	sendDataSet(const std::string &)								{}					///< A DataSetShipper shipment, for a channel that doesn't share memory
+	virtual void	setDataSetReceiver(std::function<void(const std::string &)>)	{}					///< Gets each shipment that comes in, before the messages sent after it are received
+};
+
+#endif // ENGINECHANNEL_H
@@ -0,0 +1,231 @@
+//
+// Copyright (C) 2013-2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "filterbitset.h"
+#include "processinfo.h"
+#include <algorithm>
+#include <stdexcept>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+typedef boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> filterLock;
+
+static boost::posix_time::ptime inMilliseconds(int milliseconds)
+{
+	return boost::posix_time::microsec_clock::universal_time() + boost::posix_time::milliseconds(milliseconds);
+}
+
+FilterBitset::Pin::Pin(const FilterBitset &filter) : _filter(filter)
+{
+	filterLock lock(filter._mutex);
+
+	boost::posix_time::ptime deadline = inMilliseconds(10000);
+
+	for(;;)
+	{
+		for(_slot = 0; _slot < _pinSlots; _slot++)
+		{
+			PinSlot & slot = filter._pins[_slot];
+
+			if(slot.selection != -1 && !ProcessInfo::isProcessRunning(slot.process))
+				slot.selection = -1; //Its process was killed while reading
+
+			if(slot.selection == -1)
+			{
+				_selection		= filter._current;
+				_generation		= filter._generation;
+				slot.process	= ProcessInfo::currentPID();
+				slot.selection	= _selection;
+				return;
+			}
+		}
+
+		if(!filter._unpinned.timed_wait(lock, std::min(deadline, inMilliseconds(250))) && boost::posix_time::microsec_clock::universal_time() >= deadline)
+			throw std::runtime_error("FilterBitset: all pins are taken and none were released for 10 seconds.");
+	}
+}
+
+FilterBitset::Pin::~Pin()
+{
+	filterLock lock(_filter._mutex);
+
+	_filter._pins[_slot].selection = -1;
+	_filter._unpinned.notify_all();
+}
+
+bool FilterBitset::pinned(int selection)
+{
+	for(PinSlot & slot : _pins)
+		if(slot.selection == selection)
+		{
+			if(ProcessInfo::isProcessRunning(slot.process))
+				return true;
+
+			slot.selection = -1;
+		}
+
+	return false;
+}
+
+void FilterBitset::Selection::resize(size_t rowCount)
+{
+	_rowCount = rowCount;
+	_words.resize((rowCount + 63) / 64);
+	_selectedRows.resize(rowCount);
+}
+
+void FilterBitset::Selection::release()
+{
+	_words.clear();
+	_words.shrink_to_fit();
+	_selectedRows.clear();
+	_selectedRows.shrink_to_fit();
+
+	_rowCount		= 0;
+	_selectedCount	= 0;
+	_requestId		= -1;
+}
+
+void FilterBitset::Selection::setAll()
+{
+	for(size_t word = 0; word < _words.size(); word++)
+		_words[word] = ~uint64_t(0);
+
+	if(_rowCount % 64 != 0)
+		_words.back() = (uint64_t(1) << (_rowCount % 64)) - 1;
+
+	for(size_t row = 0; row < _rowCount; row++)
+		_selectedRows[row] = static_cast<int>(row);
+
+	_selectedCount	= _rowCount;
+	_requestId		= -1;
+}
+
+// Picks two slots that nobody pins for the new current and staged selections, preferably the ones that already are, so their memory can be reused.
+bool FilterBitset::unpinnedSlots(int & current, int & staged)
+{
+	int found = 0;
+	int order[_selectionSlots] = { _current, _staged };
+
+	for(int slot = 0, next = 2; slot < _selectionSlots; slot++)
+		if(slot != _current && slot != _staged)
+			order[next++] = slot;
+
+	for(int slot : order)
+		if(!pinned(slot))
+		{
+			(found == 0 ? current : staged) = slot;
+
+			if(++found == 2)
+				return true;
+		}
+
+	return false;
+}
+
+// Frees the selections that are neither current nor staged, once nobody reads them anymore.
+void FilterBitset::releaseUnused()
+{
+	for(int slot = 0; slot < _selectionSlots; slot++)
+		if(slot != _current && slot != _staged && _selections[slot]._words.capacity() > 0 && !pinned(slot))
+			_selections[slot].release();
+}
+
+void FilterBitset::reset(size_t rowCount)
+{
+	filterLock lock(_mutex);
+
+	// A pinned selection is read right now, so it is left as it is and the new ones go in other slots.
+	// Normally only the current one can be pinned, so this only waits when readers of older selections are still busy.
+	boost::posix_time::ptime	deadline = inMilliseconds(10000);
+	int							current,
+								staged;
+
+	while(!unpinnedSlots(current, staged))
+		if(!_unpinned.timed_wait(lock, std::min(deadline, inMilliseconds(250))) && boost::posix_time::microsec_clock::universal_time() >= deadline)
+			throw std::runtime_error("FilterBitset: the filter is still being read, so it could not be reset.");
+
+	for(int slot : { current, staged })
+	{
+		_selections[slot].resize(rowCount);
+		_selections[slot].setAll();
+	}
+
+	_current			= current;
+	_staged				= staged;
+	_lastStagedRequest	= -1;
+	_generation++;
+
+	releaseUnused();
+}
+
+bool FilterBitset::stage(const std::vector<bool> & filterResult, int requestId)
+{
+	filterLock lock(_mutex);
+
+	// Readers are done within a moment, so if the selection is still pinned after a while it is given up on.
+	boost::posix_time::ptime deadline = inMilliseconds(10000);
+
+	while(pinned(_staged))
+		if(!_unpinned.timed_wait(lock, std::min(deadline, inMilliseconds(250))) && boost::posix_time::microsec_clock::universal_time() >= deadline)
+			return false;
+
+	Selection & selection = staged();
+
+	if(filterResult.size() != selection._rowCount || requestId < _lastStagedRequest)
+		return false;
+
+	_lastStagedRequest = requestId;
+
+	size_t selected = 0;
+
+	for(size_t word = 0; word < selection._words.size(); word++)
+	{
+		uint64_t	bits	= 0;
+		size_t		first	= word * 64,
+					last	= std::min(first + 64, filterResult.size());
+
+		for(size_t row = first; row < last; row++)
+			if(filterResult[row])
+			{
+				bits |= uint64_t(1) << (row - first);
+				selection._selectedRows[selected++] = static_cast<int>(row);
+			}
+
+		selection._words[word] = bits;
+	}
+
+	selection._selectedCount	= selected;
+	selection._requestId		= requestId;
+
+	return true;
+}
+
+bool FilterBitset::publish(int requestId)
+{
+	filterLock lock(_mutex);
+
+	if(staged()._requestId != requestId || requestId != _lastStagedRequest)
+		return false;
+
+	std::swap(_current, _staged);
+	_generation++;
+
+	releaseUnused();
+
+	return true;
+}
@@ -0,0 +1,163 @@
+//
+// Copyright (C) 2013-2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef FILTERBITSET_H
+#define FILTERBITSET_H
+
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+
+#include <boost/container/vector.hpp>
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/segment_manager.hpp>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <boost/interprocess/sync/interprocess_condition.hpp>
+
+typedef boost::interprocess::allocator<uint64_t, boost::interprocess::managed_shared_memory::segment_manager>	FilterWordAllocator;
+typedef boost::container::vector<uint64_t, FilterWordAllocator>													FilterWordVector;
+typedef boost::interprocess::allocator<int, boost::interprocess::managed_shared_memory::segment_manager>		FilterRowAllocator;
+typedef boost::container::vector<int, FilterRowAllocator>														FilterRowVector;
+
+/* FilterBitset lives in shared memory as part of the DataSet and holds which rows pass the filter.
+ * Each row is a single bit, packed in 64 bit words, and next to that the indices of the selected rows are kept so readers can gather the filtered rows without testing every row.
+ *
+ * There are two selections: the current one that everybody reads and a staged one.
+ * An engine that ran a filter writes its result directly into the staged selection (stage) and only tells the desktop the requestId.
+ * The desktop then makes it current (publish), which bumps the generation so anyone caching filtered data knows it is outdated.
+ * After a publish the old current selection is the next one to be staged into, so whoever reads a selection holds a Pin on it while doing so
+ * and stage() waits until the one it is about to overwrite isn't pinned anymore (by a process that is still running).
+ * A pinned selection is never resized either: reset() allocates the new current and staged selections in slots that aren't pinned
+ * and the old ones are only freed, by the next reset() or publish(), once nobody pins them anymore.
+ * All memory is allocated (and freed) by the desktop in reset() and publish(), engines never allocate anything in here.
+ */
+class FilterBitset
+{
+public:
+	class Selection
+	{
+		friend class FilterBitset;
+	public:
+		Selection(boost::interprocess::managed_shared_memory *mem) : _words(mem->get_segment_manager()), _selectedRows(mem->get_segment_manager()) {}
+
+		bool		passes(size_t row)	const { return row < _rowCount && (_words[row >> 6] >> (row & 63)) & 1; }
+		size_t		rowCount()			const { return _rowCount;			}
+		size_t		selectedCount()		const { return _selectedCount;		}
+		const int *	selectedRows()		const { return _selectedRows.data();	} ///< The 0-based indices of all rows that pass the filter, selectedCount() of them.
+		int			requestId()			const { return _requestId;			}
+
+		///Walks through [from, to) and writes convert(value) to out for each row that passes the filter. Only words that are partly set have their bits tested, the iterators are forward only so every row is still stepped over.
+		template<typename Iterator, typename Output, typename Convert>
+		size_t gather(Iterator from, Iterator to, Output * out, size_t outMax, Convert convert) const
+		{
+			size_t written = 0;
+
+			for(size_t word = 0; word < _words.size() && from != to && written < outMax; word++)
+			{
+				uint64_t	bits	= _words[word];
+				size_t		rows	= std::min<size_t>(64, _rowCount - word * 64);
+				uint64_t	all		= rows == 64 ? ~uint64_t(0) : (uint64_t(1) << rows) - 1;
+
+				if(bits == 0)
+					for(size_t row = 0; row < rows && from != to; row++)
+						++from;
+
+				else if(bits == all)
+					for(size_t row = 0; row < rows && from != to && written < outMax; row++, ++from)
+						out[written++] = convert(*from);
+
+				else
+					for(size_t row = 0; row < rows && from != to; row++, ++from, bits >>= 1)
+						if(bits & 1)
+						{
+							if(written == outMax)
+								return written;
+
+							out[written++] = convert(*from);
+						}
+			}
+
+			return written;
+		}
+
+	private:
+		void		resize(size_t rowCount);
+		void		setAll();
+		void		release();
+
+		FilterWordVector	_words;
+		FilterRowVector		_selectedRows;
+		size_t				_rowCount		= 0,
+							_selectedCount	= 0;
+		int					_requestId		= -1;
+	};
+
+	///Keeps the selection that was current when it was made from being staged into, for as long as it lives.
+	class Pin
+	{
+	public:
+							Pin(const FilterBitset &filter);
+							~Pin();
+
+		const Selection &	selection()		const { return _filter._selections[_selection];	}
+		unsigned long		generation()	const { return _generation;						} ///< Of the selection, as it was published
+
+	private:
+							Pin(const Pin &) = delete;
+		Pin &				operator=(const Pin &) = delete;
+
+		const FilterBitset	&_filter;
+		int					_slot,
+							_selection;
+		unsigned long		_generation;
+	};
+
+					FilterBitset(boost::interprocess::managed_shared_memory *mem) : _selections{ Selection(mem), Selection(mem), Selection(mem), Selection(mem) } {}
+
+	void			reset(size_t rowCount);									///< Every row passes again, allocates the memory for rowCount rows, desktop only. Throws if there are no two unpinned slots for that within 10 seconds.
+	bool			stage(const std::vector<bool> & filterResult, int requestId);	///< Writes filterResult in place as staged selection, returns false if it doesn't fit or a newer request was already staged.
+	bool			publish(int requestId);									///< Makes the staged selection of requestId current, returns false if that is not what is staged.
+
+	const Selection &	current()		const { return _selections[_current];		} ///< Only safe to read in the process that publishes, anyone else takes a Pin.
+	unsigned long		generation()	const { return _generation;					}
+
+private:
+	Selection &			staged()				{ return _selections[_staged];		}
+	bool				pinned(int selection);
+	bool				unpinnedSlots(int & current, int & staged);
+	void				releaseUnused();
+
+	struct PinSlot
+	{
+		unsigned long	process		= 0;
+		int				selection	= -1;	///< -1 when the slot is free
+	};
+
+	static const int								_pinSlots			= 32,
+													_selectionSlots		= 4;	///< Current and staged, plus room for old ones that are still pinned during a reset
+
+	Selection										_selections[_selectionSlots];
+	int												_current			= 0,
+													_staged				= 1,
+													_lastStagedRequest	= -1;
+	unsigned long									_generation			= 0;
+	mutable PinSlot									_pins[_pinSlots];
+	mutable boost::interprocess::interprocess_mutex		_mutex;
+	mutable boost::interprocess::interprocess_condition	_unpinned;
+};
+
+#endif // FILTERBITSET_H
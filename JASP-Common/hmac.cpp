@@ -0,0 +1,179 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "hmac.h"
+
+#include <cstdint>
+#include <stdexcept>
+
+#ifdef __WIN32__
+#include <windows.h>
+#include <bcrypt.h>
+#else
+#include <fstream>
+#endif
+
+using namespace std;
+
+static const uint32_t roundConstants[64] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static uint32_t rotateRight(uint32_t value, int bits) { return (value >> bits) | (value << (32 - bits)); }
+
+static void compress(uint32_t state[8], const unsigned char block[64])
+{
+	uint32_t w[64];
+
+	for (int i = 0; i < 16; i++)
+		w[i] = uint32_t(block[4 * i]) << 24 | uint32_t(block[4 * i + 1]) << 16 | uint32_t(block[4 * i + 2]) << 8 | uint32_t(block[4 * i + 3]);
+
+	for (int i = 16; i < 64; i++)
+	{
+		uint32_t s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3),
+				 s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+
+	for (int i = 0; i < 64; i++)
+	{
+		uint32_t	t1	= h + (rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25)) + ((e & f) ^ (~e & g)) + roundConstants[i] + w[i],
+					t2	= (rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+
+		h = g; g = f; f = e; e = d + t1;
+		d = c; c = b; b = a; a = t1 + t2;
+	}
+
+	state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+	state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+string Hmac::sha256(const string &message)
+{
+	uint32_t state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+	// The message is followed by a one bit, zeros up to 8 bytes short of a whole block and its length in bits
+	string		padded	= message + '\x80';
+	uint64_t	bits	= uint64_t(message.size()) * 8;
+
+	padded.append((120 - padded.size() % 64) % 64, '\0');
+
+	for (int shift = 56; shift >= 0; shift -= 8)
+		padded += char(bits >> shift);
+
+	for (size_t block = 0; block < padded.size(); block += 64)
+		compress(state, reinterpret_cast<const unsigned char *>(padded.data() + block));
+
+	string digest;
+
+	for (uint32_t word : state)
+		for (int shift = 24; shift >= 0; shift -= 8)
+			digest += char(word >> shift);
+
+	return digest;
+}
+
+string Hmac::sha256(const string &key, const string &message)
+{
+	string block = key.size() > 64 ? sha256(key) : key;
+	block.resize(64, '\0');
+
+	string inner = block, outer = block;
+
+	for (size_t i = 0; i < 64; i++)
+	{
+		inner[i] ^= 0x36;
+		outer[i] ^= 0x5c;
+	}
+
+	return sha256(outer + sha256(inner + message));
+}
+
+string Hmac::nonce()
+{
+	// Straight from the cryptographic generator of the operating system, the output of a seeded mersenne twister (like boost's uuid random_generator) can be predicted after seeing enough of it
+	string bytes(32, '\0');
+
+#ifdef __WIN32__
+	if (!BCRYPT_SUCCESS(BCryptGenRandom(NULL, reinterpret_cast<PUCHAR>(&bytes[0]), ULONG(bytes.size()), BCRYPT_USE_SYSTEM_PREFERRED_RNG)))
+		throw runtime_error("Could not get random bytes from the operating system.");
+#else
+	ifstream urandom("/dev/urandom", ios::binary);
+
+	if (!urandom.read(&bytes[0], bytes.size()))
+		throw runtime_error("Could not read random bytes from /dev/urandom.");
+#endif
+
+	return bytes;
+}
+
+bool Hmac::equal(const string &a, const string &b)
+{
+	unsigned char difference = a.size() != b.size();
+
+	for (size_t i = 0; i < a.size() && i < b.size(); i++)
+		difference |= a[i] ^ b[i];
+
+	return difference == 0;
+}
+
+string Hmac::toHex(const string &bytes)
+{
+	static const char digits[] = "0123456789abcdef";
+	string hex;
+
+	for (unsigned char byte : bytes)
+	{
+		hex += digits[byte >> 4];
+		hex += digits[byte & 15];
+	}
+
+	return hex;
+}
+
+string Hmac::fromHex(const string &hex)
+{
+	auto value = [](char c) { return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1; };
+
+	if (hex.size() % 2 != 0)
+		return "";
+
+	string bytes;
+
+	for (size_t i = 0; i < hex.size(); i += 2)
+	{
+		int high = value(hex[i]), low = value(hex[i + 1]);
+
+		if (high < 0 || low < 0)
+			return "";
+
+		bytes += char(high << 4 | low);
+	}
+
+	return bytes;
+}
@@ -0,0 +1,37 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef HMAC_H
+#define HMAC_H
+
+#include <string>
+
+/* Hmac proves that both ends of a connection know the same secret without sending it: one side sends a nonce, the other answers with sha256(secret, nonce).
+ * JASP-Common doesn't link a crypto library, so SHA-256 (FIPS 180-4) and HMAC (RFC 2104) are implemented here. All strings are raw bytes.
+ */
+class Hmac
+{
+public:
+	static std::string	sha256(const std::string &message);									///< The 32 byte digest
+	static std::string	sha256(const std::string &key, const std::string &message);			///< HMAC-SHA256 of message with key, 32 bytes
+	static std::string	nonce();															///< 32 unpredictable bytes
+	static bool			equal(const std::string &a, const std::string &b);					///< Takes as long wherever they differ, so the time doesn't give away how much of a digest was right
+	static std::string	toHex(const std::string &bytes);
+	static std::string	fromHex(const std::string &hex);									///< Empty if hex isn't
+};
+
+#endif // HMAC_H
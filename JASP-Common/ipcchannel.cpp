@@ -17,6 +17,7 @@
 
 #include "ipcchannel.h"
 #include "tempfiles.h"
+#include "tracing.h"
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include "boost/nowide/convert.hpp"
@@ -31,6 +32,10 @@ IPCChannel::IPCChannel(std::string name, int channelNumber, bool isSlave) : _bas
 
 	_sizeMtoS				= _memoryControl->find_or_construct<size_t>("sizeMasterToSlave")(1024 * 1024 * 8);
 	_sizeStoM				= _memoryControl->find_or_construct<size_t>("sizeSlaveToMaster")(1024 * 1024 * 8);
+	_cancelRequest			= _memoryControl->find_or_construct<std::atomic<uint64_t>>("cancelRequest")(0);
+	_killable				= _memoryControl->find_or_construct<std::atomic<int>>("killable")(0);
+	_sentMtoS				= _memoryControl->find_or_construct<uint64_t>("sentMasterToSlave")(0);
+	_sentStoM				= _memoryControl->find_or_construct<uint64_t>("sentSlaveToMaster")(0);
 
 	_memoryMasterToSlave	= new interprocess::managed_shared_memory(interprocess::open_or_create, _nameMtS.c_str(), *_sizeMtoS);
 	_memorySlaveToMaster	= new interprocess::managed_shared_memory(interprocess::open_or_create, _nameStM.c_str(), *_sizeStoM);
@@ -50,6 +55,9 @@ IPCChannel::IPCChannel(std::string name, int channelNumber, bool isSlave) : _bas
 	_sizeIn  = _isSlave ? _sizeMtoS : _sizeStoM;
 	_sizeOut = _isSlave ? _sizeStoM : _sizeMtoS;
 
+	_sentIn  = _isSlave ? _sentMtoS : _sentStoM;
+	_sentOut = _isSlave ? _sentStoM : _sentMtoS;
+
 	_previousSizeIn = *_sizeIn;
 	_previousSizeOut = *_sizeOut;
 
@@ -178,6 +186,8 @@ void IPCChannel::doubleMemoryOut()
 
 void IPCChannel::send(string &data, bool alreadyLockedMutex)
 {
+	TraceSpan span("IPCChannel::send");
+
 	if(!alreadyLockedMutex)
 		_mutexOut->lock();
 
@@ -195,6 +205,14 @@ void IPCChannel::send(string &data, bool alreadyLockedMutex)
 		throw e; //no need to unlock because this will crash stuff
 	}
 
+	(*_sentOut)++;
+
+	if (Tracing::enabled())
+	{
+		span.setMessageId(messageId(!_isSlave, *_sentOut));
+		Tracing::flowStart("ipc", messageId(!_isSlave, *_sentOut));
+	}
+
 #ifdef __APPLE__
 	sem_post(_semaphoreOut);
 #elif defined __WIN32__
@@ -221,6 +239,8 @@ bool IPCChannel::receive(string &data, int timeout)
 
 	if (tryWait(timeout))
 	{
+		TraceSpan span("IPCChannel::receive");
+
 		_mutexIn->lock();
 
 		while (tryWait()); // clear it completely
@@ -236,6 +256,13 @@ bool IPCChannel::receive(string &data, int timeout)
 			throw e;
 		}
 
+		// If the other side sent twice before this one looked only the last message is read, so the flows of the ones before it stay unfinished.
+		if (Tracing::enabled())
+		{
+			span.setMessageId(messageId(_isSlave, *_sentIn));
+			Tracing::flowEnd("ipc", messageId(_isSlave, *_sentIn));
+		}
+
 		_mutexIn->unlock();
 
 		return true;
@@ -245,6 +272,60 @@ bool IPCChannel::receive(string &data, int timeout)
 }
 
 
+void IPCChannel::requestCancel(int analysisId, int revision)
+{
+	_cancelRequest->store((uint64_t(uint32_t(analysisId + 1)) << 32) | uint32_t(revision));
+}
+
+bool IPCChannel::cancelRequested(int &analysisId, int &revision) const
+{
+	uint64_t request = _cancelRequest->load();
+
+	analysisId	= int(uint32_t(request >> 32)) - 1;
+	revision	= int(uint32_t(request));
+
+	return request != 0;
+}
+
+void IPCChannel::clearCancel()
+{
+	_cancelRequest->store(0);
+}
+
+void IPCChannel::discardSent()
+{
+	_mutexOut->lock();
+
+#ifdef __APPLE__
+	while (sem_trywait(_semaphoreOut) == 0);
+#elif defined __WIN32__
+	while (WaitForSingleObject(_semaphoreOut, 0) == WAIT_OBJECT_0);
+#else
+	while (_semaphoreOut->try_wait());
+#endif
+
+	_mutexOut->unlock();
+}
+
+void IPCChannel::setKillable(bool killable)
+{
+	_killable->store(killable ? 1 : 0);
+}
+
+bool IPCChannel::killable() const
+{
+	return _killable->load() == 1;
+}
+
+// Only the killed side could have held them and the other side only uses them from one thread, so nobody is waiting for them now.
+void IPCChannel::abandonLocks()
+{
+	new (_mutexIn)	interprocess::interprocess_mutex();
+	new (_mutexOut)	interprocess::interprocess_mutex();
+
+	_killable->store(0);
+}
+
 bool IPCChannel::tryWait(int timeout)
 {
 	bool messageWaiting;
@@ -37,19 +37,40 @@
 #include <boost/interprocess/managed_shared_memory.hpp>
 #include <boost/container/string.hpp>
 
+#include <atomic>
+#include <cstdint>
+
+#include "enginechannel.h"
+
 typedef boost::interprocess::allocator<char, boost::interprocess::managed_shared_memory::segment_manager> CharAllocator;
 typedef boost::container::basic_string<char, std::char_traits<char>, CharAllocator> String;
 typedef boost::interprocess::allocator<String, boost::interprocess::managed_shared_memory::segment_manager> StringAllocator;
 
-class IPCChannel
+class IPCChannel : public EngineChannel
 {
 public:
 	IPCChannel(std::string name, int channelNumber, bool isSlave = false);
 
-	void send(std::string &data, bool alreadyLockedMutex = false);
-	bool receive(std::string &data, int timeout = 0);
+	void send(std::string &data) override { send(data, false); }
+	void send(std::string &data, bool alreadyLockedMutex);
+	bool receive(std::string &data, int timeout = 0) override;
+
+	int channelNumber() override { return _channelNumber; }
+
+	/* Besides the messages there is a cancel request, so the desktop can stop a run that is out of date without waiting for the engine to read its messages.
+	 * It names an analysis and a revision: the engine interrupts R if it is running an older revision of that analysis, and clears the request once it is done with it (or when it wasn't running that at all).
+	 * If the request is still there after a while the engine is stuck and the desktop can restart it.
+	 */
+	void requestCancel(int analysisId, int revision) override;
+	bool cancelRequested(int &analysisId, int &revision) const override;
+	using EngineChannel::cancelRequested;
+	void clearCancel() override;
 
-	int channelNumber() { return _channelNumber; }
+	void discardSent() override;
+
+	void setKillable(bool killable) override;
+	bool killable() const override;
+	void abandonLocks() override;
 
 private:
 
@@ -72,6 +93,12 @@ private:
 
 	size_t *_sizeMtoS, *_sizeStoM, *_sizeIn, *_sizeOut, _previousSizeIn, _previousSizeOut;
 
+	uint64_t *_sentMtoS, *_sentStoM, *_sentIn, *_sentOut; ///< How many messages went each way, so a trace can tie a send to its receive.
+	int64_t messageId(bool masterToSlave, uint64_t count) const { return (int64_t(_channelNumber) << 33) | (int64_t(masterToSlave ? 0 : 1) << 32) | int64_t(count & 0xffffffff); }
+
+	std::atomic<uint64_t> *_cancelRequest; ///< Lock-free, so either side can read it at any time. Analysis id + 1 in the high half and revision in the low half, 0 if there is none.
+	std::atomic<int> *_killable; ///< 1 while the engine is in R evaluation, so the desktop may kill it without leaving a lock in shared memory behind.
+
 	void generateNames();
 	std::string _mutexInName,
 				_mutexOutName,
@@ -80,6 +80,7 @@ Label &Label::operator=(const Label &label)
 	this->_hasIntValue	= label._hasIntValue;
 	this->_intValue		= label._intValue;
 	this->_filterAllow	= label._filterAllow;
+	this->_count		= label._count;
 
 	std::memcpy(_stringValue, label._stringValue, label._stringLength);
 	_stringLength = label._stringLength;
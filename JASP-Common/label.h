@@ -47,6 +47,9 @@ public:
 	bool filterAllows() const { return _filterAllow; }
 	void setFilterAllows(bool allowFilter) { _filterAllow = allowFilter; }
 
+	size_t count() const { return _count; } ///< How many rows have this label, set by the ColumnStats of its column.
+	void setCount(size_t count) { _count = count; }
+
 private:
 
 	bool _hasIntValue;
@@ -57,6 +60,7 @@ private:
     void _setLabel(const std::string &label);
 
 	bool _filterAllow = true;
+	size_t _count = 0;
 };
 
 #endif // LABEL_H
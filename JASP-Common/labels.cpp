@@ -22,6 +22,7 @@
 using namespace std;
 
 map<int, map<int, string> > Labels::_orgStringValues;
+mutex Labels::_orgStringValuesMutex;
 int Labels::_counter = 0;
 
 Labels::Labels(boost::interprocess::managed_shared_memory *mem)
@@ -61,6 +62,11 @@ int Labels::add(int key, const std::string &display, bool filterAllows)
 	return key;
 }
 
+void Labels::reserve(size_t count)
+{
+	_labels.reserve(count);
+}
+
 void Labels::removeValues(std::set<int> valuesToRemove)
 {
 	_labels.erase(
@@ -201,6 +207,7 @@ std::set<int> Labels::getIntValues()
 
 map<int, string> &Labels::getOrgStringValues() const
 {
+	lock_guard<mutex> lock(_orgStringValuesMutex);
 	return Labels::_orgStringValues[_id];
 }
 
@@ -22,6 +22,7 @@
 #include <map>
 #include <vector>
 #include <set>
+#include <mutex>
 
 #include <boost/container/vector.hpp>
 #include <boost/container/map.hpp>
@@ -46,6 +47,7 @@ public:
 	int add(const std::string &display);
 	int add(int key, const std::string &display, bool filterAllows);
 	void removeValues(std::set<int> valuesToRemove);
+	void reserve(size_t count); ///< Makes room for count labels, so adding up to that many doesn't allocate shared memory
 	bool syncInts(const std::set<int> &values);
 	bool syncInts(std::map<int, std::string> &values);
 	std::map<std::string, int> syncStrings(const std::vector<std::string> &new_values, const std::map<std::string, std::string> &new_labels, bool *changedSomething);
@@ -92,6 +94,7 @@ private:
 	// This map is not in the shared memory (it's only used by the JASP-Desktop): this allows this map to grow
 	// without risking to fill up the shared memory.
 	static std::map<int, std::map<int, std::string> > _orgStringValues;
+	static std::mutex _orgStringValuesMutex; // Columns can be processed on several threads at once, each only uses its own entry of _orgStringValues
 };
 
 namespace boost
@@ -0,0 +1,66 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+size_t Parallel::threadCount()
+{
+	return std::max(1u, thread::hardware_concurrency());
+}
+
+void Parallel::forEach(size_t count, const Task &task, size_t maxThreads)
+{
+	atomic<size_t>	next(0);
+	atomic<bool>	failed(false);
+	exception_ptr	failure;
+
+	auto worker = [&](bool onCallingThread)
+	{
+		for (size_t index = next++; index < count && !failed; index = next++)
+			try
+			{
+				task(index, onCallingThread);
+			}
+			catch (...)
+			{
+				if (!failed.exchange(true))
+					failure = current_exception();
+			}
+	};
+
+	size_t threads = std::min(maxThreads == 0 ? threadCount() : maxThreads, count);
+
+	vector<thread> workers;
+	for (size_t t = 1; t < threads; t++)
+		workers.push_back(thread(worker, false));
+
+	worker(true);
+
+	for (thread &other : workers)
+		other.join();
+
+	if (failed)
+		rethrow_exception(failure);
+}
@@ -0,0 +1,37 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+/* Parallel spreads independent pieces of work (columns, blocks, archive entries) over the cores.
+ * Each thread takes the next piece that isn't done yet and the calling thread helps out as well, so nothing is started when there is only one piece.
+ * Once a piece throws no new ones are started, the first exception is rethrown on the calling thread after all the others are done.
+ */
+class Parallel
+{
+public:
+	typedef std::function<void(size_t index, bool onCallingThread)> Task; ///< onCallingThread is for reporting progress and the like, which isn't thread safe
+
+	static size_t	threadCount(); ///< As many as there are cores, at least one
+	static void		forEach(size_t count, const Task &task, size_t maxThreads = 0); ///< Calls task for every index below count, maxThreads 0 means threadCount()
+};
+
+#endif // PARALLEL_H
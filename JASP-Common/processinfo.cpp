@@ -22,6 +22,8 @@
 #include <tlhelp32.h>
 #else
 #include "unistd.h"
+#include <cerrno>
+#include <signal.h>
 #endif
 
 unsigned long ProcessInfo::currentPID()
@@ -89,3 +91,22 @@ bool ProcessInfo::isParentRunning()
 	return getppid() != 1;
 #endif
 }
+
+bool ProcessInfo::isProcessRunning(unsigned long pid)
+{
+#ifdef __WIN32__
+	HANDLE handle = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, pid);
+
+	if (handle == NULL)
+		return false;
+
+	DWORD	exitCode;
+	BOOL	success = GetExitCodeProcess(handle, &exitCode);
+
+	CloseHandle(handle);
+
+	return ( ! success) || exitCode == STILL_ACTIVE;
+#else
+	return kill(pid_t(pid), 0) == 0 || errno == EPERM;
+#endif
+}
@@ -26,6 +26,7 @@ public:
 	static unsigned long parentPID();
 
 	static bool isParentRunning();
+	static bool isProcessRunning(unsigned long pid);
 
 };
 
@@ -28,6 +28,7 @@ using namespace boost;
 
 interprocess::managed_shared_memory *SharedMemory::_memory = NULL;
 string SharedMemory::_memoryName;
+size_t SharedMemory::_mappedSize = 0;
 
 DataSet *SharedMemory::createDataSet()
 {
@@ -42,6 +43,7 @@ DataSet *SharedMemory::createDataSet()
 
 		interprocess::shared_memory_object::remove(_memoryName.c_str());
 		_memory = new interprocess::managed_shared_memory(interprocess::create_only, _memoryName.c_str(), 6 * 1024 * 1024);
+		_mappedSize = _memory->get_size();
 	}
 
 	DataSet * data = _memory->construct<DataSet>(interprocess::unique_instance)(_memory);
@@ -61,6 +63,7 @@ DataSet *SharedMemory::retrieveDataSet(unsigned long parentPID)
 		_memoryName = ss.str();
 
 		_memory = new interprocess::managed_shared_memory(interprocess::open_only, _memoryName.c_str());
+		_mappedSize = _memory->get_size();
 	}
 
 	DataSet * data = _memory->find<DataSet>(interprocess::unique_instance).first;
@@ -68,6 +71,27 @@ DataSet *SharedMemory::retrieveDataSet(unsigned long parentPID)
 	return data;
 }
 
+DataSet *SharedMemory::followGrowth(unsigned long parentPID)
+{
+	DataSet *dataSet = retrieveDataSet(parentPID);
+
+	interprocess::shared_memory_object	object(interprocess::open_only, _memoryName.c_str(), interprocess::read_only);
+	interprocess::offset_t				size = 0;
+
+	if (object.get_size(size) && size_t(size) > _mappedSize)
+	{
+#ifdef JASP_DEBUG
+		std::cout << "SharedMemory::followGrowth to " << size << std::endl;
+#endif
+		delete _memory;
+		_memory		= new interprocess::managed_shared_memory(interprocess::open_only, _memoryName.c_str());
+		_mappedSize	= _memory->get_size();
+		dataSet		= retrieveDataSet();
+	}
+
+	return dataSet;
+}
+
 DataSet *SharedMemory::enlargeDataSet(DataSet *)
 {
 	size_t extraSize = _memory->get_size();
@@ -76,10 +100,7 @@ DataSet *SharedMemory::enlargeDataSet(DataSet *)
 	std::cout << "SharedMemory::enlargeDataSet to " << extraSize << std::endl;
 #endif
 
-	delete _memory;
-
-	interprocess::managed_shared_memory::grow(_memoryName.c_str(), extraSize);
-	_memory = new interprocess::managed_shared_memory(interprocess::open_only, _memoryName.c_str());
+	_grow(extraSize);
 
 	DataSet *dataSet = retrieveDataSet();
 	dataSet->setSharedMemory(_memory);
@@ -87,6 +108,43 @@ DataSet *SharedMemory::enlargeDataSet(DataSet *)
 	return dataSet;
 }
 
+// Makes sure there is room for a data set of this size, so that filling it doesn't have to enlarge the memory (and start over) time and again.
+DataSet *SharedMemory::reserveMemory(DataSet *dataSet, size_t columnCount, size_t rowCount, size_t labelCount)
+{
+	size_t	blocksPerColumn	= (rowCount + DataBlock::capacity() - 1) / DataBlock::capacity(),
+			perBlock		= sizeof(DataBlock) + 128,							// plus the entry in the BlockMap and the bookkeeping of the allocator
+			perColumn		= sizeof(Column) + 256 + blocksPerColumn * perBlock,	// plus the name
+			perLabel		= 2 * sizeof(Label),								// a LabelVector can be twice the size it needs while growing
+			needed			= columnCount * perColumn + labelCount * perLabel;
+
+	needed += needed / 4 + 1024 * 1024; // Some slack for fragmentation
+
+	size_t free = _memory->get_free_memory();
+
+	if (free >= needed)
+		return dataSet;
+
+#ifdef JASP_DEBUG
+	std::cout << "SharedMemory::reserveMemory grows by " << (needed - free) << std::endl;
+#endif
+
+	_grow(needed - free);
+
+	dataSet = retrieveDataSet();
+	dataSet->setSharedMemory(_memory);
+
+	return dataSet;
+}
+
+void SharedMemory::_grow(size_t extraSize)
+{
+	delete _memory;
+
+	interprocess::managed_shared_memory::grow(_memoryName.c_str(), extraSize);
+	_memory = new interprocess::managed_shared_memory(interprocess::open_only, _memoryName.c_str());
+	_mappedSize = _memory->get_size();
+}
+
 void SharedMemory::deleteDataSet(DataSet *dataSet)
 {
 	_memory->destroy_ptr(dataSet);
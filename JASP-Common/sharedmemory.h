@@ -40,12 +40,17 @@ public:
 
 	static DataSet *createDataSet();
 	static DataSet *retrieveDataSet(unsigned long parentPID = 0);
+	static DataSet *followGrowth(unsigned long parentPID = 0);	///< For a background process, maps the memory again if the UI process enlarged it since, which moves the DataSet
 	static DataSet *enlargeDataSet(DataSet *dataSet);
+	static DataSet *reserveMemory(DataSet *dataSet, size_t columnCount, size_t rowCount, size_t labelCount);
 	static void deleteDataSet(DataSet *dataSet);
 
 private:
 
+	static void _grow(size_t extraSize);
+
 	static std::string _memoryName;
+	static size_t _mappedSize; ///< The size of the memory when this process mapped it, get_size() says how large it is now
 	static boost::interprocess::managed_shared_memory *_memory;
 
 };
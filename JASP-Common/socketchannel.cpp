@@ -0,0 +1,350 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "socketchannel.h"
+#include "hmac.h"
+#include "processinfo.h"
+#include "tracing.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+using boost::asio::ip::tcp;
+
+SocketChannel::SocketChannel(int channelNumber) : _socket(_service), _channelNumber(channelNumber)
+{
+}
+
+SocketChannel::~SocketChannel()
+{
+	close();
+}
+
+string SocketChannel::secretFromEnvironment()
+{
+	const char *secret = getenv("JASP_ENGINE_SECRET");
+
+	if (secret == NULL || string(secret) == "")
+		throw runtime_error("JASP_ENGINE_SECRET has to be set to the same secret for the desktop and its remote engines.");
+
+	return secret;
+}
+
+SocketChannel * SocketChannel::connect(const string &host, int port, int channelNumber, const string &secret)
+{
+	SocketChannel	*channel = new SocketChannel(channelNumber);
+	string			where	= host + ":" + std::to_string(port);
+
+	try
+	{
+		tcp::resolver resolver(channel->_service);
+		boost::asio::connect(channel->_socket, resolver.resolve(tcp::resolver::query(host, std::to_string(port))));
+		channel->_socket.set_option(tcp::no_delay(true));
+	}
+	catch (boost::system::system_error &e)
+	{
+		delete channel;
+		throw runtime_error("Could not connect to an engine at " + where + ": " + e.what());
+	}
+
+	// The engine challenges us with a nonce and we challenge it with one of our own, nothing else is sent before it proved it knows the secret as well.
+	string engineNonce, welcome;
+
+	if (!channel->readHandshake(Challenge, engineNonce, 5000) || engineNonce.size() != 32)
+	{
+		delete channel;
+		throw runtime_error("The engine at " + where + " did not send a challenge, it is not a JASP engine or an older one.");
+	}
+
+	string desktopNonce	= Hmac::nonce(),
+		   hello		= std::to_string(channelNumber) + " " + std::to_string(ProcessInfo::currentPID()) + " " + Hmac::toHex(desktopNonce);
+
+	channel->_connected = true;
+	channel->sendFrame(Hello, hello + " " + Hmac::toHex(Hmac::sha256(secret, "desktop " + engineNonce + " " + hello)));
+
+	if (!channel->readHandshake(Welcome, welcome, 5000) || !Hmac::equal(Hmac::fromHex(welcome), Hmac::sha256(secret, "engine " + desktopNonce + " " + engineNonce)))
+	{
+		delete channel;
+		throw runtime_error("The engine at " + where + " does not have the same JASP_ENGINE_SECRET.");
+	}
+
+	channel->startReading();
+
+	return channel;
+}
+
+SocketChannel * SocketChannel::listen(const string &address, int port, const string &secret, bool allowUnencrypted)
+{
+	boost::asio::ip::address listenOn = boost::asio::ip::address::from_string(address);
+
+	if (!listenOn.is_loopback() && !allowUnencrypted)
+		throw runtime_error("Everything sent to a remote engine, including the data, is unencrypted. Listen on loopback and reach it through an SSH tunnel (ssh -L), or pass --allow-unencrypted to listen on " + address + " anyway.");
+
+	boost::asio::io_service	service;
+	tcp::acceptor			acceptor(service, tcp::endpoint(listenOn, port));
+
+	while (true)
+	{
+		SocketChannel	*channel		= new SocketChannel(0);
+		string			engineNonce		= Hmac::nonce(),
+						hello;
+
+		acceptor.accept(channel->_socket);
+		channel->_socket.set_option(tcp::no_delay(true));
+
+		channel->_connected = true;
+		channel->sendFrame(Challenge, engineNonce);
+
+		// "<channel number> <process id> <their nonce> <proof>", whoever can't answer the challenge is dropped and the next connection is waited for
+		if (channel->_connected && channel->readHandshake(Hello, hello, 5000))
+		{
+			size_t			lastSpace	= hello.rfind(' ');
+			string			signedPart	= hello.substr(0, lastSpace == string::npos ? 0 : lastSpace),
+							proof		= Hmac::fromHex(hello.substr(lastSpace == string::npos ? 0 : lastSpace + 1)),
+							desktopNonce;
+			stringstream	helloStream(signedPart);
+
+			helloStream >> channel->_channelNumber >> channel->_peerProcessId >> desktopNonce;
+			desktopNonce = Hmac::fromHex(desktopNonce);
+
+			if (!helloStream.fail() && desktopNonce.size() == 32 && Hmac::equal(proof, Hmac::sha256(secret, "desktop " + engineNonce + " " + signedPart)))
+			{
+				channel->sendFrame(Welcome, Hmac::toHex(Hmac::sha256(secret, "engine " + desktopNonce + " " + engineNonce)));
+				channel->startReading();
+
+				return channel;
+			}
+		}
+
+		std::cout << "Something connected to port " << port << " without the secret of a JASP desktop, dropping it." << std::endl;
+		delete channel;
+	}
+}
+
+///Waits at most timeout ms for a frame of the handshake, so something that connects and then says nothing doesn't keep a desktop out or a desktop waiting.
+bool SocketChannel::readHandshake(Kind expected, string &payload, int timeout)
+{
+	unsigned char				header[5];
+	bool						success	= false;
+	boost::asio::deadline_timer	timer(_service, boost::posix_time::milliseconds(timeout));
+
+	timer.async_wait([&](const boost::system::error_code &error)
+	{
+		if (!error)
+		{
+			boost::system::error_code ignored;
+			_socket.close(ignored);
+		}
+	});
+
+	boost::asio::async_read(_socket, boost::asio::buffer(header, sizeof(header)), [&](const boost::system::error_code &error, size_t)
+	{
+		size_t length = size_t(header[1]) | size_t(header[2]) << 8 | size_t(header[3]) << 16 | size_t(header[4]) << 24;
+
+		if (error || header[0] != expected || length == 0 || length > 1024)
+		{
+			timer.cancel();
+			return;
+		}
+
+		payload.resize(length);
+
+		boost::asio::async_read(_socket, boost::asio::buffer(&payload[0], length), [&](const boost::system::error_code &error, size_t)
+		{
+			success = !error;
+			timer.cancel();
+		});
+	});
+
+	_service.run();
+	_service.reset();
+
+	return success;
+}
+
+void SocketChannel::close()
+{
+	if (_socket.is_open())
+	{
+		boost::system::error_code ignored;
+		_socket.shutdown(tcp::socket::shutdown_both, ignored);
+		_socket.close(ignored);
+	}
+
+	_connected = false;
+	_queueChanged.notify_all();
+
+	if (_reader.joinable())
+		_reader.join();
+}
+
+void SocketChannel::sendFrame(Kind kind, const string &payload)
+{
+	TraceSpan span("SocketChannel::send");
+
+	uint32_t	length		= uint32_t(payload.size());
+	char		header[5]	= { kind, char(length), char(length >> 8), char(length >> 16), char(length >> 24) };
+
+	std::lock_guard<std::mutex> lock(_sendMutex);
+
+	if (!_connected)
+		return;
+
+	boost::system::error_code error;
+	boost::asio::write(_socket, std::vector<boost::asio::const_buffer>{ boost::asio::buffer(header, sizeof(header)), boost::asio::buffer(payload) }, error);
+
+	if (error)
+	{
+		std::cout << "SocketChannel lost its connection while sending: " << error.message() << std::endl;
+		_connected = false;
+		_queueChanged.notify_all();
+	}
+}
+
+bool SocketChannel::readFrame(Kind &kind, string &payload)
+{
+	unsigned char				header[5];
+	boost::system::error_code	error;
+
+	boost::asio::read(_socket, boost::asio::buffer(header, sizeof(header)), error);
+
+	if (!error)
+	{
+		size_t length = size_t(header[1]) | size_t(header[2]) << 8 | size_t(header[3]) << 16 | size_t(header[4]) << 24;
+
+		if (length > maxFrameSize)
+			throw runtime_error("SocketChannel received a frame of " + std::to_string(length) + " bytes, that is more than it accepts.");
+
+		payload.resize(length);
+		kind = Kind(header[0]);
+
+		if (payload.size() > 0)
+			boost::asio::read(_socket, boost::asio::buffer(&payload[0], payload.size()), error);
+	}
+
+	return !error;
+}
+
+void SocketChannel::startReading()
+{
+	_reader = std::thread(&SocketChannel::readFrames, this);
+}
+
+void SocketChannel::readFrames()
+{
+	Kind	kind;
+	string	payload;
+
+	try
+	{
+		while (readFrame(kind, payload))
+			switch (kind)
+			{
+			case Cancel:
+			{
+				int analysisId = -1, revision = -1;
+				stringstream(payload) >> analysisId >> revision;
+				_cancelRequest = (uint64_t(uint32_t(analysisId + 1)) << 32) | uint32_t(revision);
+				break;
+			}
+
+			case ClearCancel:
+				_cancelRequest = 0;
+				break;
+
+			case Message:
+			case DataSetShipment:
+			{
+				std::lock_guard<std::mutex> lock(_queueMutex);
+				_queue.push_back(make_pair(kind, std::move(payload)));
+				_queueChanged.notify_all();
+				break;
+			}
+
+			default:
+				std::cout << "SocketChannel received a frame of unknown kind " << int(kind) << ", ignoring it." << std::endl;
+				break;
+			}
+	}
+	catch (std::exception &e) // A frame too large to take, or to allocate, means the other side can't be trusted to make sense anymore
+	{
+		std::cout << "SocketChannel drops its connection: " << e.what() << std::endl;
+
+		boost::system::error_code ignored;
+		_socket.shutdown(tcp::socket::shutdown_both, ignored);
+	}
+
+	_connected = false;
+	_queueChanged.notify_all();
+}
+
+bool SocketChannel::receive(string &data, int timeout)
+{
+	std::unique_lock<std::mutex> lock(_queueMutex);
+
+	auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+
+	while (true)
+	{
+		while (_queue.empty())
+			if (!_connected || _queueChanged.wait_until(lock, until) == std::cv_status::timeout)
+				return false;
+
+		pair<Kind, string> frame = std::move(_queue.front());
+		_queue.pop_front();
+
+		if (frame.first == Message)
+		{
+			TraceSpan span("SocketChannel::receive");
+			data = std::move(frame.second);
+			return true;
+		}
+
+		// A shipment is applied before the messages that were sent after it are handed out, those might need the data it brings.
+		if (_dataSetReceiver)
+		{
+			lock.unlock();
+			_dataSetReceiver(frame.second);
+			lock.lock();
+		}
+	}
+}
+
+void SocketChannel::requestCancel(int analysisId, int revision)
+{
+	_cancelRequest = (uint64_t(uint32_t(analysisId + 1)) << 32) | uint32_t(revision);
+	sendFrame(Cancel, std::to_string(analysisId) + " " + std::to_string(revision));
+}
+
+bool SocketChannel::cancelRequested(int &analysisId, int &revision) const
+{
+	uint64_t request = _cancelRequest;
+
+	analysisId	= int(uint32_t(request >> 32)) - 1;
+	revision	= int(uint32_t(request));
+
+	return request != 0;
+}
+
+void SocketChannel::clearCancel()
+{
+	_cancelRequest = 0;
+	sendFrame(ClearCancel, "");
+}
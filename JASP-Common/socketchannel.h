@@ -0,0 +1,96 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef SOCKETCHANNEL_H
+#define SOCKETCHANNEL_H
+
+#include "enginechannel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <boost/asio.hpp>
+
+/* A SocketChannel is an EngineChannel over a TCP connection, for an engine that the desktop doesn't start itself (it can run on another machine).
+ * The engine listens on a port (JASPEngine --listen [address:]<port>, on loopback unless an address is given) and the desktop connects to it.
+ * Both were given the same secret in JASP_ENGINE_SECRET, which never goes over the connection: the engine sends a nonce, the desktop answers with
+ * an HMAC of it (see Hmac) together with its channel number, process id and a nonce of its own, which the engine answers in the same way.
+ * Whatever connects without the secret is dropped, as is a connection that sends a frame larger than maxFrameSize.
+ * Nothing is encrypted though, the data set included, so the engine refuses to listen on anything but loopback unless it is started with
+ * --allow-unencrypted. To use an engine on another machine run it on loopback there and forward a port to it with an SSH tunnel (ssh -L).
+ * Everything is sent as frames of a kind byte, a 32 bit length and the payload. Messages and data set shipments arrive in the order they were sent,
+ * a cancel request is a frame of its own that the thread reading the socket handles straight away, so it gets through while the engine is busy.
+ */
+class SocketChannel : public EngineChannel
+{
+public:
+											~SocketChannel() override;
+
+	static const size_t						maxFrameSize		= 1 << 30;
+
+	static SocketChannel *					connect(const std::string &host, int port, int channelNumber, const std::string &secret);	///< For the desktop, throws a runtime_error if no engine listens there
+	static SocketChannel *					listen(const std::string &address, int port, const std::string &secret, bool allowUnencrypted = false);	///< For the engine, waits until a desktop with the same secret connects. Throws a runtime_error for an address other than loopback, unless allowUnencrypted
+	static std::string						secretFromEnvironment();																	///< JASP_ENGINE_SECRET, throws a runtime_error if it isn't set
+
+	void									send(std::string &data)								override	{ sendFrame(Message, data); }
+	bool									receive(std::string &data, int timeout = 0)			override;
+	int										channelNumber()										override	{ return _channelNumber; }
+
+	void									requestCancel(int analysisId, int revision)			override;
+	bool									cancelRequested(int &analysisId, int &revision)	const	override;
+	using EngineChannel::cancelRequested;
+	void									clearCancel()										override;
+
+	void									discardSent()										override	{} ///< A restarted remote engine is a new connection, which never sees what was sent before
+
+	bool									connected()									const	override	{ return _connected; }
+	bool									sharesMemory()								const	override	{ return false; }
+	void									sendDataSet(const std::string &shipment)			override	{ sendFrame(DataSetShipment, shipment); }
+	void									setDataSetReceiver(std::function<void(const std::string &)> receiver) override { _dataSetReceiver = receiver; }
+
+	unsigned long							peerProcessId()								const				{ return _peerProcessId; }
+	void									close();
+
+private:
+	enum Kind : char { Challenge = 'N', Hello = 'H', Welcome = 'W', Message = 'M', Cancel = 'C', ClearCancel = 'X', DataSetShipment = 'D' };
+
+											SocketChannel(int channelNumber);
+
+	void									sendFrame(Kind kind, const std::string &payload);
+	bool									readFrame(Kind &kind, std::string &payload);
+	bool									readHandshake(Kind expected, std::string &payload, int timeout);
+	void									startReading();
+	void									readFrames();
+
+	boost::asio::io_service					_service;
+	boost::asio::ip::tcp::socket			_socket;
+	std::thread								_reader;
+	std::mutex								_sendMutex,
+											_queueMutex;
+	std::condition_variable					_queueChanged;
+	std::deque<std::pair<Kind, std::string>>	_queue;				///< Messages and shipments that came in, in order
+	std::atomic<bool>						_connected			{ false };
+	std::atomic<uint64_t>					_cancelRequest		{ 0 };	///< Packed like the one of IPCChannel, 0 means none
+	std::function<void(const std::string &)>	_dataSetReceiver;
+	int										_channelNumber;
+	unsigned long							_peerProcessId		= 0;
+};
+
+#endif // SOCKETCHANNEL_H
@@ -0,0 +1,279 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "tracing.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include "boost/nowide/fstream.hpp"
+
+#include "processinfo.h"
+#include "utils.h"
+
+using namespace std;
+using namespace boost;
+
+std::atomic<bool> Tracing::_enabled(false);
+
+struct TraceEvent
+{
+	const char	*name;
+	char		phase;
+	int64_t		start,
+				duration,
+				id;
+	int			analysisId,
+				revision;
+};
+
+struct TraceBuffer
+{
+	std::mutex			lock;			///< Only ever contended while flushing
+	vector<TraceEvent>	events;
+	uint64_t			written = 0,
+						flushed = 0;
+	int					threadId;
+};
+
+struct TraceState
+{
+	std::mutex				lock;		///< Guards everything below
+	vector<TraceBuffer*>	buffers;	///< Those of finished threads stay, what they recorded still has to be flushed
+	string					directory,
+							processName;
+	bool					processNameWritten	= false;
+	int64_t					lastFlush			= 0;
+	uint64_t				dropped				= 0;
+};
+
+static const size_t _traceBufferSize = 1 << 14;
+
+static TraceState & traceState()
+{
+	static TraceState * state = new TraceState(); //never deleted, threads might still record something while the process exits
+	return *state;
+}
+
+static TraceBuffer * traceBuffer()
+{
+	static thread_local TraceBuffer * buffer = NULL;
+
+	if (buffer == NULL)
+	{
+		TraceState &state = traceState();
+		std::lock_guard<std::mutex> lock(state.lock);
+
+		buffer				= new TraceBuffer();
+		buffer->threadId	= state.buffers.size();
+		buffer->events.resize(_traceBufferSize);
+
+		state.buffers.push_back(buffer);
+	}
+
+	return buffer;
+}
+
+void Tracing::enableFromEnvironment(const string &processName)
+{
+	const char * directory = std::getenv("JASP_TRACE");
+
+	if (directory != NULL && string(directory) != "")
+		enable(directory, processName);
+}
+
+void Tracing::enable(const string &directory, const string &processName)
+{
+	TraceState &state = traceState();
+
+	{
+		std::lock_guard<std::mutex> lock(state.lock);
+
+		system::error_code error;
+		filesystem::create_directories(Utils::osPath(directory), error);
+
+		state.directory				= directory;
+		state.processName			= processName;
+		state.processNameWritten	= false;
+	}
+
+	_enabled = true;
+}
+
+void Tracing::disable()
+{
+	flush();
+	_enabled = false;
+}
+
+int64_t Tracing::now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracing::span(const char *name, int64_t start, int64_t end, int analysisId, int revision, int64_t messageId)
+{
+	record('X', name, start, end - start, analysisId, revision, messageId);
+}
+
+void Tracing::flowStart(const char *name, int64_t flowId)
+{
+	record('s', name, now(), 0, -1, -1, flowId);
+}
+
+void Tracing::flowEnd(const char *name, int64_t flowId)
+{
+	record('f', name, now(), 0, -1, -1, flowId);
+}
+
+void Tracing::record(char phase, const char *name, int64_t start, int64_t duration, int analysisId, int revision, int64_t id)
+{
+	if (!enabled())
+		return;
+
+	TraceBuffer *buffer = traceBuffer();
+	std::lock_guard<std::mutex> lock(buffer->lock);
+
+	buffer->events[buffer->written % _traceBufferSize] = { name, phase, start, duration, id, analysisId, revision };
+	buffer->written++;
+}
+
+void Tracing::flush(int minimumIntervalMs)
+{
+	TraceState &state = traceState();
+	std::lock_guard<std::mutex> lock(state.lock);
+
+	int64_t flushTime = now();
+
+	if (state.directory == "" || (minimumIntervalMs > 0 && flushTime - state.lastFlush < int64_t(minimumIntervalMs) * 1000))
+		return;
+
+	state.lastFlush = flushTime;
+
+	unsigned long		pid = ProcessInfo::currentPID();
+	std::stringstream	out;
+
+	if (!state.processNameWritten)
+	{
+		out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":0,\"args\":{\"name\":\"" << state.processName << "\"}}\n";
+		state.processNameWritten = true;
+	}
+
+	vector<TraceEvent> events;
+
+	for (TraceBuffer *buffer : state.buffers)
+	{
+		events.clear();
+
+		{
+			std::lock_guard<std::mutex> bufferLock(buffer->lock);
+
+			if (buffer->written - buffer->flushed > _traceBufferSize)
+			{
+				state.dropped	+= buffer->written - buffer->flushed - _traceBufferSize;
+				buffer->flushed	 = buffer->written - _traceBufferSize;
+			}
+
+			for (uint64_t i = buffer->flushed; i < buffer->written; i++)
+				events.push_back(buffer->events[i % _traceBufferSize]);
+
+			buffer->flushed = buffer->written;
+		}
+
+		for (const TraceEvent &event : events)
+		{
+			out << "{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase << "\",\"ts\":" << event.start << ",\"pid\":" << pid << ",\"tid\":" << buffer->threadId;
+
+			if (event.phase == 'X')
+			{
+				out << ",\"cat\":\"jasp\",\"dur\":" << event.duration << ",\"args\":{";
+
+				const char * separator = "";
+				if (event.analysisId != -1)	{ out << separator << "\"analysis\":"	<< event.analysisId;	separator = ","; }
+				if (event.revision != -1)	{ out << separator << "\"revision\":"	<< event.revision;		separator = ","; }
+				if (event.id != -1)			{ out << separator << "\"message\":\""	<< std::hex << event.id << std::dec << "\""; }
+
+				out << "}";
+			}
+			else // a flow, the end binds to the span around it
+				out << ",\"cat\":\"ipc\",\"id\":\"" << std::hex << event.id << std::dec << "\"" << (event.phase == 'f' ? ",\"bp\":\"e\"" : "");
+
+			out << "}\n";
+		}
+	}
+
+	if (out.tellp() == 0)
+		return;
+
+	nowide::ofstream file((state.directory + "/" + std::to_string(pid) + ".trace").c_str(), ios_base::out | ios_base::app);
+	file << out.str();
+
+	if (state.dropped > 0)
+	{
+		std::cout << "Tracing dropped " << state.dropped << " spans, flush more often." << std::endl;
+		state.dropped = 0;
+	}
+}
+
+bool Tracing::merge(const string &outputFile)
+{
+	flush();
+
+	string directory;
+	{
+		std::lock_guard<std::mutex> lock(traceState().lock);
+		directory = traceState().directory;
+	}
+
+	if (directory == "")
+		return false;
+
+	nowide::ofstream out((outputFile != "" ? outputFile : directory + "/trace.json").c_str(), ios_base::out | ios_base::trunc);
+
+	if (!out.is_open())
+		return false;
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	system::error_code	error;
+	bool				first = true;
+
+	for (filesystem::directory_iterator file(Utils::osPath(directory), error), end; !error && file != end; file.increment(error))
+	{
+		if (file->path().extension() != ".trace")
+			continue;
+
+		nowide::ifstream in((directory + "/" + file->path().filename().string()).c_str());
+		string line;
+
+		while (std::getline(in, line))
+			if (line != "")
+			{
+				out << (first ? "\n" : ",\n") << line;
+				first = false;
+			}
+	}
+
+	out << "\n]}\n";
+
+	return true;
+}
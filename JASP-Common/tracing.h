@@ -0,0 +1,79 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/* Tracing follows a request through the desktop and the engines, unlike the JASPTIMER_* macros it is compiled in always and switched on at runtime.
+ * Setting the environment variable JASP_TRACE to a directory turns it on for JASP and the engines it starts (they inherit the environment), Tracing::enable does the same from code.
+ *
+ * Every thread records its spans in its own ring buffer, so recording is cheap and never waits for another thread; if a buffer isn't flushed in time the oldest spans are overwritten.
+ * A span can carry the analysis id and revision it worked for, and the IPCChannel adds a flow from every send to the matching receive, so a message can be followed from one process to the other.
+ * Each process appends its spans to <dir>/<pid>.trace when it flushes and Tracing::merge combines those into one Chrome trace-event file that chrome://tracing or Perfetto can open.
+ * All processes take their timestamps from the same monotonic clock, so they line up without any correction.
+ *
+ * Names have to be string literals (or live at least as long as the process), only the pointer is recorded.
+ */
+class Tracing
+{
+public:
+	static void		enableFromEnvironment(const std::string &processName);
+	static void		enable(const std::string &directory, const std::string &processName);
+	static void		disable();
+	static bool		enabled() { return _enabled.load(std::memory_order_relaxed); }
+
+	static int64_t	now(); ///< Microseconds on the clock shared by all processes
+
+	static void		span(		const char *name, int64_t start, int64_t end, int analysisId = -1, int revision = -1, int64_t messageId = -1);
+	static void		flowStart(	const char *name, int64_t flowId);	///< Call it inside the span that sends a message,
+	static void		flowEnd(	const char *name, int64_t flowId);	///< and this one inside the span that receives it.
+
+	static void		flush(int minimumIntervalMs = 0);								///< Appends everything recorded since the last flush to the file of this process, unless it flushed less than minimumIntervalMs ago.
+	static bool		merge(const std::string &outputFile = "");						///< Flushes and combines the files of all processes in the directory, by default into <dir>/trace.json.
+
+private:
+	static void		record(char phase, const char *name, int64_t start, int64_t duration, int analysisId, int revision, int64_t id);
+
+	static std::atomic<bool>	_enabled;
+};
+
+///Records a span from its construction until it goes out of scope.
+class TraceSpan
+{
+public:
+	TraceSpan(const char *name, int analysisId = -1, int revision = -1) : _name(name), _analysisId(analysisId), _revision(revision), _start(Tracing::enabled() ? Tracing::now() : -1) {}
+	~TraceSpan() { if (_start != -1 && Tracing::enabled()) Tracing::span(_name, _start, Tracing::now(), _analysisId, _revision, _messageId); }
+
+	void setAnalysis(int analysisId, int revision)	{ _analysisId = analysisId; _revision = revision;	}
+	void setMessageId(int64_t messageId)			{ _messageId = messageId;							}
+
+private:
+	const char	*_name;
+	int			_analysisId,
+				_revision;
+	int64_t		_messageId = -1,
+				_start;
+};
+
+#define JASPTRACE_SCOPE(			NAME )						TraceSpan _jaspTraceSpan( NAME )
+#define JASPTRACE_SCOPE_ANALYSIS(	NAME, ID, REVISION )		TraceSpan _jaspTraceSpan( NAME, ID, REVISION )
+
+#endif // TRACING_H
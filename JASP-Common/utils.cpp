@@ -39,6 +39,9 @@ const char* Utils::getFileTypeString(const Utils::FileType &fileType) {
         case Utils::csv: return "csv";
 		case Utils::txt: return "txt";
 		case Utils::sav: return "sav";
+		case Utils::zsav: return "zsav";
+		case Utils::arrow: return "arrow";
+		case Utils::feather: return "feather";
 		case Utils::ods: return "ods";
 		case Utils::jasp: return "jasp";
         case Utils::html: return "html";
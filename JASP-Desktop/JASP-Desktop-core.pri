@@ -0,0 +1,134 @@
+# The part of JASP-Desktop that doesn't need a user interface: loading and saving data and projects, the analyses and the engines.
+# JASP-Desktop.pri includes it, JASPBatch builds only this, so it only needs QtCore and QtXml (for .ods).
+
+SOURCES += \
+    $$PWD/analyses.cpp \
+    $$PWD/appdirs.cpp \
+    $$PWD/computedcolumnsmodel.cpp \
+    $$PWD/datasetloader.cpp \
+    $$PWD/enginerepresentation.cpp \
+    $$PWD/enginesync.cpp \
+    $$PWD/exporters/dataexporter.cpp \
+    $$PWD/exporters/exporter.cpp \
+    $$PWD/exporters/jaspexporter.cpp \
+    $$PWD/exporters/ziparchivewriter.cpp \
+    $$PWD/importers/arrow/arrowfilereader.cpp \
+    $$PWD/importers/arrow/arrowimportcolumn.cpp \
+    $$PWD/importers/arrow/flatbuffer.cpp \
+    $$PWD/importers/arrowimporter.cpp \
+    $$PWD/importers/codepageconvert.cpp \
+    $$PWD/importers/convertedstringcontainer.cpp \
+    $$PWD/importers/csv.cpp \
+    $$PWD/importers/csvimportcolumn.cpp \
+    $$PWD/importers/csvimporter.cpp \
+    $$PWD/importers/importcolumn.cpp \
+    $$PWD/importers/importdataset.cpp \
+    $$PWD/importers/importer.cpp \
+    $$PWD/importers/jaspimporter.cpp \
+    $$PWD/importers/ods/odsimportcolumn.cpp \
+    $$PWD/importers/ods/odsimportdataset.cpp \
+    $$PWD/importers/ods/odssheetcell.cpp \
+    $$PWD/importers/ods/odstypes.cpp \
+    $$PWD/importers/ods/odsxmlcontentshandler.cpp \
+    $$PWD/importers/ods/odsxmlhandler.cpp \
+    $$PWD/importers/ods/odsxmlmanifesthandler.cpp \
+    $$PWD/importers/odsimporter.cpp \
+    $$PWD/importers/spss/characterencodingrecord.cpp \
+    $$PWD/importers/spss/datainforecord.cpp \
+    $$PWD/importers/spss/datarecords.cpp \
+    $$PWD/importers/spss/dictionaryterminationrecord.cpp \
+    $$PWD/importers/spss/documentrecord.cpp \
+    $$PWD/importers/spss/extnumbercasesrecord.cpp \
+    $$PWD/importers/spss/fileheaderrecord.cpp \
+    $$PWD/importers/spss/floatinforecord.cpp \
+    $$PWD/importers/spss/integerinforecord.cpp \
+    $$PWD/importers/spss/longvarnamesrecord.cpp \
+    $$PWD/importers/spss/miscinforecord.cpp \
+    $$PWD/importers/spss/missingvaluechecker.cpp \
+    $$PWD/importers/spss/numericconvertor.cpp \
+    $$PWD/importers/spss/readablerecord.cpp \
+    $$PWD/importers/spss/spssimportcolumn.cpp \
+    $$PWD/importers/spss/spssimportdataset.cpp \
+    $$PWD/importers/spss/stringutils.cpp \
+    $$PWD/importers/spss/valuelabelvarsrecord.cpp \
+    $$PWD/importers/spss/vardisplayparamrecord.cpp \
+    $$PWD/importers/spss/variablerecord.cpp \
+    $$PWD/importers/spss/verylongstringrecord.cpp \
+    $$PWD/importers/spss/zlibdatablocks.cpp \
+    $$PWD/importers/spssimporter.cpp \
+    $$PWD/jsonutilities.cpp \
+    $$PWD/qutils.cpp \
+    $$PWD/resultscache.cpp \
+    $$PWD/runscheduler.cpp \
+    $$PWD/simplecrypt.cpp \
+    $$PWD/variablespage/labelfiltergenerator.cpp
+
+HEADERS += \
+    $$PWD/analyses.h \
+    $$PWD/appdirs.h \
+    $$PWD/computedcolumnsmodel.h \
+    $$PWD/datasetloader.h \
+    $$PWD/enginerepresentation.h \
+    $$PWD/enginesync.h \
+    $$PWD/exporters/dataexporter.h \
+    $$PWD/exporters/exporter.h \
+    $$PWD/exporters/jaspexporter.h \
+    $$PWD/exporters/ziparchivewriter.h \
+    $$PWD/importers/arrow/arrowfilereader.h \
+    $$PWD/importers/arrow/arrowformat.h \
+    $$PWD/importers/arrow/arrowimportcolumn.h \
+    $$PWD/importers/arrow/flatbuffer.h \
+    $$PWD/importers/arrowimporter.h \
+    $$PWD/importers/codepageconvert.h \
+    $$PWD/importers/convertedstringcontainer.h \
+    $$PWD/importers/csv.h \
+    $$PWD/importers/csvimportcolumn.h \
+    $$PWD/importers/csvimporter.h \
+    $$PWD/importers/importcolumn.h \
+    $$PWD/importers/importdataset.h \
+    $$PWD/importers/importer.h \
+    $$PWD/importers/importerutils.h \
+    $$PWD/importers/jaspimporter.h \
+    $$PWD/importers/ods/odsimportcolumn.h \
+    $$PWD/importers/ods/odsimportdataset.h \
+    $$PWD/importers/ods/odssheetcell.h \
+    $$PWD/importers/ods/odstypes.h \
+    $$PWD/importers/ods/odsxmlcontentshandler.h \
+    $$PWD/importers/ods/odsxmlhandler.h \
+    $$PWD/importers/ods/odsxmlmanifesthandler.h \
+    $$PWD/importers/odsimporter.h \
+    $$PWD/importers/spss/characterencodingrecord.h \
+    $$PWD/importers/spss/datainforecord.h \
+    $$PWD/importers/spss/datarecords.h \
+    $$PWD/importers/spss/dictionaryterminationrecord.h \
+    $$PWD/importers/spss/documentrecord.h \
+    $$PWD/importers/spss/extnumbercasesrecord.h \
+    $$PWD/importers/spss/fileheaderrecord.h \
+    $$PWD/importers/spss/floatinforecord.h \
+    $$PWD/importers/spss/integerinforecord.h \
+    $$PWD/importers/spss/longvarnamesrecord.h \
+    $$PWD/importers/spss/measures.h \
+    $$PWD/importers/spss/miscinforecord.h \
+    $$PWD/importers/spss/missingvaluechecker.h \
+    $$PWD/importers/spss/numericconverter.h \
+    $$PWD/importers/spss/readablerecord.h \
+    $$PWD/importers/spss/spssformattype.h \
+    $$PWD/importers/spss/spssimportcolumn.h \
+    $$PWD/importers/spss/spssimportdataset.h \
+    $$PWD/importers/spss/spssstream.h \
+    $$PWD/importers/spss/stringutils.h \
+    $$PWD/importers/spss/systemfileformat.h \
+    $$PWD/importers/spss/valuelabelvarsrecord.h \
+    $$PWD/importers/spss/vardisplayparamrecord.h \
+    $$PWD/importers/spss/variablerecord.h \
+    $$PWD/importers/spss/verylongstringrecord.h \
+    $$PWD/importers/spss/zlibdatablocks.h \
+    $$PWD/importers/spssimporter.h \
+    $$PWD/jsonutilities.h \
+    $$PWD/qutils.h \
+    $$PWD/resultscache.h \
+    $$PWD/rscriptstore.h \
+    $$PWD/runscheduler.h \
+    $$PWD/simplecrypt.h \
+    $$PWD/simplecryptkey.h \
+    $$PWD/variablespage/labelfiltergenerator.h
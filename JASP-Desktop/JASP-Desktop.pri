@@ -1,11 +1,11 @@
    macx:ICON = $$PWD/icon.icns
 windows:RC_FILE = $$PWD/icon.rc
 
+include($$PWD/JASP-Desktop-core.pri)
+
 SOURCES += \
     $$PWD/aboutdialog.cpp \
-    $$PWD/analyses.cpp \
     $$PWD/analysisforms/analysisform.cpp \
-    $$PWD/appdirs.cpp \
     $$PWD/application.cpp \
     $$PWD/asyncloader.cpp \
     $$PWD/availablefields.cpp \
@@ -23,53 +23,11 @@ SOURCES += \
     $$PWD/backstage/verticaltabbar.cpp \
     $$PWD/backstage/verticaltabwidget.cpp \
     $$PWD/backstagewidget.cpp \
-    $$PWD/datasetloader.cpp \
+    $$PWD/columnindex.cpp \
     $$PWD/datasettablemodel.cpp \
-    $$PWD/enginesync.cpp \
-    $$PWD/exporters/dataexporter.cpp \
-    $$PWD/exporters/exporter.cpp \
-    $$PWD/exporters/jaspexporter.cpp \
+    $$PWD/exporters/arrowexporter.cpp \
     $$PWD/exporters/resultexporter.cpp \
     $$PWD/fileevent.cpp \
-    $$PWD/importers/codepageconvert.cpp \
-    $$PWD/importers/convertedstringcontainer.cpp \
-    $$PWD/importers/csv.cpp \
-    $$PWD/importers/csvimportcolumn.cpp \
-    $$PWD/importers/csvimporter.cpp \
-    $$PWD/importers/importcolumn.cpp \
-    $$PWD/importers/importdataset.cpp \
-    $$PWD/importers/importer.cpp \
-    $$PWD/importers/jaspimporter.cpp \
-    $$PWD/importers/ods/odsimportcolumn.cpp \
-    $$PWD/importers/ods/odsimportdataset.cpp \
-    $$PWD/importers/ods/odssheetcell.cpp \
-    $$PWD/importers/ods/odstypes.cpp \
-    $$PWD/importers/ods/odsxmlcontentshandler.cpp \
-    $$PWD/importers/ods/odsxmlhandler.cpp \
-    $$PWD/importers/ods/odsxmlmanifesthandler.cpp \
-    $$PWD/importers/odsimporter.cpp \
-    $$PWD/importers/spss/characterencodingrecord.cpp \
-    $$PWD/importers/spss/datainforecord.cpp \
-    $$PWD/importers/spss/datarecords.cpp \
-    $$PWD/importers/spss/dictionaryterminationrecord.cpp \
-    $$PWD/importers/spss/documentrecord.cpp \
-    $$PWD/importers/spss/extnumbercasesrecord.cpp \
-    $$PWD/importers/spss/fileheaderrecord.cpp \
-    $$PWD/importers/spss/floatinforecord.cpp \
-    $$PWD/importers/spss/integerinforecord.cpp \
-    $$PWD/importers/spss/longvarnamesrecord.cpp \
-    $$PWD/importers/spss/miscinforecord.cpp \
-    $$PWD/importers/spss/missingvaluechecker.cpp \
-    $$PWD/importers/spss/numericconvertor.cpp \
-    $$PWD/importers/spss/readablerecord.cpp \
-    $$PWD/importers/spss/spssimportcolumn.cpp \
-    $$PWD/importers/spss/spssimportdataset.cpp \
-    $$PWD/importers/spss/stringutils.cpp \
-    $$PWD/importers/spss/valuelabelvarsrecord.cpp \
-    $$PWD/importers/spss/vardisplayparamrecord.cpp \
-    $$PWD/importers/spss/variablerecord.cpp \
-    $$PWD/importers/spss/verylongstringrecord.cpp \
-    $$PWD/importers/spssimporter.cpp \
     $$PWD/main.cpp \
     $$PWD/mainwindow.cpp \
     $$PWD/module.cpp \
@@ -82,10 +40,8 @@ SOURCES += \
     $$PWD/onlineusernodeosf.cpp \
     $$PWD/osfnam.cpp \
     $$PWD/preferencesdialog.cpp \
-    $$PWD/qutils.cpp \
     $$PWD/ribbons/ribbonhome.cpp \
     $$PWD/ribbons/ribbonwidget.cpp \
-    $$PWD/simplecrypt.cpp \
     $$PWD/term.cpp \
     $$PWD/terms.cpp \
     $$PWD/variablespage/levelstablemodel.cpp \
@@ -133,19 +89,16 @@ SOURCES += \
     $$PWD/widgets/toolbutton.cpp \
     $$PWD/widgets/customwebengineview.cpp \
     $$PWD/resultsjsinterface.cpp \
+    $$PWD/resultsurlschemehandler.cpp \
     $$PWD/customwebenginepage.cpp \
     $$PWD/asyncloaderthread.cpp \
     $$PWD/aboutdialogjsinterface.cpp \
-    $$PWD/variablespage/labelfiltergenerator.cpp \
     $$PWD/columnsmodel.cpp \
     $$PWD/datasetview.cpp \
-    $$PWD/jsonutilities.cpp \
     $$PWD/backstage/backstagedatalibrary.cpp \
     $$PWD/backstage/datalibrarylistmodel.cpp \
     $$PWD/backstage/datalibrarybreadcrumbsmodel.cpp \
     $$PWD/settings.cpp \
-    $$PWD/enginerepresentation.cpp \
-    $$PWD/computedcolumnsmodel.cpp \
     $$PWD/filtermodel.cpp \
     $$PWD/backstage/backstagerecentfiles.cpp \
     $$PWD/backstage/recentfileslistmodel.cpp \
@@ -164,9 +117,7 @@ SOURCES += \
 
 HEADERS  += \
     $$PWD/aboutdialog.h \
-    $$PWD/analyses.h \
     $$PWD/analysisforms/analysisform.h \
-    $$PWD/appdirs.h \
     $$PWD/application.h \
     $$PWD/asyncloader.h \
     $$PWD/availablefields.h \
@@ -187,59 +138,12 @@ HEADERS  += \
     $$PWD/backstagewidget.h \
     $$PWD/bound.h \
     $$PWD/customhoverdelegate.h \
-    $$PWD/datasetloader.h \
+    $$PWD/columnindex.h \
     $$PWD/datasettablemodel.h \
-    $$PWD/enginesync.h \
-    $$PWD/exporters/dataexporter.h \
-    $$PWD/exporters/exporter.h \
-    $$PWD/exporters/jaspexporter.h \
+    $$PWD/exporters/arrowexporter.h \
     $$PWD/exporters/resultexporter.h \
     $$PWD/fileevent.h \
-    $$PWD/importers/codepageconvert.h \
-    $$PWD/importers/convertedstringcontainer.h \
-    $$PWD/importers/csv.h \
-    $$PWD/importers/csvimportcolumn.h \
-    $$PWD/importers/csvimporter.h \
-    $$PWD/importers/importcolumn.h \
-    $$PWD/importers/importdataset.h \
-    $$PWD/importers/importer.h \
-    $$PWD/importers/importerutils.h \
-    $$PWD/importers/jaspimporter.h \
-    $$PWD/importers/ods/odsimportcolumn.h \
-    $$PWD/importers/ods/odsimportdataset.h \
-    $$PWD/importers/ods/odssheetcell.h \
-    $$PWD/importers/ods/odstypes.h \
-    $$PWD/importers/ods/odsxmlcontentshandler.h \
-    $$PWD/importers/ods/odsxmlhandler.h \
-    $$PWD/importers/ods/odsxmlmanifesthandler.h \
-    $$PWD/importers/odsimporter.h \
-    $$PWD/importers/spss/characterencodingrecord.h \
     $$PWD/importers/spss/cpconverter.h \
-    $$PWD/importers/spss/datainforecord.h \
-    $$PWD/importers/spss/datarecords.h \
-    $$PWD/importers/spss/dictionaryterminationrecord.h \
-    $$PWD/importers/spss/documentrecord.h \
-    $$PWD/importers/spss/extnumbercasesrecord.h \
-    $$PWD/importers/spss/fileheaderrecord.h \
-    $$PWD/importers/spss/floatinforecord.h \
-    $$PWD/importers/spss/integerinforecord.h \
-    $$PWD/importers/spss/longvarnamesrecord.h \
-    $$PWD/importers/spss/measures.h \
-    $$PWD/importers/spss/miscinforecord.h \
-    $$PWD/importers/spss/missingvaluechecker.h \
-    $$PWD/importers/spss/numericconverter.h \
-    $$PWD/importers/spss/readablerecord.h \
-    $$PWD/importers/spss/spssformattype.h \
-    $$PWD/importers/spss/spssimportcolumn.h \
-    $$PWD/importers/spss/spssimportdataset.h \
-    $$PWD/importers/spss/spssstream.h \
-    $$PWD/importers/spss/stringutils.h \
-    $$PWD/importers/spss/systemfileformat.h \
-    $$PWD/importers/spss/valuelabelvarsrecord.h \
-    $$PWD/importers/spss/vardisplayparamrecord.h \
-    $$PWD/importers/spss/variablerecord.h \
-    $$PWD/importers/spss/verylongstringrecord.h \
-    $$PWD/importers/spssimporter.h \
     $$PWD/mainwindow.h \
     $$PWD/module.h \
     $$PWD/onlinedataconnection.h \
@@ -251,11 +155,8 @@ HEADERS  += \
     $$PWD/onlineusernodeosf.h \
     $$PWD/osfnam.h \
     $$PWD/preferencesdialog.h \
-    $$PWD/qutils.h \
     $$PWD/ribbons/ribbonhome.h \
     $$PWD/ribbons/ribbonwidget.h \
-    $$PWD/simplecrypt.h \
-    $$PWD/simplecryptkey.h \
     $$PWD/term.h \
     $$PWD/terms.h \
     $$PWD/variableinfo.h \
@@ -309,20 +210,16 @@ HEADERS  += \
     $$PWD/widgets/toolbutton.h \
     $$PWD/widgets/customwebengineview.h \
     $$PWD/resultsjsinterface.h \
+    $$PWD/resultsurlschemehandler.h \
     $$PWD/customwebenginepage.h \
     $$PWD/asyncloaderthread.h \
     $$PWD/aboutdialogjsinterface.h \
-    $$PWD/variablespage/labelfiltergenerator.h \
     $$PWD/columnsmodel.h \
     $$PWD/datasetview.h \
-    $$PWD/jsonutilities.h \
     $$PWD/backstage/backstagedatalibrary.h \
     $$PWD/backstage/datalibrarylistmodel.h \
     $$PWD/backstage/datalibrarybreadcrumbsmodel.h \
     $$PWD/settings.h \
-    $$PWD/enginerepresentation.h \
-    $$PWD/rscriptstore.h \
-    $$PWD/computedcolumnsmodel.h \
     $$PWD/filtermodel.h \
     $$PWD/backstage/backstagerecentfiles.h \
     $$PWD/backstage/recentfileslistmodel.h \
@@ -45,10 +45,11 @@ windows:CONFIG(DebugBuild) {
 }
 
    macx:LIBS += -lboost_filesystem-clang-mt-1_64 -lboost_system-clang-mt-1_64 -larchive -lz
-windows:LIBS += -lole32 -loleaut32
+windows:LIBS += -lole32 -loleaut32 -lws2_32 -lmswsock -lbcrypt
+windows:INCLUDEPATH += $$[QT_INSTALL_HEADERS]/QtZlib #Qt comes with zlib, used for .zsav
 
 linux {
-    LIBS += -larchive
+    LIBS += -larchive -lz
     exists(/app/lib/*)	{ LIBS += -L/app/lib }
     LIBS += -lboost_filesystem -lboost_system -lrt
 }
@@ -18,7 +18,7 @@
 
 #include "appdirs.h"
 
-#include <QApplication>
+#include <QCoreApplication>
 #include <QDir>
 #include <QDebug>
 
@@ -35,9 +35,9 @@ using namespace std;
 const QString AppDirs::examples()
 {
 #ifdef __APPLE__
-    static QString dir = QApplication::applicationDirPath() + "/../Resources/Data Sets";
+    static QString dir = QCoreApplication::applicationDirPath() + "/../Resources/Data Sets";
 #else
-    static QString dir = QApplication::applicationDirPath() + QDir::separator() + "Resources/Data Sets";
+    static QString dir = QCoreApplication::applicationDirPath() + QDir::separator() + "Resources/Data Sets";
 #endif
 
 	return dir;
@@ -46,9 +46,9 @@ const QString AppDirs::examples()
 const QString AppDirs::help()
 {
 #ifdef __APPLE__
-	static QString dir = QApplication::applicationDirPath() + "/../Resources/Help";
+	static QString dir = QCoreApplication::applicationDirPath() + "/../Resources/Help";
 #else
-	static QString dir = QApplication::applicationDirPath() + QDir::separator() + "Resources/Help";
+	static QString dir = QCoreApplication::applicationDirPath() + QDir::separator() + "Resources/Help";
 #endif
 
 	return dir;
@@ -27,6 +27,7 @@
 
 #include "qutils.h"
 #include "utils.h"
+#include "sharedmemory.h"
 #include "onlinedatamanager.h"
 #include <QDebug>
 
@@ -35,8 +36,11 @@ using namespace std;
 AsyncLoader::AsyncLoader(QObject *parent) :
 	QObject(parent)
 { 
+	qRegisterMetaType<DataSetPackage *>();
+
 	connect(this, SIGNAL(beginLoad(FileEvent*, DataSetPackage*)), this, SLOT(loadTask(FileEvent*, DataSetPackage*)));
 	connect(this, SIGNAL(beginSave(FileEvent*, DataSetPackage*)), this, SLOT(saveTask(FileEvent*, DataSetPackage*)));
+	connect(this, SIGNAL(beginResetEmptyValues(DataSetPackage*, QStringList, bool)), this, SLOT(resetEmptyValuesTask(DataSetPackage*, QStringList, bool)));
 }
 
 void AsyncLoader::io(FileEvent *event, DataSetPackage *package)
@@ -78,6 +82,11 @@ void AsyncLoader::io(FileEvent *event, DataSetPackage *package)
 	}
 }
 
+void AsyncLoader::resetEmptyValues(DataSetPackage *package, QStringList changedColumns, bool memoryEnlarged)
+{
+	emit beginResetEmptyValues(package, changedColumns, memoryEnlarged);
+}
+
 void AsyncLoader::free(DataSet *dataSet)
 {
 	_loader.freeDataSet(dataSet);
@@ -151,6 +160,38 @@ void AsyncLoader::saveTask(FileEvent *event, DataSetPackage *package)
 	}
 }
 
+void AsyncLoader::resetEmptyValuesTask(DataSetPackage *package, QStringList changedColumns, bool memoryEnlarged)
+{
+	vector<string>	colChanged;
+	QString			error;
+	bool			needsMemory = false;
+
+	for (const QString &col : changedColumns)
+		colChanged.push_back(fq(col));
+
+	try
+	{
+		// Meanwhile the data view shows nothing and the engines hold off reading the data, just like when a data file is being synched.
+		DataSetChange change(package->dataSet());
+
+		package->dataSet()->resetEmptyValues(package->emptyValuesMap(), colChanged);
+	}
+	catch (boost::interprocess::bad_alloc &)
+	{
+		if (memoryEnlarged)	error = "Out of memory: this data set is too large for your computer's available memory";
+		else				needsMemory = true;
+	}
+	catch (exception &e)	{	error = tq(e.what());	}
+	catch (...)				{	error = "Resetting the missing values failed for an unknown reason";	} // This is a slot, nothing may escape it
+
+	changedColumns.clear();
+	for (const string &col : colChanged)
+		changedColumns.append(tq(col));
+
+	if (needsMemory)	emit emptyValuesResetNeedsMemory(package, changedColumns);
+	else				emit emptyValuesReset(package, changedColumns, error);
+}
+
 void AsyncLoader::progressHandler(string status, int progress)
 {
 	emit this->progress(QString::fromUtf8(status.c_str(), status.length()), progress);
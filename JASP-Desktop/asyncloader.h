@@ -22,6 +22,7 @@
 #include <QObject>
 #include <QMutex>
 #include <QTimer>
+#include <QStringList>
 
 #include "dataset.h"
 #include "datasetloader.h"
@@ -38,6 +39,7 @@ public:
 	explicit AsyncLoader(QObject *parent = 0);
 
 	void io(FileEvent *event, DataSetPackage *package);
+	void resetEmptyValues(DataSetPackage *package, QStringList changedColumns = QStringList(), bool memoryEnlarged = false); ///< changedColumns and memoryEnlarged are for running it again after emptyValuesResetNeedsMemory
 	void free(DataSet *dataSet);
 	void setOnlineDataManager(OnlineDataManager *odm);
 
@@ -46,10 +48,14 @@ signals:
 	void beginSave(FileEvent*, DataSetPackage*);
 	void progress(const QString &status, int progress);
 	void beginFileUpload(QString nodePath, QString sourcePath);
+	void beginResetEmptyValues(DataSetPackage*, QStringList, bool);
+	void emptyValuesResetNeedsMemory(DataSetPackage *package, QStringList changedColumns);	///< The memory can only be enlarged on the GUI thread, the columns that weren't reset yet are as they were
+	void emptyValuesReset(DataSetPackage *package, QStringList changedColumns, QString error);
 
 private slots:
 	void loadTask(FileEvent *event, DataSetPackage *package);
 	void saveTask(FileEvent *event, DataSetPackage *package);
+	void resetEmptyValuesTask(DataSetPackage *package, QStringList changedColumns, bool memoryEnlarged);
 	void loadPackage(QString id);
 	void uploadFileFinished(QString id);
 	//void errorFlagged(QString msg, QString id);
@@ -68,4 +74,6 @@ private:
 	
 };
 
+Q_DECLARE_METATYPE(DataSetPackage *)
+
 #endif // ASYNCLOADER_H
@@ -46,9 +46,9 @@ FileEvent *BackstageComputer::browseOpen(const QString &path)
 	else
 		browsePath = path;
 
-	QString filter = "Data Sets (*.jasp *.csv *.txt *.sav *.ods)";
+	QString filter = "Data Sets (*.jasp *.csv *.txt *.sav *.zsav *.ods *.arrow *.feather)";
 	if (_mode == FileEvent::FileSyncData)
-		filter = "Data Sets (*.csv *.txt *.sav *.ods)";
+		filter = "Data Sets (*.csv *.txt *.sav *.zsav *.ods *.arrow *.feather)";
 	QString finalPath = QFileDialog::getOpenFileName(this, "Open", browsePath, filter);
 
 	FileEvent *event = new FileEvent(this, _mode);
@@ -93,14 +93,18 @@ FileEvent *BackstageComputer::browseSave(const QString &path, FileEvent::FileMod
 		break;
 
 	case FileEvent::FileGenerateData:
-	case FileEvent::FileExportData:
 		caption	= "Export Data as CSV";
 		filter	= "CSV Files (*.csv *.txt)";
 		break;
 
+	case FileEvent::FileExportData:
+		caption	= "Export Data";
+		filter	= "CSV Files (*.csv *.txt);;Arrow Files (*.arrow *.feather)";
+		break;
+
 	case FileEvent::FileSyncData:
 		caption = "Sync Data";
-		filter = "Data Files (*.csv *.txt *.sav *.ods)";
+		filter = "Data Files (*.csv *.txt *.sav *.zsav *.ods *.arrow *.feather)";
 		break;
 
 	default:
@@ -311,11 +311,11 @@ void FSBMOSF::gotFilesAndFolders()
 					entryType = FSEntry::Folder;
 				else if (nodeData.name.endsWith(".jasp", Qt::CaseInsensitive))
 					entryType = FSEntry::JASP;
-				else if (nodeData.name.endsWith(".csv", Qt::CaseInsensitive) || nodeData.name.endsWith(".txt", Qt::CaseInsensitive))
+				else if (nodeData.name.endsWith(".csv", Qt::CaseInsensitive) || nodeData.name.endsWith(".txt", Qt::CaseInsensitive) || nodeData.name.endsWith(".arrow", Qt::CaseInsensitive) || nodeData.name.endsWith(".feather", Qt::CaseInsensitive))
 					entryType = FSEntry::CSV;
 				else if (nodeData.name.endsWith(".html", Qt::CaseInsensitive) || nodeData.name.endsWith(".pdf", Qt::CaseInsensitive))
 					entryType = FSEntry::Other;
-				else if (nodeData.name.endsWith(".spss", Qt::CaseInsensitive) || nodeData.name.endsWith(".sav", Qt::CaseInsensitive))
+				else if (nodeData.name.endsWith(".spss", Qt::CaseInsensitive) || nodeData.name.endsWith(".sav", Qt::CaseInsensitive) || nodeData.name.endsWith(".zsav", Qt::CaseInsensitive))
 					entryType = FSEntry::SPSS;
 				else
 					continue;
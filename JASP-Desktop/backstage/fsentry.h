@@ -41,6 +41,8 @@ public:
 		switch (basefiletype)
 		{
 		 case Utils::FileType::csv:
+		 case Utils::FileType::arrow:
+		 case Utils::FileType::feather:
 			entrytype = FSEntry::CSV;
 			break;
 			
@@ -49,6 +51,7 @@ public:
 			break;
 			
 		case Utils::FileType::sav:
+		case Utils::FileType::zsav:
 			entrytype = FSEntry::SPSS;
 			break;
 			
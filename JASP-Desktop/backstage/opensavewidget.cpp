@@ -220,7 +220,7 @@ void OpenSaveWidget::sync()
 			return;
 
 		QString caption = "Find Data File";
-		QString filter = "Data File (*.csv *.txt *.sav *.ods)";
+		QString filter = "Data File (*.csv *.txt *.sav *.zsav *.ods *.arrow *.feather)";
 		path = QFileDialog::getOpenFileName(this, caption, "", filter);
 	}
 
@@ -0,0 +1,259 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "columnindex.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "parallel.h"
+
+using namespace std;
+
+// As Column shows a scale value in the data view.
+static string displayed(double value)
+{
+	stringstream shown;
+	shown << (value == 0 ? 0 : value);
+	return shown.str();
+}
+
+// Doubles as unsigned integers that sort the same way: flip the sign bit of positive numbers and all bits of negative ones.
+static uint64_t sortableKey(double value)
+{
+	if (value == 0)
+		value = 0; // -0 is 0
+
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	return bits & 0x8000000000000000ull ? ~bits : bits | 0x8000000000000000ull;
+}
+
+static double valueOfKey(uint64_t key)
+{
+	uint64_t bits = key & 0x8000000000000000ull ? key & ~0x8000000000000000ull : ~key;
+
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+// Least significant digit first, 16 bits at a time. A pass where every key has the same digit doesn't move anything and is skipped.
+static void radixSort(vector<uint64_t> &keys, vector<int> &rows)
+{
+	vector<uint64_t>	keysTo(keys.size());
+	vector<int>			rowsTo(rows.size());
+	vector<size_t>		start(1 << 16);
+
+	for (int shift = 0; shift < 64; shift += 16)
+	{
+		fill(start.begin(), start.end(), 0);
+
+		for (uint64_t key : keys)
+			start[(key >> shift) & 0xffff]++;
+
+		if (*max_element(start.begin(), start.end()) == keys.size())
+			continue;
+
+		size_t position = 0;
+		for (size_t &count : start)
+		{
+			size_t here	= count;
+			count		= position;
+			position	+= here;
+		}
+
+		for (size_t i = 0; i < keys.size(); i++)
+		{
+			size_t to	= start[(keys[i] >> shift) & 0xffff]++;
+			keysTo[to]	= keys[i];
+			rowsTo[to]	= rows[i];
+		}
+
+		keys.swap(keysTo);
+		rows.swap(rowsTo);
+	}
+}
+
+ColumnIndex::ColumnIndex(Column &column) : _columnId(column.id()), _revision(column.revision()), _isScale(column.columnType() == Column::ColumnTypeScale)
+{
+	_rank.resize(column.rowCount());
+
+	if (_isScale)	sortScale(column);
+	else			sortLevels(column);
+}
+
+void ColumnIndex::sortScale(Column &column)
+{
+	vector<uint64_t>	keys;
+	vector<int>			rows,
+						missingRows;
+	int					row = 0;
+
+	keys.reserve(column.rowCount());
+	rows.reserve(column.rowCount());
+
+	for (double value : column.AsDoubles)
+	{
+		if (std::isnan(value))	missingRows.push_back(row);
+		else
+		{
+			keys.push_back(sortableKey(value));
+			rows.push_back(row);
+		}
+
+		row++;
+	}
+
+	radixSort(keys, rows);
+
+	int rank = -1;
+	for (size_t i = 0; i < keys.size(); i++)
+	{
+		if (i == 0 || keys[i] != keys[i - 1])
+		{
+			rank++;
+			_rankStart.push_back(i);
+			_rankValue.push_back(valueOfKey(keys[i]));
+		}
+
+		_rank[rows[i]] = rank;
+	}
+
+	_missingRank = rank + 1;
+	_rankStart.push_back(keys.size());
+	_rankStart.push_back(keys.size() + missingRows.size());
+
+	for (int missingRow : missingRows)
+		_rank[missingRow] = _missingRank;
+
+	_order = std::move(rows);
+	_order.insert(_order.end(), missingRows.begin(), missingRows.end());
+}
+
+// The values are keys of the labels, so this is a single counting sort on the position of the label of each row.
+void ColumnIndex::sortLevels(Column &column)
+{
+	Labels &labels	= column.labels();
+	_missingRank	= int(labels.size());
+
+	unordered_map<int, int> rankOfKey;
+	for (size_t i = 0; i < labels.size(); i++)
+	{
+		rankOfKey[labels[i].value()] = int(i);
+		_ranksOfLabel[labels.getLabelFromRow(int(i))].push_back(int(i));
+	}
+
+	_rankStart.assign(_missingRank + 2, 0);
+
+	int row = 0;
+	for (int key : column.AsInts)
+	{
+		auto found	= key == INT_MIN ? rankOfKey.end() : rankOfKey.find(key);
+		int rank	= found == rankOfKey.end() ? _missingRank : found->second;
+
+		_rank[row++] = rank;
+		_rankStart[rank + 1]++;
+	}
+
+	for (size_t rank = 1; rank < _rankStart.size(); rank++)
+		_rankStart[rank] += _rankStart[rank - 1];
+
+	vector<int> position(_rankStart.begin(), _rankStart.end() - 1);
+	_order.resize(_rank.size());
+
+	for (size_t r = 0; r < _rank.size(); r++)
+		_order[position[_rank[r]]++] = int(r);
+}
+
+vector<int> ColumnIndex::rowsWith(const string &value) const
+{
+	vector<int> ranks;
+
+	if (value == "")
+		ranks.push_back(_missingRank);
+	else if (_isScale)
+	{
+		char	*end;
+		double	number = strtod(value.c_str(), &end);
+
+		if (end == value.c_str() || *end != '\0' || !std::isfinite(number))
+			return vector<int>();
+
+		// The view shows 6 significant digits, so every value that shows the same as the number typed is a match.
+		// Those all lie within one unit of the 6th digit of it.
+		string	shown		= displayed(number);
+		double	tolerance	= number == 0 ? 0 : pow(10, floor(log10(fabs(number))) - 5);
+
+		for (auto found = lower_bound(_rankValue.begin(), _rankValue.end(), number - tolerance); found != _rankValue.end() && *found <= number + tolerance; found++)
+			if (displayed(*found) == shown)
+				ranks.push_back(int(found - _rankValue.begin()));
+	}
+	else
+	{
+		auto found = _ranksOfLabel.find(value);
+
+		if (found != _ranksOfLabel.end())
+			ranks = found->second;
+	}
+
+	vector<int> rows;
+	for (int rank : ranks)
+		rows.insert(rows.end(), _order.begin() + _rankStart[rank], _order.begin() + _rankStart[rank + 1]);
+
+	if (ranks.size() > 1)
+		sort(rows.begin(), rows.end());
+
+	return rows;
+}
+
+bool ColumnIndexes::upToDate(int column) const
+{
+	auto found = _indexes.find(column);
+
+	return found != _indexes.end() && size_t(column) < _dataSet->columnCount() && found->second->belongsTo(_dataSet->column(column));
+}
+
+const ColumnIndex &ColumnIndexes::index(int column)
+{
+	if (!upToDate(column))
+		_indexes[column].reset(new ColumnIndex(_dataSet->column(column)));
+
+	return *_indexes[column];
+}
+
+// The columns are only read, so their indexes are built in parallel. If one can't be built none of them are kept.
+void ColumnIndexes::prepare(const vector<int> &columns)
+{
+	vector<int> outdated;
+	for (int column : columns)
+		if (!upToDate(column))
+			outdated.push_back(column);
+
+	vector<unique_ptr<ColumnIndex>> built(outdated.size());
+
+	Parallel::forEach(outdated.size(), [&](size_t i, bool) { built[i].reset(new ColumnIndex(_dataSet->column(outdated[i]))); });
+
+	for (size_t i = 0; i < outdated.size(); i++)
+		_indexes[outdated[i]] = std::move(built[i]);
+}
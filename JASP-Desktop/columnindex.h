@@ -0,0 +1,79 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef COLUMNINDEX_H
+#define COLUMNINDEX_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dataset.h"
+
+/* ColumnIndex is what the data view needs to show the rows sorted on a column and to find a value in it, without going over the data again.
+ * It holds the rows in the order of their values with the missing ones last, and per row the rank of its value (equal values, equal rank).
+ * Scale columns are radix sorted on their doubles, the other columns on the position of their labels, which is the order the variables page shows.
+ * Sorting is stable, so the rows that have the same value follow each other in ascending order in order() and finding a value is a binary search.
+ */
+class ColumnIndex
+{
+public:
+	ColumnIndex(Column &column);
+
+	bool						belongsTo(Column &column) const { return column.id() == _columnId && column.revision() == _revision && column.rowCount() == _order.size(); }
+	const std::vector<int> &	order()			const { return _order;			}
+	const std::vector<int> &	rank()			const { return _rank;			}
+	int							missingRank()	const { return _missingRank;	} ///< The rank of missing values, all others are below it.
+
+	///The rows that show value in the data view, in ascending order.
+	std::vector<int>			rowsWith(const std::string &value) const;
+
+private:
+	void						sortScale(Column &column);
+	void						sortLevels(Column &column);
+
+	int							_columnId;
+	size_t						_revision;
+	bool						_isScale;
+	std::vector<int>			_order,
+								_rank,
+								_rankStart;		///< Where each rank starts in _order, one extra at the end.
+	std::vector<double>			_rankValue;		///< Scale: the value of each rank.
+	std::map<std::string, std::vector<int>>	_ranksOfLabel;	///< Not scale: the ranks of the labels that show this text.
+	int							_missingRank	= 0;
+};
+
+/* ColumnIndexes keeps the ColumnIndex of the columns of a data set that were asked for, until their column changes.
+ * prepare builds the ones that are missing or outdated on a thread per column.
+ */
+class ColumnIndexes
+{
+public:
+	void				setDataSet(DataSet *dataSet)	{ _dataSet = dataSet; _indexes.clear(); }
+
+	const ColumnIndex &	index(int column);
+	void				prepare(const std::vector<int> &columns);
+	bool				upToDate(int column) const;
+
+private:
+	DataSet										*_dataSet = NULL;
+	std::map<int, std::unique_ptr<ColumnIndex>>	_indexes;
+};
+
+#endif // COLUMNINDEX_H
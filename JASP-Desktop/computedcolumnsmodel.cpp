@@ -1,6 +1,7 @@
 #include "computedcolumnsmodel.h"
 #include "jsonutilities.h"
 #include "sharedmemory.h"
+#include "constructorevaluator.h"
 
 ComputedColumnsModel::ComputedColumnsModel(Analyses * analyses, QObject * parent)
 	: QObject(parent), _analyses(analyses)
@@ -112,8 +113,40 @@ bool ComputedColumnsModel::areLoopDependenciesOk(std::string columnName, std::st
 
 void ComputedColumnsModel::emitSendComputeCode(QString columnName, QString code, Column::ColumnType colType)
 {
-	if(areLoopDependenciesOk(columnName.toStdString(), code.toStdString()))
-		emit sendComputeCode(columnName, code, colType);
+	if(!areLoopDependenciesOk(columnName.toStdString(), code.toStdString()))
+		return;
+
+	if(tryToComputeNatively(columnName.toStdString()))
+		return;
+
+	emit sendComputeCode(columnName, code, colType);
+}
+
+bool ComputedColumnsModel::tryToComputeNatively(std::string columnName)
+{
+	ComputedColumn & col = (*_computedColumns)[columnName];
+
+	if(col.codeType() != ComputedColumn::computedType::constructorCode || col.column() == NULL)
+		return false;
+
+	bool		dataChanged;
+	DataSet	*	dataSet = _package->dataSet();
+
+	try
+	{
+		DataSetChange			change(dataSet);
+		ConstructorEvaluator	evaluator(dataSet->columns());
+
+		dataChanged = evaluator.evaluateInto(col.constructorCode(), *col.column());
+	}
+	catch(ConstructorEvaluator::notNative &)
+	{
+		//Not a problem, the engine will just run the generated R-code instead
+		return false;
+	}
+
+	computeColumnSucceeded(columnName, "", dataChanged);
+	return true;
 }
 
 void ComputedColumnsModel::sendCode(QString code, QString json)
@@ -400,6 +433,7 @@ void ComputedColumnsModel::requestComputedColumnDestruction(std::string columnNa
 	int index = _package->dataSet()->getColumnIndex(columnName);
 
 	_computedColumns->removeComputedColumn(columnName);
+	_package->clearEdits(); // The columns after it moved, the edits of the data refer to them by index
 
 	emit headerDataChanged(Qt::Horizontal, index, _package->dataSet()->columns().columnCount() + 1);
 
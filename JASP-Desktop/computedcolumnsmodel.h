@@ -1,7 +1,6 @@
 #ifndef COMPUTEDCOLUMNSCODEITEM_H
 #define COMPUTEDCOLUMNSCODEITEM_H
 
-#include <QQuickItem>
 #include <QObject>
 #include "computedcolumns.h"
 #include "datasetpackage.h"
@@ -60,6 +59,7 @@ private:
 				void	invalidateDependents(std::string columnName);
 				void	checkForDependentColumnsToBeSent(std::string columnName, bool refreshMe = false);
 				void	emitSendComputeCode(QString columnName, QString code, Column::ColumnType colType);
+				bool	tryToComputeNatively(std::string columnName);
 				void	clearColumn(std::string columnName);
 signals:
 				void	datasetLoadedChanged();
@@ -27,12 +27,14 @@
 #include "importers/spssimporter.h"
 #include "importers/jaspimporter.h"
 #include "importers/odsimporter.h"
+#include "importers/arrowimporter.h"
 
 #include <QFileInfo>
 
 using namespace std;
 using namespace spss;
 using namespace ods;
+using namespace arrowipc;
 using namespace boost::interprocess;
 using namespace boost;
 
@@ -50,8 +52,9 @@ Importer* DataSetLoader::getImporter(DataSetPackage *packageData, const string &
 	string ext = getExtension(locator, extension);
 
 	if (boost::iequals(ext,".csv") || boost::iequals(ext,".txt"))	result = new CSVImporter(packageData);
-	else if (boost::iequals(ext,".sav"))							result = new SPSSImporter(packageData);
+	else if (boost::iequals(ext,".sav") || boost::iequals(ext,".zsav"))	result = new SPSSImporter(packageData);
 	else if (boost::iequals(ext,".ods"))							result = new ODSImporter(packageData);
+	else if (boost::iequals(ext,".arrow") || boost::iequals(ext,".feather"))	result = new ArrowImporter(packageData);
 
 	return result;
 }
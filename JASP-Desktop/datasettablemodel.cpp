@@ -20,6 +20,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <cmath>
 
 #include <QSize>
 #include <QDebug>
@@ -63,9 +65,132 @@ void DataSetTableModel::setDataSetPackage(DataSetPackage *package)
     beginResetModel();
 	_dataSet = package == NULL ? NULL : package->dataSet();
 	_package = package;
+	_indexes.setDataSet(_dataSet);
+	_sortedBy.clear();
+	applySort();
     endResetModel();
 
 	emit columnsFilteredCountChanged();
+	emit sortChanged();
+}
+
+void DataSetTableModel::refresh()
+{
+	beginResetModel();
+	applySort();
+	endResetModel();
+}
+
+void DataSetTableModel::sortByColumns(const std::vector<std::pair<int, bool>> &columns)
+{
+	beginResetModel();
+	_sortedBy = columns;
+	applySort();
+	endResetModel();
+
+	emit sortChanged();
+}
+
+bool DataSetTableModel::sortsOn(int column) const
+{
+	for (const std::pair<int, bool> &sortedBy : _sortedBy)
+		if (sortedBy.first == column)
+			return true;
+
+	return false;
+}
+
+// Works out the permutation again from the indexes, only the ones of columns that changed are built again.
+void DataSetTableModel::applySort()
+{
+	_rowOfVisualRow.clear();
+	_visualRowOfRow.clear();
+
+	if (_dataSet == NULL || _sortedBy.empty())
+		return;
+
+	std::vector<int>	columns;
+	size_t				rows = _dataSet->rowCount();
+
+	for (const std::pair<int, bool> &sortedBy : _sortedBy)
+	{
+		if (sortedBy.first < 0 || size_t(sortedBy.first) >= _dataSet->columnCount() || _dataSet->column(sortedBy.first).rowCount() != rows)
+		{
+			_sortedBy.clear(); // The column is gone or the data set is being changed, it is shown unsorted
+			return;
+		}
+
+		columns.push_back(sortedBy.first);
+	}
+
+	_indexes.prepare(columns);
+
+	if (_sortedBy.size() == 1 && !_sortedBy[0].second)
+		_rowOfVisualRow = _indexes.index(columns[0]).order();
+	else
+	{
+		// From the last column to the first, each a stable counting sort on the ranks, so ties keep the order of the columns after it.
+		std::vector<int> order(rows), sorted(rows), start;
+
+		for (size_t row = 0; row < rows; row++)
+			order[row] = int(row);
+
+		for (auto sortedBy = _sortedBy.rbegin(); sortedBy != _sortedBy.rend(); sortedBy++)
+		{
+			const ColumnIndex	&index			= _indexes.index(sortedBy->first);
+			int					missingRank		= index.missingRank();
+			bool				descending		= sortedBy->second;
+
+			auto rankOf = [&](int row) { int rank = index.rank()[row]; return descending && rank != missingRank ? missingRank - 1 - rank : rank; }; // Missing values stay last
+
+			start.assign(missingRank + 2, 0);
+			for (int row : order)
+				start[rankOf(row) + 1]++;
+
+			for (size_t rank = 1; rank < start.size(); rank++)
+				start[rank] += start[rank - 1];
+
+			for (int row : order)
+				sorted[start[rankOf(row)]++] = row;
+
+			order.swap(sorted);
+		}
+
+		_rowOfVisualRow = std::move(order);
+	}
+
+	_visualRowOfRow.resize(rows);
+	for (size_t visualRow = 0; visualRow < rows; visualRow++)
+		_visualRowOfRow[_rowOfVisualRow[visualRow]] = int(visualRow);
+}
+
+int DataSetTableModel::findNext(int column, QString value, int fromRow)
+{
+	if (_dataSet == NULL || column < 0 || size_t(column) >= _dataSet->columnCount())
+		return -1;
+
+	std::vector<int> rows = _indexes.index(column).rowsWith(fq(value));
+
+	if (rows.empty())
+		return -1;
+
+	if (_visualRowOfRow.empty())
+	{
+		auto next = std::upper_bound(rows.begin(), rows.end(), fromRow);
+		return next == rows.end() ? rows[0] : *next;
+	}
+
+	int next = -1, first = -1;
+
+	for (int row : rows)
+	{
+		int visualRow = _visualRowOfRow[row];
+
+		if (visualRow > fromRow && (next == -1 || visualRow < next))	next	= visualRow;
+		if (first == -1 || visualRow < first)							first	= visualRow;
+	}
+
+	return next != -1 ? next : first;
 }
 
 
@@ -96,7 +221,7 @@ QVariant DataSetTableModel::data(const QModelIndex &index, int role) const
 	if(column > -1 && column < columnCount())
 	{
 		if(role == Qt::DisplayRole)
-			return tq(_dataSet->column(column)[index.row()]);
+			return tq(_dataSet->column(column)[dataRow(index.row())]);
 		else if(role == (int)specialRoles::active)
 			return getRowFilter(index.row());
 		else if(role == (int)specialRoles::lines)
@@ -162,6 +287,37 @@ bool DataSetTableModel::columnUsedInEasyFilter(int column) const
 	return false;
 }
 
+QString DataSetTableModel::columnSummary(int column) const
+{
+	if(_dataSet == NULL || column < 0 || size_t(column) >= _dataSet->columnCount())
+		return "";
+
+	Column		&col		= _dataSet->column(column);
+	bool		filtered	= _dataSet->filteredRowCount() < int(_dataSet->rowCount());
+	ColumnStats	stats;
+
+	if(!_dataSet->columnStats(col, stats, filtered))
+		return "Computing..."; // The data is being changed, the header is refreshed when that is done
+
+	QString summary = QString("Valid: %1, missing: %2").arg(stats.count).arg(stats.missing);
+
+	if(col.columnType() == Column::ColumnTypeScale)
+	{
+		if(stats.infinite > 0)
+			summary += QString(", infinite: %1").arg(stats.infinite);
+
+		if(stats.finite() > 0)
+			summary += QString("\nMean: %1, std. deviation: %2\nMinimum: %3, maximum: %4").arg(stats.mean()).arg(std::sqrt(stats.variance())).arg(stats.min).arg(stats.max);
+	}
+	else
+		summary += QString("\nLevels: %1").arg(stats.distinct);
+
+	if(filtered)
+		summary += "\n(of the rows that pass the filter)";
+
+	return summary;
+}
+
 int DataSetTableModel::columnsFilteredCount()
 {
 	if(_dataSet == NULL) return 0;
@@ -228,7 +384,7 @@ QVariant DataSetTableModel::headerData ( int section, Qt::Orientation orientatio
 		}
 		else
 		{
-			return QVariant(section + 1);
+			return QVariant(dataRow(section) + 1); // The row numbers of the data set, also when sorted
 		}
 	}
 	else if(role == (int)specialRoles::maxColString) //A query from DataSetView for the maximumlength string to be expected! This to accomodate columnwidth
@@ -247,6 +403,7 @@ QVariant DataSetTableModel::headerData ( int section, Qt::Orientation orientatio
 	else if(role == (int)specialRoles::computedColumnIsInvalidated)	return isComputedColumnInvalided(section);
 	else if(role == (int)specialRoles::columnIsFiltered)			return columnHasFilter(section) || columnUsedInEasyFilter(section);
 	else if(role == (int)specialRoles::computedColumnError)			return getComputedColumnError(section);
+	else if(role == Qt::ToolTipRole && orientation == Qt::Horizontal)	return columnSummary(section);
 
 
 	return QVariant();
@@ -271,31 +428,99 @@ QHash<int, QByteArray> DataSetTableModel::roleNames() const
 
 bool DataSetTableModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-	/*if (_dataSet == NULL)
+	if (_dataSet == NULL || role != Qt::EditRole || !(flags(index) & Qt::ItemIsEditable))
+		return false;
+
+	DataSetEdit edit;
+	edit.setText(index.column(), dataRow(index.row()), fq(value.toString()));
+
+	return applyEdit(edit, index);
+}
+
+bool DataSetTableModel::pasteValues(int row, int column, QString text)
+{
+	if (_dataSet == NULL || row < 0 || column < 0)
 		return false;
 
-	bool ok;
+	QStringList lines = text.split('\n');
 
-	Column &column = _dataSet->columns()[index.column()];
-	if (column.dataType() == Column::DataTypeInt)
+	if (lines.size() > 1 && lines.last() == "")
+		lines.removeLast(); // Copied rows end with a newline
+
+	DataSetEdit edit;
+
+	for (int line = 0; line < lines.size() && row + line < rowCount(); line++)
 	{
-		int v = value.toInt(&ok);
-		if (ok)
-			column.setValue(index.row(), v);
-		else
-			emit badDataEntered(index);
+		QStringList cells = lines[line].split('\t');
+
+		for (int cell = 0; cell < cells.size() && column + cell < columnCount(); cell++)
+		{
+			if (isComputedColumn(column + cell))
+				continue;
+
+			QString value = cells[cell];
+			if (value.endsWith('\r'))
+				value.chop(1);
 
-		return ok;
-	}*/
+			edit.setText(column + cell, dataRow(row + line), fq(value));
+		}
+	}
 
-	//_dataSet->columns()[index.column()].setValue(index.row(), v);
+	return applyEdit(edit, index(row, column));
+}
+
+bool DataSetTableModel::applyEdit(const DataSetEdit &edit, const QModelIndex &where)
+{
+	if (edit.empty())
+		return false;
+
+	try
+	{
+		_package->applyEdit(edit); // Comes back through cellsChanged
+	}
+	catch (std::runtime_error &e)
+	{
+		std::cout << "Edit of the data rejected: " << e.what() << std::endl;
+		emit badDataEntered(where);
+		return false;
+	}
 
 	return true;
 }
 
+void DataSetTableModel::cellsChanged(const DataSetChanges &changes)
+{
+	for (const auto &column : changes.rows)
+		if (sortsOn(column.first))
+		{
+			refresh(); // The rows might be in another order now
+			return;
+		}
+
+	for (const auto &column : changes.rows)
+	{
+		int col = int(column.first);
+
+		for (const std::pair<int, int> &range : column.second)
+			if (_visualRowOfRow.empty())
+				emit dataChanged(index(range.first, col), index(range.second, col));
+			else
+				for (int row = range.first; row <= range.second; row++)
+				{
+					QModelIndex shown = index(_visualRowOfRow[row], col);
+					emit dataChanged(shown, shown);
+				}
+
+		emit headerDataChanged(Qt::Horizontal, col, col); // The summary in the tooltip
+	}
+}
+
 Qt::ItemFlags DataSetTableModel::flags(const QModelIndex &index) const
 {
-	return Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+	if (_dataSet == NULL || !index.isValid() || isComputedColumn(index.column()))
+		return Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+
+	return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsEditable;
 }
 
 bool DataSetTableModel::setColumnType(int columnIndex, Column::ColumnType newColumnType)
@@ -306,6 +531,9 @@ bool DataSetTableModel::setColumnType(int columnIndex, Column::ColumnType newCol
 	bool changed = _dataSet->column(columnIndex).changeColumnType(newColumnType);
 	emit headerDataChanged(Qt::Horizontal, columnIndex, columnIndex);
 
+	if(sortsOn(columnIndex))
+		refresh(); // Sorted on values or on labels now
+
 	return changed;
 }
 
@@ -318,14 +546,20 @@ void DataSetTableModel::refreshColumn(Column * column)
 {
 	for(size_t col=0; col<_dataSet->columns().columnCount(); col++)
 		if(&(_dataSet->columns()[col]) == column)
-			emit dataChanged(index(0, col), index(rowCount()-1, col));
+		{
+			if(sortsOn(col))	refresh();
+			else				emit dataChanged(index(0, col), index(rowCount()-1, col));
+		}
 }
 
 void DataSetTableModel::columnWasOverwritten(std::string columnName, std::string possibleError)
 {
 	for(size_t col=0; col<_dataSet->columns().columnCount(); col++)
 		if(_dataSet->columns()[col].name() == columnName)
-			emit dataChanged(index(0, col), index(rowCount()-1, col));
+		{
+			if(sortsOn(col))	refresh();
+			else				emit dataChanged(index(0, col), index(rowCount()-1, col));
+		}
 }
 
 int DataSetTableModel::setColumnTypeFromQML(int columnIndex, int newColumnType)
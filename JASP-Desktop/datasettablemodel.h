@@ -23,6 +23,7 @@
 #include <QAbstractTableModel>
 #include <QIcon>
 
+#include "columnindex.h"
 #include "common.h"
 #include "datasetpackage.h"
 
@@ -47,14 +48,27 @@ public:
 				Qt::ItemFlags		flags(const QModelIndex &index)														const	override;
 
 	Q_INVOKABLE bool				isColumnNameFree(QString name)						{ return _package->isColumnNameFree(name.toStdString()); }
-	Q_INVOKABLE bool				getRowFilter(int row)					const		{ return (row >=0 && row < rowCount()) ? _dataSet->filterVector()[row] : true; }
+	Q_INVOKABLE bool				getRowFilter(int row)					const		{ return (row >=0 && row < rowCount()) ? _dataSet->filter().current().passes(dataRow(row)) : true; }
 	Q_INVOKABLE	QVariant			columnTitle(int column)					const;
 	Q_INVOKABLE QVariant			columnIcon(int column)					const;
 	Q_INVOKABLE QVariant			getColumnTypesWithCorrespondingIcon()	const;
 	Q_INVOKABLE bool				columnHasFilter(int column)				const;
 	Q_INVOKABLE bool				columnUsedInEasyFilter(int column)		const;
+	Q_INVOKABLE QString				columnSummary(int column)				const; ///< For the tooltip of a column header, from the ColumnStats so nothing has to run in R.
 	Q_INVOKABLE void				resetAllFilters();
 	Q_INVOKABLE int					setColumnTypeFromQML(int columnIndex, int newColumnType);
+	Q_INVOKABLE bool				pasteValues(int row, int column, QString text);		///< Tab separated cells and a line per row, as copied from a spreadsheet, from row and column on and all as one edit.
+
+	/* The rows can be shown sorted on one or more columns, the data itself stays where it is: the rows of the model are mapped to the rows of the data set through a permutation.
+	 * The ColumnIndex of each column it is sorted on is kept until that column changes and is also used to find values.
+	 */
+	Q_INVOKABLE void				sortByColumn(int column, bool descending = false)		{ sortByColumns({ std::make_pair(column, descending) }); }
+	Q_INVOKABLE void				clearSort()												{ sortByColumns({}); }
+	Q_INVOKABLE int					sortedByColumn()						const		{ return _sortedBy.empty() ? -1		: _sortedBy[0].first;	}
+	Q_INVOKABLE bool				sortedDescending()						const		{ return _sortedBy.empty() ? false	: _sortedBy[0].second;	}
+	Q_INVOKABLE int					findNext(int column, QString value, int fromRow);	///< The first row after fromRow (as shown) where column shows value, from the top again if there is none after it, -1 if there is none at all.
+				void				sortByColumns(const std::vector<std::pair<int, bool>> &columns); ///< Sorted on the first column, ties on the next one and so on, descending where the bool is true.
+				int					dataRow(int row)						const		{ return size_t(row) < _rowOfVisualRow.size() ? _rowOfVisualRow[row] : row; } ///< The row of the data set that is shown at row
 
 				void				setDataSetPackage(DataSetPackage *package);
 				void				clearDataSet() { setDataSetPackage(NULL); }
@@ -73,19 +87,30 @@ signals:
 				void				badDataEntered(const QModelIndex index);
 				void				allFiltersReset();
 				void				dataSetChanged(DataSet * newDataSet);
+				void				sortChanged();
 				void				columnDataTypeChanged(std::string columnName);
 
 public slots:
-				void				refresh() { beginResetModel(); endResetModel(); }
+				void				refresh();
 				void				refreshColumn(Column * column);
+				void				cellsChanged(const DataSetChanges &changes);
 				void				columnWasOverwritten(std::string columnName, std::string possibleError);
 				void				notifyColumnFilterStatusChanged(int columnIndex);
 				void				setColumnsUsedInEasyFilter(std::set<std::string> usedColumns);
     
 private:
+				void				applySort();
+				bool				applyEdit(const DataSetEdit &edit, const QModelIndex &where);
+				bool				sortsOn(int column) const;
+
 	DataSet						*_dataSet;
 	DataSetPackage				*_package;
 	std::map<std::string, bool> columnNameUsedInEasyFilter;
+
+	ColumnIndexes							_indexes;
+	std::vector<std::pair<int, bool>>		_sortedBy;
+	std::vector<int>						_rowOfVisualRow,	///< Empty when not sorted
+											_visualRowOfRow;
 };
 
 #endif // DATASETTABLEMODEL_H
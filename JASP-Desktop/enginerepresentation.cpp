@@ -1,5 +1,7 @@
 #include "enginerepresentation.h"
+#include "tracing.h"
 
+#include <iostream>
 
 EngineRepresentation::~EngineRepresentation()
 {
@@ -9,12 +11,16 @@ EngineRepresentation::~EngineRepresentation()
 		_slaveProcess->terminate();
 		_slaveProcess->kill();
 	}
+
+	if(isRemote())
+		delete _channel; // Closes the connection, which stops the remote engine
 }
 
 void EngineRepresentation::clearAnalysisInProgress()
 {
 	_analysisInProgress = NULL;
 	_engineState		= engineState::idle;
+	_abandoned			= false;
 }
 
 void EngineRepresentation::setAnalysisInProgress(Analysis* analysis)
@@ -56,6 +62,19 @@ void EngineRepresentation::process()
 		default:							throw std::logic_error("If you define new engineStates you should add them to the switch in EngineRepresentation::process()!");
 		}
 	}
+	else if (!_channel->connected())
+		lostConnection();
+}
+
+///A remote engine went away (or the network did), what it was running is run again by another engine.
+void EngineRepresentation::lostConnection()
+{
+	std::cout << "Lost the connection to remote engine " << channelNumber() << std::endl;
+
+	if(_analysisInProgress != NULL && !_analysisInProgress->isAborted())
+		_analysisInProgress->setStatus(Analysis::Empty);
+
+	clearAnalysisInProgress();
 }
 
 
@@ -91,13 +110,10 @@ void EngineRepresentation::processFilterReply(Json::Value json)
 
 	int requestId = json.get("requestId", -1).asInt();
 
-	if(json.get("filterResult", Json::Value(Json::intValue)).isArray()) //If the result is an array then it came from the engine.
+	if(json.isMember("filterStaged")) //The engine wrote the result straight into the filter of the dataset, if it wasn't staged a newer filter was already there.
 	{
-		std::vector<bool> filterResult;
-		for(Json::Value & jsonResult : json.get("filterResult", Json::Value(Json::arrayValue)))
-			filterResult.push_back(jsonResult.asBool());
-
-		emit processNewFilterResult(filterResult, requestId);
+		if(json.get("filterStaged", false).asBool())
+			emit processNewFilterResult(requestId);
 
 		if(json.get("filterError", "").asString() != "")
 			emit processFilterErrorMsg(QString::fromStdString(json.get("filterError", "there was a warning").asString()), requestId);
@@ -173,6 +189,8 @@ void EngineRepresentation::processComputeColumnReply(Json::Value json)
 
 void EngineRepresentation::runAnalysisOnProcess(Analysis *analysis)
 {
+	JASPTRACE_SCOPE_ANALYSIS("EngineRepresentation::runAnalysisOnProcess", analysis->id(), analysis->revision());
+
 #ifdef PRINT_ENGINE_MESSAGES
 	std::cout << "send " << analysis->id() << " to process " << channelNumber() << "\n";
 	std::cout.flush();
@@ -219,6 +237,9 @@ void EngineRepresentation::runAnalysisOnProcess(Analysis *analysis)
 		}
 	}
 
+	if (isRemote() && (perform == performType::init || perform == performType::run))
+		shipDataSet();
+
 	sendString(json.toStyledString());
 
 	if(analysis->isAborted())
@@ -226,6 +247,18 @@ void EngineRepresentation::runAnalysisOnProcess(Analysis *analysis)
 
 }
 
+// Whatever changed in the data set since the last shipment goes out before the request, the engine applies it before it reads the request.
+void EngineRepresentation::shipDataSet()
+{
+	JASPTRACE_SCOPE("EngineRepresentation::shipDataSet");
+
+	DataSet		*dataSet = _dataSetSource ? _dataSetSource() : NULL;
+	std::string	shipment;
+
+	if (dataSet != NULL && _shipper.ship(dataSet, shipment))
+		_channel->sendDataSet(shipment);
+}
+
 Analysis::Status EngineRepresentation::analysisResultStatusToAnalysStatus(analysisResultStatus result, Analysis * analysis)
 {
 	switch(result)
@@ -257,6 +290,8 @@ void EngineRepresentation::processAnalysisReply(Json::Value json)
 	Json::Value results			= json.get("results", Json::nullValue);
 	analysisResultStatus status	= analysisResultStatusFromString(json.get("status", "error").asString());
 
+	JASPTRACE_SCOPE_ANALYSIS("EngineRepresentation::processAnalysisReply", id, revision);
+
 	if (analysis->id() != id || analysis->revision() < revision)
 		throw std::runtime_error("Received results for wrong analysis!");
 
@@ -295,6 +330,9 @@ void EngineRepresentation::processAnalysisReply(Json::Value json)
 		//createdColumns and if it succeeded or not should actually be communicated through jaspColumn or something, to be created
 		for(std::string col : analysis->columnsCreated())
 			emit computeColumnSucceeded(col, "", true);
+
+		if(status == analysisResultStatus::complete)
+			emit analysisCompleted(analysis);
 		break;
 
 	case analysisResultStatus::running:
@@ -310,5 +348,92 @@ void EngineRepresentation::handleRunningAnalysisStatusChanges()
 		return;
 
 	if(_analysisInProgress->isEmpty() || _analysisInProgress->isAborted())
-		runAnalysisOnProcess(_analysisInProgress);
+	{
+		bool	stopped		= _abandoned && _analysisInProgress->isEmpty();
+		int		analysisId	= _analysisInProgress->id(),
+				revision	= _analysisInProgress->revision() + (_analysisInProgress->isAborted() ? 1 : 0); // Only what runs now is interrupted, never a later run of the same analysis
+
+		runAnalysisOnProcess(_analysisInProgress); // First the new revision or the abort, so the engine finds it when it stops
+
+		if (!stopped)
+			cancelRunningAnalysis(analysisId, revision);
+	}
+}
+
+///Stops the run of a revision that was superseded without sending the newer one, EngineSync sends that once the analysis stops changing.
+///Until then the engine stays reserved for the analysis, whatever it still sends about the old revision is then recognised as outdated.
+void EngineRepresentation::abandonRunningAnalysis()
+{
+	if (_engineState != engineState::analysis || _abandoned)
+		return;
+
+	JASPTRACE_SCOPE_ANALYSIS("EngineRepresentation::abandonRunningAnalysis", _analysisInProgress->id(), _analysisInProgress->revision());
+
+	int analysisId = _analysisInProgress->id();
+
+	Json::Value json		= Json::Value(Json::objectValue);
+	json["typeRequest"]		= engineStateToString(engineState::analysis);
+	json["id"]				= analysisId;
+	json["perform"]			= performTypeToString(performType::abort);
+	json["requiresInit"]	= _analysisInProgress->requiresInit();
+	json["revision"]		= _analysisInProgress->revision();
+	json["jaspResults"]		= _analysisInProgress->usesJaspResults();
+
+	sendString(json.toStyledString());
+	cancelRunningAnalysis(analysisId, _analysisInProgress->revision()); // The run is of an older revision, the newer one won't be interrupted by this
+
+	_abandoned = true;
+}
+
+// The engine interrupts R when it sees the request, instead of waiting until the analysis happens to call back.
+void EngineRepresentation::cancelRunningAnalysis(int analysisId, int revision)
+{
+	_channel->requestCancel(analysisId, revision);
+
+	// If the request is still there later the engine is stuck, for instance in compiled code that never checks for an interrupt.
+	QTimer::singleShot(_cancelTimeout, this, [=]() { checkCancelled(analysisId, revision); });
+}
+
+void EngineRepresentation::checkCancelled(int analysisId, int revision)
+{
+	int pendingId, pendingRevision;
+
+	if(!_channel->cancelRequested(pendingId, pendingRevision) || pendingId != analysisId || pendingRevision != revision)
+		return;
+
+	// Killed outside of R evaluation it might leave a lock in shared memory behind, so then it gets a little longer.
+	if(_channel->killable())
+		emit engineUnresponsive(this);
+	else
+		QTimer::singleShot(_cancelTimeout / 10, this, [=]() { checkCancelled(analysisId, revision); });
+}
+
+///Kills the engine process, EngineSync starts a new one. Whatever was sent to it is discarded and the analysis it was running, if any, is run again.
+void EngineRepresentation::killEngine()
+{
+	if(_slaveProcess != NULL)
+	{
+		unsigned long processId = (unsigned long)_slaveProcess->processId();
+
+		_slaveProcess->disconnect(); // it dies on purpose, that shouldn't be reported as a crash
+		_slaveProcess->kill();
+		_slaveProcess->waitForFinished(1000);
+		_slaveProcess->deleteLater();
+		_slaveProcess = NULL;
+
+		// It might have been writing a computed column, nobody else is going to finish that change
+		DataSet *dataSet = _dataSetSource ? _dataSetSource() : NULL;
+		if(dataSet != NULL)
+			dataSet->abandonChangesOf(processId);
+
+		_channel->abandonLocks();
+	}
+
+	_channel->discardSent();
+	_channel->clearCancel();
+
+	if(_analysisInProgress != NULL && !_analysisInProgress->isAborted())
+		_analysisInProgress->setStatus(Analysis::Empty);
+
+	clearAnalysisInProgress();
 }
@@ -4,12 +4,14 @@
 #include <QObject>
 #include <QProcess>
 #include <QTimer>
+#include <functional>
 #include <vector>
 
 #include "options/options.h"
 #include "analysis.h"
 #include "analyses.h"
-#include "ipcchannel.h"
+#include "enginechannel.h"
+#include "datasetshipper.h"
 #include "datasetpackage.h"
 #include <queue>
 #include "enginedefinitions.h"
@@ -20,20 +22,27 @@ class EngineRepresentation : public QObject
 	Q_OBJECT
 
 public:
-	EngineRepresentation(IPCChannel * channel, QProcess * slaveProcess, QObject * parent = NULL) : QObject(parent), _slaveProcess(slaveProcess), _channel(channel) {}
+	EngineRepresentation(EngineChannel * channel, QProcess * slaveProcess, QObject * parent = NULL) : QObject(parent), _slaveProcess(slaveProcess), _channel(channel) {}
 	~EngineRepresentation();
 	void clearAnalysisInProgress();
 	void setAnalysisInProgress(Analysis* analysis);
 
-	bool isIdle() { return _engineState == engineState::idle; }
+	bool isIdle() { return _engineState == engineState::idle && _channel->connected(); }
+	bool connected() const { return _channel->connected(); }
+	bool isRemote() const { return !_channel->sharesMemory(); } ///< Doesn't see the shared memory, so it gets a copy of the data set and only runs analyses
+	bool canRun(Analysis *analysis) const { return !isRemote() || ((analysis->isEmpty() || analysis->isInited()) && analysis->columnsCreated().empty()); }
+	Analysis* analysisInProgress() const { return _engineState == engineState::analysis ? _analysisInProgress : NULL; }
 
 	void handleRunningAnalysisStatusChanges();
+	void abandonRunningAnalysis();
+	bool abandoned() const { return _abandoned; }
 
 	void runScriptOnProcess(RFilterStore * filterStore);
 	void runScriptOnProcess(RScriptStore * scriptStore);
 	void runScriptOnProcess(RComputeColumnStore * computeColumnStore);
 	void runAnalysisOnProcess(Analysis *analysis);
 	void terminateJaspEngine();
+	void killEngine();
 
 	void process();
 	void processFilterReply(		Json::Value json);
@@ -41,8 +50,9 @@ public:
 	void processComputeColumnReply(	Json::Value json);
 	void processAnalysisReply(		Json::Value json);
 
-	void setChannel(IPCChannel * channel)			{ _channel = channel; }
+	void setChannel(EngineChannel * channel)		{ _channel = channel; }
 	void setSlaveProcess(QProcess * slaveProcess)	{ _slaveProcess = slaveProcess; }
+	void setDataSetSource(std::function<DataSet *()> source) { _dataSetSource = source; }
 	int channelNumber()								{ return _channel->channelNumber(); }
 
 	void sendString(std::string str)
@@ -55,18 +65,27 @@ public:
 
 private:
 	Analysis::Status analysisResultStatusToAnalysStatus(analysisResultStatus result, Analysis * analysis);
-
-	QProcess*	_slaveProcess		= NULL;
-	IPCChannel*	_channel			= NULL;
-	Analysis*	_analysisInProgress = NULL;
-	engineState	_engineState		= engineState::idle;
-	int			_ppi				= 96;
+	void cancelRunningAnalysis(int analysisId, int revision);
+	void checkCancelled(int analysisId, int revision);
+	void shipDataSet();
+	void lostConnection();
+
+	QProcess*					_slaveProcess		= NULL;
+	EngineChannel*				_channel			= NULL;
+	Analysis*					_analysisInProgress = NULL;
+	engineState					_engineState		= engineState::idle;
+	bool						_abandoned			= false;	///< The run of _analysisInProgress was stopped, the engine waits for its newest revision
+	int							_ppi				= 96,
+								_cancelTimeout		= 5000; ///< Milliseconds an engine gets to stop an analysis that was cancelled, after that it is restarted.
+	DataSetShipper				_shipper;							///< Keeps the copy of the data set of a remote engine up to date
+	std::function<DataSet *()>	_dataSetSource;						///< Shipped to a remote engine, cleaned up after a local one that was killed
 
 signals:
 	void engineTerminated();
+	void engineUnresponsive(EngineRepresentation * engine);
 
 	void processFilterErrorMsg(QString error, int requestId);
-	void processNewFilterResult(std::vector<bool> filterResult, int requestId);
+	void processNewFilterResult(int requestId);
 	void computeColumnErrorTextChanged(QString error);
 
 	void rCodeReturned(QString result, int requestId);
@@ -74,6 +93,8 @@ signals:
 	void computeColumnSucceeded(std::string columnName, std::string warning, bool dataChanged);
 	void computeColumnFailed(std::string columnName, std::string error);
 
+	void analysisCompleted(Analysis * analysis);
+
 public slots:
 	void ppiChanged(int newPPI) { _ppi = newPPI; }
 };
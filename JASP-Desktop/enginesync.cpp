@@ -18,22 +18,28 @@
 
 #include "enginesync.h"
 
-#include <QApplication>
+#include <QCoreApplication>
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
 #include <QDebug>
 
+#include <algorithm>
+#include <set>
+
 #include <boost/interprocess/shared_memory_object.hpp>
 #include <boost/interprocess/mapped_region.hpp>
 #include <boost/foreach.hpp>
+#include "ipcchannel.h"
 #include "jsonredirect.h"
 #include "processinfo.h"
 #include "common.h"
 #include "appinfo.h"
 #include "qutils.h"
+#include "socketchannel.h"
 #include "tempfiles.h"
 #include "timers.h"
+#include "tracing.h"
 
 using namespace boost::interprocess;
 
@@ -44,6 +50,8 @@ EngineSync::EngineSync(Analyses *analyses, DataSetPackage *package, QObject *par
 	_analyses = analyses;
 	_package = package;
 
+	connect(this, &EngineSync::ppiChanged, this, [this](int newPPI) { _resultsCache.setPPI(newPPI); });
+
 	/* commented out because it makes JASP crash after synchronizing, also quite pointless because enginseSync calls ProcessAnalysisRequests anyway from process, but then after filter, rscript and compute column requests..
 	connect(_analyses, SIGNAL(analysisAdded(Analysis*)), this, SLOT(ProcessAnalysisRequests()));
 	connect(_analyses, SIGNAL(analysisOptionsChanged(Analysis*)), this, SLOT(ProcessAnalysisRequests()));
@@ -59,6 +67,8 @@ EngineSync::~EngineSync()
 {
 	if (_engineStarted)
 	{		
+		qDebug() << "Analysis runs:" << QString::fromStdString(Json::FastWriter().write(_scheduler.metrics())).trimmed();
+
 		_engines.clear();
 		tempfiles_deleteAll();
 	}
@@ -66,7 +76,7 @@ EngineSync::~EngineSync()
 	shared_memory_object::remove(_memoryName.c_str());
 }
 
-void EngineSync::start()
+void EngineSync::start(size_t engineCount)
 {
 	if (_engineStarted)
 		return;
@@ -79,23 +89,21 @@ void EngineSync::start()
 	try {
 		_memoryName = "JASP-IPC-" + std::to_string(ProcessInfo::currentPID());
 
+		if (engineCount == 0)
 #ifdef JASP_DEBUG
-		_engines.resize(1);
+			engineCount = 1;
 #else
-		_engines.resize(4);
+			engineCount = 4;
 #endif
-		for(size_t i=0; i<_engines.size(); i++)
+		for(size_t i=0; i<engineCount; i++)
 		{
-			_engines[i] = new EngineRepresentation(new IPCChannel(_memoryName, i), startSlaveProcess(i), this);
-
-			connect(_engines[i],	&EngineRepresentation::engineTerminated,				this,			&EngineSync::engineTerminated		);
-			connect(_engines[i],	&EngineRepresentation::rCodeReturned,					this,			&EngineSync::rCodeReturned			);
-			connect(_engines[i],	&EngineRepresentation::processNewFilterResult,			this,			&EngineSync::processNewFilterResult	);
-			connect(_engines[i],	&EngineRepresentation::processFilterErrorMsg,			this,			&EngineSync::processFilterErrorMsg	);
-			connect(_engines[i],	&EngineRepresentation::computeColumnSucceeded,			this,			&EngineSync::computeColumnSucceeded	);
-			connect(_engines[i],	&EngineRepresentation::computeColumnFailed,				this,			&EngineSync::computeColumnFailed	);
-			connect(this,			&EngineSync::ppiChanged,								_engines[i],	&EngineRepresentation::ppiChanged	);
+			EngineRepresentation *engine = new EngineRepresentation(new IPCChannel(_memoryName, i), startSlaveProcess(i), this);
+			engine->setDataSetSource([this]() { return _package->dataSet(); });
+
+			addEngine(engine);
 		}
+
+		connectRemoteEngines();
 	}
 	catch (interprocess_exception e)
 	{
@@ -115,15 +123,114 @@ void EngineSync::start()
 }
 
 
+void EngineSync::addEngine(EngineRepresentation *engine)
+{
+	connect(engine,	&EngineRepresentation::engineTerminated,				this,	&EngineSync::engineTerminated		);
+	connect(engine,	&EngineRepresentation::engineUnresponsive,				this,	&EngineSync::restartEngine			);
+	connect(engine,	&EngineRepresentation::rCodeReturned,					this,	&EngineSync::rCodeReturned			);
+	connect(engine,	&EngineRepresentation::processNewFilterResult,			this,	&EngineSync::processNewFilterResult	);
+	connect(engine,	&EngineRepresentation::processFilterErrorMsg,			this,	&EngineSync::processFilterErrorMsg	);
+	connect(engine,	&EngineRepresentation::computeColumnSucceeded,			this,	&EngineSync::computeColumnSucceeded	);
+	connect(engine,	&EngineRepresentation::computeColumnFailed,				this,	&EngineSync::computeColumnFailed	);
+	connect(engine,	&EngineRepresentation::analysisCompleted,				this,	&EngineSync::analysisCompleted		);
+	connect(this,	&EngineSync::ppiChanged,								engine,	&EngineRepresentation::ppiChanged	);
+
+	_engines.push_back(engine);
+}
+
+void EngineSync::connectRemoteEngines()
+{
+	QString remotes = QProcessEnvironment::systemEnvironment().value("JASP_REMOTE_ENGINES");
+
+	if (remotes.trimmed() == "")
+		return;
+
+	std::string secret;
+
+	try
+	{
+		secret = SocketChannel::secretFromEnvironment();
+	}
+	catch (std::runtime_error &e)
+	{
+		qDebug() << "Not using the remote engines:" << e.what();
+		return;
+	}
+
+	for (const QString &remote : remotes.split(",", QString::SkipEmptyParts))
+	{
+		QString	host = remote.section(":", 0, -2).trimmed();
+		int		port = remote.section(":", -1).toInt();
+
+		try
+		{
+			EngineRepresentation *engine = new EngineRepresentation(SocketChannel::connect(host.toStdString(), port, int(_engines.size()), secret), NULL, this);
+			engine->setDataSetSource([this]() { return _package->dataSet(); });
+
+			addEngine(engine);
+			qDebug() << "Using the remote engine at" << remote << "as engine" << engine->channelNumber();
+		}
+		catch (std::runtime_error &e)
+		{
+			qDebug() << e.what();
+		}
+	}
+}
+
+///Only for remote engines, one that was started here is restarted instead.
+void EngineSync::removeEngine(EngineRepresentation *engine)
+{
+	_engines.erase(std::remove(_engines.begin(), _engines.end(), engine), _engines.end());
+	engine->deleteLater();
+}
+
 void EngineSync::process()
 {
 	for (auto engine : _engines)
 		engine->process();
+
+	for (auto engine : std::vector<EngineRepresentation*>(_engines))
+		if (engine->isRemote() && !engine->connected())
+			removeEngine(engine);
 	
 	processScriptQueue();
 	ProcessAnalysisRequests();
+
+	if (Tracing::enabled())
+		Tracing::flush(1000); // Often enough that the ring buffers of this process don't overflow
+}
+
+
+void EngineSync::restartEngine(EngineRepresentation * engine)
+{
+	if (engine->isRemote())
+	{
+		qDebug() << "Remote engine" << engine->channelNumber() << "did not stop the cancelled analysis in time, it is no longer used.";
+
+		engine->killEngine();
+		removeEngine(engine);
+		return;
+	}
+
+	qDebug() << "Engine" << engine->channelNumber() << "did not stop the cancelled analysis in time, it is restarted.";
+
+	engine->killEngine();
+	engine->setSlaveProcess(startSlaveProcess(engine->channelNumber()));
+}
+
+// Once the filter of a freshly loaded file is applied the data is as it was when its analyses ran, so their results can be served later on.
+void EngineSync::cacheLoadedResults()
+{
+	for (Analysis *analysis : *_analyses)
+		if (analysis != NULL && analysis->status() == Analysis::Complete)
+			_resultsCache.store(analysis, _package->dataSet());
 }
 
+void EngineSync::analysisCompleted(Analysis * analysis)
+{
+	_scheduler.completed(analysis->id(), analysis->revision());
+	_resultsCache.completed(analysis);
+}
 
 void EngineSync::sendFilter(QString generatedFilter, QString filter, int requestID)
 {
@@ -162,7 +269,7 @@ void EngineSync::computeColumn(QString columnName, QString computeCode, Column::
 void EngineSync::processScriptQueue()
 {
 	for(auto engine : _engines)
-		if(engine->isIdle())
+		if(engine->isIdle() && !engine->isRemote())
 		{
 			if(_waitingScripts.size() == 0 && _waitingFilter == nullptr)
 				return;
@@ -204,41 +311,93 @@ void EngineSync::ProcessAnalysisRequests()
 {	
 	const size_t initedAnalysesStartIndex =
 #ifndef JASP_DEBUG
-			1; // don't perform 'runs' on process 0, "only" inits & filters & rCode & columnCoputes.
+			_engines.size() > 1 ? 1 : 0; // don't perform 'runs' on process 0, "only" inits & filters & rCode & columnCoputes.
 #else
 			0;
 #endif
 
+	for (Analysis *analysis : *_analyses)
+		if (analysis != NULL)
+		{
+			if (analysis->isAborted())	_scheduler.forget(analysis->id()); // Removed (or stopped), what it did so far says little about its next run
+			else						_scheduler.seen(analysis->id(), analysis->revision());
+		}
+
+	std::set<Analysis *> waitingOnTheirEngine;
+
 	for(auto engine : _engines)
+	{
+		Analysis *running = engine->analysisInProgress();
+
+		// A superseded run is stopped right away, but while its analysis keeps changing the newest revision waits instead of taking its place.
+		// That revision goes to the same engine later on, which drops whatever the engine still reports about the old one.
+		if (running != NULL && running->isEmpty())
+		{
+			if (!engine->abandoned())
+				_scheduler.cancelled();
+
+			if (!_scheduler.mayRun(running->id(), running->revision()))
+			{
+				engine->abandonRunningAnalysis();
+				waitingOnTheirEngine.insert(running);
+				continue;
+			}
+
+			_scheduler.dispatched(running->id(), running->revision());
+			_resultsCache.dispatched(running, _package->dataSet());
+		}
+
 		engine->handleRunningAnalysisStatusChanges();
+	}
 
 	for (Analysis *analysis : *_analyses)
 	{
+		if (analysis == NULL || waitingOnTheirEngine.count(analysis) > 0)
+			continue;
+
+		// Ran before with the same options on the same data? Then it doesn't need an engine.
+		if ((analysis->isEmpty() || analysis->isInited()) && analysis->isAutorun() && _resultsCache.restore(analysis, _package->dataSet()))
+		{
+			_scheduler.restoredFromCache();
+			continue;
+		}
+
 		if(!idleEngineAvailable())
 			return;
 
-		if (analysis == NULL)
-			continue;
-		
+		if (analysis->isEmpty() && !_scheduler.mayRun(analysis->id(), analysis->revision()))
+			continue; // Still changing, this revision probably won't be the last
+
 		if (analysis->isEmpty() || analysis->isSaveImg() || analysis->isEditImg())
 		{
 			for(auto engine : _engines)
-				if(engine->isIdle())
+				if(engine->isIdle() && engine->canRun(analysis))
 				{
-					engine->runAnalysisOnProcess(analysis);
+					dispatch(engine, analysis);
 					break;
 				}
 		}
 		else if (analysis->isInited())
 			for (size_t i = initedAnalysesStartIndex; i<_engines.size(); i++)
-				if (_engines[i]->isIdle())
+				if (_engines[i]->isIdle() && _engines[i]->canRun(analysis))
 				{
-					_engines[i]->runAnalysisOnProcess(analysis);
+					dispatch(_engines[i], analysis);
 					break;
 				}
 	}
 }
 
+void EngineSync::dispatch(EngineRepresentation *engine, Analysis *analysis)
+{
+	if (analysis->isEmpty() || analysis->isInited())
+	{
+		_scheduler.dispatched(analysis->id(), analysis->revision());
+		_resultsCache.dispatched(analysis, _package->dataSet());
+	}
+
+	engine->runAnalysisOnProcess(analysis);
+}
+
 QProcess * EngineSync::startSlaveProcess(int no)
 {
 	QDir programDir = QFileInfo( QCoreApplication::applicationFilePath() ).absoluteDir();
@@ -28,12 +28,17 @@
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
 
 #include "enginerepresentation.h"
+#include "resultscache.h"
+#include "runscheduler.h"
 
 /* EngineSync is responsible for launching the background
  * processes, scheduling analyses, and for sending and
  * receiving communications with the running analyses.
  * It keeps track of which analyses are executing on
  * which background process.
+ * Besides the engines it starts itself it can use remote ones that already listen
+ * somewhere, those are listed in JASP_REMOTE_ENGINES as host:port,host:port, with the secret they
+ * were started with in JASP_ENGINE_SECRET, and only get analyses (see EngineRepresentation::canRun).
  */
 class EngineSync : public QObject
 {
@@ -43,17 +48,21 @@ public:
 	EngineSync(Analyses *analyses, DataSetPackage *package, QObject *parent);
 	~EngineSync();
 
-	void start();
+	void start(size_t engineCount = 0); ///< 0 starts the default number of engines
 
 	bool engineStarted()			{ return _engineStarted; }
+	const RunScheduler& scheduler()	const { return _scheduler; }
 	
 public slots:
 	void sendFilter(QString generatedFilter, QString filter, int requestID);
 	void sendRCode(QString rCode, int requestId);
 	void computeColumn(QString columnName, QString computeCode, Column::ColumnType columnType);
+	void clearResultsCache()		{ _resultsCache.clear(); }
+	void clearScheduler()			{ _scheduler.clear(); }	///< The analyses are gone, the next ones might get the same ids
+	void cacheLoadedResults();
 	
 signals:
-	void processNewFilterResult(std::vector<bool> filterResult, int requestID);
+	void processNewFilterResult(int requestID);
 	void processFilterErrorMsg(QString error, int requestID);
 	void engineTerminated();
 	void filterUpdated(int requestID);
@@ -67,6 +76,10 @@ private:
 	bool		idleEngineAvailable();
 	QProcess*	startSlaveProcess(int no);
 	void		processScriptQueue();
+	void		dispatch(EngineRepresentation *engine, Analysis *analysis);
+	void		addEngine(EngineRepresentation *engine);
+	void		connectRemoteEngines();
+	void		removeEngine(EngineRepresentation *engine);
 
 	Analyses		*_analyses;
 	bool			_engineStarted = false;
@@ -75,6 +88,8 @@ private:
 	std::queue<RScriptStore*>			_waitingScripts;
 	std::vector<EngineRepresentation*>	_engines;
 	RFilterStore						*_waitingFilter = nullptr;
+	ResultsCache						_resultsCache;
+	RunScheduler						_scheduler;
 
 
 	std::string _memoryName,
@@ -86,6 +101,8 @@ private slots:
 	void heartbeatTempFiles();
 
 	void process();
+	void restartEngine(EngineRepresentation * engine);
+	void analysisCompleted(Analysis * analysis);
 
 	void subProcessStandardOutput();
 	void subProcessStandardError();
@@ -0,0 +1,375 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "arrowexporter.h"
+
+#include "dataset.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+using namespace std;
+using namespace arrowipc;
+
+ArrowExporter::ArrowExporter(bool includeComputeColumns) : _includeComputeColumns(includeComputeColumns)
+{
+	_defaultFileType = Utils::arrow;
+	_allowedFileTypes.push_back(Utils::arrow);
+	_allowedFileTypes.push_back(Utils::feather);
+}
+
+ArrowExporter::ExportColumn::ExportColumn(Column *column)
+	: column(column)
+	, isScale(column->columnType() == Column::ColumnTypeScale)
+	, isText(column->columnType() == Column::ColumnTypeNominalText)
+	, ints(column->AsInts.begin())
+	, intsEnd(column->AsInts.end())
+	, doubles(column->AsDoubles.begin())
+	, doublesEnd(column->AsDoubles.end())
+{
+	if (!isText)
+		return;
+
+	Labels &labels = column->labels();
+
+	for (size_t l = 0; l < labels.size(); l++)
+	{
+		entryOfKey[labels[l].value()] = l;
+		dictionary.push_back(labels.getValueFromRow(l));
+	}
+}
+
+void ArrowExporter::saveDataSet(const std::string &path, DataSetPackage* package, boost::function<void (const std::string &, int)> progressCallback)
+{
+	DataSet *dataset = package->dataSet();
+
+	vector<ExportColumn> columns;
+
+	int columnCount = dataset->columnCount();
+	for (int i = 0; i < columnCount; i++)
+	{
+		Column &column = dataset->column(i);
+
+		if(!package->isColumnComputed(column.name()) || _includeComputeColumns)
+			columns.push_back(ExportColumn(&column));
+	}
+
+	boost::nowide::ofstream outfile(path.c_str(), ios::out | ios::binary);
+
+	if (!outfile.is_open())
+		throw runtime_error("Could not open '" + path + "' for writing.");
+
+	outfile.write("ARROW1\0\0", 8);
+
+	{
+		FlatBufferBuilder builder;
+		writeMessage(outfile, finishMessage(builder, MessageHeader::Schema, addSchema(builder, columns), 0), vector<ArrayBuffers>(), 0);
+	}
+
+	vector<Block> dictionaries, recordBatches;
+
+	// Every nominal text column has its own dictionary, its id is the number of the column.
+	for (size_t i = 0; i < columns.size(); i++)
+		if (columns[i].isText)
+		{
+			int64_t					bodyLength;
+			vector<ArrayBuffers>	arrays	= { dictionaryArray(columns[i]) };
+			FlatBufferBuilder		builder;
+			FlatBufferBuilder::Ref	data	= addRecordBatch(builder, columns[i].dictionary.size(), { { static_cast<int64_t>(columns[i].dictionary.size()), 0 } }, arrays, bodyLength);
+
+			builder.startTable();
+			builder.addScalar<int64_t>(DictionaryBatch::id, i);
+			builder.addRef(DictionaryBatch::data, data);
+
+			dictionaries.push_back(writeMessage(outfile, finishMessage(builder, MessageHeader::DictionaryBatch, builder.endTable(), bodyLength), arrays, bodyLength));
+		}
+
+	// The rows are written in record batches of a few million cells, so we only hold one of those in memory at a time.
+	size_t	rowCount		= dataset->rowCount(),
+			batchRows		= std::min<size_t>(1024 * 1024, std::max<size_t>(1024, 4 * 1024 * 1024 / std::max<size_t>(1, columns.size())));
+	int		lastProgress	= -1;
+
+	for (size_t firstRow = 0; firstRow < rowCount; firstRow += batchRows)
+	{
+		size_t					rows	= std::min(batchRows, rowCount - firstRow);
+		vector<ArrayBuffers>	arrays;
+		vector<FieldNode>		nodes;
+
+		for (ExportColumn &exportColumn : columns)
+		{
+			int64_t nullCount;
+			arrays.push_back(nextChunk(exportColumn, rows, nullCount));
+			nodes.push_back({ static_cast<int64_t>(rows), nullCount });
+		}
+
+		int64_t					bodyLength;
+		FlatBufferBuilder		builder;
+		FlatBufferBuilder::Ref	batch = addRecordBatch(builder, rows, nodes, arrays, bodyLength);
+
+		recordBatches.push_back(writeMessage(outfile, finishMessage(builder, MessageHeader::RecordBatch, batch, bodyLength), arrays, bodyLength));
+
+		int progress = 99 * (firstRow + rows) / rowCount;
+		if (progress != lastProgress)
+		{
+			progressCallback("Export Data Set", progress);
+			lastProgress = progress;
+		}
+	}
+
+	// The footer repeats the schema and tells where every batch is, that is what makes it a file instead of a stream.
+	FlatBufferBuilder		builder;
+	FlatBufferBuilder::Ref	schema			= addSchema(builder, columns),
+							dictionaryRefs	= builder.createStructVector(dictionaries),
+							batchRefs		= builder.createStructVector(recordBatches);
+
+	builder.startTable();
+	builder.addScalar<int16_t>(Footer::version, metadataVersionV5);
+	builder.addRef(Footer::schema, schema);
+	builder.addRef(Footer::dictionaries, dictionaryRefs);
+	builder.addRef(Footer::recordBatches, batchRefs);
+
+	string	footer			= builder.finish(builder.endTable());
+	int32_t	footerLength	= footer.size();
+
+	outfile.write(footer.data(), footer.size());
+	outfile.write(reinterpret_cast<const char *>(&footerLength), sizeof(footerLength));
+	outfile.write(fileMagic, fileMagicLength);
+	outfile.flush();
+
+	if (!outfile.good())
+		throw runtime_error("Could not write all of the data to '" + path + "'.");
+
+	outfile.close();
+
+	progressCallback("Export Data Set", 100);
+}
+
+/**
+ * @brief nextChunk Gives the next rows of a column as an Arrow array: a validity bitmap (left empty if there are no nulls) and the values.
+ */
+ArrowExporter::ArrayBuffers ArrowExporter::nextChunk(ExportColumn &exportColumn, size_t rows, int64_t &nullCount)
+{
+	string	validity((rows + 7) / 8, '\0'),
+			values;
+
+	nullCount = 0;
+	values.reserve(rows * (exportColumn.isScale ? sizeof(double) : sizeof(int32_t)));
+
+	for (size_t row = 0; row < rows; row++)
+	{
+		bool valid;
+
+		if (exportColumn.isScale)
+		{
+			double value = NAN;
+
+			if (exportColumn.doubles != exportColumn.doublesEnd)
+			{
+				value = *exportColumn.doubles;
+				++exportColumn.doubles;
+			}
+
+			valid = !std::isnan(value);
+			values.append(reinterpret_cast<const char *>(&value), sizeof(value));
+		}
+		else
+		{
+			int		key		= INT_MIN;
+			int32_t	value	= 0;
+
+			if (exportColumn.ints != exportColumn.intsEnd)
+			{
+				key = *exportColumn.ints;
+				++exportColumn.ints;
+			}
+
+			if (exportColumn.isText)
+			{
+				auto entry	= exportColumn.entryOfKey.find(key);
+				valid		= entry != exportColumn.entryOfKey.end();
+				value		= valid ? entry->second : 0;
+			}
+			else
+			{
+				valid		= key != INT_MIN;
+				value		= valid ? key : 0;
+			}
+
+			values.append(reinterpret_cast<const char *>(&value), sizeof(value));
+		}
+
+		if (valid)	validity[row >> 3] |= 1 << (row & 7);
+		else		nullCount++;
+	}
+
+	if (nullCount == 0)
+		validity.clear();
+
+	return { validity, values };
+}
+
+ArrowExporter::ArrayBuffers ArrowExporter::dictionaryArray(const ExportColumn &exportColumn)
+{
+	string			offsets,
+					data;
+	int32_t			offset = 0;
+
+	offsets.append(reinterpret_cast<const char *>(&offset), sizeof(offset));
+
+	for (const string &value : exportColumn.dictionary)
+	{
+		data	+= value;
+		offset	 = data.size();
+		offsets.append(reinterpret_cast<const char *>(&offset), sizeof(offset));
+	}
+
+	return { "", offsets, data };
+}
+
+FlatBufferBuilder::Ref ArrowExporter::addSchema(FlatBufferBuilder &builder, const vector<ExportColumn> &columns)
+{
+	vector<FlatBufferBuilder::Ref> fields;
+
+	for (size_t i = 0; i < columns.size(); i++)
+	{
+		const ExportColumn &exportColumn = columns[i];
+
+		FlatBufferBuilder::Ref	name		= builder.createString(exportColumn.column->name()),
+								children	= builder.createVector({}),
+								type,
+								dictionary	= 0;
+		Type					typeType;
+
+		builder.startTable();
+
+		if (exportColumn.isScale)
+		{
+			typeType = Type::FloatingPoint;
+			builder.addScalar<int16_t>(FloatingPointType::precision, static_cast<int16_t>(Precision::Double));
+			type = builder.endTable();
+		}
+		else if (!exportColumn.isText)
+		{
+			typeType = Type::Int;
+			builder.addScalar<int32_t>(IntType::bitWidth, 32);
+			builder.addScalar<uint8_t>(IntType::isSigned, 1);
+			type = builder.endTable();
+		}
+		else
+		{
+			typeType	= Type::Utf8;
+			type		= builder.endTable();
+
+			builder.startTable();
+			builder.addScalar<int32_t>(IntType::bitWidth, 32);
+			builder.addScalar<uint8_t>(IntType::isSigned, 1);
+			FlatBufferBuilder::Ref indexType = builder.endTable();
+
+			builder.startTable();
+			builder.addScalar<int64_t>(DictionaryEncoding::id, i);
+			builder.addRef(DictionaryEncoding::indexType, indexType);
+			dictionary = builder.endTable();
+		}
+
+		builder.startTable();
+		builder.addRef(Field::name, name);
+		builder.addScalar<uint8_t>(Field::nullable, 1);
+		builder.addScalar<uint8_t>(Field::typeType, static_cast<uint8_t>(typeType));
+		builder.addRef(Field::type, type);
+		if (dictionary != 0)
+			builder.addRef(Field::dictionary, dictionary);
+		builder.addRef(Field::children, children);
+
+		fields.push_back(builder.endTable());
+	}
+
+	FlatBufferBuilder::Ref fieldsRef = builder.createVector(fields);
+
+	builder.startTable();
+	builder.addRef(Schema::fields, fieldsRef);
+
+	return builder.endTable();
+}
+
+/**
+ * @brief addRecordBatch Adds the metadata of a record batch, every buffer of the arrays starts at a multiple of 8 bytes in the body.
+ */
+FlatBufferBuilder::Ref ArrowExporter::addRecordBatch(FlatBufferBuilder &builder, int64_t length, const vector<FieldNode> &nodes, const vector<ArrayBuffers> &arrays, int64_t &bodyLength)
+{
+	vector<Buffer> buffers;
+
+	bodyLength = 0;
+
+	for (const ArrayBuffers &array : arrays)
+		for (const string &buffer : array)
+		{
+			buffers.push_back({ bodyLength, static_cast<int64_t>(buffer.size()) });
+			bodyLength += padded(buffer.size());
+		}
+
+	FlatBufferBuilder::Ref	nodesRef	= builder.createStructVector(nodes),
+							buffersRef	= builder.createStructVector(buffers);
+
+	builder.startTable();
+	builder.addScalar<int64_t>(RecordBatch::length, length);
+	builder.addRef(RecordBatch::nodes, nodesRef);
+	builder.addRef(RecordBatch::buffers, buffersRef);
+
+	return builder.endTable();
+}
+
+string ArrowExporter::finishMessage(FlatBufferBuilder &builder, MessageHeader headerType, FlatBufferBuilder::Ref header, int64_t bodyLength)
+{
+	builder.startTable();
+	builder.addScalar<int16_t>(Message::version, metadataVersionV5);
+	builder.addScalar<uint8_t>(Message::headerType, static_cast<uint8_t>(headerType));
+	builder.addRef(Message::header, header);
+	builder.addScalar<int64_t>(Message::bodyLength, bodyLength);
+
+	return builder.finish(builder.endTable());
+}
+
+/**
+ * @brief writeMessage Writes a message: the continuation marker, the length of the metadata, the metadata and then the body with the buffers of the arrays.
+ * @return Where it is, for the footer.
+ */
+Block ArrowExporter::writeMessage(boost::nowide::ofstream &outfile, const string &metadata, const vector<ArrayBuffers> &arrays, int64_t bodyLength)
+{
+	static const char padding[8] = { 0 };
+
+	Block	block;
+	int32_t	metadataLength = metadata.size();
+
+	block.offset			= outfile.tellp();
+	block.metaDataLength	= sizeof(continuationMarker) + sizeof(metadataLength) + metadata.size();
+	block.padding			= 0;
+	block.bodyLength		= bodyLength;
+
+	outfile.write(reinterpret_cast<const char *>(&continuationMarker), sizeof(continuationMarker));
+	outfile.write(reinterpret_cast<const char *>(&metadataLength), sizeof(metadataLength));
+	outfile.write(metadata.data(), metadata.size());
+
+	for (const ArrayBuffers &array : arrays)
+		for (const string &buffer : array)
+		{
+			outfile.write(buffer.data(), buffer.size());
+			outfile.write(padding, padded(buffer.size()) - buffer.size());
+		}
+
+	return block;
+}
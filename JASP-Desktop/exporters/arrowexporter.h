@@ -0,0 +1,68 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ARROWEXPORTER_H
+#define ARROWEXPORTER_H
+
+#include "exporter.h"
+#include "column.h"
+#include "importers/arrow/arrowformat.h"
+#include "importers/arrow/flatbuffer.h"
+
+#include <boost/nowide/fstream.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+///Writes the data as an Arrow IPC file (.arrow, or .feather version 2): scale columns as doubles, nominal and ordinal ones as 32 bit integers and nominal text as a dictionary of strings.
+class ArrowExporter : public Exporter
+{
+public:
+	ArrowExporter(bool includeComputeColumns);
+	void saveDataSet(const std::string &path, DataSetPackage* package, boost::function<void (const std::string &, int)> progressCallback) OVERRIDE;
+
+private:
+	struct ExportColumn
+	{
+		ExportColumn(Column *column);
+
+		Column						*column;
+		bool						isScale,
+									isText;
+		std::vector<std::string>	dictionary;		///< For nominal text, the values of its labels
+		std::map<int, int>			entryOfKey;		///< and where each key is in there.
+		Column::Ints::iterator		ints,		intsEnd;
+		Column::Doubles::iterator	doubles,	doublesEnd;
+	};
+
+	///The buffers of one array, in the order of its type's layout.
+	typedef std::vector<std::string> ArrayBuffers;
+
+	ArrayBuffers	nextChunk(ExportColumn &exportColumn, size_t rows, int64_t &nullCount);
+	ArrayBuffers	dictionaryArray(const ExportColumn &exportColumn);
+
+	arrowipc::FlatBufferBuilder::Ref	addSchema(arrowipc::FlatBufferBuilder &builder, const std::vector<ExportColumn> &columns);
+	arrowipc::FlatBufferBuilder::Ref	addRecordBatch(arrowipc::FlatBufferBuilder &builder, int64_t length, const std::vector<arrowipc::FieldNode> &nodes, const std::vector<ArrayBuffers> &arrays, int64_t &bodyLength);
+
+	std::string		finishMessage(arrowipc::FlatBufferBuilder &builder, arrowipc::MessageHeader headerType, arrowipc::FlatBufferBuilder::Ref header, int64_t bodyLength);
+	arrowipc::Block	writeMessage(boost::nowide::ofstream &outfile, const std::string &metadata, const std::vector<ArrayBuffers> &arrays, int64_t bodyLength);
+
+	bool _includeComputeColumns;
+};
+
+#endif // ARROWEXPORTER_H
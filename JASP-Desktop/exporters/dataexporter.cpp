@@ -26,6 +26,13 @@
 
 #include <boost/nowide/fstream.hpp>
 
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+
 using namespace std;
 
 DataExporter::DataExporter(bool includeComputeColumns) : _includeComputeColumns(includeComputeColumns) {
@@ -34,69 +41,239 @@ DataExporter::DataExporter(bool includeComputeColumns) : _includeComputeColumns(
     _allowedFileTypes.push_back(Utils::txt);
 }
 
+DataExporter::ExportColumn::ExportColumn(Column *column)
+	: column(column)
+	, isScale(column->columnType() == Column::ColumnTypeScale)
+	, ints(column->AsInts.begin())
+	, intsEnd(column->AsInts.end())
+	, doubles(column->AsDoubles.begin())
+	, doublesEnd(column->AsDoubles.end())
+{
+}
+
 void DataExporter::saveDataSet(const std::string &path, DataSetPackage* package, boost::function<void (const std::string &, int)> progressCallback)
 {
+	// A .txt file gets tabs, which the csv importer recognizes as well.
+	_separator = _currentFileType == Utils::txt ? '\t' : ',';
 
-	boost::nowide::ofstream outfile(path.c_str(), ios::out);
+	// snprintf follows the locale Qt set up, the file should always get a '.' though.
+	_decimalPoint = localeconv()->decimal_point[0];
+
+	// Empty cells end up as "", just like they always have.
+	_emptyCell = escaped(Utils::emptyValue);
 
 	DataSet *dataset = package->dataSet();
 
 	std::vector<Column*> cols;
 
-	int columnCount = dataset->columnCount();
-	for (int i = 0; i < columnCount; i++)
+	if (_columnNames.size() > 0)
+	{
+		for (const std::string &name : _columnNames)
+		{
+			int index = dataset->getColumnIndex(name);
+
+			if (index < 0)
+				throw runtime_error("There is no column '" + name + "' to export.");
+
+			cols.push_back(&dataset->column(index));
+		}
+	}
+	else
 	{
-		Column &column = dataset->column(i);
-		string name = column.name();
+		int columnCount = dataset->columnCount();
+		for (int i = 0; i < columnCount; i++)
+		{
+			Column &column = dataset->column(i);
+			string name = column.name();
 
-		if(!package->isColumnComputed(name) || _includeComputeColumns)
-			cols.push_back(&column);
+			if(!package->isColumnComputed(name) || _includeComputeColumns)
+				cols.push_back(&column);
+		}
 	}
 
+	std::string buffer;
+	const size_t bufferSize = 1024 * 1024;
+	buffer.reserve(bufferSize + 64 * 1024);
 
 	for (size_t i = 0; i < cols.size(); i++)
 	{
-		Column *column		= cols[i];
-		std::string name	= column->name();
+		buffer += escaped(cols[i]->name());
+		buffer += i < cols.size()-1 ? _separator : '\n';
+	}
+
+	size_t	firstRow	= std::min(_firstRow, (size_t)dataset->rowCount()),
+			endRow		= std::max(firstRow, std::min(_endRow, (size_t)dataset->rowCount()));
 
-		if (escapeValue(name))	outfile << '"' << name << '"';
-		else					outfile << name;
+	// The escaped values of the labels are worked out once, instead of once per cell.
+	std::vector<ExportColumn> exportColumns;
+	exportColumns.reserve(cols.size());
+
+	for (Column *column : cols)
+	{
+		exportColumns.push_back(ExportColumn(column));
+		ExportColumn &exportColumn = exportColumns.back();
 
-		if (i < cols.size()-1)	outfile << ",";
-		else					outfile << "\n";
+		if (!exportColumn.isScale)
+		{
+			Labels &labels = column->labels();
+			for (size_t l = 0; l < labels.size(); l++)
+			{
+				std::string value = labels.getValueFromRow(l);
+				exportColumn.values[labels[l].value()] = value == "." ? "" : escaped(value);
+			}
 
+			for (size_t r = 0; r < firstRow && exportColumn.ints != exportColumn.intsEnd; r++)
+				++exportColumn.ints;
+		}
+		else
+			for (size_t r = 0; r < firstRow && exportColumn.doubles != exportColumn.doublesEnd; r++)
+				++exportColumn.doubles;
 	}
 
-	size_t rowCount = dataset->rowCount();
+	boost::nowide::ofstream outfile(path.c_str(), ios::out);
+
+	if (!outfile.is_open())
+		throw runtime_error("Could not open '" + path + "' for writing.");
+
+	// The cells are formatted a column at a time, for a chunk of rows, and then put in the buffer row by row.
+	const size_t	chunkRows		= 1024;
+	int				lastProgress	= -1;
+
+	for (size_t chunkStart = firstRow; chunkStart < endRow; chunkStart += chunkRows)
+	{
+		size_t chunkEnd = std::min(endRow, chunkStart + chunkRows);
+
+		for (ExportColumn &exportColumn : exportColumns)
+			formatCells(exportColumn, chunkStart, chunkEnd);
 
-	for (size_t r = 0; r < rowCount; r++)
-		for (size_t i = 0; i < cols.size(); i++)
+		for (size_t r = 0; r < chunkEnd - chunkStart; r++)
 		{
-			Column *column = cols[i];
+			for (size_t i = 0; i < exportColumns.size(); i++)
+			{
+				const ExportColumn	&exportColumn	= exportColumns[i];
+				size_t				cellStart		= r == 0 ? 0 : exportColumn.cellEnds[r - 1];
+
+				buffer.append(exportColumn.cells, cellStart, exportColumn.cellEnds[r] - cellStart);
+
+				if (i < exportColumns.size()-1)			buffer += _separator;
+				else if (chunkStart + r != endRow-1)	buffer += '\n';
+			}
 
-			string value = column->getOriginalValue(r);
-			if (value != ".")
+			if (buffer.size() >= bufferSize)
 			{
-				if (escapeValue(value))	outfile << '"' << value << '"';
-				else					outfile << value;
+				outfile.write(buffer.data(), buffer.size());
+				buffer.clear();
 			}
+		}
 
-			if (i < cols.size()-1)		outfile << ",";
-			else if (r != rowCount-1)	outfile << "\n";
+		int progress = 99 * (chunkEnd - firstRow) / (endRow - firstRow);
+		if (progress != lastProgress)
+		{
+			progressCallback("Export Data Set", progress);
+			lastProgress = progress;
 		}
+	}
 
+	outfile.write(buffer.data(), buffer.size());
 	outfile.flush();
+
+	if (!outfile.good())
+		throw runtime_error("Could not write all of the data to '" + path + "'.");
+
 	outfile.close();
 
 	progressCallback("Export Data Set", 100);
 }
 
+// Writes the cells of the rows from firstRow up to endRow into exportColumn.cells, the same as getOriginalValue would give them but escaped.
+void DataExporter::formatCells(ExportColumn &exportColumn, size_t firstRow, size_t endRow)
+{
+	exportColumn.cells.clear();
+	exportColumn.cellEnds.clear();
+
+	for (size_t row = firstRow; row < endRow; row++)
+	{
+		if (exportColumn.isScale ? exportColumn.doubles == exportColumn.doublesEnd : exportColumn.ints == exportColumn.intsEnd)
+			exportColumn.cells += _emptyCell;
+
+		else if (exportColumn.isScale)
+		{
+			double value = *exportColumn.doubles;
+			++exportColumn.doubles;
+
+			if (value > DBL_MAX)					exportColumn.cells += "\xE2\x88\x9E";
+			else if (value < -DBL_MAX)				exportColumn.cells += "-\xE2\x88\x9E";
+			else if (Column::isEmptyValue(value))	exportColumn.cells += _emptyCell;
+			else									formatDouble(value, exportColumn.cells);
+		}
+		else
+		{
+			int key = *exportColumn.ints;
+			++exportColumn.ints;
+
+			auto value = exportColumn.values.find(key);
+
+			if (key == INT_MIN)								exportColumn.cells += _emptyCell;
+			else if (value != exportColumn.values.end())	exportColumn.cells += value->second;
+			else
+			{
+				std::string original = exportColumn.column->getOriginalValue(row);
+				if (original != ".")
+					exportColumn.cells += escaped(original);
+			}
+		}
+
+		exportColumn.cellEnds.push_back(exportColumn.cells.size());
+	}
+}
+
+// Gives the same as "std::ostream << value" does, without creating a stream for every value.
+void DataExporter::formatDouble(double value, std::string &to)
+{
+	if (value == std::floor(value) && std::fabs(value) < 1e6 && !(value == 0 && std::signbit(value)))
+	{
+		char	digits[8];
+		int		count		= 0;
+		long	intValue	= static_cast<long>(std::fabs(value));
+
+		do
+		{
+			digits[count++] = '0' + intValue % 10;
+			intValue /= 10;
+		}
+		while (intValue > 0);
+
+		if (value < 0)
+			to += '-';
+
+		while (count > 0)
+			to += digits[--count];
+
+		return;
+	}
+
+	char formatted[32];
+	int length = snprintf(formatted, sizeof(formatted), "%g", value);
+
+	if (_decimalPoint != '.')
+		std::replace(formatted, formatted + length, _decimalPoint, '.');
+
+	to.append(formatted, length);
+}
+
+std::string DataExporter::escaped(std::string value)
+{
+	if (escapeValue(value))
+		return '"' + value + '"';
+
+	return value;
+}
 
 bool DataExporter::escapeValue(std::string &value)
 {
 	bool useQuotes = false;
-	std::size_t found = value.find(",");
-	if (found != std::string::npos)
+	std::size_t found = value.find_first_of(",\n\r");
+	if (found != std::string::npos || value.find(_separator) != std::string::npos)
 		useQuotes = true;
 
 	if (value.find_first_of(" \n\r\t\v\f") == 0)
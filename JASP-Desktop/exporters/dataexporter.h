@@ -19,6 +19,10 @@
 #define DATAEXPORTER_H
 
 #include "exporter.h"
+#include "column.h"
+
+#include <unordered_map>
+#include <limits>
 
 class DataExporter : public Exporter
 {
@@ -26,9 +30,42 @@ public:
 	DataExporter(bool includeComputeColumns);
 	void saveDataSet(const std::string &path, DataSetPackage* package, boost::function<void (const std::string &, int)> progressCallback) OVERRIDE;
 
+	// Only export the rows from firstRow up to (but not including) endRow, by default all of them are exported.
+	void setRowRange(size_t firstRow, size_t endRow)				{ _firstRow = firstRow; _endRow = endRow; }
+	// Only export these columns, in this order, by default all columns are exported. saveDataSet throws when one of them doesn't exist.
+	void setColumns(const std::vector<std::string> &columnNames)	{ _columnNames = columnNames; }
+
+	// Doubles the quotes in value and tells whether it needs quotes around it: when it has the separator, a line break or a quote in it, or starts or ends with whitespace.
+	// Line breaks weren't quoted before, which broke the row they were in, so only such values are exported differently than they used to be.
 	bool escapeValue(std::string &value);
 
 	bool _includeComputeColumns;
+
+private:
+	// The cells of one column for the rows that are being exported, formatted just once per chunk of rows.
+	struct ExportColumn
+	{
+		ExportColumn(Column *column);
+
+		Column									*column;
+		bool									 isScale;
+		Column::Ints::iterator					 ints,		intsEnd;
+		Column::Doubles::iterator				 doubles,	doublesEnd;
+		std::unordered_map<int, std::string>	 values;	// The escaped value per key, for the columns that are not scale
+		std::string								 cells;		// The formatted cells, one after the other
+		std::vector<size_t>						 cellEnds;
+	};
+
+	void formatCells(ExportColumn &exportColumn, size_t firstRow, size_t endRow);
+	void formatDouble(double value, std::string &to);
+	std::string escaped(std::string value);
+
+	std::vector<std::string>	_columnNames;
+	size_t						_firstRow	= 0,
+								_endRow		= std::numeric_limits<size_t>::max();
+	std::string					_emptyCell;
+	char						_separator	= ',',
+								_decimalPoint;
 };
 
 #endif // DATAEXPORTER_H
@@ -24,10 +24,8 @@
 
 #include "dataset.h"
 
-#include "libzip/archive.h"
-#include "libzip/archive_entry.h"
+#include "ziparchivewriter.h"
 #include "jsonredirect.h"
-#include "filereader.h"
 #include "version.h"
 #include "tempfiles.h"
 #include "appinfo.h"
@@ -44,38 +42,21 @@ JASPExporter::JASPExporter() {
 
 void JASPExporter::saveDataSet(const std::string &path, DataSetPackage* package, boost::function<void (const std::string &, int)> progressCallback)
 {
-	struct archive *a;
+	ZipArchiveWriter archive(path);
 
-	a = archive_write_new();
-	archive_write_set_format_zip(a);
+	saveDataArchive(archive, package, progressCallback);
+	saveJASPArchive(archive, package, progressCallback);
 
-#ifdef __WIN32__
-	int errorCode = archive_write_open_filename_w(a, boost::nowide::widen(path.c_str()).c_str());
-#else
-	int errorCode = archive_write_open_filename(a, path.c_str());
-#endif
-
-	if (errorCode != ARCHIVE_OK)
-		throw std::runtime_error("File could not be opened.");
-
-	saveDataArchive(a, package, progressCallback);
-	saveJASPArchive(a, package, progressCallback);
-
-	errorCode = archive_write_close(a);
-	if (errorCode != ARCHIVE_OK)
-		throw std::runtime_error("File could not be closed.");
-
-	errorCode = archive_write_free(a);
+	// The entries are only compressed now, data.bin included, that takes the last three quarters of the progress
+	archive.close([&](int percentage) { progressCallback("Saving Data Set", 25 + 3 * percentage / 4); });
 
 	progressCallback("Saving Data Set", 100);
 }
 
 
-void JASPExporter::saveDataArchive(archive *a, DataSetPackage *package, boost::function<void (const std::string &, int)> progressCallback)
+void JASPExporter::saveDataArchive(ZipArchiveWriter &archive, DataSetPackage *package, boost::function<void (const std::string &, int)> progressCallback)
 {
-	createJARContents(a);
-
-	struct archive_entry *entry;
+	createJARContents(archive);
 
 	DataSet *dataset = package->dataSet();
 
@@ -119,8 +100,6 @@ void JASPExporter::saveDataArchive(archive *a, DataSetPackage *package, boost::f
 
 	Json::Value columnsData = Json::arrayValue;
 
-	//Calculate size of data file that'll be added to the archive////////
-	int dataSize = 0;
 	int columnCount = dataset ? dataset->columnCount() : 0;
 	for (int i = 0; i < columnCount; i++)
 	{
@@ -133,12 +112,10 @@ void JASPExporter::saveDataArchive(archive *a, DataSetPackage *package, boost::f
 		if (column.columnType()			!= Column::ColumnTypeScale)
 		{
 			columnMetaData["type"] = Json::Value("integer");
-			dataSize += sizeof(int) * dataset->rowCount();
 		}
 		else
 		{
 			columnMetaData["type"] = Json::Value("number");
-			dataSize += sizeof(double) * dataset->rowCount();
 		}
 
 
@@ -177,7 +154,7 @@ void JASPExporter::saveDataArchive(archive *a, DataSetPackage *package, boost::f
 
 		columnsData.append(columnMetaData);
 
-		progress = 49 * (i / columnCount);
+		progress = 24 * (i / columnCount);
 		if (progress != lastProgress)
 		{
 			progressCallback("Saving Meta Data", progress);
@@ -186,193 +163,89 @@ void JASPExporter::saveDataArchive(archive *a, DataSetPackage *package, boost::f
 	}
 	dataSet["fields"]		= columnsData;
 
-	//Create new entry for archive
-	std::string metaDataString	= metaData.toStyledString();
-	int sizeOfMetaData			= metaDataString.size();
-	entry						= archive_entry_new();
-	std::string dd2				= std::string("metadata.json");
-
-	archive_entry_set_pathname(entry, dd2.c_str());
-	archive_entry_set_size(entry, sizeOfMetaData);
-	archive_entry_set_filetype(entry, AE_IFREG);
-	archive_entry_set_perm(entry, 0644); // Not sure what this does
-	archive_write_header(a, entry);
-
-	archive_write_data(a, metaDataString.c_str(), sizeOfMetaData);
-
-	archive_entry_free(entry);
-
-
-	//Create new entry for archive
-	std::string labelDataString = labelsData.toStyledString();
-	int sizeOflabelData = labelDataString.size();
-
-	entry = archive_entry_new();
-	std::string dd9 = std::string("xdata.json");
-	archive_entry_set_pathname(entry, dd9.c_str());
-	archive_entry_set_size(entry, sizeOflabelData);
-	archive_entry_set_filetype(entry, AE_IFREG);
-	archive_entry_set_perm(entry, 0644); // Not sure what this does
-	archive_write_header(a, entry);
-
-	archive_write_data(a, labelDataString.c_str(), sizeOflabelData);
-
-	archive_entry_free(entry);
-
-
-	//Create new entry for archive NOTE: must be done before data is added
-	entry = archive_entry_new();
-	std::string dd = std::string("data.bin");
-	archive_entry_set_pathname(entry, dd.c_str());
-	archive_entry_set_size(entry, dataSize);
-	archive_entry_set_filetype(entry, AE_IFREG);
-	archive_entry_set_perm(entry, 0644); // Not sure what this does
-	archive_write_header(a, entry);
+	archive.addEntry("metadata.json",	metaData.toStyledString());
+	archive.addEntry("xdata.json",		labelsData.toStyledString());
 
-	//Data data to archive
-
-	for (int i = 0; i < columnCount; i++)
+	// data.bin is passed to the archive in pieces whenever it asks for it, rather than copying all of the data set into one string first
+	archive.addStream("data.bin", [dataset, columnCount](const ZipArchiveWriter::Sink &sink)
 	{
-		Column &column = dataset->column(i);
+		const size_t	pieceSize	= 1 << 20;
+		std::string		piece;
 
-		if (column.columnType() != Column::ColumnTypeScale)
+		piece.reserve(pieceSize + sizeof(double));
+
+		for (int i = 0; i < columnCount; i++)
 		{
-			for (Column::Ints::iterator iter = column.AsInts.begin(); iter != column.AsInts.end(); iter++)
+			Column &column = dataset->column(i);
+
+			if (column.columnType() != Column::ColumnTypeScale)
 			{
-				int value = *iter;
-				archive_write_data(a, (const char*)(&value), sizeof(int));
+				for (Column::Ints::iterator iter = column.AsInts.begin(); iter != column.AsInts.end(); iter++)
+				{
+					int value = *iter;
+					piece.append((const char*)(&value), sizeof(int));
+
+					if (piece.size() >= pieceSize)
+					{
+						sink(piece.data(), piece.size());
+						piece.clear();
+					}
+				}
 			}
-		}
-		else
-		{
-			for (Column::Doubles::iterator iter = column.AsDoubles.begin(); iter != column.AsDoubles.end(); iter++)
+			else
 			{
-				double value = *iter;
-				archive_write_data(a, (const char*)(&value), sizeof(double));
-			}
-		}
+				for (Column::Doubles::iterator iter = column.AsDoubles.begin(); iter != column.AsDoubles.end(); iter++)
+				{
+					double value = *iter;
+					piece.append((const char*)(&value), sizeof(double));
 
-		progress = 49 + 50 * (i / columnCount);
-		if (progress != lastProgress)
-		{
-			progressCallback("Saving Data Set", progress);
-			lastProgress = progress;
+					if (piece.size() >= pieceSize)
+					{
+						sink(piece.data(), piece.size());
+						piece.clear();
+					}
+				}
+			}
 		}
-	}
-
-	archive_entry_free(entry);
-
-	//Create new entry for archive: HTML results
-	std::string html = package->analysesHTML();
-	int htmlSize = html.size();
-	entry = archive_entry_new();
-	std::string dd3 = std::string("index.html");
-	archive_entry_set_pathname(entry, dd3.c_str());
-	archive_entry_set_size(entry, htmlSize);
-	archive_entry_set_filetype(entry, AE_IFREG);
-	archive_entry_set_perm(entry, 0644); // Not sure what this does
-	archive_write_header(a, entry);
-
-	int ws = archive_write_data(a, html.c_str(), htmlSize);
-	if (ws != htmlSize)
-		throw std::runtime_error("Can't save jasp archive writing ERROR");
 
-	archive_entry_free(entry);
+		sink(piece.data(), piece.size());
+	});
 
+	archive.addEntry("index.html",	package->analysesHTML());
 }
 
-void JASPExporter::saveJASPArchive(archive *a, DataSetPackage *package, boost::function<void (const std::string &, int)> progressCallback)
+void JASPExporter::saveJASPArchive(ZipArchiveWriter &archive, DataSetPackage *package, boost::function<void (const std::string &, int)> progressCallback)
 {
 	if (package->hasAnalyses())
 	{
-		struct archive_entry *entry;
-
 		const Json::Value &analysesJson = package->analysesData();
 
-		//Create new entry for archive NOTE: must be done before data is added
-		std::string analysesString = analysesJson.toStyledString();
-		int sizeOfAnalysesString = analysesString.size();
-
-		entry = archive_entry_new();
-		std::string dd4 = std::string("analyses.json");
-		archive_entry_set_pathname(entry, dd4.c_str());
-		archive_entry_set_size(entry, sizeOfAnalysesString);
-		archive_entry_set_filetype(entry, AE_IFREG);
-		archive_entry_set_perm(entry, 0644); // Not sure what this does
-		archive_write_header(a, entry);
-
-		archive_write_data(a, analysesString.c_str(), sizeOfAnalysesString);
-
-		archive_entry_free(entry);
-
-		char imagebuff[8192];
+		archive.addEntry("analyses.json", analysesJson.toStyledString());
 
 		Json::Value analysesDataList = analysesJson;
 		if (!analysesDataList.isArray())
 			analysesDataList = analysesJson["analyses"];
 
+		// The images and state files are read when they are compressed, a file that is gone by then is left out like before
 		for (Json::Value::iterator iter = analysesDataList.begin(); iter != analysesDataList.end(); iter++)
 		{
 			Json::Value &analysisJson = *iter;
 			std::vector<std::string> paths = tempfiles_retrieveList(analysisJson["id"].asInt());
 			for (size_t j = 0; j < paths.size(); j++)
-			{
-				FileReader fileInfo = FileReader(tempfiles_sessionDirName() + "/" + paths[j]);
-				if (fileInfo.exists())
-				{
-					int imageSize = fileInfo.size();
-
-					entry = archive_entry_new();
-					std::string dd4 = paths[j];
-					archive_entry_set_pathname(entry, dd4.c_str());
-					archive_entry_set_size(entry, imageSize);
-					archive_entry_set_filetype(entry, AE_IFREG);
-					archive_entry_set_perm(entry, 0644); // Not sure what this does
-					archive_write_header(a, entry);
-
-					int bytes = 0;
-					int errorCode = 0;
-					while ((bytes = fileInfo.readData(imagebuff, sizeof(imagebuff), errorCode)) > 0 && errorCode == 0) {
-						archive_write_data(a, imagebuff, bytes);
-					}
-
-					archive_entry_free(entry);
-
-					if (errorCode < 0)
-						throw std::runtime_error("Required resource files could not be accessed.");
-				}
-				fileInfo.close();
-			}
+				archive.addFile(paths[j], tempfiles_sessionDirName() + "/" + paths[j]);
 		}
 	}
 }
 
-void JASPExporter::createJARContents(archive *a)
+void JASPExporter::createJARContents(ZipArchiveWriter &archive)
 {
-	struct archive_entry *entry = archive_entry_new();
-
 	std::stringstream manifestStream;
 	manifestStream << "Manifest-Version: 1.0" << "\n";
 	manifestStream << "Created-By: " << AppInfo::getShortDesc() << "\n";
 	manifestStream << "Data-Archive-Version: " << dataArchiveVersion.asString() << "\n";
 	manifestStream << "JASP-Archive-Version: " << jaspArchiveVersion.asString() << "\n";
 
-	manifestStream.flush();
-
-	const std::string& tmp	= manifestStream.str();
-	int manifestSize		= tmp.size();
-	const char* manifest	= tmp.c_str();
-
-	std::string f1 = std::string("META-INF/MANIFEST.MF");
-	archive_entry_set_pathname(entry, f1.c_str());
-	archive_entry_set_size(entry, manifestSize);
-	archive_entry_set_filetype(entry, AE_IFREG);
-	archive_entry_set_perm(entry, 0644); // Not sure what this does
-	archive_write_header(a, entry);
-
-	archive_write_data(a, manifest, manifestSize);
-
-	archive_entry_free(entry);
+	archive.addEntry("META-INF/MANIFEST.MF", manifestStream.str());
 }
 
 
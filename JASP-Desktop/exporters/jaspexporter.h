@@ -20,7 +20,7 @@
 
 #include "exporter.h"
 
-#include "libzip/archive.h"
+#include "ziparchivewriter.h"
 
 class JASPExporter: public Exporter
 {
@@ -32,10 +32,10 @@ public:
 	void saveDataSet(const std::string &path, DataSetPackage* package, boost::function<void (const std::string &, int)> progressCallback) OVERRIDE;
 
 private:
-	static void saveDataArchive(archive *a, DataSetPackage *package, boost::function<void (const std::string &, int)> progressCallback);
-	static void saveJASPArchive(archive *a, DataSetPackage *package, boost::function<void (const std::string &, int)> progressCallback);
+	static void saveDataArchive(ZipArchiveWriter &archive, DataSetPackage *package, boost::function<void (const std::string &, int)> progressCallback);
+	static void saveJASPArchive(ZipArchiveWriter &archive, DataSetPackage *package, boost::function<void (const std::string &, int)> progressCallback);
 
-	static void createJARContents(archive *a);
+	static void createJARContents(ZipArchiveWriter &archive);
 	static std::string getColumnTypeName(Column::ColumnType columnType);
 };
 
@@ -0,0 +1,582 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "ziparchivewriter.h"
+
+#include <zlib.h>
+#include <algorithm>
+#include <ctime>
+#include <memory>
+#include <stdexcept>
+
+#include <QCryptographicHash>
+
+#include "utils.h"
+#include "parallel.h"
+
+using namespace std;
+
+static const uint32_t	localHeaderSignature		= 0x04034b50,
+						centralHeaderSignature		= 0x02014b50,
+						endSignature				= 0x06054b50,
+						zip64EndSignature			= 0x06064b50,
+						zip64LocatorSignature		= 0x07064b50,
+						noFit32						= 0xFFFFFFFF;
+static const uint16_t	noFit16						= 0xFFFF,
+						zip64ExtraId				= 0x0001,
+						hashExtraId					= 0x4A53,	///< Not a registered one, other readers skip it
+						utf8Names					= 1 << 11,
+						methodStored				= 0,
+						methodDeflate				= 8,
+						madeByUnix					= 3 << 8;
+
+static void put16(string &to, uint16_t value) { for (int i = 0; i < 2; i++) to.push_back(char(value >> (8 * i))); }
+static void put32(string &to, uint32_t value) { for (int i = 0; i < 4; i++) to.push_back(char(value >> (8 * i))); }
+static void put64(string &to, uint64_t value) { for (int i = 0; i < 8; i++) to.push_back(char(value >> (8 * i))); }
+
+static uint64_t get(const string &from, size_t pos, int bytes)
+{
+	if (pos + bytes > from.size())
+		throw runtime_error("The zip archive ends too soon.");
+
+	uint64_t value = 0;
+	for (int i = bytes - 1; i >= 0; i--)
+		value = (value << 8) | uint8_t(from[pos + i]);
+
+	return value;
+}
+
+static uint16_t	get16(const string &from, size_t pos) { return uint16_t(get(from, pos, 2)); }
+static uint32_t	get32(const string &from, size_t pos) { return uint32_t(get(from, pos, 4)); }
+static uint64_t	get64(const string &from, size_t pos) { return get(from, pos, 8); }
+
+static string readAt(istream &from, uint64_t pos, size_t bytes)
+{
+	string read(bytes, '\0');
+
+	from.clear();
+	from.seekg(streamoff(pos));
+	from.read(&read[0], streamsize(bytes));
+
+	if (size_t(from.gcount()) != bytes)
+		throw runtime_error("The zip archive ends too soon.");
+
+	return read;
+}
+
+ZipArchiveWriter::ZipArchiveWriter(const string &path) : _path(path), _partPath(path + ".part")
+{
+	_file.open(_partPath.c_str(), ios::out | ios::trunc | ios::binary);
+
+	if (!_file.is_open())
+		throw runtime_error("File could not be opened.");
+
+	time_t	now		= time(NULL);
+	tm		*local	= localtime(&now);
+
+	_dosTime = uint16_t((local->tm_hour << 11) | (local->tm_min << 5) | (local->tm_sec / 2));
+	_dosDate = uint16_t(((local->tm_year - 80) << 9) | ((local->tm_mon + 1) << 5) | local->tm_mday);
+
+	readPreviousArchive();
+}
+
+ZipArchiveWriter::~ZipArchiveWriter()
+{
+	if (!_closed)
+	{
+		_file.close();
+		Utils::removeFile(_partPath); // whatever was there before is left as it was
+	}
+}
+
+void ZipArchiveWriter::addEntry(const string &name, string contents)
+{
+	std::shared_ptr<string> kept = std::make_shared<string>();
+	kept->swap(contents);
+
+	addStream(name, [kept](const Sink &sink) { sink(kept->data(), kept->size()); });
+}
+
+void ZipArchiveWriter::addStream(const string &name, Producer producer)
+{
+	_entries.push_back(Entry());
+	_entries.back().name		= name;
+	_entries.back().producer	= producer;
+}
+
+void ZipArchiveWriter::addFile(const string &name, const string &filePath)
+{
+	addStream(name, [filePath](const Sink &sink)
+	{
+		boost::nowide::ifstream file(filePath.c_str(), ios::in | ios::binary);
+
+		if (!file.is_open())
+			throw runtime_error("Required resource files could not be accessed.");
+
+		string piece(1 << 20, '\0');
+
+		while (file.read(&piece[0], streamsize(piece.size())) || file.gcount() > 0)
+			sink(piece.data(), size_t(file.gcount()));
+
+		if (file.bad())
+			throw runtime_error("Required resource files could not be accessed.");
+	});
+
+	_entries.back().filePath = filePath;
+}
+
+// Only the entries that were written with a hash can be reused, an archive that can't be read is simply not used at all.
+void ZipArchiveWriter::readPreviousArchive()
+{
+	_previousFile.open(_path.c_str(), ios::in | ios::binary);
+
+	if (!_previousFile.is_open())
+		return;
+
+	try
+	{
+		_previousFile.seekg(0, ios::end);
+
+		uint64_t	fileSize	= uint64_t(_previousFile.tellg()),
+					tailSize	= std::min<uint64_t>(fileSize, 22 + 65535);
+		string		tail		= readAt(_previousFile, fileSize - tailSize, tailSize);
+		size_t		end			= tail.rfind(string("PK\5\6", 4));
+
+		if (end == string::npos)
+			throw runtime_error("No end of central directory");
+
+		uint64_t	entries		= get16(tail, end + 10),
+					cdSize		= get32(tail, end + 12),
+					cdOffset	= get32(tail, end + 16);
+
+		if (entries == noFit16 || cdSize == noFit32 || cdOffset == noFit32)
+		{
+			if (end < 20 || get32(tail, end - 20) != zip64LocatorSignature)
+				throw runtime_error("No zip64 end of central directory locator");
+
+			string zip64End = readAt(_previousFile, get64(tail, end - 20 + 8), 56);
+
+			if (get32(zip64End, 0) != zip64EndSignature)
+				throw runtime_error("No zip64 end of central directory");
+
+			entries		= get64(zip64End, 32);
+			cdSize		= get64(zip64End, 40);
+			cdOffset	= get64(zip64End, 48);
+		}
+
+		string cd = readAt(_previousFile, cdOffset, cdSize);
+
+		for (size_t pos = 0, entry = 0; entry < entries; entry++)
+		{
+			if (get32(cd, pos) != centralHeaderSignature)
+				throw runtime_error("Damaged central directory");
+
+			PreviousEntry	previous;
+			uint16_t		method		= get16(cd, pos + 10),
+							nameSize	= get16(cd, pos + 28),
+							extraSize	= get16(cd, pos + 30),
+							commentSize	= get16(cd, pos + 32);
+			string			hash;
+
+			previous.deflated		= method == methodDeflate;
+			previous.crc			= get32(cd, pos + 16);
+			previous.compressedSize	= get32(cd, pos + 20);
+			previous.size			= get32(cd, pos + 24);
+			previous.offset			= get32(cd, pos + 42);
+
+			for (size_t extra = pos + 46 + nameSize; extra + 4 <= pos + 46 + nameSize + extraSize; )
+			{
+				uint16_t	id		= get16(cd, extra),
+							size	= get16(cd, extra + 2);
+				size_t		field	= extra + 4;
+
+				if (id == zip64ExtraId)
+				{
+					if (previous.size			== noFit32)	{ previous.size				= get64(cd, field); field += 8; }
+					if (previous.compressedSize	== noFit32)	{ previous.compressedSize	= get64(cd, field); field += 8; }
+					if (previous.offset			== noFit32)	{ previous.offset			= get64(cd, field); field += 8; }
+				}
+				else if (id == hashExtraId && size == 20)
+					hash = cd.substr(field, 20);
+
+				extra += 4 + size;
+			}
+
+			if (hash.size() == 20 && (method == methodStored || method == methodDeflate))
+				_previous[hash] = previous;
+
+			pos += 46 + nameSize + extraSize + commentSize;
+		}
+	}
+	catch (exception &)
+	{
+		_previous.clear();
+	}
+
+	if (_previous.empty())
+		_previousFile.close();
+}
+
+bool ZipArchiveWriter::worthCompressing(const string &name)
+{
+	string extension = name.substr(std::min(name.size(), name.rfind('.')));
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+	return extension != ".png" && extension != ".jpg" && extension != ".jpeg" && extension != ".gif" && extension != ".zip" && extension != ".gz" && extension != ".jasp";
+}
+
+uint32_t ZipArchiveWriter::crc32Of(uint32_t crc, const char *data, size_t size)
+{
+	const size_t chunk = 1 << 30;
+
+	for (size_t pos = 0; pos < size; pos += chunk)
+		crc = uint32_t(crc32(crc, reinterpret_cast<const Bytef *>(data + pos), uInt(std::min(chunk, size - pos))));
+
+	return crc;
+}
+
+namespace
+{
+	/// Raw deflate, as zip wants it, of contents that come in pieces.
+	class Deflater
+	{
+	public:
+		Deflater()
+		{
+			_stream.zalloc	= Z_NULL;
+			_stream.zfree	= Z_NULL;
+			_stream.opaque	= Z_NULL;
+
+			if (deflateInit2(&_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+				throw runtime_error("Could not start compressing.");
+		}
+
+		~Deflater() { deflateEnd(&_stream); }
+
+		void add(const char *data, size_t size)	{ deflateSome(data, size, Z_NO_FLUSH); }
+		string &finish()						{ deflateSome(NULL, 0, Z_FINISH); return _compressed; }
+
+	private:
+		void deflateSome(const char *data, size_t size, int flush)
+		{
+			const size_t chunk = 1 << 20;
+			size_t in = 0;
+
+			do
+			{
+				size_t inNow = std::min(chunk, size - in);
+
+				_stream.next_in		= reinterpret_cast<Bytef *>(const_cast<char *>(data + in));
+				_stream.avail_in	= uInt(inNow);
+
+				do // until deflate leaves room in the output, which means it took all of the input (and finished, if it had to)
+				{
+					size_t out = _compressed.size();
+					_compressed.resize(out + chunk);
+
+					_stream.next_out	= reinterpret_cast<Bytef *>(&_compressed[out]);
+					_stream.avail_out	= uInt(chunk);
+
+					if (deflate(&_stream, in + inNow == size ? flush : Z_NO_FLUSH) == Z_STREAM_ERROR)
+						throw runtime_error("Could not compress.");
+
+					_compressed.resize(out + chunk - _stream.avail_out);
+				}
+				while (_stream.avail_out == 0);
+
+				in += inNow;
+			}
+			while (in < size);
+		}
+
+		z_stream	_stream;
+		string		_compressed;
+	};
+}
+
+/// Looks the hash of the entry up in the previous archive.
+bool ZipArchiveWriter::reuse(Entry &entry) const
+{
+	auto previous = _previous.find(entry.hash);
+
+	if (previous == _previous.end())
+		return false;
+
+	entry.reused			= true;
+	entry.deflated			= previous->second.deflated;
+	entry.crc				= previous->second.crc;
+	entry.size				= previous->second.size;
+	entry.compressedSize	= previous->second.compressedSize;
+	entry.previousOffset	= previous->second.offset;
+
+	return true;
+}
+
+/// Runs on a worker thread: hashes the entry and compresses it, unless the previous archive has it already.
+void ZipArchiveWriter::prepare(Entry &entry) const
+{
+	if (!entry.filePath.empty() && Utils::getFileSize(entry.filePath) < 0)
+	{
+		entry.missing = true;
+		return;
+	}
+
+	QCryptographicHash	hash(QCryptographicHash::Sha1);
+	const size_t		chunk	= 1 << 30;
+
+	entry.crc	= crc32Of(0, NULL, 0);
+	entry.size	= 0;
+
+	entry.producer([&](const char *data, size_t size)
+	{
+		for (size_t pos = 0; pos < size; pos += chunk)
+			hash.addData(data + pos, int(std::min(chunk, size - pos)));
+
+		entry.crc	=  crc32Of(entry.crc, data, size);
+		entry.size	+= size;
+	});
+
+	entry.hash = hash.result().toStdString();
+
+	if (reuse(entry))
+		return;
+
+	entry.compressedSize = entry.size;
+
+	if (worthCompressing(entry.name))
+	{
+		Deflater	deflater;
+		uint32_t	crc			= crc32Of(0, NULL, 0);
+
+		entry.producer([&](const char *data, size_t size)
+		{
+			deflater.add(data, size);
+			crc = crc32Of(crc, data, size);
+		});
+
+		string &compressed = deflater.finish();
+
+		if (crc != entry.crc)
+			throw runtime_error(entry.name + " changed while it was saved.");
+
+		if (compressed.size() < entry.size)
+		{
+			entry.compressed.swap(compressed);
+			entry.compressedSize	= entry.compressed.size();
+			entry.deflated			= true;
+		}
+	}
+}
+
+void ZipArchiveWriter::write(Entry &entry)
+{
+	if (entry.missing)
+		return;
+
+	bool	zip64	= entry.size >= noFit32 || entry.compressedSize >= noFit32;
+	string	header;
+
+	entry.offset = _written;
+
+	put32(header, localHeaderSignature);
+	put16(header, zip64 ? 45 : 20);
+	put16(header, utf8Names);
+	put16(header, entry.deflated ? methodDeflate : methodStored);
+	put16(header, _dosTime);
+	put16(header, _dosDate);
+	put32(header, entry.crc);
+	put32(header, zip64 ? noFit32 : uint32_t(entry.compressedSize));
+	put32(header, zip64 ? noFit32 : uint32_t(entry.size));
+	put16(header, uint16_t(entry.name.size()));
+	put16(header, zip64 ? 20 : 0);
+	header += entry.name;
+
+	if (zip64)
+	{
+		put16(header, zip64ExtraId);
+		put16(header, 16);
+		put64(header, entry.size);
+		put64(header, entry.compressedSize);
+	}
+
+	_file.write(header.data(), streamsize(header.size()));
+
+	if (entry.reused)
+	{
+		string		previousHeader	= readAt(_previousFile, entry.previousOffset, 30);
+		uint64_t	from			= entry.previousOffset + 30 + get16(previousHeader, 26) + get16(previousHeader, 28);
+		const size_t chunk			= 1 << 20;
+
+		for (uint64_t copied = 0; copied < entry.compressedSize; copied += chunk)
+		{
+			string data = readAt(_previousFile, from + copied, size_t(std::min<uint64_t>(chunk, entry.compressedSize - copied)));
+			_file.write(data.data(), streamsize(data.size()));
+		}
+	}
+	else if (entry.deflated)
+	{
+		_file.write(entry.compressed.data(), streamsize(entry.compressed.size()));
+		string().swap(entry.compressed);
+	}
+	else
+	{
+		uint32_t crc = crc32Of(0, NULL, 0);
+
+		entry.producer([&](const char *data, size_t size)
+		{
+			_file.write(data, streamsize(size));
+			crc = crc32Of(crc, data, size);
+		});
+
+		if (crc != entry.crc)
+			throw runtime_error(entry.name + " changed while it was saved.");
+	}
+
+	entry.producer = Producer();
+
+	if (!_file.good())
+		throw runtime_error("Can't save jasp archive writing ERROR");
+
+	_written += header.size() + entry.compressedSize;
+}
+
+void ZipArchiveWriter::writeCentralDirectory()
+{
+	uint64_t	cdOffset	= _written,
+				count		= 0;
+	string		cd;
+
+	for (const Entry &entry : _entries)
+	{
+		if (entry.missing)
+			continue;
+
+		string zip64Extra;
+		if (entry.size				>= noFit32)	put64(zip64Extra, entry.size);
+		if (entry.compressedSize	>= noFit32)	put64(zip64Extra, entry.compressedSize);
+		if (entry.offset			>= noFit32)	put64(zip64Extra, entry.offset);
+
+		string extra;
+		if (!zip64Extra.empty())
+		{
+			put16(extra, zip64ExtraId);
+			put16(extra, uint16_t(zip64Extra.size()));
+			extra += zip64Extra;
+		}
+
+		put16(extra, hashExtraId);
+		put16(extra, uint16_t(entry.hash.size()));
+		extra += entry.hash;
+
+		uint16_t version = zip64Extra.empty() ? 20 : 45;
+
+		put32(cd, centralHeaderSignature);
+		put16(cd, madeByUnix | version);
+		put16(cd, version);
+		put16(cd, utf8Names);
+		put16(cd, entry.deflated ? methodDeflate : methodStored);
+		put16(cd, _dosTime);
+		put16(cd, _dosDate);
+		put32(cd, entry.crc);
+		put32(cd, uint32_t(std::min<uint64_t>(entry.compressedSize,	noFit32)));
+		put32(cd, uint32_t(std::min<uint64_t>(entry.size,			noFit32)));
+		put16(cd, uint16_t(entry.name.size()));
+		put16(cd, uint16_t(extra.size()));
+		put16(cd, 0);				// comment
+		put16(cd, 0);				// disk
+		put16(cd, 0);				// internal attributes
+		put32(cd, 0100644u << 16);	// a regular file, rw-r--r--
+		put32(cd, uint32_t(std::min<uint64_t>(entry.offset, noFit32)));
+		cd += entry.name;
+		cd += extra;
+
+		count++;
+	}
+
+	uint64_t cdSize = cd.size();
+
+	if (count >= noFit16 || cdSize >= noFit32 || cdOffset >= noFit32)
+	{
+		uint64_t zip64EndOffset = cdOffset + cdSize;
+
+		put32(cd, zip64EndSignature);
+		put64(cd, 44);
+		put16(cd, madeByUnix | 45);
+		put16(cd, 45);
+		put32(cd, 0);
+		put32(cd, 0);
+		put64(cd, count);
+		put64(cd, count);
+		put64(cd, cdSize);
+		put64(cd, cdOffset);
+
+		put32(cd, zip64LocatorSignature);
+		put32(cd, 0);
+		put64(cd, zip64EndOffset);
+		put32(cd, 1);
+	}
+
+	put32(cd, endSignature);
+	put16(cd, 0);
+	put16(cd, 0);
+	put16(cd, uint16_t(std::min<uint64_t>(count, noFit16)));
+	put16(cd, uint16_t(std::min<uint64_t>(count, noFit16)));
+	put32(cd, uint32_t(std::min<uint64_t>(cdSize, noFit32)));
+	put32(cd, uint32_t(std::min<uint64_t>(cdOffset, noFit32)));
+	put16(cd, 0);
+
+	_file.write(cd.data(), streamsize(cd.size()));
+	_written += cd.size();
+}
+
+void ZipArchiveWriter::close(std::function<void(int)> progress)
+{
+	size_t threads = Parallel::threadCount();
+
+	for (size_t first = 0; first < _entries.size(); )
+	{
+		// A couple of entries per thread keeps them all busy while not holding too much of the archive in memory.
+		size_t batch = std::min(_entries.size() - first, threads * 2);
+
+		Parallel::forEach(batch, [&](size_t i, bool) { prepare(_entries[first + i]); });
+
+		// The file is written by this thread only, in order.
+		for (size_t i = 0; i < batch; i++)
+		{
+			Entry &entry = _entries[first + i];
+
+			write(entry);
+
+			if (entry.reused)
+				_reused++;
+		}
+
+		first += batch;
+
+		if (progress)
+			progress(int(100 * first / _entries.size()));
+	}
+
+	writeCentralDirectory();
+
+	_file.close();
+	_previousFile.close();
+
+	if (_file.fail() || !Utils::renameOverwrite(_partPath, _path))
+		throw runtime_error("File could not be closed.");
+
+	_closed = true;
+}
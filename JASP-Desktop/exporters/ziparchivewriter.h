@@ -0,0 +1,105 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ZIPARCHIVEWRITER_H
+#define ZIPARCHIVEWRITER_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/nowide/fstream.hpp>
+
+/*
+ * ZipArchiveWriter writes a zip archive (a .jasp) with its entries compressed on all cores, a couple at a time, and written in the order they were added.
+ * Entries that are compressed already (png, jpeg) are stored as they are, as is anything that deflate doesn't make smaller.
+ *
+ * Every entry gets the SHA-1 of its contents in an extra field of the central directory. If the archive that is replaced has an entry with the same hash
+ * its compressed bytes are copied instead of compressing it again, which makes saving a project that changed only a little quick.
+ * Files are always read to hash them: a size and modification time that match the last save don't prove the contents do.
+ * Nothing is held uncompressed: the contents are passed through in pieces to hash them, again to compress them and once more to store them if that didn't help.
+ * The archive is written next to the destination and only replaces it once it is complete.
+ */
+class ZipArchiveWriter
+{
+public:
+	typedef std::function<void(const char *data, size_t size)>	Sink;
+	typedef std::function<void(const Sink &sink)>				Producer;	///< Passes all of the contents of an entry to the sink, in as many pieces as it likes, every time it is called.
+
+			ZipArchiveWriter(const std::string &path);
+			~ZipArchiveWriter();
+
+	void	addEntry(const std::string &name, std::string contents);
+	void	addStream(const std::string &name, Producer producer);			///< Called two or three times while it is compressed and written, it has to produce the same each time.
+	void	addFile(const std::string &name, const std::string &filePath);	///< Read when it is compressed, if it doesn't exist by then it is left out.
+
+	void	close(std::function<void(int)> progress = std::function<void(int)>());	///< Compresses and writes everything, progress gets the percentage of entries done.
+
+	size_t	reusedEntries() const { return _reused; }
+
+private:
+	struct Entry
+	{
+		std::string		name,
+						filePath,
+						compressed,		///< Once it is prepared, if deflate made it smaller
+						hash;
+		Producer		producer;
+		bool			missing			= false,
+						deflated		= false,
+						reused			= false;
+		uint32_t		crc				= 0;
+		uint64_t		size			= 0,
+						compressedSize	= 0,
+						offset			= 0,
+						previousOffset	= 0;	///< Of the local header of the same entry in the previous archive, if it is reused
+	};
+
+	struct PreviousEntry
+	{
+		bool			deflated;
+		uint32_t		crc;
+		uint64_t		size,
+						compressedSize,
+						offset;
+	};
+
+	void				readPreviousArchive();
+	void				prepare(Entry &entry)		const;
+	bool				reuse(Entry &entry)			const;
+	void				write(Entry &entry);
+	void				writeCentralDirectory();
+
+	static bool			worthCompressing(const std::string &name);
+	static uint32_t		crc32Of(uint32_t crc, const char *data, size_t size);
+
+	std::string								_path,
+											_partPath;
+	std::vector<Entry>						_entries;
+	std::map<std::string, PreviousEntry>	_previous;		///< By hash
+	boost::nowide::ofstream					_file;
+	boost::nowide::ifstream					_previousFile;
+	uint64_t								_written	= 0;
+	uint16_t								_dosTime	= 0,
+											_dosDate	= 0;
+	size_t									_reused		= 0;
+	bool									_closed		= false;
+};
+
+#endif // ZIPARCHIVEWRITER_H
@@ -18,6 +18,7 @@
 
 #include "fileevent.h"
 #include "exporters/dataexporter.h"
+#include "exporters/arrowexporter.h"
 #include "exporters/resultexporter.h"
 #include "exporters/jaspexporter.h"
 
@@ -77,6 +78,18 @@ bool FileEvent::setPath(const QString &path)
 		}
 	}
 
+	// An exported data set can also be written as an Arrow file, which needs its own exporter.
+	if (_operation == FileEvent::FileExportData)
+	{
+		bool arrowFile = filetype == Utils::arrow || filetype == Utils::feather;
+
+		if (arrowFile != (dynamic_cast<ArrowExporter*>(_exporter) != NULL))
+		{
+			delete _exporter;
+			_exporter = arrowFile ? static_cast<Exporter*>(new ArrowExporter(true)) : new DataExporter(true);
+		}
+	}
+
 	if (_exporter != NULL)
 	{
 		result = _exporter->isFileTypeAllowed(filetype);
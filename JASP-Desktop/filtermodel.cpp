@@ -95,13 +95,15 @@ void FilterModel::setGeneratedFilter(QString newGeneratedFilter)
 }
 
 
-void FilterModel::processFilterResult(std::vector<bool> filterResult, int requestId)
+void FilterModel::processFilterResult(int requestId)
 {
 	if((requestId > -1 && requestId < _lastSentRequestId) || _package == NULL || _package->dataSet() == NULL)
 		return;
 
+	if(!_package->dataSet()->filter().publish(requestId)) //The engine already wrote the result into shared memory, we only need to make it the current one
+		return;
+
 	_package->setDataFilter(_rFilter.toStdString()); //store the filter that was last used and actually gave results.
-	_package->dataSet()->setFilterVector(filterResult);
 
 	emit filterUpdated();
 
@@ -143,6 +145,8 @@ void FilterModel::updateStatusBar()
 
 	if(_package->refreshAnalysesAfterFilter()) //After loading a JASP package we do not want to rerun all analyses because it might take very long
 		refreshAllAnalyses();
+	else
+		emit loadedAnalysesUpToDate();
 
 	_package->setRefreshAnalysesAfterFilter(true);
 }
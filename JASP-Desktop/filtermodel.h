@@ -55,7 +55,7 @@ public slots:
 	void setGeneratedFilter(QString newGeneratedFilter);
 	void setConstructedJSON(QString newConstructedJSON);
 
-	void processFilterResult(std::vector<bool> filterResult, int requestId);
+	void processFilterResult(int requestId);
 	void processFilterErrorMsg(QString filterErrorMsg, int requestId);
 	void rescanRFilterForColumns();
 
@@ -75,6 +75,7 @@ signals:
 
 	void refreshAllAnalyses();
 	void filterUpdated();
+	void loadedAnalysesUpToDate();
 
 	void sendFilter(QString generatedFilter, QString rFilter, int requestID);
 
@@ -365,6 +365,8 @@ $(document).ready(function () {
 
 	window.remove = function (id) {
 
+		delete analysisSerials[id]
+
 		window.unselect()
 
 		analyses.removeAnalysisId(id);
@@ -435,6 +437,35 @@ $(document).ready(function () {
 
     }
 
+	// The results of an analysis are loaded as a script from the jasp-temp scheme, the scripts run in the order they were asked for.
+	// The serial says which results were asked for last, anything older that still comes in is ignored.
+	var analysisSerials = {}
+
+	window.loadAnalysis = function (id, serial) {
+
+		analysisSerials[id] = serial
+
+		var script = document.createElement("script")
+		script.async = false
+		script.src = "jasp-temp://results/" + id + "-" + serial + ".js"
+		script.onload = function () { document.head.removeChild(script) }
+		script.onerror = function () {
+			document.head.removeChild(script)
+			jasp.analysisResults(id, serial, function (json) {
+				if (json !== "")
+					window.analysisLoaded(id, serial, JSON.parse(json))
+			})
+		}
+
+		document.head.appendChild(script)
+	}
+
+	window.analysisLoaded = function (id, serial, analysis) {
+
+		if (analysisSerials[id] === serial)
+			window.analysisChanged(analysis)
+	}
+
 	window.analysisChanged = function (analysis) {
 
 		if (introVisible) {
@@ -624,23 +655,10 @@ window.imageSaved = function (args) {
 	delete savingImages[args.id];
 }
 
-var convertToBase64Id = 0;
-var convertToBase64Images = {};
-
 var convertToBase64Begin = function (path, callback, context) {
-	var index = convertToBase64Id;
-	convertToBase64Id += 1;
-	convertToBase64Images[index] = {
-		callback: callback,
-		context: context
-	}
-	jasp.getImageInBase64(index, path);
-}
-
-window.convertToBase64Done = function (args) {
-	var callbackData = convertToBase64Images[args.id];
-	callbackData.callback.call(callbackData.context, args.result);
-    delete convertToBase64Images[args.id];
+	jasp.getImageInBase64(path, function (base64) {
+		callback.call(context, base64);
+	});
 }
 
 
@@ -0,0 +1,519 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "arrowfilereader.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+using namespace arrowipc;
+
+static inline bool isNull(const vector<char> &validity, int64_t row)
+{
+	return !validity.empty() && ((validity[row >> 3] >> (row & 7)) & 1) == 0;
+}
+
+ArrowFileReader::ArrowFileReader(const string &path)
+	: _file(path.c_str(), ios::in | ios::binary)
+	, _rowCount(0)
+{
+	if (!_file.is_open())
+		throw runtime_error("Could not open '" + path + "'.");
+
+	readFooter();
+}
+
+/**
+ * @brief readFooter The file starts and ends with "ARROW1", right before the last one is the footer with the schema and the position of every record batch and dictionary.
+ */
+void ArrowFileReader::readFooter()
+{
+	_file.seekg(0, ios::end);
+	_fileSize = _file.tellg();
+
+	const int64_t	tailLength	= sizeof(int32_t) + fileMagicLength;
+	char			magic[fileMagicLength];
+	int32_t			footerLength;
+
+	if (_fileSize < 8 + tailLength)
+		throw runtime_error("This is not an Arrow file.");
+
+	_file.seekg(0);
+	_file.read(magic, fileMagicLength);
+
+	if (memcmp(magic, fileMagic, fileMagicLength) != 0)
+		throw runtime_error("This is not an Arrow file, only the Arrow IPC file format (also known as Feather version 2) can be read.");
+
+	_file.seekg(_fileSize - tailLength);
+	_file.read(reinterpret_cast<char *>(&footerLength), sizeof(footerLength));
+	_file.read(magic, fileMagicLength);
+
+	if (!_file.good() || memcmp(magic, fileMagic, fileMagicLength) != 0 || footerLength <= 0 || footerLength > _fileSize - tailLength - 8)
+		throw runtime_error("The Arrow file is incomplete or damaged.");
+
+	vector<char> footerData(footerLength);
+	_file.seekg(_fileSize - tailLength - footerLength);
+	_file.read(footerData.data(), footerLength);
+
+	if (!_file.good())
+		throw runtime_error("The Arrow file is incomplete or damaged.");
+
+	FlatBufferTable footer(footerData.data(), footerData.size());
+
+	readSchema(footer.table(Footer::schema));
+
+	for (size_t i = 0; i < footer.vectorLength(Footer::recordBatches); i++)
+	{
+		_batches.push_back(readBatch(footer.structAt<Block>(Footer::recordBatches, i), MessageHeader::RecordBatch));
+
+		if (_batches.back().length > INT_MAX - _rowCount)
+			throw runtime_error("The Arrow file has more rows than JASP can read.");
+
+		_rowCount += _batches.back().length;
+	}
+
+	for (size_t i = 0; i < footer.vectorLength(Footer::dictionaries); i++)
+	{
+		int64_t	id;
+		bool	isDelta;
+		Batch	batch = readBatch(footer.structAt<Block>(Footer::dictionaries, i), MessageHeader::DictionaryBatch, &id, &isDelta);
+
+		_dictionaries[id].push_back({ batch, isDelta });
+	}
+}
+
+void ArrowFileReader::readSchema(const FlatBufferTable &schema)
+{
+	if (schema.scalar<int16_t>(Schema::endianness, 0) != 0)
+		throw runtime_error("This Arrow file is big endian, JASP can only read little endian Arrow files.");
+
+	size_t	nodes	= 0,
+			buffers	= 0;
+
+	for (size_t i = 0; i < schema.vectorLength(Schema::fields); i++)
+		addField(schema.tableAt(Schema::fields, i), nodes, buffers, true);
+}
+
+/**
+ * @brief addField Works out which FieldNode and Buffers of a record batch belong to field.
+ * Every field, also the children of nested ones, has one FieldNode and a number of buffers that depends on its type, in the order of the schema.
+ * Nested fields aren't read, but we still need to know how many nodes and buffers they take up.
+ */
+void ArrowFileReader::addField(const FlatBufferTable &field, size_t &nodes, size_t &buffers, bool topLevel)
+{
+	FieldInfo info;
+
+	info.name	= field.string(Field::name);
+	info.type	= static_cast<Type>(field.scalar<uint8_t>(Field::typeType, 0));
+	info.node	= nodes++;
+	info.buffer	= buffers;
+
+	if (info.type == Type::Int && field.has(Field::type))
+	{
+		FlatBufferTable type = field.table(Field::type);
+		info.bitWidth		= type.scalar<int32_t>(IntType::bitWidth, 0);
+		info.isSigned		= type.scalar<uint8_t>(IntType::isSigned, 0) != 0;
+	}
+	else if (info.type == Type::FloatingPoint && field.has(Field::type))
+		info.precision = static_cast<Precision>(field.table(Field::type).scalar<int16_t>(FloatingPointType::precision, 0));
+
+	if (field.has(Field::dictionary))
+	{
+		// The values are in a dictionary batch, the record batches only have the (by default 32 bit) indices.
+		FlatBufferTable dictionary = field.table(Field::dictionary);
+
+		info.isDictionary	= true;
+		info.dictionaryId	= dictionary.scalar<int64_t>(DictionaryEncoding::id, 0);
+		info.bitWidth		= 32;
+		info.isSigned		= true;
+
+		if (dictionary.has(DictionaryEncoding::indexType))
+		{
+			FlatBufferTable indexType = dictionary.table(DictionaryEncoding::indexType);
+			info.bitWidth	= indexType.scalar<int32_t>(IntType::bitWidth, 0);
+			info.isSigned	= indexType.scalar<uint8_t>(IntType::isSigned, 0) != 0;
+		}
+
+		buffers += 2;
+	}
+	else
+	{
+		switch (info.type)
+		{
+		case Type::Null:																					break;
+		case Type::Struct:
+		case Type::FixedSizeList:	buffers += 1;															break;
+		case Type::List:
+		case Type::LargeList:
+		case Type::Map:				buffers += 2;															break;
+		case Type::Union:			buffers += field.table(Field::type).scalar<int16_t>(0, 0) == 1 ? 2 : 1;	break; // Dense unions have offsets as well
+		case Type::Binary:
+		case Type::Utf8:
+		case Type::LargeBinary:
+		case Type::LargeUtf8:		buffers += 3;															break;
+		case Type::Int:
+		case Type::FloatingPoint:
+		case Type::Bool:
+		case Type::Decimal:
+		case Type::Date:
+		case Type::Time:
+		case Type::Timestamp:
+		case Type::Interval:
+		case Type::FixedSizeBinary:
+		case Type::Duration:		buffers += 2;															break;
+		default:
+			throw runtime_error("Column '" + info.name + "' of the Arrow file has a type that JASP does not know.");
+		}
+
+		for (size_t i = 0; i < field.vectorLength(Field::children); i++)
+			addField(field.tableAt(Field::children, i), nodes, buffers, false);
+	}
+
+	if (topLevel)
+		_fields.push_back(info);
+}
+
+/**
+ * @brief readBatch Reads the metadata of a record batch or a dictionary batch, the data itself is read when it is needed.
+ */
+ArrowFileReader::Batch ArrowFileReader::readBatch(const Block &block, MessageHeader expected, int64_t *dictionaryId, bool *isDelta)
+{
+	uint32_t	first;
+	int32_t		metadataLength;
+	int64_t		prefixLength	= sizeof(first);
+
+	// The offsets and lengths come from the file, so they are compared without adding them up, that could overflow.
+	if (block.offset < 0 || block.metaDataLength < 0 || block.offset > _fileSize || block.metaDataLength > _fileSize - block.offset)
+		throw runtime_error("The Arrow file is incomplete or damaged.");
+
+	_file.seekg(block.offset);
+	_file.read(reinterpret_cast<char *>(&first), sizeof(first));
+
+	// Older files don't have the continuation marker, only the length.
+	if (first == continuationMarker)
+	{
+		_file.read(reinterpret_cast<char *>(&metadataLength), sizeof(metadataLength));
+		prefixLength += sizeof(metadataLength);
+	}
+	else
+		metadataLength = static_cast<int32_t>(first);
+
+	if (!_file.good() || metadataLength <= 0 || metadataLength > block.metaDataLength - prefixLength)
+		throw runtime_error("The Arrow file is incomplete or damaged.");
+
+	vector<char> metadata(metadataLength);
+	_file.read(metadata.data(), metadataLength);
+
+	if (!_file.good())
+		throw runtime_error("The Arrow file is incomplete or damaged.");
+
+	FlatBufferTable message(metadata.data(), metadata.size());
+
+	if (static_cast<MessageHeader>(message.scalar<uint8_t>(Message::headerType, 0)) != expected)
+		throw runtime_error("The Arrow file is damaged.");
+
+	FlatBufferTable	header		= message.table(Message::header);
+	int64_t			bodyOffset	= block.offset + block.metaDataLength,
+					bodyLength	= message.scalar<int64_t>(Message::bodyLength, 0);
+
+	if (bodyLength < 0 || bodyLength > _fileSize - bodyOffset)
+		throw runtime_error("The Arrow file is incomplete or damaged.");
+
+	if (expected == MessageHeader::DictionaryBatch)
+	{
+		*dictionaryId	= header.scalar<int64_t>(DictionaryBatch::id, 0);
+		*isDelta		= header.scalar<uint8_t>(DictionaryBatch::isDelta, 0) != 0;
+
+		return readBatch(header.table(DictionaryBatch::data), bodyOffset, bodyLength);
+	}
+
+	return readBatch(header, bodyOffset, bodyLength);
+}
+
+ArrowFileReader::Batch ArrowFileReader::readBatch(const FlatBufferTable &recordBatch, int64_t bodyOffset, int64_t bodyLength)
+{
+	if (recordBatch.has(RecordBatch::compression))
+		throw runtime_error("This Arrow file is compressed, JASP can only read Arrow files that are written without compression.");
+
+	Batch batch;
+
+	batch.bodyOffset	= bodyOffset;
+	batch.bodyLength	= bodyLength;
+	batch.length		= recordBatch.scalar<int64_t>(RecordBatch::length, 0);
+
+	if (batch.length < 0 || batch.length > INT_MAX)
+		throw runtime_error("The Arrow file is damaged.");
+
+	for (size_t i = 0; i < recordBatch.vectorLength(RecordBatch::nodes); i++)
+		batch.nodes.push_back(recordBatch.structAt<FieldNode>(RecordBatch::nodes, i));
+
+	for (size_t i = 0; i < recordBatch.vectorLength(RecordBatch::buffers); i++)
+		batch.buffers.push_back(recordBatch.structAt<Buffer>(RecordBatch::buffers, i));
+
+	return batch;
+}
+
+// Only the nodes of top level fields are read, and those have a value for every row of their batch.
+const FieldNode &ArrowFileReader::nodeOf(const Batch &batch, size_t node) const
+{
+	if (node >= batch.nodes.size() || batch.nodes[node].length != batch.length || batch.nodes[node].nullCount < 0 || batch.nodes[node].nullCount > batch.length)
+		throw runtime_error("The Arrow file is damaged.");
+
+	return batch.nodes[node];
+}
+
+/**
+ * @brief checkBuffer Throws unless buffer of batch has at least length bytes, and they are all in the body of batch.
+ * The lengths come from the file, so this is done before anything is allocated for them.
+ */
+void ArrowFileReader::checkBuffer(const Batch &batch, size_t buffer, int64_t length) const
+{
+	if (buffer >= batch.buffers.size() || length < 0 || length > batch.buffers[buffer].length || batch.buffers[buffer].offset < 0 || length > batch.bodyLength - batch.buffers[buffer].offset)
+		throw runtime_error("The Arrow file is damaged.");
+}
+
+/**
+ * @brief readBuffer Reads the first length bytes of a buffer of batch straight into to.
+ */
+void ArrowFileReader::readBuffer(const Batch &batch, size_t buffer, int64_t length, void *to)
+{
+	if (length == 0)
+		return;
+
+	checkBuffer(batch, buffer, length);
+
+	_file.seekg(batch.bodyOffset + batch.buffers[buffer].offset);
+	_file.read(static_cast<char *>(to), length);
+
+	if (_file.gcount() != length)
+		throw runtime_error("The Arrow file is incomplete.");
+}
+
+vector<char> ArrowFileReader::readBuffer(const Batch &batch, size_t buffer, int64_t length)
+{
+	if (length != 0)
+		checkBuffer(batch, buffer, length);
+
+	vector<char> data(length);
+	readBuffer(batch, buffer, length, data.data());
+
+	return data;
+}
+
+/**
+ * @brief readValidity Reads the bitmap that tells which values are not null, it is left out when there aren't any nulls.
+ * @return The bitmap, or an empty vector if all values are valid.
+ */
+vector<char> ArrowFileReader::readValidity(const Batch &batch, size_t buffer, const FieldNode &node)
+{
+	if (node.nullCount == 0 || buffer >= batch.buffers.size() || batch.buffers[buffer].length == 0)
+		return vector<char>();
+
+	return readBuffer(batch, buffer, (node.length + 7) / 8);
+}
+
+void ArrowFileReader::readIntegers(const Batch &batch, const FieldInfo &field, const FieldNode &node, vector<int64_t> &values)
+{
+	if (field.bitWidth != 8 && field.bitWidth != 16 && field.bitWidth != 32 && field.bitWidth != 64)
+		throw runtime_error("Column '" + field.name + "' of the Arrow file has integers of an unknown size.");
+
+	size_t			width	= field.bitWidth / 8;
+	vector<char>	data	= readBuffer(batch, field.buffer + 1, node.length * width);
+	const char		*value	= data.data();
+
+	values.resize(node.length);
+
+	for (int64_t row = 0; row < node.length; row++, value += width)
+		switch (field.bitWidth)
+		{
+		case 8:		values[row] = field.isSigned ? *reinterpret_cast<const int8_t *>(value) : *reinterpret_cast<const uint8_t *>(value);	break;
+		case 16:	{ int16_t	v; memcpy(&v, value, width); values[row] = field.isSigned ? v : static_cast<uint16_t>(v);	break; }
+		case 32:	{ int32_t	v; memcpy(&v, value, width); values[row] = field.isSigned ? v : static_cast<uint32_t>(v);	break; }
+		default:	{ uint64_t	v; memcpy(&v, value, width); values[row] = field.isSigned || v <= INT64_MAX ? static_cast<int64_t>(v) : INT64_MAX;	break; }
+		}
+}
+
+void ArrowFileReader::readStrings(const Batch &batch, size_t node, size_t buffer, bool large, vector<string> &to)
+{
+	const FieldNode	&fieldNode	= nodeOf(batch, node);
+	int64_t			count		= fieldNode.length;
+
+	if (count == 0)
+		return;
+
+	vector<char>	validity	= readValidity(batch, buffer, fieldNode);
+	size_t			offsetWidth	= large ? sizeof(int64_t) : sizeof(int32_t);
+
+	// count comes from the file, there have to be as many offsets in the buffer before room is made for them.
+	if (buffer + 1 >= batch.buffers.size() || batch.buffers[buffer + 1].length < 0 || count + 1 > batch.buffers[buffer + 1].length / static_cast<int64_t>(offsetWidth))
+		throw runtime_error("The Arrow file is damaged.");
+
+	vector<int64_t>	offsets(count + 1);
+
+	if (large)
+		readBuffer(batch, buffer + 1, (count + 1) * sizeof(int64_t), offsets.data());
+	else
+	{
+		vector<int32_t> smallOffsets(count + 1);
+		readBuffer(batch, buffer + 1, (count + 1) * sizeof(int32_t), smallOffsets.data());
+		std::copy(smallOffsets.begin(), smallOffsets.end(), offsets.begin());
+	}
+
+	if (offsets[0] < 0 || offsets[count] < offsets[0])
+		throw runtime_error("The Arrow file is damaged.");
+
+	vector<char> data = readBuffer(batch, buffer + 2, offsets[count]);
+
+	to.reserve(to.size() + count);
+
+	for (int64_t row = 0; row < count; row++)
+	{
+		if (offsets[row + 1] < offsets[row] || offsets[row + 1] > offsets[count])
+			throw runtime_error("The Arrow file is damaged.");
+
+		if (isNull(validity, row))	to.push_back("");
+		else						to.push_back(string(data.data() + offsets[row], offsets[row + 1] - offsets[row]));
+	}
+}
+
+bool ArrowFileReader::columnKind(const FieldInfo &field, ArrowImportColumn::Kind &kind)
+{
+	bool isText = field.type == Type::Utf8 || field.type == Type::LargeUtf8;
+
+	if (field.isDictionary)
+	{
+		kind = ArrowImportColumn::Kind::Dictionary;
+		return isText;
+	}
+
+	switch (field.type)
+	{
+	case Type::Int:
+	case Type::Bool:			kind = ArrowImportColumn::Kind::Ints;		return true;
+	case Type::FloatingPoint:	kind = ArrowImportColumn::Kind::Doubles;	return field.precision != Precision::Half;
+	case Type::Utf8:
+	case Type::LargeUtf8:		kind = ArrowImportColumn::Kind::Strings;	return true;
+	default:																return false;
+	}
+}
+
+void ArrowFileReader::readColumn(size_t fieldNo, ArrowImportColumn *column)
+{
+	const FieldInfo	&field		= _fields.at(fieldNo);
+	bool			large		= field.type == Type::LargeUtf8;
+
+	if (column->kind == ArrowImportColumn::Kind::Dictionary)
+	{
+		auto parts = _dictionaries.find(field.dictionaryId);
+
+		if (parts == _dictionaries.end())
+			throw runtime_error("The dictionary of column '" + field.name + "' is missing from the Arrow file.");
+
+		for (const DictionaryPart &part : parts->second)
+		{
+			if (!part.isDelta)
+				column->strings.clear();
+
+			readStrings(part.batch, 0, 0, large, column->strings);
+		}
+	}
+
+	vector<int64_t> integers;
+
+	for (const Batch &batch : _batches)
+	{
+		if (column->kind == ArrowImportColumn::Kind::Strings)
+		{
+			readStrings(batch, field.node, field.buffer, large, column->strings);
+			continue;
+		}
+
+		const FieldNode	&node		= nodeOf(batch, field.node);
+		vector<char>	validity	= readValidity(batch, field.buffer, node);
+
+		if (field.type == Type::FloatingPoint && !field.isDictionary)
+		{
+			checkBuffer(batch, field.buffer + 1, node.length * (field.precision == Precision::Double ? sizeof(double) : sizeof(float)));
+
+			size_t first = column->doubles.size();
+			column->doubles.resize(first + node.length);
+
+			// Doubles have the same layout in the file as in the column, so they go straight in there.
+			if (field.precision == Precision::Double)
+				readBuffer(batch, field.buffer + 1, node.length * sizeof(double), column->doubles.data() + first);
+			else
+			{
+				vector<float> floats(node.length);
+				readBuffer(batch, field.buffer + 1, node.length * sizeof(float), floats.data());
+				std::copy(floats.begin(), floats.end(), column->doubles.begin() + first);
+			}
+
+			if (!validity.empty())
+				for (int64_t row = 0; row < node.length; row++)
+					if (isNull(validity, row))
+						column->doubles[first + row] = NAN;
+
+			continue;
+		}
+
+		if (field.type == Type::Bool && !field.isDictionary)
+		{
+			vector<char> bits = readBuffer(batch, field.buffer + 1, (node.length + 7) / 8);
+
+			for (int64_t row = 0; row < node.length; row++)
+				column->ints.push_back(isNull(validity, row) ? INT_MIN : (bits[row >> 3] >> (row & 7)) & 1);
+
+			continue;
+		}
+
+		readIntegers(batch, field, node, integers);
+
+		if (column->kind == ArrowImportColumn::Kind::Dictionary)
+		{
+			for (int64_t row = 0; row < node.length; row++)
+			{
+				if (!isNull(validity, row) && (integers[row] < 0 || integers[row] >= static_cast<int64_t>(column->strings.size())))
+					throw runtime_error("Column '" + field.name + "' of the Arrow file refers to values that are not in its dictionary.");
+
+				column->ints.push_back(isNull(validity, row) ? INT_MIN : integers[row]);
+			}
+
+			continue;
+		}
+
+		// INT_MIN is what JASP uses for a missing value, so that doesn't fit either.
+		if (column->kind == ArrowImportColumn::Kind::Ints)
+			for (int64_t row = 0; row < node.length; row++)
+				if (!isNull(validity, row) && (integers[row] <= INT_MIN || integers[row] > INT_MAX))
+				{
+					column->intsToDoubles();
+					break;
+				}
+
+		for (int64_t row = 0; row < node.length; row++)
+		{
+			bool null = isNull(validity, row);
+
+			if (column->kind == ArrowImportColumn::Kind::Ints)	column->ints.push_back(null ? INT_MIN : static_cast<int>(integers[row]));
+			else												column->doubles.push_back(null ? NAN : static_cast<double>(integers[row]));
+		}
+	}
+}
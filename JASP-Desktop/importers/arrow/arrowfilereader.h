@@ -0,0 +1,119 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ARROWFILEREADER_H
+#define ARROWFILEREADER_H
+
+#include "arrowformat.h"
+#include "arrowimportcolumn.h"
+#include "flatbuffer.h"
+
+#include <boost/nowide/fstream.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace arrowipc
+{
+
+/**
+ * @brief The ArrowFileReader class
+ *  Reads an Arrow IPC file (.arrow, or .feather version 2). The footer tells where every record batch is,
+ *  so a column can be read on its own: only its own buffers of each record batch are read from the file.
+ *  Only flat columns without compression are read, which is what pyarrow writes with compression="uncompressed".
+ */
+class ArrowFileReader
+{
+public:
+	struct FieldInfo
+	{
+		std::string	name;
+		Type		type			= Type::None;	///< For a dictionary encoded field this is the type of the values of the dictionary.
+		int			bitWidth		= 0;			///< Of an Int, or of the indices of a dictionary encoded field.
+		bool		isSigned		= true;
+		Precision	precision		= Precision::Double;
+		bool		isDictionary	= false;
+		int64_t		dictionaryId	= 0;
+		size_t		node			= 0,			///< The first FieldNode of this field in a record batch
+					buffer			= 0;			///< and its first Buffer.
+	};
+
+	/**
+	 * @brief ArrowFileReader Opens the file and reads the footer, the schema and the metadata of all record batches.
+	 * @param path The file to read.
+	 */
+	ArrowFileReader(const std::string &path);
+
+	const std::vector<FieldInfo>	&fields()	const { return _fields; }
+	int64_t							rowCount()	const { return _rowCount; }
+
+	/**
+	 * @brief columnKind How a field is read, or false if JASP can't read this type of field.
+	 */
+	static bool columnKind(const FieldInfo &field, ArrowImportColumn::Kind &kind);
+
+	/**
+	 * @brief readColumn Reads all values of a field, one record batch at a time.
+	 * @param field The index of the field in fields().
+	 * @param column The column to read them into, it should have the kind columnKind gives.
+	 */
+	void readColumn(size_t field, ArrowImportColumn *column);
+
+private:
+	struct Batch
+	{
+		int64_t					bodyOffset,
+								bodyLength,
+								length;
+		std::vector<FieldNode>	nodes;
+		std::vector<Buffer>		buffers;
+	};
+
+	struct DictionaryPart
+	{
+		Batch	batch;
+		bool	isDelta;
+	};
+
+	void	readFooter();
+	void	readSchema(const FlatBufferTable &schema);
+	void	addField(const FlatBufferTable &field, size_t &nodes, size_t &buffers, bool topLevel);
+	Batch	readBatch(const Block &block, MessageHeader expected, int64_t *dictionaryId = NULL, bool *isDelta = NULL);
+	Batch	readBatch(const FlatBufferTable &recordBatch, int64_t bodyOffset, int64_t bodyLength);
+
+	void				checkBuffer(const Batch &batch, size_t buffer, int64_t length) const;
+	void				readBuffer(const Batch &batch, size_t buffer, int64_t length, void *to);
+	std::vector<char>	readBuffer(const Batch &batch, size_t buffer, int64_t length);
+	std::vector<char>	readValidity(const Batch &batch, size_t buffer, const FieldNode &node);
+
+	void readIntegers(	const Batch &batch, const FieldInfo &field, const FieldNode &node, std::vector<int64_t> &values);
+	void readStrings(	const Batch &batch, size_t node, size_t buffer, bool large, std::vector<std::string> &to);
+
+	const FieldNode &nodeOf(const Batch &batch, size_t node) const;
+
+	boost::nowide::ifstream					_file;
+	int64_t									_fileSize,
+											_rowCount;
+	std::vector<FieldInfo>					_fields;
+	std::vector<Batch>						_batches;
+	std::map<int64_t, std::vector<DictionaryPart>>	_dictionaries;
+};
+
+}
+
+#endif // ARROWFILEREADER_H
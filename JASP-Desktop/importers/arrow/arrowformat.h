@@ -0,0 +1,81 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ARROWFORMAT_H
+#define ARROWFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * The parts of the Arrow IPC file format (also known as Feather V2) that JASP reads and writes.
+ * See Schema.fbs, Message.fbs and File.fbs in the Arrow format specification,
+ * the field numbers are the ids of the fields in those schemas (a union takes two: its type and its value).
+ */
+namespace arrowipc
+{
+
+static const char		fileMagic[]			= "ARROW1";
+static const size_t		fileMagicLength		= 6;
+static const uint32_t	continuationMarker	= 0xFFFFFFFF;
+static const int16_t	metadataVersionV5	= 4;
+
+namespace Footer			{ enum { version = 0, schema, dictionaries, recordBatches }; }
+namespace Schema			{ enum { endianness = 0, fields }; }
+namespace Field				{ enum { name = 0, nullable, typeType, type, dictionary, children }; }
+namespace Message			{ enum { version = 0, headerType, header, bodyLength }; }
+namespace RecordBatch		{ enum { length = 0, nodes, buffers, compression }; }
+namespace DictionaryBatch	{ enum { id = 0, data, isDelta }; }
+namespace DictionaryEncoding{ enum { id = 0, indexType, isOrdered }; }
+namespace IntType			{ enum { bitWidth = 0, isSigned }; }
+namespace FloatingPointType	{ enum { precision = 0 }; }
+
+enum class MessageHeader : uint8_t	{ None = 0, Schema, DictionaryBatch, RecordBatch };
+enum class Precision : int16_t		{ Half = 0, Single, Double };
+
+enum class Type : uint8_t
+{
+	None = 0, Null, Int, FloatingPoint, Binary, Utf8, Bool, Decimal, Date, Time, Timestamp, Interval,
+	List, Struct, Union, FixedSizeBinary, FixedSizeList, Map, Duration, LargeBinary, LargeUtf8, LargeList
+};
+
+struct FieldNode
+{
+	int64_t	length,
+			nullCount;
+};
+
+struct Buffer
+{
+	int64_t	offset,
+			length;
+};
+
+struct Block
+{
+	int64_t	offset;
+	int32_t	metaDataLength,
+			padding;
+	int64_t	bodyLength;
+};
+
+///Buffers (and the body of a message) start at multiples of 8 bytes.
+inline int64_t padded(int64_t length) { return (length + 7) & ~int64_t(7); }
+
+}
+
+#endif // ARROWFORMAT_H
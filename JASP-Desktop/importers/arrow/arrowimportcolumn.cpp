@@ -0,0 +1,99 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "arrowimportcolumn.h"
+
+#include <climits>
+#include <cmath>
+#include <sstream>
+#include <limits>
+
+using namespace std;
+using namespace arrowipc;
+
+ArrowImportColumn::ArrowImportColumn(ImportDataSet* importDataSet, string name, Kind kind)
+	: ImportColumn(importDataSet, name)
+	, kind(kind)
+{
+}
+
+ArrowImportColumn::~ArrowImportColumn()
+{
+}
+
+size_t ArrowImportColumn::size() const
+{
+	switch (kind)
+	{
+	case Kind::Doubles:	return doubles.size();
+	case Kind::Strings:	return strings.size();
+	default:			return ints.size();
+	}
+}
+
+void ArrowImportColumn::intsToDoubles()
+{
+	doubles.reserve(ints.size());
+
+	for (int value : ints)
+		doubles.push_back(value == INT_MIN ? NAN : value);
+
+	ints.clear();
+	ints.shrink_to_fit();
+	kind = Kind::Doubles;
+}
+
+string ArrowImportColumn::valueAsString(size_t row) const
+{
+	switch (kind)
+	{
+	case Kind::Doubles:
+	{
+		if (std::isnan(doubles[row]))
+			return "";
+
+		stringstream ss;
+		ss.precision(numeric_limits<double>::max_digits10);
+		ss << doubles[row];
+		return ss.str();
+	}
+
+	case Kind::Ints:
+		return ints[row] == INT_MIN ? "" : to_string(ints[row]);
+
+	case Kind::Strings:
+		return strings[row];
+
+	default:
+		return ints[row] == INT_MIN ? "" : strings[ints[row]];
+	}
+}
+
+bool ArrowImportColumn::isValueEqual(Column &col, size_t row) const
+{
+	if (row >= size())
+		return false;
+
+	// A scale column can be compared to the numbers themselves, that way nothing gets lost in formatting them.
+	if (col.columnType() == Column::ColumnTypeScale && kind == Kind::Doubles)
+		return col.isValueEqual(row, doubles[row]);
+
+	if (col.columnType() == Column::ColumnTypeScale && kind == Kind::Ints)
+		return col.isValueEqual(row, ints[row] == INT_MIN ? NAN : static_cast<double>(ints[row]));
+
+	return isStringValueEqual(valueAsString(row), col, row);
+}
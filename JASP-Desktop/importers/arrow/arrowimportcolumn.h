@@ -0,0 +1,62 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ARROWIMPORTCOLUMN_H
+#define ARROWIMPORTCOLUMN_H
+
+#include "../importcolumn.h"
+
+#include <string>
+#include <vector>
+
+namespace arrowipc
+{
+
+/**
+ * @brief The ArrowImportColumn class
+ *  The values of a column of an Arrow file, kept in the type they have in the file instead of as strings.
+ */
+class ArrowImportColumn : public ImportColumn
+{
+public:
+	enum class Kind { Doubles, Ints, Strings, Dictionary };
+
+	ArrowImportColumn(ImportDataSet* importDataSet, std::string name, Kind kind);
+	virtual ~ArrowImportColumn();
+
+	virtual size_t size() const;
+	virtual bool isValueEqual(Column &col, size_t row) const;
+
+	/**
+	 * @brief intsToDoubles Turns an Ints column into a Doubles column, for when the integers in the file do not fit in an int.
+	 */
+	void intsToDoubles();
+
+	/**
+	 * @brief valueAsString The value of row as the other importers would have read it from a text file, an empty string for a null.
+	 */
+	std::string valueAsString(size_t row) const;
+
+	Kind						kind;
+	std::vector<double>			doubles;	///< For Doubles, NaN where the value is null.
+	std::vector<int>			ints;		///< For Ints the values, for Dictionary the index in strings. INT_MIN where the value is null.
+	std::vector<std::string>	strings;	///< For Strings the values, for Dictionary the values of the dictionary.
+};
+
+}
+
+#endif // ARROWIMPORTCOLUMN_H
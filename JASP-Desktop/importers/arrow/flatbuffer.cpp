@@ -0,0 +1,207 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "flatbuffer.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace arrowipc;
+
+FlatBufferTable::FlatBufferTable(const char *data, size_t size)
+	: FlatBufferTable(data, size, 0)
+{
+}
+
+/**
+ * @brief FlatBufferTable The table that starts at pos, or the root table if pos is 0.
+ */
+FlatBufferTable::FlatBufferTable(const char *data, size_t size, size_t pos)
+	: _data(data)
+	, _size(size)
+	, _pos(pos)
+{
+	if (_pos == 0)
+		_pos = followOffset(0);
+
+	// The vtable is found by subtracting the signed offset at the start of the table.
+	_vtable		= _pos - static_cast<size_t>(static_cast<int64_t>(read<int32_t>(_pos)));
+	_vtableSize	= read<uint16_t>(_vtable);
+}
+
+/**
+ * @brief fieldPos Looks up where a field is stored.
+ * @return The position in the buffer, or 0 if the field is not there (so it has its default value).
+ */
+size_t FlatBufferTable::fieldPos(int field) const
+{
+	size_t entry = 4 + 2 * field;
+
+	if (entry + 2 > _vtableSize)
+		return 0;
+
+	uint16_t offset = read<uint16_t>(_vtable + entry);
+
+	return offset == 0 ? 0 : _pos + offset;
+}
+
+size_t FlatBufferTable::vectorPos(int field) const
+{
+	size_t pos = fieldPos(field);
+
+	if (pos == 0)
+		throw runtime_error("The metadata of the Arrow file is incomplete.");
+
+	return followOffset(pos);
+}
+
+FlatBufferTable FlatBufferTable::table(int field) const
+{
+	size_t pos = fieldPos(field);
+
+	if (pos == 0)
+		throw runtime_error("The metadata of the Arrow file is incomplete.");
+
+	return FlatBufferTable(_data, _size, followOffset(pos));
+}
+
+string FlatBufferTable::string(int field) const
+{
+	size_t pos = fieldPos(field);
+
+	if (pos == 0)
+		return "";
+
+	pos				= followOffset(pos);
+	uint32_t length	= read<uint32_t>(pos);
+
+	if (pos + 4 + length > _size)
+		throw runtime_error("The metadata of the Arrow file is damaged.");
+
+	return std::string(_data + pos + 4, length);
+}
+
+size_t FlatBufferTable::vectorLength(int field) const
+{
+	return has(field) ? read<uint32_t>(vectorPos(field)) : 0;
+}
+
+FlatBufferTable FlatBufferTable::tableAt(int field, size_t index) const
+{
+	if (index >= vectorLength(field))
+		throw runtime_error("The metadata of the Arrow file is damaged.");
+
+	return FlatBufferTable(_data, _size, followOffset(vectorPos(field) + 4 + 4 * index));
+}
+
+void FlatBufferBuilder::align(size_t alignment, size_t following)
+{
+	while ((_reversed.size() + following) % alignment != 0)
+		_reversed += '\0';
+}
+
+void FlatBufferBuilder::pushBytes(const void *bytes, size_t size)
+{
+	const char *chars = static_cast<const char *>(bytes);
+
+	for (size_t i = size; i > 0; i--)
+		_reversed += chars[i - 1];
+}
+
+/**
+ * @brief pushRef Adds an offset to ref, which is counted from where the offset itself is stored.
+ */
+void FlatBufferBuilder::pushRef(Ref ref)
+{
+	align(4);
+	push<uint32_t>(offset() + 4 - ref);
+}
+
+FlatBufferBuilder::Ref FlatBufferBuilder::createString(const std::string &value)
+{
+	align(4, value.size() + 1);
+	_reversed += '\0';
+	pushBytes(value.data(), value.size());
+	push<uint32_t>(value.size());
+
+	return offset();
+}
+
+FlatBufferBuilder::Ref FlatBufferBuilder::createVector(const std::vector<Ref> &tables)
+{
+	align(4, 4 * tables.size());
+
+	for (size_t i = tables.size(); i > 0; i--)
+		pushRef(tables[i - 1]);
+
+	push<uint32_t>(tables.size());
+
+	return offset();
+}
+
+void FlatBufferBuilder::startTable()
+{
+	_fields.clear();
+	_tableStart = offset();
+}
+
+void FlatBufferBuilder::addRef(int field, Ref ref)
+{
+	pushRef(ref);
+	_fields.push_back({ field, offset() });
+}
+
+/**
+ * @brief endTable Adds the start of the table and its vtable, which has the position of every field in the table.
+ */
+FlatBufferBuilder::Ref FlatBufferBuilder::endTable()
+{
+	push<int32_t>(0);
+	Ref tableEnd = offset();
+
+	int fieldCount = 0;
+	for (const TableField &field : _fields)
+		fieldCount = std::max(fieldCount, field.field + 1);
+
+	vector<uint16_t> entries(fieldCount, 0);
+	for (const TableField &field : _fields)
+		entries[field.field] = tableEnd - field.at;
+
+	for (size_t i = entries.size(); i > 0; i--)
+		push<uint16_t>(entries[i - 1]);
+
+	push<uint16_t>(tableEnd - _tableStart);
+	push<uint16_t>(4 + 2 * entries.size());
+
+	// Now we know where the vtable is the start of the table can point to it.
+	int32_t toVTable = offset() - tableEnd;
+
+	for (size_t byte = 0; byte < sizeof(toVTable); byte++)
+		_reversed[tableEnd - 1 - byte] = reinterpret_cast<const char *>(&toVTable)[byte];
+
+	_fields.clear();
+
+	return tableEnd;
+}
+
+std::string FlatBufferBuilder::finish(Ref root)
+{
+	align(8, 4);
+	pushRef(root);
+
+	return std::string(_reversed.rbegin(), _reversed.rend());
+}
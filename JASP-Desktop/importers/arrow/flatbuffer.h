@@ -0,0 +1,145 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef FLATBUFFER_H
+#define FLATBUFFER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace arrowipc
+{
+
+/**
+ * @brief The FlatBufferTable class
+ *  Reads a table from a FlatBuffers buffer, which is how Arrow stores its metadata.
+ *  Only what is needed for the Arrow schema and messages is here, fields are asked for by their id in the schema.
+ *  Every read is checked against the size of the buffer, a damaged file gives a std::runtime_error.
+ */
+class FlatBufferTable
+{
+public:
+	/**
+	 * @brief FlatBufferTable The root table of a buffer.
+	 * @param data The buffer, it has to outlive the table.
+	 * @param size Its size in bytes.
+	 */
+	FlatBufferTable(const char *data, size_t size);
+
+	bool has(int field) const { return fieldPos(field) != 0; }
+
+	template <typename T> T scalar(int field, T defaultValue) const
+	{
+		size_t pos = fieldPos(field);
+		return pos == 0 ? defaultValue : read<T>(pos);
+	}
+
+	FlatBufferTable	table(int field)	const;
+	std::string		string(int field)	const;
+
+	size_t			vectorLength(int field)						const;
+	FlatBufferTable	tableAt(int field, size_t index)			const;
+	///Reads a struct from a vector of structs, T has to have the same layout as the struct in the schema.
+	template <typename T> T structAt(int field, size_t index)	const { return read<T>(vectorPos(field) + 4 + index * sizeof(T)); }
+
+private:
+	FlatBufferTable(const char *data, size_t size, size_t pos);
+
+	size_t fieldPos(int field)	const;
+	size_t vectorPos(int field)	const;
+	size_t followOffset(size_t pos) const { return pos + read<uint32_t>(pos); }
+
+	template <typename T> T read(size_t pos) const
+	{
+		if (pos + sizeof(T) > _size || pos + sizeof(T) < pos)
+			throw std::runtime_error("The metadata of the Arrow file is damaged.");
+
+		T value;
+		memcpy(&value, _data + pos, sizeof(T));
+		return value;
+	}
+
+	const char	*_data;
+	size_t		_size,
+				_pos,			///< Where the table starts
+				_vtable,
+				_vtableSize;
+};
+
+/**
+ * @brief The FlatBufferBuilder class
+ *  Builds a FlatBuffers buffer, back to front like the FlatBuffers library does: an object is always added before whatever refers to it.
+ *  Objects are referred to by their offset from the end of the buffer, which is what the create and end functions return.
+ */
+class FlatBufferBuilder
+{
+public:
+	typedef uint32_t Ref;
+
+	Ref createString(const std::string &value);
+	Ref createVector(const std::vector<Ref> &tables);
+	///Adds a vector of structs, T has to have the same layout as the struct in the schema.
+	template <typename T> Ref createStructVector(const std::vector<T> &structs)
+	{
+		align(8, structs.size() * sizeof(T));
+		pushBytes(structs.data(), structs.size() * sizeof(T));
+		push<uint32_t>(structs.size());
+		return offset();
+	}
+
+	void startTable();
+	template <typename T> void addScalar(int field, T value)
+	{
+		push(value);
+		_fields.push_back({ field, offset() });
+	}
+	void addRef(int field, Ref ref);
+	Ref endTable();
+
+	///Finishes the buffer with root as its root table, the buffer is padded to a multiple of 8 bytes.
+	std::string finish(Ref root);
+
+private:
+	struct TableField
+	{
+		int		field;
+		Ref		at;
+	};
+
+	Ref offset() const { return static_cast<Ref>(_reversed.size()); }
+
+	void align(size_t alignment, size_t following = 0);
+	void pushBytes(const void *bytes, size_t size);
+	void pushRef(Ref ref);
+
+	template <typename T> void push(T value)
+	{
+		align(sizeof(T));
+		pushBytes(&value, sizeof(T));
+	}
+
+	std::string				_reversed;	///< The buffer, last byte first.
+	std::vector<TableField>	_fields;	///< The fields of the table being built.
+	Ref						_tableStart;
+};
+
+}
+
+#endif // FLATBUFFER_H
@@ -0,0 +1,206 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "arrowimporter.h"
+#include "arrow/arrowfilereader.h"
+#include "arrow/arrowimportcolumn.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+using namespace std;
+using namespace arrowipc;
+
+ArrowImporter::ArrowImporter(DataSetPackage *packageData) : Importer(packageData)
+{
+	_packageData->setIsArchive(false);
+}
+
+ImportDataSet* ArrowImporter::loadFile(const string &locator, boost::function<void(const string &, int)> progressCallback)
+{
+	progressCallback("Reading Arrow file.", 0);
+
+	ArrowFileReader									reader(locator);
+	const vector<ArrowFileReader::FieldInfo>		&fields = reader.fields();
+	vector<size_t>									fieldsToRead;
+
+	if (_columnNames.empty())
+		for (size_t field = 0; field < fields.size(); field++)
+			fieldsToRead.push_back(field);
+
+	for (const string &name : _columnNames)
+	{
+		auto found = std::find_if(fields.begin(), fields.end(), [&](const ArrowFileReader::FieldInfo &field) { return field.name == name; });
+
+		if (found == fields.end())
+			throw runtime_error("Column '" + name + "' is not in the Arrow file.");
+
+		fieldsToRead.push_back(found - fields.begin());
+	}
+
+	ImportDataSet	*result = new ImportDataSet(this);
+	vector<string>	colNames,
+					leftOut;
+
+	try
+	{
+		for (size_t i = 0; i < fieldsToRead.size(); i++)
+		{
+			size_t								fieldNo	= fieldsToRead[i];
+			const ArrowFileReader::FieldInfo	&field	= fields[fieldNo];
+			ArrowImportColumn::Kind				kind;
+
+			if (!ArrowFileReader::columnKind(field, kind))
+			{
+				leftOut.push_back(field.name);
+				continue;
+			}
+
+			// Same as for a csv: every column gets a name and the names are unique.
+			string colName = field.name;
+
+			if (colName == "")
+				colName = "V" + to_string(colNames.size() + 1);
+
+			if (std::find(colNames.begin(), colNames.end(), colName) != colNames.end())
+				colName += "_" + to_string(colNames.size() + 1);
+
+			colNames.push_back(colName);
+
+			ArrowImportColumn *column = new ArrowImportColumn(result, colName, kind);
+			result->addColumn(column);
+
+			// One column at a time, so only its own buffers are read from the file.
+			reader.readColumn(fieldNo, column);
+
+			progressCallback("Reading Arrow file.", 50 * (i + 1) / fieldsToRead.size());
+		}
+	}
+	catch (...)
+	{
+		delete result;
+		throw;
+	}
+
+	if (colNames.empty() && !leftOut.empty())
+	{
+		delete result;
+		throw runtime_error("None of the columns of the Arrow file has a type that JASP can read.");
+	}
+
+	if (!leftOut.empty())
+	{
+		string message = "These columns of the Arrow file have a type that JASP cannot read and were left out:";
+
+		for (const string &name : leftOut)
+			message += "\n" + (name == "" ? string("(without a name)") : name);
+
+		_packageData->setWarningMessage(message);
+	}
+
+	result->buildDictionary();
+
+	return result;
+}
+
+void ArrowImporter::prepareColumn(ImportColumn *importColumn, PreparedColumn &column)
+{
+	ArrowImportColumn	*arrowColumn	= dynamic_cast<ArrowImportColumn *>(importColumn);
+	size_t				rowCount		= arrowColumn->size();
+
+	switch (arrowColumn->kind)
+	{
+	case ArrowImportColumn::Kind::Doubles:
+		column.columnType	= Column::ColumnTypeScale;
+		column.doubles		= arrowColumn->doubles;
+
+		// The numbers that are set as missing values are missing here too, just like they would be in a csv.
+		for (size_t row = 0; row < rowCount; row++)
+			if (!std::isnan(column.doubles[row]) && Column::isEmptyValue(column.doubles[row]))
+			{
+				column.emptyValues[row]	= arrowColumn->valueAsString(row);
+				column.doubles[row]		= NAN;
+			}
+		break;
+
+	case ArrowImportColumn::Kind::Ints:
+		column.ints = arrowColumn->ints;
+
+		for (size_t row = 0; row < rowCount; row++)
+		{
+			int value = column.ints[row];
+
+			if (value == INT_MIN)
+				continue;
+
+			if (Column::isEmptyValue(static_cast<double>(value)))
+			{
+				column.emptyValues[row]	= to_string(value);
+				column.ints[row]		= INT_MIN;
+			}
+			else
+				column.uniqueInts.insert(value);
+		}
+
+		if (column.uniqueInts.size() <= 24)
+			column.columnType = Column::ColumnTypeNominal;
+		else
+		{
+			column.columnType = Column::ColumnTypeScale;
+			column.doubles.reserve(rowCount);
+
+			for (int value : column.ints)
+				column.doubles.push_back(value == INT_MIN ? NAN : value);
+
+			column.ints.clear();
+			column.uniqueInts.clear();
+		}
+		break;
+
+	case ArrowImportColumn::Kind::Strings:
+		column.setNominalText(arrowColumn->strings);
+		break;
+
+	case ArrowImportColumn::Kind::Dictionary:
+	{
+		// The levels are worked out once for the whole dictionary, instead of for every row.
+		vector<int>			levelPerEntry;
+		map<int, string>	emptyEntries;
+
+		column.columnType	= Column::ColumnTypeNominalText;
+		column.textLevels	= Column::nominalTextLevels(arrowColumn->strings, levelPerEntry, emptyEntries);
+		column.ints.reserve(rowCount);
+
+		for (size_t row = 0; row < rowCount; row++)
+		{
+			int entry = arrowColumn->ints[row];
+
+			if (entry == INT_MIN)
+				column.ints.push_back(INT_MIN);
+			else
+			{
+				column.ints.push_back(levelPerEntry[entry]);
+
+				if (levelPerEntry[entry] == INT_MIN && !arrowColumn->strings[entry].empty())
+					column.emptyValues[row] = arrowColumn->strings[entry];
+			}
+		}
+		break;
+	}
+	}
+}
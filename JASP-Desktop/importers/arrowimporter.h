@@ -0,0 +1,54 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ARROWIMPORTER_H
+#define ARROWIMPORTER_H
+
+#include "importer.h"
+
+#include <string>
+#include <vector>
+
+namespace arrowipc
+{
+
+/**
+ * @brief The ArrowImporter class
+ *  Imports .arrow and .feather (version 2) files, the columns keep the types they have in the file:
+ *  floating point columns become scale, dictionary encoded strings become nominal text with the dictionary as levels
+ *  and integers become nominal or scale just like they would from a csv.
+ *  Columns of any other type are left out and listed in the warning message of the package.
+ */
+class ArrowImporter : public Importer
+{
+public:
+	ArrowImporter(DataSetPackage *packageData);
+
+	///Only reads these columns from the file, in this order, the buffers of the other columns aren't read at all. By default all columns that JASP can read are imported.
+	void setColumns(const std::vector<std::string> &columnNames) { _columnNames = columnNames; }
+
+protected:
+	virtual ImportDataSet* loadFile(const std::string &locator, boost::function<void(const std::string &, int)> progressCallback);
+	virtual void prepareColumn(ImportColumn *importColumn, PreparedColumn &column);
+
+private:
+	std::vector<std::string> _columnNames;
+};
+
+}
+
+#endif // ARROWIMPORTER_H
@@ -44,7 +44,7 @@ CodePageConvert::CodePageConvert(const char *ianaCSNameSrc)
 	{
 		// do we know of this codec?
 		if (_knownCPs.find(ianaCSNameSrc) != _knownCPs.end())
-			_source = QTextCodec::codecForName(ianaCSNameSrc)->makeDecoder();
+			_source = QTextCodec::codecForName(ianaCSNameSrc);
 		else
 			throw runtime_error(msg + ianaCSNameSrc);
 	}
@@ -52,8 +52,6 @@ CodePageConvert::CodePageConvert(const char *ianaCSNameSrc)
 
 CodePageConvert::~CodePageConvert()
 {
-	if (_source != 0)
-		delete _source;
 }
 
 /**
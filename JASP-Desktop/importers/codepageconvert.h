@@ -66,7 +66,7 @@ private:
 
 	static QSet<QByteArray> _knownCPs;
 
-	QTextDecoder	*_source;
+	QTextCodec		*_source; ///< Owned by Qt. Unlike a QTextDecoder it keeps no state between calls, so the columns can be converted on several threads at once.
 };
 
 
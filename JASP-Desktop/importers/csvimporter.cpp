@@ -109,11 +109,11 @@ ImportDataSet* CSVImporter::loadFile(const string &locator, boost::function<void
 }
 
 
-void CSVImporter::fillSharedMemoryColumn(ImportColumn *importColumn, Column &column)
+void CSVImporter::prepareColumn(ImportColumn *importColumn, PreparedColumn &column)
 {
 	CSVImportColumn *csvColumn = dynamic_cast<CSVImportColumn *>(importColumn);
 	const vector<string> &values = csvColumn->getValues();
 
-	fillSharedMemoryColumnWithStrings(values, column);
+	prepareColumnWithStrings(values, column);
 }
 
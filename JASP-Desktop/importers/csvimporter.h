@@ -28,7 +28,7 @@ public:
 
 protected:
 	virtual ImportDataSet* loadFile(const std::string &locator, boost::function<void(const std::string &, int)> progressCallback);
-	virtual void fillSharedMemoryColumn(ImportColumn *importColumn, Column &column);
+	virtual void prepareColumn(ImportColumn *importColumn, PreparedColumn &column);
 
 };
 
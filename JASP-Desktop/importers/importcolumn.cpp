@@ -1,5 +1,6 @@
 #include "importcolumn.h"
 #include <cmath>
+#include <algorithm>
 #include "utils.h"
 
 using namespace std;
@@ -168,3 +169,49 @@ bool ImportColumn::convertToDouble(const vector<string> &values, vector<double>
 
 	return success;
 }
+
+void PreparedColumn::setNominalText(const vector<string> &values, const map<string, string> &labels)
+{
+	columnType	= Column::ColumnTypeNominalText;
+	textLevels	= Column::nominalTextLevels(values, ints, emptyValues);
+	textLabels	= labels;
+}
+
+size_t PreparedColumn::labelCount() const
+{
+	switch (columnType)
+	{
+	case Column::ColumnTypeNominal:
+	case Column::ColumnTypeOrdinal:		return std::max(uniqueInts.size(), intLabels.size());
+	case Column::ColumnTypeNominalText:	return textLevels.size();
+	default:							return 0;
+	}
+}
+
+void PreparedColumn::commit(Column &column) const
+{
+	switch (columnType)
+	{
+	case Column::ColumnTypeScale:
+		column.setColumnAsScale(doubles);
+		break;
+
+	case Column::ColumnTypeNominal:
+	case Column::ColumnTypeOrdinal:
+		if (intLabels.empty())
+			column.setColumnAsNominalOrOrdinal(ints, uniqueInts, columnType == Column::ColumnTypeOrdinal);
+		else
+		{
+			map<int, string> labels = intLabels; // Labels::syncInts wants to be able to change them
+			column.setColumnAsNominalOrOrdinal(ints, labels, columnType == Column::ColumnTypeOrdinal);
+		}
+		break;
+
+	case Column::ColumnTypeNominalText:
+		column.setColumnAsNominalText(textLevels, ints, textLabels);
+		break;
+
+	default:
+		break;
+	}
+}
@@ -4,12 +4,30 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <set>
 
 #include "importdataset.h"
 #include "column.h"
 
 class ImportDataSet;
 
+///What goes into a Column: its type, values and labels. This is worked out in private memory by Importer::prepareColumn, so that could be done for all columns at once, and is copied into the shared memory by commit.
+struct PreparedColumn
+{
+	Column::ColumnType					columnType = Column::ColumnTypeUnknown;	///< If unknown the column is left as it is
+	std::vector<int>					ints;		///< The values of a nominal or ordinal column, or the index in textLevels for a nominal text column. INT_MIN is empty.
+	std::vector<double>					doubles;	///< The values of a scale column
+	std::set<int>						uniqueInts;
+	std::map<int, std::string>			intLabels;	///< If there are any, these are used instead of uniqueInts
+	std::vector<std::string>			textLevels;
+	std::map<std::string, std::string>	textLabels;
+	std::map<int, std::string>			emptyValues;
+
+	void	setNominalText(const std::vector<std::string> &values, const std::map<std::string, std::string> &labels = std::map<std::string, std::string>());
+	size_t	labelCount() const;
+	void	commit(Column &column) const;
+};
+
 class ImportColumn
 {
 public:
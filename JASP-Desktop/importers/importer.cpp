@@ -1,6 +1,11 @@
 #include "importer.h"
+#include "importcolumn.h"
 #include "sharedmemory.h"
+#include "parallel.h"
 #include <iostream>
+#include <atomic>
+#include <algorithm>
+#include <memory>
 
 Importer::Importer(DataSetPackage *packageData)
 {
@@ -11,7 +16,8 @@ Importer::~Importer() {}
 
 void Importer::loadDataSet(const std::string &locator, boost::function<void(const std::string &, int)> progressCallback)
 {
-	ImportDataSet *importDataSet = loadFile(locator, progressCallback);
+	// Owned for the whole load, so whatever throws doesn't leak it
+	std::unique_ptr<ImportDataSet> importDataSet(loadFile(locator, progressCallback));
 
 	int columnCount = importDataSet->columnCount();
 	_packageData->setDataSet(SharedMemory::createDataSet()); // this is required incase the loading of the data fails so that the SharedMemory::createDataSet() can be later freed.
@@ -20,22 +26,51 @@ void Importer::loadDataSet(const std::string &locator, boost::function<void(cons
 		return;
 	int rowCount = importDataSet->rowCount();
 
+	std::vector<PreparedColumn> preparedColumns = prepareColumns(importDataSet.get(), progressCallback);
+
+	// Now we know how much memory it will all take, the shared memory only needs to grow once.
+	size_t labelCount = 0;
+	for (const PreparedColumn &preparedColumn : preparedColumns)
+		labelCount += preparedColumn.labelCount();
+
+	_packageData->setDataSet(SharedMemory::reserveMemory(_packageData->dataSet(), columnCount, rowCount, labelCount));
+
 	setDataSetSize(columnCount, rowCount);
 
 	int colNo = 0;
 	for (ImportColumn *importColumn : *importDataSet)
 	{
-		progressCallback("Loading Data Set", 50 + 50 * colNo / columnCount);
-		initColumn(colNo, importColumn);
+		progressCallback("Loading Data Set", 90 + 10 * colNo / columnCount);
+		commitColumn(colNo, importColumn->getName(), preparedColumns[colNo]);
 		colNo++;
 	}
+}
+
+// Prepares all columns in private memory, each one on the first thread that is free, and returns them in the same order as in importDataSet.
+// A column that can't be prepared throws on this thread, after the others stopped.
+std::vector<PreparedColumn> Importer::prepareColumns(ImportDataSet *importDataSet, boost::function<void(const std::string &, int)> progressCallback)
+{
+	std::vector<ImportColumn*>	importColumns(importDataSet->begin(), importDataSet->end());
+	size_t						columnCount = importColumns.size();
+	std::vector<PreparedColumn>	preparedColumns(columnCount);
+	std::atomic<size_t>			columnsDone(0);
+
+	Parallel::forEach(columnCount, [&](size_t colNo, bool onCallingThread)
+	{
+		prepareColumn(importColumns[colNo], preparedColumns[colNo]);
+
+		size_t done = ++columnsDone;
+
+		if (onCallingThread)
+			progressCallback("Loading Data Set", 50 + 40 * done / columnCount);
+	});
 
-	delete importDataSet;
+	return preparedColumns;
 }
 
 void Importer::syncDataSet(const std::string &locator, boost::function<void(const std::string &, int)> progress)
 {
-	ImportDataSet *importDataSet	= loadFile(locator, progress);
+	std::unique_ptr<ImportDataSet> importDataSet(loadFile(locator, progress));
 	DataSet *dataSet				= _packageData->dataSet();
 	bool rowCountChanged			= importDataSet->rowCount() != dataSet->rowCount();
 
@@ -117,48 +152,38 @@ void Importer::syncDataSet(const std::string &locator, boost::function<void(cons
 			}
 	}
 
-	_syncPackage(importDataSet, newColumns, changedColumns, missingColumns, changeNameColumns, rowCountChanged);
-
-	delete importDataSet;
+	_syncPackage(importDataSet.get(), newColumns, changedColumns, missingColumns, changeNameColumns, rowCountChanged);
 }
 
-void Importer::fillSharedMemoryColumnWithStrings(const std::vector<std::string> &values, Column &column)
+void Importer::prepareColumnWithStrings(const std::vector<std::string> &values, PreparedColumn &column)
 {
 	// try to make the column nominal
-	bool success = false;
-	std::set<int> uniqueValues;
-	std::vector<int> intValues;
-	intValues.reserve(values.size());
-	std::map<int, std::string> emptyValuesMap;
+	column.ints.reserve(values.size());
 
-	if (ImportColumn::convertToInt(values, intValues, uniqueValues, emptyValuesMap) && uniqueValues.size() <= 24)
+	if (ImportColumn::convertToInt(values, column.ints, column.uniqueInts, column.emptyValues) && column.uniqueInts.size() <= 24)
 	{
-		column.setColumnAsNominalOrOrdinal(intValues, uniqueValues);
-		success = true;
+		column.columnType = Column::ColumnTypeNominal;
+		return;
 	}
 
+	column.ints.clear();
+	column.uniqueInts.clear();
+	column.emptyValues.clear();
 
-	if (!success)
-	{
-		// try to make the column scale
-		std::vector<double> doubleValues;
-		doubleValues.reserve(values.size());
-		emptyValuesMap.clear();
-
-		if (ImportColumn::convertToDouble(values, doubleValues, emptyValuesMap))
-		{
-			column.setColumnAsScale(doubleValues);
-			success = true;
-		}
-	}
+	// try to make the column scale
+	column.doubles.reserve(values.size());
 
-	if (!success)
+	if (ImportColumn::convertToDouble(values, column.doubles, column.emptyValues))
 	{
-		// if it can't be made nominal numeric or scale, make it nominal-text
-		emptyValuesMap = column.setColumnAsNominalText(values);
+		column.columnType = Column::ColumnTypeScale;
+		return;
 	}
 
-	_packageData->storeInEmptyValues(column.name(), emptyValuesMap);
+	column.doubles.clear();
+	column.emptyValues.clear();
+
+	// if it can't be made nominal numeric or scale, make it nominal-text
+	column.setNominalText(values);
 }
 
 DataSet* Importer::setDataSetSize(int columnCount, int rowCount)
@@ -206,32 +231,27 @@ DataSet* Importer::setDataSetSize(int columnCount, int rowCount)
 	return dataSet;
 }
 
-void Importer::initColumn(std::string colName, ImportColumn *importColumn)
-{
-	initColumn(_packageData->dataSet()->getColumnIndex(colName), importColumn);
-}
-
-void Importer::initColumn(int colNo, ImportColumn *importColumn)
+void Importer::commitColumn(int colNo, const std::string &name, const PreparedColumn &preparedColumn)
 {
 	bool success = true;
 
 	do {
 		try {
 			Column &column = _packageData->dataSet()->column(colNo);
-			column.setName(importColumn->getName());
-			fillSharedMemoryColumn(importColumn, column);
+			column.setName(name);
+			preparedColumn.commit(column);
+			_packageData->storeInEmptyValues(name, preparedColumn.emptyValues);
 			success = true;
 		}
 		catch (boost::interprocess::bad_alloc &e)
 		{
+			// Shouldn't happen after SharedMemory::reserveMemory, but syncing a data set doesn't reserve anything.
 			try {
 				_packageData->setDataSet(SharedMemory::enlargeDataSet(_packageData->dataSet()));
 				success = false;
 			}
 			catch (std::exception &e)	{ throw std::runtime_error("Out of memory: this data set is too large for your computer's available memory");	}
 		}
-		catch (std::exception e)	{ std::cout << "n " << e.what() << std::endl;		}
-		catch (...)					{ std::cout << "something else\n " << std::endl;	}
 
 	} while (success == false);
 }
@@ -246,12 +266,41 @@ void Importer::_syncPackage(
 		bool										rowCountChanged)
 
 {
-	_packageData->dataSet()->setSynchingData(true);
+	// The columns are prepared first, in parallel, so a column that can't be read throws before the data set is touched.
+	std::vector<ImportColumn*> importColumns;
+	for (auto indexColChanged : changedColumns)
+		importColumns.push_back(syncDataSet->getColumn(indexColChanged.second->name()));
+	for (auto newColumn : newColumns)
+		importColumns.push_back(syncDataSet->getColumn(newColumn.first));
+
+	std::vector<PreparedColumn> preparedColumns(importColumns.size());
+	Parallel::forEach(importColumns.size(), [&](size_t i, bool) { prepareColumn(importColumns[i], preparedColumns[i]); });
 
 	std::vector<std::string>			_changedColumns;
 	std::vector<std::string>			_missingColumns;
 	std::map<std::string, std::string>	_changeNameColumns;
 
+	{
+		// Committing a column can enlarge the shared memory, which moves the data set
+		DataSetChange change([this]() { return _packageData->dataSet(); });
+
+		_syncColumns(syncDataSet, preparedColumns, newColumns, changedColumns, missingColumns, changeNameColumns, _changedColumns, _missingColumns, _changeNameColumns);
+	}
+
+	_packageData->dataChanged(_packageData, _changedColumns, _missingColumns, _changeNameColumns, rowCountChanged);
+}
+
+void Importer::_syncColumns(
+		ImportDataSet								*syncDataSet,
+		const std::vector<PreparedColumn>			&preparedColumns,
+		std::vector<std::pair<std::string, int>>	&newColumns,
+		std::vector<std::pair<int, Column *>>		&changedColumns,
+		std::map<std::string, Column *>				&missingColumns,
+		std::map<std::string, Column *>				&changeNameColumns,
+		std::vector<std::string>					&_changedColumns,
+		std::vector<std::string>					&_missingColumns,
+		std::map<std::string, std::string>			&_changeNameColumns)
+{
 	for (auto changeNameColumnIt : changeNameColumns)
 	{
 		std::string newColName	= changeNameColumnIt.first;
@@ -268,7 +317,8 @@ void Importer::_syncPackage(
 			tempChangedNameList[indexColChanged.first] = indexColChanged.second->name();
 
 
-	int colNo = _packageData->dataSet()->columnCount();
+	int		colNo		= _packageData->dataSet()->columnCount();
+	size_t	prepared	= 0;
 	setDataSetRowCount(syncDataSet->rowCount());
 
 	if (changedColumns.size() > 0)
@@ -279,7 +329,7 @@ void Importer::_syncPackage(
 			//Column &column		= _packageData->dataSet()->column(indexColChanged.first);
 			std::string colName	= tempChangedNameList[indexColChanged.first];//indexColChanged.second->name();
 			_changedColumns.push_back(colName);
-			initColumn(colName, syncDataSet->getColumn(colName));
+			commitColumn(_packageData->dataSet()->getColumnIndex(colName), colName, preparedColumns[prepared++]);
 		}
 	}
 
@@ -293,7 +343,7 @@ void Importer::_syncPackage(
 			increaseDataSetColCount(syncDataSet->rowCount());
 
 			std::cout << "New column " << it->first << std::endl;
-			initColumn(_packageData->dataSet()->columnCount() - 1, syncDataSet->getColumn(it->first));
+			commitColumn(_packageData->dataSet()->columnCount() - 1, it->first, preparedColumns[prepared++]);
 		}
 	}
 
@@ -312,7 +362,4 @@ void Importer::_syncPackage(
 			}
 		}
 	}
-
-	_packageData->dataSet()->setSynchingData(false);
-	_packageData->dataChanged(_packageData, _changedColumns, _missingColumns, _changeNameColumns, rowCountChanged);
 }
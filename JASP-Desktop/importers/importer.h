@@ -8,6 +8,7 @@
 
 class ImportDataSet;
 class ImportColumn;
+struct PreparedColumn;
 
 class Importer
 {
@@ -19,9 +20,10 @@ public:
 
 protected:
 	virtual ImportDataSet* loadFile(const std::string &locator, boost::function<void(const std::string &, int)> progressCallback) = 0;
-	virtual void fillSharedMemoryColumn(ImportColumn *importColumn, Column &column) = 0;
+	///Works out what goes in the column, without touching the shared memory. This is called for several columns at once from different threads.
+	virtual void prepareColumn(ImportColumn *importColumn, PreparedColumn &column) = 0;
 
-	void fillSharedMemoryColumnWithStrings(const std::vector<std::string> &values, Column &column);
+	static void prepareColumnWithStrings(const std::vector<std::string> &values, PreparedColumn &column);
 
 	DataSetPackage *_packageData;
 
@@ -37,9 +39,20 @@ private:
 			std::map<std::string, Column *> &missingColumns,
 			std::map<std::string, Column *> &changeNameColumns,
 			bool rowCountChanged);
+	void _syncColumns(
+			ImportDataSet *syncDataSet,
+			const std::vector<PreparedColumn> &preparedColumns,
+			std::vector<std::pair<std::string, int> > &newColumns,
+			std::vector<std::pair<int, Column *> > &changedColumns,
+			std::map<std::string, Column *> &missingColumns,
+			std::map<std::string, Column *> &changeNameColumns,
+			std::vector<std::string> &_changedColumns,
+			std::vector<std::string> &_missingColumns,
+			std::map<std::string, std::string> &_changeNameColumns);
+
+	std::vector<PreparedColumn> prepareColumns(ImportDataSet *importDataSet, boost::function<void(const std::string &, int)> progressCallback);
 
-	void initColumn(int colNo,				ImportColumn *importColumn);
-	void initColumn(std::string colName,	ImportColumn *importColumn);
+	void commitColumn(int colNo, const std::string &name, const PreparedColumn &column);
 };
 
 #endif // IMPORTER_H
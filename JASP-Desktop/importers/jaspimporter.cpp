@@ -35,6 +35,8 @@
 #include "tempfiles.h"
 #include "exporters/jaspexporter.h"
 #include <iostream>
+#include <algorithm>
+#include <climits>
 
 void JASPImporter::loadDataSet(DataSetPackage *packageData, const std::string &path, boost::function<void (const std::string &, int)> progressCallback)
 {	
@@ -132,6 +134,18 @@ void JASPImporter::loadDataArchive_1_00(DataSetPackage *packageData, const std::
 	if (rowCount < 0 || columnCount < 0)
 		throw std::runtime_error("Data size has been corrupted.");
 
+	Json::Value &columnsDesc = dataSetDesc["fields"];
+
+	// Make the shared memory big enough for everything at once, rather than enlarging it whenever it runs out below.
+	size_t labelCount = 0;
+	for (const Json::Value &columnDesc : columnsDesc)
+	{
+		const Json::Value &labelsDesc = columnDesc["labels"];
+		labelCount += !labelsDesc.isNull() ? labelsDesc.size() : xData.get(columnDesc["name"].asString(), Json::nullValue)["labels"].size();
+	}
+
+	packageData->setDataSet(SharedMemory::reserveMemory(packageData->dataSet(), columnCount, rowCount, labelCount));
+
 	do
 	{
 		try
@@ -160,7 +174,6 @@ void JASPImporter::loadDataArchive_1_00(DataSetPackage *packageData, const std::
 	unsigned long long progress;
 	unsigned long long lastProgress = -1;
 
-	Json::Value &columnsDesc = dataSetDesc["fields"];
 	int i = 0;
 
 	for (Json::Value columnDesc : columnsDesc)
@@ -242,31 +255,47 @@ void JASPImporter::loadDataArchive_1_00(DataSetPackage *packageData, const std::
 	if (!dataEntry.exists())
 		throw std::runtime_error("Entry " + entryName + " could not be found.");
 
-	char buff[sizeof(double) > sizeof(int) ? sizeof(double) : sizeof(int)];
+	std::vector<double>	doubles(rowCount);
+	std::vector<int>	ints(rowCount);
 
-	for (int c = 0; c < columnCount; c++)
+	// A whole column is read at once and copied in block by block, instead of looking up the block of each single value.
+	auto readColumn = [&](char *to, size_t bytes)
 	{
-		Column &column					= packageData->dataSet()->column(c);
-		Column::ColumnType columnType	= column.columnType();
-		int typeSize					= (columnType == Column::ColumnTypeScale) ? sizeof(double) : sizeof(int);
-
-		for (int r = 0; r < rowCount; r++)
+		for (size_t read = 0; read < bytes; )
 		{
 			int errorCode	= 0;
-			int size		= dataEntry.readData(buff, typeSize, errorCode);
+			int size		= dataEntry.readData(to + read, std::min<size_t>(bytes - read, INT_MAX), errorCode);
 
-			if (errorCode != 0 || size != typeSize)
+			if (errorCode != 0 || size <= 0)
 				throw std::runtime_error("Could not read 'data.bin' in JASP archive.");
 
-			if (columnType == Column::ColumnTypeScale)	column.setValue(r, *(double*)buff);
-			else										column.setValue(r, *(int*)buff);
+			read += size;
+		}
+	};
 
-			progress = 50 + (50 * ((c * rowCount) + (r + 1)) / (columnCount * rowCount));
-			if (progress != lastProgress)
-			{
-				progressCallback("Loading Data Set", progress);
-				lastProgress = progress;
-			}
+	for (int c = 0; c < columnCount; c++)
+	{
+		Column &column = packageData->dataSet()->column(c);
+
+		if (column.columnType() == Column::ColumnTypeScale)
+		{
+			readColumn(reinterpret_cast<char*>(doubles.data()), doubles.size() * sizeof(double));
+			std::copy(doubles.begin(), doubles.end(), column.AsDoubles.begin());
+		}
+		else
+		{
+			readColumn(reinterpret_cast<char*>(ints.data()), ints.size() * sizeof(int));
+			std::copy(ints.begin(), ints.end(), column.AsInts.begin());
+		}
+
+		column.incRevision();
+		column.stats(); // Summarized now the column was just read, instead of when it is first looked at
+
+		progress = 50 + (50 * (c + 1) / columnCount);
+		if (progress != lastProgress)
+		{
+			progressCallback("Loading Data Set", progress);
+			lastProgress = progress;
 		}
 	}
 	dataEntry.close();
@@ -28,10 +28,12 @@
 #include "odsimportdataset.h"
 
 #include <set>
+#include <algorithm>
 
 using namespace std;
 using namespace ods;
 
+const ODSSheetCell ODSImportColumn::EmptySheetCell;
 
 ODSImportColumn::ODSImportColumn(ODSImportDataSet* importDataSet, int columnNumber, string name)
 	: ImportColumn(importDataSet, name)
@@ -49,15 +51,15 @@ ODSImportColumn::~ODSImportColumn()
 size_t ODSImportColumn::size()
 const
 {
-	return _rows.size();
+	return _rowCount;
 }
 
 bool ODSImportColumn::isValueEqual(Column &col, size_t row) const
 {
-	if (row >= _rows.size())
+	if (row >= _rowCount)
 		return false;
 
-	const string &value = _rows.at(row)._string;
+	const string &value = _runAt(row)->cell._string;
 
 	return isStringValueEqual(value, col, row);
 }
@@ -71,39 +73,108 @@ void insert(int row, const std::string& data);
 
 
 /**
- * @brief _createSpace Ensures that we have enough elements in _rows.
- * @param row Row number to check for.
+ * @brief _runAt The run that holds row.
  */
-void ODSImportColumn::createSpace(size_t row)
+ODSImportColumn::Cases::const_iterator ODSImportColumn::_runAt(size_t row) const
+{
+	if (row >= _rowCount)
+		throw out_of_range("ODSImportColumn: there is no row " + to_string(row) + ".");
+
+	return upper_bound(_rows.begin(), _rows.end(), row, [](size_t row, const Run &run) { return row < run.end; });
+}
+
+/**
+ * @brief _setRows Makes the count rows from first on hold cell.
+ * Rows are added at the end while the sheet is read, which takes no more than extending or adding the last run.
+ * Anything else cuts the runs it overlaps.
+ */
+void ODSImportColumn::_setRows(size_t first, size_t count, const ODSSheetCell &cell)
 {
-#ifdef JASP_DEBUG
-	size_t numAdded = 0;
-#endif
+	if (count == 0)
+		return;
+
+	size_t end = first + count;
+
+	if (first >= _rowCount)
+	{
+		if (first > _rowCount)
+			_setRows(_rowCount, first - _rowCount, EmptySheetCell);
+
+		if (!_rows.empty() && _rows.back().cell._xmlType == cell._xmlType && _rows.back().cell._string == cell._string)
+			_rows.back().end = end;
+		else
+			_rows.push_back(Run{ cell, end });
+
+		_rowCount = end;
+		return;
+	}
+
+	Cases	runs;
+	size_t	start = 0;
+
+	for (const Run &run : _rows)
+	{
+		if (run.end <= first || start >= end)
+			runs.push_back(run);
+		else
+		{
+			if (start < first)
+				runs.push_back(Run{ run.cell, first });
+
+			if (runs.empty() || runs.back().end != end)
+				runs.push_back(Run{ cell, end });
+
+			if (run.end > end)
+				runs.push_back(run);
+		}
 
-	while (_rows.size() <= row)
-#ifdef JASP_DEBUG
+		start = run.end;
+	}
+
+	if (end > _rowCount)
 	{
-		numAdded++;
-#endif
-		_rows.push_back(ODSSheetCell());
-#ifdef JASP_DEBUG
+		runs.back().end = end;
+		_rowCount		= end;
 	}
 
-	if (numAdded != 0)
-		DEBUG_COUT7("ODSImportColumn::_createSpace(", row, ") - added ", numAdded, " row",
-					((numAdded != 1) ? "s" : ""), ".");
-#endif
+	_rows.swap(runs);
+}
+
+/**
+ * @brief _createSpace Ensures that we have enough rows, the new ones are empty.
+ * @param row Row number to check for.
+ */
+void ODSImportColumn::createSpace(size_t row)
+{
+	if (_rowCount <= row)
+	{
+		DEBUG_COUT5("ODSImportColumn::_createSpace(", row, ") - added ", row + 1 - _rowCount, " rows.");
+		_setRows(_rowCount, row + 1 - _rowCount, EmptySheetCell);
+	}
 }
 
 void ODSImportColumn::setValue(int row, const string &data)
 {
 	DEBUG_COUT7("Inserting ", data, ", row ", row, ", column ", _columnNumber, ".");
 
-	// Big enough?
+	ODSSheetCell cell;
+	cell.setValue(data);
+
+	_setRows(row, 1, cell);
+}
+
+/**
+ * @brief repeatValue Makes the count rows that follow row hold its value as well.
+ * @param row Row to repeat.
+ * @param count Number of times.
+ */
+void ODSImportColumn::repeatValue(int row, size_t count)
+{
 	createSpace(row);
 
-	ODSSheetCell & cell = _rows.at(row);
-	cell.setValue(data);	
+	ODSSheetCell cell = _runAt(row)->cell;
+
+	_setRows(row + 1, count, cell);
 }
 
 /**
@@ -120,11 +191,14 @@ void ODSImportColumn::postLoadProcess()
 
 vector<string> ODSImportColumn::getData()
 {
-	vector<string> values;
+	vector<string>	values;
+	size_t			start = 0;
+
+	values.reserve(_rowCount);
 	for (Cases::const_iterator i = _rows.begin(); i != _rows.end(); ++i)
 	{
-		const string &value = i->valueAsString();
-		values.push_back(value);
+		values.insert(values.end(), i->end - start, i->cell.valueAsString());
+		start = i->end;
 	}
 	return values;
 }
@@ -40,8 +40,15 @@ public:
 	// The empty value for a cell.
 	static const ODSSheetCell EmptySheetCell;
 
-	// The constainer used to hold rows within the column.
-	typedef std::vector<ODSSheetCell>	Cases;
+	// A cell and the row after the last one that holds it: a whole block of repeated rows takes up just one run.
+	struct Run
+	{
+		ODSSheetCell	cell;
+		size_t			end;
+	};
+
+	// The constainer used to hold rows within the column, as runs of the same cell.
+	typedef std::vector<Run>	Cases;
 
 	ODSImportColumn(ODSImportDataSet* importDataSet, int columnNumber, std::string name);
 	virtual ~ODSImportColumn();
@@ -80,7 +87,7 @@ public:
 	}
 
 	/**
-	 * @brief _createSpace Ensures that we have enough elements in _rows.
+	 * @brief _createSpace Ensures that we have enough rows, the new ones are empty.
 	 * @param row Row number to check for.
 	 */
 	void createSpace(size_t row);
@@ -92,7 +99,15 @@ public:
 	 */
 	void setValue(int row, const std::string& data);
 
-	const ODSSheetCell &getCell(int row) const { return _rows.at(row); }
+	/**
+	 * @brief repeatValue Makes the count rows that follow row hold its value as well.
+	 * When row is the last one, as it is while the sheet is read, this only lengthens its run, so repeated rows take no memory until getData expands them.
+	 * @param row Row to repeat.
+	 * @param count Number of times.
+	 */
+	void repeatValue(int row, size_t count);
+
+	const ODSSheetCell &getCell(int row) const { return _runAt(row)->cell; }
 
 	/**
 	 * @brief postLoadProcess Performs posy load processing.
@@ -109,12 +124,17 @@ public:
 	// Getters.
 	Column::ColumnType getJASPColumnType() const { return _columnType; }
 
+	// The values of all rows, this is where the repeated rows are expanded.
 	std::vector<std::string> getData();
 
 private:
 
 	// The cells/rows (as read).
 	Cases	_rows;
+	size_t	_rowCount = 0;
+
+	Cases::const_iterator	_runAt(size_t row) const;
+	void					_setRows(size_t first, size_t count, const ODSSheetCell &cell);
 
 	typedef std::map< int, size_t > CellIndex;
 	CellIndex			_index;		///< cell indexes indexed by row.
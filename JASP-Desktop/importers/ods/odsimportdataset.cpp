@@ -95,9 +95,10 @@ void ODSImportDataSet::postLoadProcess()
 
 
 	// ensure that we have enough rows.
-	for (ImportColumns::iterator colI = begin(); colI != end(); ++colI)
-	{
-		ODSImportColumn * col = static_cast<ODSImportColumn *>(*colI);
-		col->createSpace(numRows - 1);
-	}
+	if (numRows > 0)
+		for (ImportColumns::iterator colI = begin(); colI != end(); ++colI)
+		{
+			ODSImportColumn * col = static_cast<ODSImportColumn *>(*colI);
+			col->createSpace(numRows - 1);
+		}
 }
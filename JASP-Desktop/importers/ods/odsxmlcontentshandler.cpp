@@ -30,7 +30,7 @@ const QString XmlContentsHandler::_typeTime("time");
 
 
 XmlContentsHandler::XmlContentsHandler(ODSImportDataSet *dta)
- : XmlHandler(dta)
+ : _dataSet(dta)
  , _docDepth(not_in_doc)
  , _row(0)
  , _column(0)
@@ -39,27 +39,24 @@ XmlContentsHandler::XmlContentsHandler(ODSImportDataSet *dta)
  , _lastType(odsType_unknown)
  , _colRepeat(1)
  , _rowRepeat(1)
-
+ , _readingText(false)
 {
 
 }
 
 /**
  * @brief startElement Called on the start of an element.
- * @param namespaceURI - the URI.
  * @param localName - local name (name without prefix).
- * @param qName - Qualified name.
  * @param atts- Attributes.
- * @return true on no error found.
  *
  * Called when a <tag ...> construction found.
  *
  */
-bool XmlContentsHandler::startElement(const QString &namespaceURI, const QString &localName, const QString &qName, const QXmlAttributes &atts)
+void XmlContentsHandler::startElement(const QStringRef &localName, const QXmlStreamAttributes &atts)
 {
 	if (_tableRead == false)
 	{
-		DEBUG_COUT6("XmlContentsHandler::startElement. docDepth: ", _docDepth, ", localName: ", localName.toStdString(), ", qName: ", qName.toStdString());
+		DEBUG_COUT4("XmlContentsHandler::startElement. docDepth: ", _docDepth, ", localName: ", localName.toString().toStdString());
 		
 		// Where were we?
 		switch(_docDepth)
@@ -103,33 +100,31 @@ bool XmlContentsHandler::startElement(const QString &namespaceURI, const QString
 
 		case table_cell:
 			if (localName == _nameText)
+			{
 				_docDepth = text;
+				// Only the first paragraph, and only if the value wasn't in the attributes.
+				_readingText = _currentCell.empty();
+			}
 			break;
 
 		case text:
 			break;
 		}
 	} // if ! table read.
-
-	return true;
 }
 
 /**
  * @brief endElement Called on the end of an element.
- * @param namespaceURI - the URI.
  * @param localName - local name (name without prefix).
- * @param qName - Qualified name.
- * @param atts- Attributes.
- * @return true on no error found.
  *
  * Called when a </tag> construction found.
  *
  */
-bool XmlContentsHandler::endElement(const QString &namespaceURI, const QString &localName, const QString &qName)
+void XmlContentsHandler::endElement(const QStringRef &localName)
 {
 	if (_tableRead == false)
 	{
-		DEBUG_COUT6("XmlContentsHandler::endElement. docDepth: ", _docDepth, ", localName: ", localName.toStdString(), ", qName: ", qName.toStdString());
+		DEBUG_COUT4("XmlContentsHandler::endElement. docDepth: ", _docDepth, ", localName: ", localName.toString().toStdString());
 		
 		switch(_docDepth)
 		{
@@ -158,18 +153,15 @@ bool XmlContentsHandler::endElement(const QString &namespaceURI, const QString &
 			if (localName == _nameTableRow)
 			{
 				_docDepth = table;
-				if (_row > 0 && _lastNotEmptyColumn > -1)
+				if (_row > 0 && _lastNotEmptyColumn > -1 && _rowRepeat > 1)
 				{
-					// Repeat the last row
-					for (int i = 1; i < _rowRepeat; i++)
-					{
-						for (int j = 0; j < _dataSet->columnCount(); j++)
-						{
-							(*_dataSet)[j].setValue(_row, (*_dataSet)[j].getCell(_row - 1).valueAsString());
-						}
-						_row++;
-					}
+					// Repeat the last row, a column at a time.
+					for (int j = 0; j < _dataSet->columnCount(); j++)
+						(*_dataSet)[j].repeatValue(_row - 1, _rowRepeat - 1);
+
+					_row += _rowRepeat - 1;
 				}
+				// Repeated empty rows (usually the padding up to the end of the sheet) are not stored.
 				_row++;
 				// Starting next column.
 				_column = 0;
@@ -182,7 +174,7 @@ bool XmlContentsHandler::endElement(const QString &namespaceURI, const QString &
 		case table_cell:
 			if (localName == _nameTableCell)
 			{
-				if (!_currentCell.isEmpty())
+				if (!_currentCell.empty())
 				{
 					if (_row == 0)
 					{
@@ -196,7 +188,7 @@ bool XmlContentsHandler::endElement(const QString &namespaceURI, const QString &
 							_dataSet->createColumn(ss.str());
 						}
 						// Create the column with the current cell name
-						_dataSet->createColumn(_currentCell.toStdString());
+						_dataSet->createColumn(_currentCell);
 						// Repeat create column if necessary
 						for (int i = 1; i < _colRepeat; i++)
 						{
@@ -213,7 +205,7 @@ bool XmlContentsHandler::endElement(const QString &namespaceURI, const QString &
 							_dataSet->getOrCreate(i).setValue(_row - 1, string());
 						}
 						for (int i = 0; i < _colRepeat; i++)
-							_dataSet->getOrCreate(_column + i).setValue(_row - 1, _currentCell.toStdString());
+							_dataSet->getOrCreate(_column + i).setValue(_row - 1, _currentCell);
 					}
 					_lastNotEmptyColumn = _column + _colRepeat - 1;
 				}
@@ -227,32 +219,31 @@ bool XmlContentsHandler::endElement(const QString &namespaceURI, const QString &
 
 		case text:
 			if (localName == _nameText)
+			{
 				_docDepth = table_cell;
+				_readingText = false;
+			}
 			break;
 		}
 	}
-
-	return true;
 }
 
 
 /**
  * @brief characters Called when char data found.
- * @param ch The found data.
- * @return true on no error.
+ * @param ch The found data, can be a part of the text when it contains entities.
  */
-bool XmlContentsHandler::characters(const QString &ch)
+void XmlContentsHandler::characters(const QStringRef &ch)
 {
 
 	if (_tableRead == false)
 	{
-		if ((_docDepth == text) && (ch.isEmpty() == false) && _currentCell.isEmpty())
+		if ((_docDepth == text) && _readingText)
 		{
-			DEBUG_COUT2("Characters: ", ch.toStdString());
-			_currentCell = ch;
+			DEBUG_COUT2("Characters: ", ch.toString().toStdString());
+			_currentCell.append(ch.toUtf8().constData());
 		}
 	}
-	return true;
 }
 
 
@@ -269,7 +260,9 @@ void XmlContentsHandler::resetDocument()
 	_lastType = odsType_unknown;
 	_colRepeat = 1;
 	_rowRepeat = 1;
-	
+	_readingText = false;
+	_currentCell.clear();
+
 	_dataSet->clear();
 }
 
@@ -279,10 +272,10 @@ void XmlContentsHandler::resetDocument()
  * @param QXmlAttributes atts Attriutes to find.
  * @return value of lastType;
  */
-XmlDatatype XmlContentsHandler::_setLastTypeGetValue(QString &value, const QXmlAttributes &atts)
+XmlDatatype XmlContentsHandler::_setLastTypeGetValue(string &value, const QXmlStreamAttributes &atts)
 {
 	_lastType = odsType_unknown;
-	QString fromfile = atts.value(_attValueType);
+	QStringRef fromfile = atts.value(_attValueType);
 
 	if (fromfile == _typeFloat)
 		_lastType = odsType_float;
@@ -304,16 +297,16 @@ XmlDatatype XmlContentsHandler::_setLastTypeGetValue(QString &value, const QXmlA
 	case odsType_float:
 	case odsType_currency:
 	case odsType_percent:
-		value = atts.value(_attValue);
+		value = atts.value(_attValue).toUtf8().constData();
 		break;
 	case odsType_boolean:
-		value = atts.value(_attBoolValue);
+		value = atts.value(_attBoolValue).toUtf8().constData();
 		break;
 	case odsType_date:
-		value = atts.value(_attDateValue);
+		value = atts.value(_attDateValue).toUtf8().constData();
 		break;
 	case odsType_time:
-		value = atts.value(_attTimeValue);
+		value = atts.value(_attTimeValue).toUtf8().constData();
 		break;
 	case odsType_string:
 	case odsType_unknown:
@@ -329,7 +322,7 @@ XmlDatatype XmlContentsHandler::_setLastTypeGetValue(QString &value, const QXmlA
  * @param defaultValue The value to return if not found.
  * @return The found value or default.
  */
-int XmlContentsHandler::_findColRepeat(const QXmlAttributes &atts, int defaultValue)
+int XmlContentsHandler::_findColRepeat(const QXmlStreamAttributes &atts, int defaultValue)
 {
 	int result = 0;
 	bool okay = false;
@@ -337,7 +330,7 @@ int XmlContentsHandler::_findColRepeat(const QXmlAttributes &atts, int defaultVa
 	return (okay) ? result : defaultValue;
 }
 
-int XmlContentsHandler::_findRowRepeat(const QXmlAttributes &atts, int defaultValue)
+int XmlContentsHandler::_findRowRepeat(const QXmlStreamAttributes &atts, int defaultValue)
 {
 	int result = 0;
 	bool okay = false;
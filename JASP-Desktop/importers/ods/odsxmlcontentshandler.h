@@ -2,14 +2,23 @@
 #define ODSXMLCONTENTSHANDLER_H
 
 #include <vector>
+#include <string>
 
-#include "odsxmlhandler.h"
+#include <QXmlStreamReader>
+
+#include "odsimportdataset.h"
 #include "odstypes.h"
 
 namespace ods
 {
 
-class XmlContentsHandler : public XmlHandler
+/**
+ * @brief The XmlContentsHandler class Fills the dataset from the first table in content.xml.
+ *
+ * It is driven by ODSImporter::readContents, which pulls the elements from a QXmlStreamReader that is fed the
+ * content.xml straight from the archive, a block at a time. So the document is never in memory as a whole.
+ */
+class XmlContentsHandler
 {
 	// Depth in XML document.
 	typedef enum e_docDepth
@@ -29,36 +38,33 @@ public:
 
 	/**
 	 * @brief startElement Called on the start of an element.
-	 * @param namespaceURI - the URI.
 	 * @param localName - local name (name without prefix).
-	 * @param qName - Qualified name.
 	 * @param atts- Attributes.
-	 * @return true on no error found.
 	 *
 	 * Called when a <tag ...> construction found.
 	 *
 	 */
-	virtual bool startElement(const QString &namespaceURI, const QString &localName, const QString &qName, const QXmlAttributes &atts);
+	void startElement(const QStringRef &localName, const QXmlStreamAttributes &atts);
 
 	/**
 	 * @brief endElement Called on the end of an element.
-	 * @param namespaceURI - the URI.
 	 * @param localName - local name (name without prefix).
-	 * @param qName - Qualified name.
-	 * @param atts- Attributes.
-	 * @return true on no error found.
 	 *
 	 * Called when a </tag> construction found.
 	 *
 	 */
-	virtual bool endElement(const QString &namespaceURI, const QString &localName, const QString &qName);
+	void endElement(const QStringRef &localName);
 
 	/**
 	 * @brief characters Called when char data found.
 	 * @param ch The found data.
-	 * @return true on no error.
 	 */
-	virtual bool characters(const QString &ch);
+	void characters(const QStringRef &ch);
+
+	/**
+	 * @brief tableRead True once the first table is read, the rest of the document is of no interest.
+	 */
+	bool tableRead() const { return _tableRead; }
 
 	/**
 	 * @brief resetDocument Reset level, row and column, clears data.
@@ -66,6 +72,7 @@ public:
 	void resetDocument();
 
 private:
+	ODSImportDataSet *_dataSet;
 	DocDepth 		_docDepth;			///< Current depth of document.
 	int				_row;				///< Current row in document/table.
 	int				_column;			///< Current column in document/table.
@@ -74,7 +81,8 @@ private:
 	XmlDatatype		_lastType;		///< The last type we found in a opening tag.
 	int				_colRepeat;			///< Number cells this XML element spans.
 	int				_rowRepeat;
-	QString			_currentCell;
+	std::string		_currentCell;		///< Value of the current cell, in UTF-8.
+	bool			_readingText;		///< True if the text in this text element is the value of the cell.
 
 	// Names we search for.
 	static const QString _nameDocContent;
@@ -107,10 +115,10 @@ private:
 	/**
 	 * @brief XmlContentsHandler::setLastType Sets the lastType value, and gets value
 	 * @param QValue value OUTPIT value found.
-	 * @param QXmlAttributes atts Attriutes to find.
+	 * @param QXmlStreamAttributes atts Attriutes to find.
 	 * @return value of lastType;
 	 */
-	XmlDatatype _setLastTypeGetValue(QString &value, const QXmlAttributes &atts);
+	XmlDatatype _setLastTypeGetValue(std::string &value, const QXmlStreamAttributes &atts);
 
 	/**
 	 * @brief _findColRepeat/_findRowRepeat Finds the column/row repeat from attributes.
@@ -118,8 +126,8 @@ private:
 	 * @param defaultValue The value to return if not found.
 	 * @return The found value or default.
 	 */
-	static int _findColRepeat(const QXmlAttributes &atts, int defaultValue = 1);
-	static int _findRowRepeat(const QXmlAttributes &atts, int defaultValue = 1);
+	static int _findColRepeat(const QXmlStreamAttributes &atts, int defaultValue = 1);
+	static int _findRowRepeat(const QXmlStreamAttributes &atts, int defaultValue = 1);
 
 };
 
@@ -23,6 +23,7 @@
 #include "filereader.h"
 
 #include <QXmlInputSource>
+#include <QXmlStreamReader>
 
 namespace ods
 {
@@ -39,7 +40,7 @@ ImportDataSet* ODSImporter::loadFile(const std::string &locator, boost::function
 
 	// Read the sheet contents.
 	progressCallback("Reading ODS contents.", 33);
-	readContents(locator, result);
+	readContents(locator, result, progressCallback);
 
 	// Do post load processing:
 	progressCallback("Processing.", 60);
@@ -51,12 +52,12 @@ ImportDataSet* ODSImporter::loadFile(const std::string &locator, boost::function
 	return result;
 }
 
-void ODSImporter::fillSharedMemoryColumn(ImportColumn *importColumn, Column &column)
+void ODSImporter::prepareColumn(ImportColumn *importColumn, PreparedColumn &column)
 {
 	ODSImportColumn *odsColumn = dynamic_cast<ODSImportColumn *>(importColumn);
 	const std::vector<std::string> &values = odsColumn->getData();
 
-	fillSharedMemoryColumnWithStrings(values, column);
+	prepareColumnWithStrings(values, column);
 
 
 }
@@ -85,26 +86,56 @@ void ODSImporter::readManifest(const std::string &path, ODSImportDataSet *datase
 	}
 }
 
-void ODSImporter::readContents(const std::string &path, ODSImportDataSet *dataset)
+void ODSImporter::readContents(const std::string &path, ODSImportDataSet *dataset, boost::function<void(const std::string &, int)> progressCallback)
 {
-
 	FileReader contents(path, dataset->getContentFilename());
 
-	QXmlInputSource src;
+	if (contents.size() == 0)
+		throw std::runtime_error("Error reading contents in ODS.");
+
+	// The contents are fed to the reader a block at a time as they come out of the archive, so we never hold the whole (UTF-8) document, let alone a UTF-16 copy of it.
+	const int			blockSize	= 256 * 1024;
+	std::vector<char>	block(blockSize);
+	QXmlStreamReader	reader;
+	XmlContentsHandler	contentsHandler(dataset);
+	int					lastProgress = -1;
+
+	while (!contentsHandler.tableRead())
 	{
-		std::string tmp;
-		int errorCode = 0;
-		if (((tmp = contents.readAllData(4096, errorCode)).size() == 0) || (errorCode < 0))
+		while (!reader.atEnd() && !contentsHandler.tableRead())
+		{
+			switch (reader.readNext())
+			{
+			case QXmlStreamReader::StartElement:	contentsHandler.startElement(reader.name(), reader.attributes());	break;
+			case QXmlStreamReader::EndElement:		contentsHandler.endElement(reader.name());							break;
+			case QXmlStreamReader::Characters:		contentsHandler.characters(reader.text());							break;
+			default:																									break;
+			}
+		}
+
+		if (contentsHandler.tableRead())
+			break;
+
+		if (reader.hasError() && reader.error() != QXmlStreamReader::PrematureEndOfDocumentError)
+			throw std::runtime_error("Error reading contents in ODS: " + reader.errorString().toStdString());
+
+		int errorCode	= 0,
+			bytesRead	= contents.readData(block.data(), blockSize, errorCode);
+
+		if (errorCode < 0)
 			throw std::runtime_error("Error reading contents in ODS.");
-		src.setData(QString::fromStdString(tmp));
-	}
 
-	{
-		XmlContentsHandler * contentsHandler = new XmlContentsHandler(dataset);
-		QXmlSimpleReader reader;
-		reader.setContentHandler(contentsHandler);
-		reader.setErrorHandler(contentsHandler);
-		reader.parse(src);
+		if (bytesRead <= 0)
+			break; // No table, or a document that ends early, we keep what we have.
+
+		reader.addData(QByteArray(block.data(), bytesRead));
+
+		int progress = 33 + static_cast<int>(27.0 * contents.pos() / contents.size());
+		if (progress != lastProgress)
+		{
+			progressCallback("Reading ODS contents.", progress);
+			lastProgress = progress;
+		}
 	}
 
 	contents.close();
@@ -39,7 +39,7 @@ public:
 protected:
 	// Implmemtation of Inporter base class.
 	virtual ImportDataSet* loadFile(const std::string &locator, boost::function<void(const std::string &, int)> progressCallback);
-	virtual void fillSharedMemoryColumn(ImportColumn *importColumn, Column &column);
+	virtual void prepareColumn(ImportColumn *importColumn, PreparedColumn &column);
 
 private:
 	static const std::string _contentFile;
@@ -58,8 +58,9 @@ private:
 	 * @brief readContents Reads contents to _dta;
 	 * @param path The file path to the archive file
 	 * @param dataset The data set to import into.
+	 * @param progressCallback Gets the progress while the contents are read.
 	 */
-	void readContents(const std::string &path, ODSImportDataSet *dataset);
+	void readContents(const std::string &path, ODSImportDataSet *dataset, boost::function<void(const std::string &, int)> progressCallback);
 
 };
 
@@ -21,6 +21,8 @@
 #include "spssimportdataset.h"
 #include "../importerutils.h"
 #include <cmath>
+#include <cstring>
+#include <algorithm>
 
 using namespace std;
 using namespace boost;
@@ -44,6 +46,11 @@ DataRecords::DataRecords(SPSSImporter* importer, SPSSImportDataSet *dataset, con
  , _fixer(fixer)
  , _numDbls(0)
  , _numStrs(0)
+ , _nextCell(0)
+ , _blockPos(0)
+ , _blockEnd(0)
+ , _blockFilePos(0)
+ , _zlibBlocks(NULL)
 {
 }
 
@@ -52,133 +59,297 @@ DataRecords::DataRecords(SPSSImporter* importer, SPSSImportDataSet *dataset, con
  */
 void DataRecords::read()
 {
+	buildPlan();
 
-	if (_fileHeader.compressed() == 0)
+	if (_plan.empty())
+		return;
+
+	const size_t blockSize = 4 * 1024 * 1024;
+	_block.resize(blockSize);
+	_blockFilePos = _from.tellg();
+
+	switch (_fileHeader.compressed())
+	{
+	case FileHeaderRecord::compression_none:
 		readUncompressed();
-	else
+		break;
+
+	case FileHeaderRecord::compression_zlib:
+	{
+		// The inflated blocks hold the same bytecode as compression_bytecode.
+		ZLibDataBlocks zlibBlocks(_fixer, _from);
+		_zlibBlocks = &zlibBlocks;
 		readCompressed();
-}
+		_zlibBlocks = NULL;
+		break;
+	}
 
+	default:
+		readCompressed();
+		break;
+	}
+
+	removeSegmentColumns();
+}
 
 /**
- * @brief readCompressed - Reads compressed data
+ * @brief buildPlan Works out the PlannedCell for each cell in a case, merges the segments of very long strings into their root column.
  */
-void DataRecords::readCompressed()
+void DataRecords::buildPlan()
 {
-	unsigned char codes[ sizeof(Char_8) ];
+	// merged strings are slightly shorter than what is in the file.
+	// See Appendix B System File Format, PSPP devloper's Guide, release 0.10.2 pp69
+	const size_t mergedStrlen = 252;
+	const SPSSImportDataSet::LongColsData &longStrings = _dataset->veryLongColsDat();
 
-	bool eofFlag = false;
-	while (_from.good() && !eofFlag)
-	{
-		_importer->reportFileProgress(_from.tellg(), _progress);
-		memset(codes, code_eof, sizeof(codes));
+	_plan.clear();
+	_nextCell = 0;
 
-		_SPSSIMPORTER_READ_VAR(codes, _from);
+	for (ImportColumns::iterator colIt = _dataset->begin(); colIt != _dataset->end(); ++colIt)
+	{
+		SPSSImportColumn *column = dynamic_cast<SPSSImportColumn*>(*colIt);
+		bool isString = column->cellType() == SPSSImportColumn::cellString;
 
-		for (size_t cnt = 0; cnt < sizeof(codes); cnt++)
+		if (!_dataset->hasNoCases())
 		{
-			// Decode the code found.
-			switch(codes[cnt])
-			{
-			case code_ignore: break;
+			if (isString)	column->strings.reserve(_dataset->numCases());
+			else			column->numerics.reserve(_dataset->numCases());
+		}
 
-			default: // A compressed data value.
-				insertToCol(_importer->getNextColumn(_dataset), static_cast<double>(codes[cnt]) - _fileHeader.bias());
-				break;
+		SPSSImportDataSet::LongColsData::const_iterator longString = isString ? longStrings.find(column->spssRawColName()) : longStrings.end();
 
-			case code_eof: // end of file found.
-				eofFlag = true;
-				break;
+		if (longString == longStrings.end())
+		{
+			for (size_t cell = 0; cell < column->columnSpan(); cell++)
+				_plan.push_back({ column, isString, cell == 0, sizeof(Char_8) });
+			continue;
+		}
 
-			case code_notCompressed:
-				// Uncompressed data values follows..
-				readUnCompVal(_importer->getNextColumn(_dataset));
-				break;
+		// A very long string, the segments are the columns that follow it and go into this one.
+		SPSSImportColumn	*root		= column;
+		size_t				merged		= 0,
+							keep		= root->spssStringLen() == 255 ? mergedStrlen : root->spssStringLen();
 
-			case code_allSpaces:
-				insertToCol(_importer->getNextColumn(_dataset), string(sizeof(Char_8), ' '));
-				break;
+		while (true)
+		{
+			for (size_t cell = 0; cell < column->columnSpan(); cell++)
+			{
+				size_t from = cell * sizeof(Char_8);
+				_plan.push_back({ root, true, column == root && cell == 0, from >= keep ? 0 : std::min(keep - from, sizeof(Char_8)) });
+			}
 
-			case code_systmMissing:
-				// system missing value follows.
-				insertToCol(_importer->getNextColumn(_dataset), NAN);
+			merged += keep;
+
+			if (merged >= longString->second || colIt + 1 == _dataset->end())
 				break;
 
-			}
+			++colIt;
+			column	= dynamic_cast<SPSSImportColumn*>(*colIt);
+			keep	= std::min(mergedStrlen, longString->second - merged);
+			_segmentColumns.push_back(column);
 		}
+
+		root->spssStringLen(merged);
 	}
 }
 
+/**
+ * @brief removeSegmentColumns Drops the columns that only held segments of very long strings, their content has been read into the root column.
+ */
+void DataRecords::removeSegmentColumns()
+{
+	for (SPSSImportColumn *segment : _segmentColumns)
+	{
+		ImportColumns::iterator found = std::find(_dataset->begin(), _dataset->end(), segment);
+
+		if (found != _dataset->end())
+			_dataset->erase(found);
+	}
+
+	_segmentColumns.clear();
+}
 
 /**
- * @brief readUncompressed - Reads uncompressed data
+ * @brief fillBlock Reads the next block from the file, keeping what was left of the current one.
+ * @return true if there is at least one full cell available.
  */
-void DataRecords::readUncompressed()
+bool DataRecords::fillBlock()
 {
-	while (_from.good())
+	size_t left = _blockEnd - _blockPos;
+
+	if (left > 0)
+		memmove(_block.data(), _block.data() + _blockPos, left);
+
+	_blockPos	= 0;
+	_blockEnd	= left;
+
+	if (_zlibBlocks != NULL)
+	{
+		_blockEnd		+= _zlibBlocks->read(_block.data() + left, _block.size() - left);
+		_blockFilePos	 = _zlibBlocks->filePosition();
+	}
+	else if (_from.good())
 	{
-		_importer->reportFileProgress(_from.tellg(), _progress);
-		readUnCompVal(_importer->getNextColumn(_dataset));
+		_from.read(_block.data() + left, _block.size() - left);
+		_blockEnd		+= _from.gcount();
+		_blockFilePos	+= _from.gcount();
 	}
+
+	// Once per block is more than enough to keep the progress bar moving.
+	_importer->reportFileProgress(_blockFilePos, _progress);
+
+	return _blockEnd - _blockPos >= sizeof(Char_8);
 }
 
+/**
+ * @brief nextCell Gets the next 8 bytes from the data section.
+ * @return Pointer to them, or NULL at the end of the data.
+ */
+inline const char *DataRecords::nextCell()
+{
+	if (_blockEnd - _blockPos < sizeof(Char_8) && !fillBlock())
+		return NULL;
+
+	const char *cell = _block.data() + _blockPos;
+	_blockPos += sizeof(Char_8);
+
+	return cell;
+}
 
 /**
- * @brief insertToCol Insrts a string into the (next) column.
- * @param str The string value to insert / append.
+ * @brief advance Moves on to the next cell in the case, wrapping to the next case.
+ * @return The cell we were at.
  */
-void DataRecords::insertToCol(SPSSImportColumn &col, const string &str)
+inline const DataRecords::PlannedCell &DataRecords::advance()
 {
-	if (col.cellType() == SPSSImportColumn::cellString)
+	const PlannedCell &cell = _plan[_nextCell];
+
+	if (++_nextCell == _plan.size())
+		_nextCell = 0;
+
+	return cell;
+}
+
+/**
+ * @brief storeNumber Stores a value in the column of the next cell in the case.
+ * @param value The value to store.
+ */
+inline void DataRecords::storeNumber(double value)
+{
+	const PlannedCell &cell = advance();
+
+	if (!cell.isString)
 	{
-		if (_importer->isSpaning())
-		{
-			col.append(str);
-//			DEBUG_COUT5("Appended string \"", str, "\" into column ", col.spssRawColName(), ".");
-		}
-		else
-		{
-			col.insert(str);
-//			DEBUG_COUT5("Inserted string \"", str, "\" into column ", col.spssRawColName(), ".");
-		}
-		_numStrs++;
+		cell.column->numerics.push_back(value);
+		_numDbls++;
 	}
 	else
-		DEBUG_COUT5("FAILED TO INSERT string \"", str, "\" into column ", col.spssRawColName(), ".");
+	{
+		DEBUG_COUT5("FAILED TO INSERT double ", value, " into column ", cell.column->spssRawColName(), ".");
+	}
 }
 
 /**
- * @brief insertToCol Insrts a string into the (next) column.
- * @param value The value to insert
+ * @brief storeChars Stores (part of) a string in the column of the next cell in the case.
+ * @param chars The 8 chars of the cell.
  */
-void DataRecords::insertToCol(SPSSImportColumn &col, double value)
+inline void DataRecords::storeChars(const char *chars)
 {
-	if (col.cellType() == SPSSImportColumn::cellDouble)
+	const PlannedCell &cell = advance();
+
+	if (cell.isString)
 	{
-		col.numerics.push_back(value);
-		_numDbls++;
-//		DEBUG_COUT5("Inserted double ", value, " into column ", col.spssRawColName(), ".");
+		std::vector<std::string> &strings = cell.column->strings;
+
+		if (cell.startsValue || strings.empty())
+			strings.push_back(std::string(chars, cell.keepChars));
+		else
+			strings.back().append(chars, cell.keepChars);
+
+		_numStrs++;
 	}
 	else
-		DEBUG_COUT5("FAILED TO INSERT double ", value, " into column ", col.spssRawColName(), ".");
-
+	{
+		DEBUG_COUT5("FAILED TO INSERT string \"", std::string(chars, sizeof(Char_8)), "\" into column ", cell.column->spssRawColName(), ".");
+	}
 }
 
 /**
- * @brief readUnCompVal Reads in and stores a single data value
- * @param col the column to insert into.
+ * @brief storeRaw Stores an uncompressed cell in the column of the next cell in the case.
+ * @param cell The 8 bytes of the cell.
  */
-void DataRecords::readUnCompVal(SPSSImportColumn &col)
+inline void DataRecords::storeRaw(const char *cell)
 {
-	SpssDataCell dta;
-	_SPSSIMPORTER_READ_VAR(dta, _from);
-	if (col.cellType() == SPSSImportColumn::cellString)
-		insertToCol(col, string(dta.chars, sizeof(dta.chars)));
+	if (_plan[_nextCell].isString)
+		storeChars(cell);
 	else
 	{
-		_fixer.fixup(&dta.dbl);
+		double value;
+		memcpy(&value, cell, sizeof(value));
+		_fixer.fixup(&value);
 
 		// TODO: Enstring date types!
-		insertToCol(col, dta.dbl);
+		storeNumber(value);
 	}
 }
+
+/**
+ * @brief readCompressed - Reads compressed data
+ */
+void DataRecords::readCompressed()
+{
+	static const char	allSpaces[sizeof(Char_8) + 1]	= "        ";
+	const double		bias							= _fileHeader.bias();
+	unsigned char		codes[ sizeof(Char_8) ];
+
+	for (const char *cell = nextCell(); cell != NULL; cell = nextCell())
+	{
+		// Copied because reading the uncompressed values that follow might refill the block.
+		memcpy(codes, cell, sizeof(codes));
+
+		for (size_t cnt = 0; cnt < sizeof(codes); cnt++)
+		{
+			// Decode the code found.
+			switch(codes[cnt])
+			{
+			case code_ignore: break;
+
+			default: // A compressed data value.
+				storeNumber(static_cast<double>(codes[cnt]) - bias);
+				break;
+
+			case code_eof: // end of file found.
+				return;
+
+			case code_notCompressed:
+			{
+				// Uncompressed data values follows..
+				const char *value = nextCell();
+				if (value == NULL)
+					return;
+				storeRaw(value);
+				break;
+			}
+
+			case code_allSpaces:
+				storeChars(allSpaces);
+				break;
+
+			case code_systmMissing:
+				// system missing value follows.
+				storeNumber(NAN);
+				break;
+			}
+		}
+	}
+}
+
+
+/**
+ * @brief readUncompressed - Reads uncompressed data
+ */
+void DataRecords::readUncompressed()
+{
+	for (const char *cell = nextCell(); cell != NULL; cell = nextCell())
+		storeRaw(cell);
+}
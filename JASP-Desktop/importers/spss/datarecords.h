@@ -22,6 +22,7 @@
 #include "fileheaderrecord.h"
 #include "../spssimporter.h"
 #include "spssimportcolumn.h"
+#include "zlibdatablocks.h"
 
 namespace spss {
 
@@ -99,24 +100,81 @@ private:
 	size_t  _numStrs;
 
 	/**
-	 * @brief insertToCol Insrts a string into the (next) column.
-	 * @param col The colum to insert into.
-	 * @param str The teing value to insert / append.
+	 * @brief The PlannedCell struct Where a single data cell of a case ends up.
+	 *
+	 * A case is always the same sequence of cells, so this is worked out once from the dictionary
+	 * instead of looking up the column for every cell read.
 	 */
-	void insertToCol(SPSSImportColumn &col, const std::string &str);
+	struct PlannedCell
+	{
+		SPSSImportColumn	*column;		// Column that receives the value, for a segment of a very long string that is the root column.
+		bool				isString;		// Whether this cell holds 8 chars or a double.
+		bool				startsValue;	// First cell of a (string) value, so a new string should be started.
+		size_t				keepChars;		// Number of chars of this cell that belong to the string.
+	};
+
+	std::vector<PlannedCell>		_plan;
+	size_t							_nextCell;
+	std::vector<SPSSImportColumn*>	_segmentColumns; // Columns that only hold a segment of a very long string.
+
+	/**
+	 * @brief _block The data section is read in blocks of this, cells are taken from it.
+	 */
+	std::vector<char>		_block;
+	size_t					_blockPos,
+							_blockEnd;
+	SPSSStream::pos_type	_blockFilePos;
+
+	/**
+	 * @brief _zlibBlocks Where the data comes from for a .zsav, NULL otherwise.
+	 */
+	ZLibDataBlocks			*_zlibBlocks;
+
+	/**
+	 * @brief buildPlan Works out the PlannedCell for each cell in a case, merges the segments of very long strings into their root column.
+	 */
+	void buildPlan();
+
+	/**
+	 * @brief removeSegmentColumns Drops the columns that only held segments of very long strings, their content has been read into the root column.
+	 */
+	void removeSegmentColumns();
+
+	/**
+	 * @brief nextCell Gets the next 8 bytes from the data section.
+	 * @return Pointer to them, or NULL at the end of the data.
+	 */
+	inline const char *nextCell();
+
+	/**
+	 * @brief fillBlock Reads the next block from the file, keeping what was left of the current one.
+	 * @return true if there is at least one full cell available.
+	 */
+	bool fillBlock();
+
+	/**
+	 * @brief storeNumber Stores a value in the column of the next cell in the case.
+	 * @param value The value to store.
+	 */
+	inline void storeNumber(double value);
+
+	/**
+	 * @brief storeRaw Stores an uncompressed cell in the column of the next cell in the case.
+	 * @param cell The 8 bytes of the cell.
+	 */
+	inline void storeRaw(const char *cell);
 
 	/**
-	 * @brief insertToCol Inserts a string into the (next) column.
-	 * @param col The colum to insert into.
-	 * @param value The value to insert
+	 * @brief storeChars Stores (part of) a string in the column of the next cell in the case.
+	 * @param chars The 8 chars of the cell.
 	 */
-	void insertToCol(SPSSImportColumn &col, double value);
+	inline void storeChars(const char *chars);
 
 	/**
-	 * @brief readUnCompVal Reads in and stores a single data value
-	 * @param col the cilum to insert into.
+	 * @brief advance Moves on to the next cell in the case, wrapping to the next case.
+	 * @return The cell we were at.
 	 */
-	void readUnCompVal(SPSSImportColumn &col);
+	inline const PlannedCell &advance();
 
 };
 
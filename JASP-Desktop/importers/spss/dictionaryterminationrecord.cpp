@@ -43,6 +43,5 @@ DictionaryTermination::~DictionaryTermination()
  */
 void DictionaryTermination::process(SPSSImporter* importer, SPSSImportDataSet *dataset)
 {
-	// inin the columns iterator.
-	importer->resetNextCol(dataset);
+	// The columns each cell goes to are planned by DataRecords.
 }
@@ -51,7 +51,7 @@ public:
 	{
 		compression_none = 0,
 		compression_bytecode = 1,
-		compression_zlib = 3
+		compression_zlib = 2
 	};
 
 	/*
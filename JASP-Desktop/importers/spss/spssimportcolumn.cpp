@@ -460,11 +460,12 @@ size_t SPSSImportColumn::append(const std::string &str)
 
 /**
  * @brief setColumnScaleData Sets floating point data into the column.
- * @param column The columns to insert into.
+ * @param column The prepared column to put the data in.
  */
-void SPSSImportColumn::setColumnScaleData(Column &column)
+void SPSSImportColumn::setColumnScaleData(PreparedColumn &column)
 {
-	vector<double> values = numerics;
+	vector<double> &values = column.doubles;
+	values = numerics;
 	size_t numCases = _dataset->numCases();
 	if (values.size() > numCases)
 		values.resize(numCases);
@@ -473,15 +474,14 @@ void SPSSImportColumn::setColumnScaleData(Column &column)
 		values[i] = missingChecker().processMissingValue(_dataset->getFloatInfo(), values[i]);
 	while (values.size() < numCases)
 		values.push_back(NAN);
-	// Have the columns do most of the work.
-	column.setColumnAsScale(values);
+	column.columnType = Column::ColumnTypeScale;
 }
 
 /**
  * @brief setColumnConvrtStringData Sets String data into the column.
- * @param column The columns to insert into.
+ * @param column The prepared column to put the data in.
  */
-void SPSSImportColumn::setColumnConvertStringData(Column &column)
+void SPSSImportColumn::setColumnConvertStringData(PreparedColumn &column)
 {
 	map<string, string> labels;
 	CodePageConvert &strConvertor = _dataset->stringsConv();
@@ -498,10 +498,10 @@ void SPSSImportColumn::setColumnConvertStringData(Column &column)
 		labels[value] = it->second;
 	}
 
-	column.setColumnAsNominalText(strings, labels);
+	column.setNominalText(strings, labels);
 }
 
-void SPSSImportColumn::setColumnConvertDblToString(Column &column)
+void SPSSImportColumn::setColumnConvertDblToString(PreparedColumn &column)
 {
 	map<string, string> labels;
 	strings.clear();
@@ -514,10 +514,10 @@ void SPSSImportColumn::setColumnConvertDblToString(Column &column)
 		labels[format(it->first.dbl, _dataset->getFloatInfo())] = it->second;
 	}
 
-	column.setColumnAsNominalText(strings, labels);
+	column.setNominalText(strings, labels);
 }
 
-void SPSSImportColumn::setColumnAsNominalOrOrdinal(Column &column, Column::ColumnType columnType)
+void SPSSImportColumn::setColumnAsNominalOrOrdinal(PreparedColumn &column, Column::ColumnType columnType)
 {
 	size_t numCases = _dataset->numCases();
 
@@ -548,7 +548,9 @@ void SPSSImportColumn::setColumnAsNominalOrOrdinal(Column &column, Column::Colum
 				dataToInsert.push_back(INT_MIN);
 		}
 
-		column.setColumnAsNominalOrOrdinal(dataToInsert, labels, columnType);
+		column.columnType	= columnType;
+		column.ints.swap(dataToInsert);
+		column.intLabels.swap(labels);
 	}
 }
 
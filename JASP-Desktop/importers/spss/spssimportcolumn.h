@@ -131,27 +131,27 @@ public:
 
 	/**
 	 * @brief setColumnConvertStringData Sets String data into the column, after doing a code page convert.
-	 * @param column The columns to insert into.
+	 * @param column The prepared column to put the data in.
 	 */
-	void setColumnConvertStringData(Column &column);
+	void setColumnConvertStringData(PreparedColumn &column);
 
 	/**
 	 * @brief setColumnConvertDblToString Sets String data into the column.
-	 * @param column The columns to insert into.
+	 * @param column The prepared column to put the data in.
 	 */
-	void setColumnConvertDblToString(Column &column);
+	void setColumnConvertDblToString(PreparedColumn &column);
 
 	/**
 	 * @brief setColumnAsNominalOrOrdinal Sets numeric data into the column, with labels.
-	 * @param column The columns to insert into.
+	 * @param column The prepared column to put the data in.
 	 */
-	void setColumnAsNominalOrOrdinal(Column &column, Column::ColumnType columnType);
+	void setColumnAsNominalOrOrdinal(PreparedColumn &column, Column::ColumnType columnType);
 
 	/**
 	 * @brief setColumnScaleData Sets floating point / scalar data into the column.
-	 * @param column The columns to insert into.
+	 * @param column The prepared column to put the data in.
 	 */
-	void setColumnScaleData(Column &column);
+	void setColumnScaleData(PreparedColumn &column);
 
 	protected:
 
@@ -0,0 +1,245 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zlibdatablocks.h"
+
+#include <zlib.h>
+#include <stdexcept>
+#include <cstring>
+#include <algorithm>
+
+#include "parallel.h"
+
+using namespace std;
+using namespace spss;
+
+/**
+ * @brief ZLibDataBlocks Reads the ZHEADER (at the current position of fromStream) and the ZTRAILER.
+ * See "System File Format", PSPP developer's Guide, for the layout.
+ */
+ZLibDataBlocks::ZLibDataBlocks(const NumericConverter &fixer, SPSSStream &fromStream)
+ : _fixer(fixer)
+ , _from(fromStream)
+ , _ahead(2 * Parallel::threadCount())
+ , _currentPos(0)
+ , _claimed(0)
+ , _handedOut(0)
+ , _inflated(_ahead)
+ , _ready(_ahead, false)
+ , _stopping(false)
+{
+	int64_t headerOffset	= static_cast<int64_t>(_from.tellg()),
+			zheaderOfs		= 0,
+			ztrailerOfs		= 0,
+			ztrailerLen		= 0;
+
+	_SPSSIMPORTER_READ_VAR(zheaderOfs, _from);		_fixer.fixup(&zheaderOfs);
+	_SPSSIMPORTER_READ_VAR(ztrailerOfs, _from);		_fixer.fixup(&ztrailerOfs);
+	_SPSSIMPORTER_READ_VAR(ztrailerLen, _from);		_fixer.fixup(&ztrailerLen);
+
+	if (!_from.good() || zheaderOfs != headerOffset || ztrailerOfs <= zheaderOfs)
+		throw runtime_error("The zlib header of the .ZSAV file is damaged.");
+
+	_from.seekg(ztrailerOfs);
+
+	int64_t bias = 0,
+			zero = 0;
+	int32_t blockSize = 0,
+			numBlocks = 0;
+
+	_SPSSIMPORTER_READ_VAR(bias, _from);		_fixer.fixup(&bias);
+	_SPSSIMPORTER_READ_VAR(zero, _from);		_fixer.fixup(&zero);
+	_SPSSIMPORTER_READ_VAR(blockSize, _from);	_fixer.fixup(&blockSize);
+	_SPSSIMPORTER_READ_VAR(numBlocks, _from);	_fixer.fixup(&numBlocks);
+
+	const int64_t entrySize = 24;
+
+	if (!_from.good() || numBlocks < 0 || ztrailerLen != entrySize * (numBlocks + 1))
+		throw runtime_error("The zlib trailer of the .ZSAV file is damaged.");
+
+	_blocks.resize(numBlocks);
+
+	int64_t expectedOffset = zheaderOfs + entrySize;
+
+	for (Block &block : _blocks)
+	{
+		_SPSSIMPORTER_READ_VAR(block.uncompressedOffset, _from);	_fixer.fixup(&block.uncompressedOffset);
+		_SPSSIMPORTER_READ_VAR(block.compressedOffset, _from);		_fixer.fixup(&block.compressedOffset);
+		_SPSSIMPORTER_READ_VAR(block.uncompressedSize, _from);		_fixer.fixup(&block.uncompressedSize);
+		_SPSSIMPORTER_READ_VAR(block.compressedSize, _from);		_fixer.fixup(&block.compressedSize);
+
+		// The blocks follow each other, without gaps, up to the trailer.
+		if (block.compressedOffset != expectedOffset || block.compressedSize < 0 || block.uncompressedSize < 0 || block.compressedOffset + block.compressedSize > ztrailerOfs)
+			throw runtime_error("The zlib trailer of the .ZSAV file does not match its data blocks.");
+
+		expectedOffset += block.compressedSize;
+	}
+
+	if (!_from.good())
+		throw runtime_error("The zlib trailer of the .ZSAV file is damaged.");
+
+	_filePosition = zheaderOfs + entrySize;
+
+	// A couple of blocks per thread keeps them all busy while not holding too much of the file in memory.
+	for (size_t i = std::min(Parallel::threadCount(), _blocks.size()); i > 0; i--)
+		_workers.push_back(std::thread(&ZLibDataBlocks::work, this));
+}
+
+ZLibDataBlocks::~ZLibDataBlocks()
+{
+	{
+		lock_guard<mutex> lock(_mutex);
+		_stopping = true;
+	}
+
+	_room.notify_all();
+
+	for (std::thread &worker : _workers)
+		worker.join();
+}
+
+/**
+ * @brief inflateBlock Inflates a single block, can be called from any thread.
+ */
+void ZLibDataBlocks::inflateBlock(const vector<char> &compressed, vector<char> &inflated, const Block &block)
+{
+	inflated.resize(block.uncompressedSize);
+
+	uLongf inflatedSize = block.uncompressedSize;
+
+	int result = uncompress(reinterpret_cast<Bytef *>(inflated.data()), &inflatedSize, reinterpret_cast<const Bytef *>(compressed.data()), compressed.size());
+
+	if (result != Z_OK || inflatedSize != static_cast<uLongf>(block.uncompressedSize))
+		throw runtime_error("Could not inflate a data block of the .ZSAV file.");
+}
+
+/**
+ * @brief work What each of the inflating threads does: takes on the next block, reads and inflates it, until the blocks run out.
+ * Whatever goes wrong is passed on to read().
+ */
+void ZLibDataBlocks::work()
+{
+	unique_lock<mutex> lock(_mutex);
+
+	while (true)
+	{
+		_room.wait(lock, [&]() { return _stopping || _error || _claimed >= _blocks.size() || _claimed < _handedOut + _ahead; });
+
+		if (_stopping || _error || _claimed >= _blocks.size())
+			return;
+
+		size_t			index	= _claimed++;
+		const Block		&block	= _blocks[index];
+		vector<char>	compressed(block.compressedSize),
+						inflated;
+
+		lock.unlock();
+
+		try
+		{
+			{
+				lock_guard<mutex> reading(_readMutex);
+
+				_from.seekg(block.compressedOffset);
+				_from.read(compressed.data(), block.compressedSize);
+
+				if (_from.gcount() != block.compressedSize)
+					throw runtime_error("The .ZSAV file ends in the middle of a data block.");
+			}
+
+			inflateBlock(compressed, inflated, block);
+		}
+		catch (...)
+		{
+			lock.lock();
+
+			if (!_error)
+				_error = current_exception();
+
+			_room.notify_all();
+			_inflatedOne.notify_all();
+			return;
+		}
+
+		lock.lock();
+
+		_inflated[index % _ahead].swap(inflated);
+		_ready[index % _ahead] = true;
+
+		_inflatedOne.notify_all();
+	}
+}
+
+/**
+ * @brief nextBlock Waits until the next block is inflated and makes it the current one.
+ * @return false if there are no more blocks.
+ */
+bool ZLibDataBlocks::nextBlock()
+{
+	if (_handedOut >= _blocks.size())
+		return false;
+
+	{
+		unique_lock<mutex> lock(_mutex);
+
+		size_t slot = _handedOut % _ahead;
+
+		_inflatedOne.wait(lock, [&]() { return _error || _ready[slot]; });
+
+		if (_error)
+			rethrow_exception(_error);
+
+		_current.swap(_inflated[slot]);
+		_ready[slot] = false;
+		vector<char>().swap(_inflated[slot]);
+
+		const Block &block	= _blocks[_handedOut];
+		_filePosition		= block.compressedOffset + block.compressedSize;
+		_currentPos			= 0;
+		_handedOut++;
+	}
+
+	_room.notify_all();
+
+	return true;
+}
+
+/**
+ * @brief read Copies the next inflated bytes.
+ * @param to Where to copy them.
+ * @param maxBytes How many bytes fit in there.
+ * @return The number of bytes copied, 0 when all blocks are done.
+ */
+size_t ZLibDataBlocks::read(char *to, size_t maxBytes)
+{
+	size_t copied = 0;
+
+	while (copied < maxBytes)
+	{
+		if (_currentPos == _current.size() && !nextBlock())
+			break;
+
+		size_t bytes = std::min(maxBytes - copied, _current.size() - _currentPos);
+
+		memcpy(to + copied, _current.data() + _currentPos, bytes);
+
+		copied		+= bytes;
+		_currentPos	+= bytes;
+	}
+
+	return copied;
+}
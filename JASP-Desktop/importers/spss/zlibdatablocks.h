@@ -0,0 +1,117 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ZLIBDATABLOCKS_H
+#define ZLIBDATABLOCKS_H
+
+#include "systemfileformat.h"
+#include "numericconverter.h"
+#include "spssstream.h"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace spss
+{
+
+/**
+ * @brief The ZLibDataBlocks class
+ *  Reads the data section of a .zsav file, which is the same bytecode compressed data as in a .sav
+ *  but cut into blocks that are each compressed with zlib. The ZTRAILER at the end of the file tells
+ *  where every block is, so a number of them can be read and inflated in parallel and handed out in order.
+ *  The inflating threads keep going while the blocks handed out are being decoded, a few blocks ahead of them.
+ */
+class ZLibDataBlocks
+{
+public:
+	/**
+	 * @brief ZLibDataBlocks Reads the ZHEADER (at the current position of fromStream) and the ZTRAILER.
+	 * @param fixer Fixes byte order.
+	 * @param fromStream The stream to read, positioned right after the dictionary termination record.
+	 */
+	ZLibDataBlocks(const NumericConverter &fixer, SPSSStream &fromStream);
+
+	/**
+	 * @brief ~ZLibDataBlocks Stops the inflating threads, fromStream is not read anymore afterwards.
+	 */
+	~ZLibDataBlocks();
+
+	/**
+	 * @brief read Copies the next inflated bytes.
+	 * @param to Where to copy them.
+	 * @param maxBytes How many bytes fit in there.
+	 * @return The number of bytes copied, 0 when all blocks are done.
+	 */
+	size_t read(char *to, size_t maxBytes);
+
+	/**
+	 * @brief filePosition Position in the file up to which the blocks have been read, for progress.
+	 */
+	SPSSStream::pos_type filePosition() const { return _filePosition; }
+
+	size_t numBlocks() const { return _blocks.size(); }
+
+private:
+	struct Block
+	{
+		int64_t		uncompressedOffset,
+					compressedOffset;
+		int32_t		uncompressedSize,
+					compressedSize;
+	};
+
+	/**
+	 * @brief work What each of the inflating threads does: takes on the next block, reads and inflates it, until the blocks run out.
+	 */
+	void work();
+
+	/**
+	 * @brief nextBlock Waits until the next block is inflated and makes it the current one.
+	 * @return false if there are no more blocks.
+	 */
+	bool nextBlock();
+
+	static void inflateBlock(const std::vector<char> &compressed, std::vector<char> &inflated, const Block &block);
+
+	const NumericConverter			&_fixer;
+	SPSSStream						&_from;			///< Only read by the inflating threads, one at a time
+	SPSSStream::pos_type			_filePosition;
+
+	std::vector<Block>				_blocks;
+	size_t							_ahead;			///< How many blocks may be inflated ahead of the current one.
+	std::vector<char>				_current;		///< The block read() copies from.
+	size_t							_currentPos;
+
+	std::vector<std::thread>		_workers;
+	std::mutex						_readMutex,		///< Guards _from
+									_mutex;			///< Guards everything below it
+	std::condition_variable			_room,			///< A block was handed out, so another one can be inflated
+									_inflatedOne;
+	size_t							_claimed,		///< Next block that a thread takes on
+									_handedOut;		///< Blocks that became the current one
+	std::vector<std::vector<char>>	_inflated;		///< The blocks inflated ahead, by their number modulo _ahead.
+	std::vector<bool>				_ready;
+	std::exception_ptr				_error;			///< The first thing that went wrong on an inflating thread
+	bool							_stopping;
+};
+
+}
+
+#endif // ZLIBDATABLOCKS_H
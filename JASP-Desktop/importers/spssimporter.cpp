@@ -214,76 +214,11 @@ ImportDataSet* SPSSImporter::loadFile(const std::string &locator, boost::functio
 }
 
 /**
- * @brief _processStringsPostLoad - Deals with very Long std::strings (len > 255) and CP processes all std::strings.
+ * @brief _processStringsPostLoad - Trims all std::strings, very long std::strings (len > 255) are already merged by DataRecords.
  * Call after the data is loaded!.
  */
 void SPSSImporter::_processStringsPostLoad(SPSSImportDataSet *dataset, boost::function<void (const std::string &, int)> progress)
 {
-	// For every found very long std::string.
-	const SPSSImportDataSet::LongColsData &strLens = dataset->veryLongColsDat();
-	float numStrlens = distance(strLens.begin(), strLens.end());
-	for (std::map<std::string, size_t>::const_iterator ituple = strLens.begin(); ituple != strLens.end(); ituple++)
-	{
-		{ // report progress
-			float prog = 100.0 * ((float) distance(strLens.begin(), ituple)) / numStrlens;
-			static float lastProg = -1.0;
-			if ((prog - lastProg) >= 1.0)
-			{
-				progress("Processing long std::strings.", (int) (prog + 0.5));
-				lastProg = prog;
-			}
-
-		}
-		// find the root col...
-		ImportColumns::iterator rootIter;
-		for (rootIter = dataset->begin(); rootIter != dataset->end(); rootIter++)
-		{
-			SPSSImportColumn* col = dynamic_cast<SPSSImportColumn*>(*rootIter);
-			DEBUG_COUT7("Matching '", ituple->first, "' against '", col->spssRawColName(), "' size ", ituple->second, ".");
-			if (col->spssRawColName() == ituple->first)
-					break;
-		}
-
-		const long mergedStrlen = 252;
-		// Shouldn't happen..
-		if (rootIter == dataset->end())
-			throw std::runtime_error("Failed to process a very long std::string value.");
-
-		SPSSImportColumn* rootColumn = dynamic_cast<SPSSImportColumn*>(*rootIter);
-		// merged std::strings are slightly shorter than what is in the file.
-		// See Appendix B System File Format, PSPP devloper's Guide, release 0.10.2 pp69
-		if (rootColumn->spssStringLen() == 255)
-			rootColumn->spssStringLen(mergedStrlen);
-
-		// Chop the length of the std::strings in the root col.
-		for (size_t cse  = 0; cse < rootColumn->strings.size(); cse++)
-		{
-			std::string str = rootColumn->strings[cse].substr(0, rootColumn->spssStringLen());
-			rootColumn->strings[cse] = str;
-		}
-
-		while (rootColumn->spssStringLen() < ituple->second)
-		{
-			// Find the next segment, (Should be next one along)
-			ImportColumns::iterator nextcolIter = rootIter;
-			++nextcolIter;
-			SPSSImportColumn* nextcol = dynamic_cast<SPSSImportColumn*>(*nextcolIter);
-			// How much to fetch?
-			long needed = std::min(mergedStrlen, long(std::min(ituple->second - rootColumn->spssStringLen(), rootColumn->spssStringLen())));
-
-			// Concatinate all the std::strings, going down the cases.
-			for (size_t cse  = 0; cse < rootColumn->strings.size(); cse++)
-			{
-				if (needed > 0)
-					rootColumn->strings[cse].append(nextcol->strings[cse], 0, needed);
-			}
-			// Advance the std::string length.
-			rootColumn->spssStringLen( rootColumn->spssStringLen() + needed );
-			// Dump the column.
-			dataset->erase(nextcolIter);
-		}
-	}
-
 	// Trim trialing spaces for all std::strings in the data set.
 	size_t numCols = distance(dataset->begin(), dataset->end());
 	for (ImportColumns::iterator iCol = dataset->begin(); iCol != dataset->end(); ++iCol)
@@ -312,7 +247,7 @@ void SPSSImporter::_processStringsPostLoad(SPSSImportDataSet *dataset, boost::fu
 	}
 }
 
-void SPSSImporter::fillSharedMemoryColumn(ImportColumn *importColumn, Column &column)
+void SPSSImporter::prepareColumn(ImportColumn *importColumn, PreparedColumn &column)
 {
 	SPSSImportColumn* spssCol = dynamic_cast<SPSSImportColumn*>(importColumn);
 
@@ -363,47 +298,4 @@ void SPSSImporter::reportFileProgress(SPSSStream::pos_type position, boost::func
 	}
 }
 
-/**
- * @brief resetNextCol. reset the col iterator
- *
- */
-void SPSSImporter::resetNextCol(SPSSImportDataSet *dataset)
-{
-	_currentColIter = dataset->begin();
-	SPSSImportColumn *col = dynamic_cast<SPSSImportColumn*>(*_currentColIter);
-	_remainingColSpan = col->columnSpan();
-}
-
-
-/**
- * @brief getNextColumn Get next column wrapping as required.
- * @return
- */
-SPSSImportColumn& SPSSImporter::getNextColumn(SPSSImportDataSet *dataset)
-{
-	// Grab what will be the result.
-	SPSSImportColumn *result = dynamic_cast<SPSSImportColumn*>(*_currentColIter);
-
-	// Set the spaning var.
-	_isSpaning = result->columnSpan() != _remainingColSpan;
-
-	// Anthing left (for next time)?
-	if (--_remainingColSpan == 0)
-	{
-		// Go to next column.
-		++_currentColIter;
-		// Dropped off end?
-		if (_currentColIter == dataset->end())
-		{
-			resetNextCol(dataset);
-		}
-		else
-		{
-			SPSSImportColumn* col = dynamic_cast<SPSSImportColumn*>(*_currentColIter);
-			_remainingColSpan = col->columnSpan();
-		}
-	}
-	return *result;
-}
-
 }
@@ -25,6 +25,8 @@
 
 
 #include "application.h"
+#include "resultsurlschemehandler.h"
+#include "tracing.h"
 
 int main(int argc, char *argv[])
 {
@@ -44,10 +46,18 @@ int main(int argc, char *argv[])
 
 	QLocale::setDefault(QLocale(QLocale::English)); // make decimal points == .
 
+	Tracing::enableFromEnvironment("JASP");
+
+	ResultsUrlSchemeHandler::registerScheme();
+
 	try
 	{
 		Application a(argc, argv);
-		return a.exec();
+		int result = a.exec();
+
+		Tracing::merge(); // The engines flush after every message, so what they recorded is there already
+
+		return result;
 	}
 	catch(...)
 	{
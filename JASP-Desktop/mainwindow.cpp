@@ -168,6 +168,7 @@ void MainWindow::makeConnections()
 {
 	_package->isModifiedChanged.connect(boost::bind(&MainWindow::packageChanged,	this,	_1));
 	_package->dataChanged.connect(		boost::bind(&MainWindow::packageDataChanged, this,	_1, _2, _3, _4, _5));
+	_package->cellsChanged.connect(		boost::bind(&MainWindow::packageCellsChanged, this,	_1, _2));
 
 	CONNECT_SHORTCUT("Ctrl+S",		&MainWindow::saveKeysSelected);
 	CONNECT_SHORTCUT("Ctrl+O",		&MainWindow::openKeysSelected);
@@ -177,6 +178,13 @@ void MainWindow::makeConnections()
 	CONNECT_SHORTCUT("Ctrl+-",		&MainWindow::zoomOutKeysSelected);
 	CONNECT_SHORTCUT("Ctrl+=",		&MainWindow::zoomEqualKeysSelected);
 
+	// Undo and redo are of edits in the data view, elsewhere (the analysis forms, the filter) the keys are left to the widget that has focus
+	QShortcut	*undoShortcut = new QShortcut(QKeySequence("Ctrl+Z"),			ui->quickWidget_Data, nullptr, nullptr, Qt::WidgetWithChildrenShortcut),
+				*redoShortcut = new QShortcut(QKeySequence("Ctrl+Shift+Z"),	ui->quickWidget_Data, nullptr, nullptr, Qt::WidgetWithChildrenShortcut);
+
+	connect(undoShortcut, &QShortcut::activated, this, &MainWindow::undoKeysSelected);
+	connect(redoShortcut, &QShortcut::activated, this, &MainWindow::redoKeysSelected);
+
 	connect(_levelsTableModel,		&LevelsTableModel::resizeLabelColumn,				this,					&MainWindow::resizeVariablesWindowLabelColumn				);
 	connect(_levelsTableModel,		&LevelsTableModel::labelFilterChanged,				_labelFilterGenerator,	&labelFilterGenerator::labelFilterChanged					);
 	connect(_levelsTableModel,		&LevelsTableModel::notifyColumnHasFilterChanged,	_tableModel,			&DataSetTableModel::notifyColumnFilterStatusChanged			);
@@ -221,6 +229,8 @@ void MainWindow::makeConnections()
 
 	connect(_odm,					&OnlineDataManager::progress,						this,					&MainWindow::setProgressStatus,								Qt::QueuedConnection);
 	connect(&_loader,				&AsyncLoader::progress,								this,					&MainWindow::setProgressStatus								);
+	connect(&_loader,				&AsyncLoader::emptyValuesReset,						this,					&MainWindow::emptyValuesReset								);
+	connect(&_loader,				&AsyncLoader::emptyValuesResetNeedsMemory,			this,					&MainWindow::emptyValuesResetNeedsMemory					);
 	connect(_engineSync,			&EngineSync::engineTerminated,						this,					&MainWindow::fatalError										);
 	connect(_okButton,				&QPushButton::clicked,								this,					&MainWindow::analysisOKed									);
 	connect(_runButton,				&QPushButton::clicked,								this,					&MainWindow::analysisRunned									);
@@ -236,6 +246,7 @@ void MainWindow::makeConnections()
 	connect(ui->tabBar,				&TabBar::useDefaultPPIHandler,						_resultsJsInterface,	&ResultsJsInterface::getDefaultPPI							);
 
 	connect(_filterModel,			&FilterModel::refreshAllAnalyses,					this,					&MainWindow::refreshAllAnalyses								);
+	connect(_filterModel,			&FilterModel::loadedAnalysesUpToDate,				_engineSync,			&EngineSync::cacheLoadedResults								);
 	connect(_filterModel,			&FilterModel::updateColumnsUsedInConstructedFilter, _tableModel,			&DataSetTableModel::setColumnsUsedInEasyFilter				);
 	connect(_filterModel,			&FilterModel::filterUpdated,						_tableModel,			&DataSetTableModel::refresh									);
 	connect(_filterModel,			&FilterModel::sendFilter,							_engineSync,			&EngineSync::sendFilter										);
@@ -496,6 +507,32 @@ void MainWindow::syncKeysSelected()
 	ui->backStage->sync();
 }
 
+void MainWindow::undoKeysSelected()
+{
+	if (filterShortCut() || !_package->canUndoEdit())
+		return;
+
+	try							{ _package->undoEdit(); }
+	catch (std::runtime_error &e)
+	{
+		_package->clearEdits(); // The data changed in some other way since, the older edits won't fit either
+		QMessageBox::warning(this, "Undo", QString::fromStdString(e.what()));
+	}
+}
+
+void MainWindow::redoKeysSelected()
+{
+	if (filterShortCut() || !_package->canRedoEdit())
+		return;
+
+	try							{ _package->redoEdit(); }
+	catch (std::runtime_error &e)
+	{
+		_package->clearEdits();
+		QMessageBox::warning(this, "Redo", QString::fromStdString(e.what()));
+	}
+}
+
 
 void MainWindow::illegalOptionStateChanged(AnalysisForm * form)
 {
@@ -610,14 +647,36 @@ void MainWindow::setDataSetAndPackageInModels(DataSetPackage *package)
 	_computedColumnsModel->setDataSetPackage(package);
 }
 
+// The cells of an edit were changed in place, so only what depends on those columns is refreshed, instead of the whole resync of packageDataChanged
+void MainWindow::packageCellsChanged(DataSetPackage *package, const DataSetChanges &changes)
+{
+	_tableModel->cellsChanged(changes);
+
+	for (size_t column : changes.columnsWithNewLabels)
+		_levelsTableModel->refreshColumn(&package->dataSet()->column(column));
+
+	vector<string>		changedColumns = changes.columnNames,
+						missingColumns;
+	map<string, string>	changeNameColumns;
+
+	_filterModel->checkForSendFilter();
+	refreshAnalysesUsingColumns(changedColumns, missingColumns, changeNameColumns, false);
+}
+
 void MainWindow::packageDataChanged(DataSetPackage *package,
 									vector<string> &changedColumns,
 									vector<string> &missingColumns,
 									map<string, string> &changeNameColumns,
 									bool rowCountChanged)
 {
+	package->clearEdits(); // They were made on the data as it was before the sync
 	setDataSetAndPackageInModels(package);
 
+	if(package->dataSet() != NULL) //Let the engines know their cached copies of these columns are outdated, edited cells already changed the revision of their column themselves
+		for(Column & column : package->dataSet()->columns())
+			if(rowCountChanged || std::find(changedColumns.begin(), changedColumns.end(), column.name()) != changedColumns.end())
+				column.incRevision();
+
 	_labelFilterGenerator->regenerateFilter();
 	_filterModel->checkForSendFilter();
 	refreshAnalysesUsingColumns(changedColumns, missingColumns, changeNameColumns, rowCountChanged);
@@ -1199,6 +1258,8 @@ void MainWindow::dataSetIOCompleted(FileEvent *event)
 			}
 			_analysisFormsMap.clear();
 			_analyses->clear();
+			_engineSync->clearResultsCache();
+			_engineSync->clearScheduler();
 			hideOptionsPanel();
 			setDataSetAndPackageInModels(NULL);
 			_loader.free(_package->dataSet());
@@ -1458,31 +1519,41 @@ void MainWindow::requestHelpPage(const QString &pageName)
 
 void MainWindow::emptyValuesChangedHandler()
 {
+	// This can take a while on large data sets, so it is done by the loader thread. emptyValuesReset follows once it is done.
 	if (_package->isLoaded())
+		_loader.resetEmptyValues(_package);
+}
+
+// The loader thread ran out of shared memory, which can only be enlarged here. The columns it did reset stay reset, it goes on with the others.
+void MainWindow::emptyValuesResetNeedsMemory(DataSetPackage *package, QStringList changedColumns)
+{
+	try
 	{
-		vector<string> colChanged;
-		vector<string> missingColumns;
-		map<string, string> changeNameColumns;
+		package->setDataSet(SharedMemory::enlargeDataSet(package->dataSet()));
+	}
+	catch (exception &)
+	{
+		emptyValuesReset(package, changedColumns, "Out of memory: this data set is too large for your computer's available memory");
+		return;
+	}
 
-		try
-		{
-			colChanged = _package->dataSet()->resetEmptyValues(_package->emptyValuesMap());
-		}
-		catch (boost::interprocess::bad_alloc &e)
-		{
-			try {
+	_loader.resetEmptyValues(package, changedColumns, true);
+}
 
-				_package->setDataSet(SharedMemory::enlargeDataSet(_package->dataSet()));
-				colChanged = _package->dataSet()->resetEmptyValues(_package->emptyValuesMap());
-			}
-			catch (exception &e)	{	throw runtime_error("Out of memory: this data set is too large for your computer's available memory");	}
-		}
-		catch (exception e)	{	cout << "MainWindow::emptyValuesChangedHandler n " << e.what() << std::endl; 	}
-		catch (...)			{	cout << "MainWindow::emptyValuesChangedHandler something when wrong...\n" << std::endl; }
+void MainWindow::emptyValuesReset(DataSetPackage *package, QStringList changedColumns, QString error)
+{
+	if (error != "")
+		QMessageBox::warning(this, "Missing Values", "Not all columns could be updated to the new missing values.\n\n" + error);
 
-		_package->setModified(true);
-		packageDataChanged(_package, colChanged, missingColumns, changeNameColumns, false);
-	}
+	vector<string> colChanged;
+	vector<string> missingColumns;
+	map<string, string> changeNameColumns;
+
+	for (const QString &col : changedColumns)
+		colChanged.push_back(fq(col));
+
+	package->setModified(true);
+	packageDataChanged(package, colChanged, missingColumns, changeNameColumns, false);
 }
 
 void MainWindow::itemSelected(const QString &item)
@@ -1747,6 +1818,12 @@ void MainWindow::refreshAnalysesUsingColumn(QString col)
 	std::vector<std::string> changedColumns, missingColumns;
 	std::map<std::string, std::string> changeNameColumns;
 	changedColumns.push_back(col.toStdString());
+
+	if(_package->dataSet() != NULL) //Its labels changed, which the engines cache along with the data
+		for(Column & column : _package->dataSet()->columns())
+			if(column.name() == changedColumns[0])
+				column.incRevision();
+
 	refreshAnalysesUsingColumns(changedColumns, missingColumns, changeNameColumns, false);
 
 	_package->setModified(false);
@@ -1846,7 +1923,7 @@ void MainWindow::startDataEditorHandler()
 		else
 		{
 			QString caption = "Find Data File";
-			QString filter = "Data File (*.csv *.txt *.sav *.ods)";
+			QString filter = "Data File (*.csv *.txt *.sav *.zsav *.ods)";
 
 			path = QFileDialog::getOpenFileName(this, caption, "", filter);
 			if (path == "")
@@ -1887,7 +1964,7 @@ void MainWindow::startDataEditor(QString path)
 	int useDefaultSpreadsheetEditor = Settings::value(Settings::USE_DEFAULT_SPREADSHEET_EDITOR).toInt();
 	QString appname = Settings::value(Settings::SPREADSHEET_EDITOR_NAME).toString();
 
-	if (QString::compare(fileInfo.suffix(), "sav", Qt::CaseInsensitive) == 0)
+	if (QString::compare(fileInfo.suffix(), "sav", Qt::CaseInsensitive) == 0 || QString::compare(fileInfo.suffix(), "zsav", Qt::CaseInsensitive) == 0)
 	{
 		if (useDefaultSpreadsheetEditor == 0 && !appname.contains("SPSS", Qt::CaseInsensitive))
 			useDefaultSpreadsheetEditor = 1;
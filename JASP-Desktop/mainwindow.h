@@ -80,6 +80,7 @@ private:
 
 
 	void packageChanged(DataSetPackage *package);
+	void packageCellsChanged(DataSetPackage *package, const DataSetChanges &changes);
 	void packageDataChanged(DataSetPackage *package, std::vector<std::string> &changedColumns, std::vector<std::string> &missingColumns, std::map<std::string, std::string> &changeNameColumns,	bool rowCountChanged);
 	void refreshAnalysesUsingColumns(std::vector<std::string> &changedColumns, std::vector<std::string> &missingColumns, std::map<std::string, std::string> &changeNameColumns, bool rowCountChanged);
 
@@ -158,6 +159,8 @@ private slots:
 	void zoomInKeysSelected();
 	void zoomOutKeysSelected();
 	void zoomEqualKeysSelected();
+	void undoKeysSelected();
+	void redoKeysSelected();
 
 	void illegalOptionStateChanged(AnalysisForm * form);
 	void fatalError();
@@ -166,6 +169,8 @@ private slots:
 	void requestHelpPage(const QString &pageName);
 
 	void emptyValuesChangedHandler();
+	void emptyValuesResetNeedsMemory(DataSetPackage *package, QStringList changedColumns);
+	void emptyValuesReset(DataSetPackage *package, QStringList changedColumns, QString error);
 
 	void resizeVariablesWindowLabelColumn();
 	void closeVariablesPage();
@@ -9,6 +9,31 @@ FocusScope
 
 	signal doubleClicked()
 
+	property int findColumn:	0	//The column whose header was clicked last
+	property int foundRow:		-1
+
+	function findNext()
+	{
+		var row = dataSetModel.findNext(findColumn, findText.text, foundRow)
+
+		foundRow		= row
+		findText.color	= row === -1 && findText.text !== "" ? "red" : "black"
+
+		if(row !== -1)
+			dataTableView.scrollToRow(row)
+	}
+
+	Shortcut
+	{
+		sequence:	StandardKey.Find
+		onActivated:
+		{
+			findBar.visible = true
+			findText.forceActiveFocus()
+			findText.selectAll()
+		}
+	}
+
 	Rectangle
 	{
 		color:			"white"
@@ -23,7 +48,7 @@ FocusScope
 			anchors.top:		parent.top
 			anchors.left:		parent.left
 			anchors.right:		parent.right
-			anchors.bottom:		dataStatusBar.top
+			anchors.bottom:		findBar.top
 
 			font.pixelSize:		baseFontSize * ppiScale
 
@@ -375,11 +400,53 @@ FocusScope
 					sourceSize {	width:	headerRoot.__iconDim * 2
 									height:	headerRoot.__iconDim * 2 }
 
-					anchors.right:			parent.right
+					anchors.right:			colSort.left
 					anchors.margins:		columnIsFiltered ? 1 : 0
 					anchors.verticalCenter:	parent.verticalCenter
 				}
 
+				Text
+				{
+					id:						colSort
+
+					property bool sorted:	false
+
+					function update()
+					{
+						sorted	= columnIndex > -1 && dataSetModel.sortedByColumn() === columnIndex
+						text	= !sorted ? "\u21C5" : dataSetModel.sortedDescending() ? "\u25BC" : "\u25B2"
+					}
+
+					Component.onCompleted:	update()
+					Connections				{ target: dataSetModel; onSortChanged: colSort.update() }
+
+					font:					dataTableView.font
+					color:					sorted ? "black" : "grey"
+					anchors.right:			parent.right
+					anchors.rightMargin:	4
+					anchors.verticalCenter:	parent.verticalCenter
+
+					MouseArea
+					{
+						anchors.fill:		parent
+						onClicked: //Ascending, descending and then back as it was
+						{
+							if(!colSort.sorted)							dataSetModel.sortByColumn(columnIndex, false)
+							else if(!dataSetModel.sortedDescending())	dataSetModel.sortByColumn(columnIndex, true)
+							else										dataSetModel.clearSort()
+
+							__myRoot.foundRow = -1
+						}
+
+						hoverEnabled:		true
+						ToolTip.visible:	containsMouse
+						ToolTip.text:		"Click here to sort the rows on this column"
+						ToolTip.timeout:	3000
+						ToolTip.delay:		500
+						cursorShape:		containsMouse ? Qt.PointingHandCursor : Qt.ArrowCursor
+					}
+				}
+
 
 
 				MouseArea
@@ -391,6 +458,12 @@ FocusScope
 
 					onClicked:
 					{
+						if(columnIndex > -1 && __myRoot.findColumn !== columnIndex)
+						{
+							__myRoot.findColumn	= columnIndex
+							__myRoot.foundRow	= -1
+						}
+
 						var chooseThisColumn = (columnIndex > -1 && dataSetModel.columnIcon(columnIndex)  !== columnTypeScale) ? columnIndex : -1
 						variablesWindow.chooseColumn(chooseThisColumn)
 
@@ -412,6 +485,61 @@ FocusScope
 			}
 		}
 
+		Rectangle
+		{
+			id:				findBar
+			anchors.left:	parent.left
+			anchors.right:	parent.right
+			anchors.bottom: dataStatusBar.top
+
+			visible:		false
+			color:			"#EEEEEE"
+			border.color:	"lightGrey"
+			border.width:	1
+
+			height:			visible ? findText.height + 8 : 0
+
+			Text
+			{
+				id:						findLabel
+				text:					"Find in " + (__myRoot.findColumn < dataSetModel.columnCount() ? dataSetModel.headerData(__myRoot.findColumn, Qt.Horizontal) : "") + ":"
+				font:					dataTableView.font
+				anchors.left:			parent.left
+				anchors.verticalCenter:	parent.verticalCenter
+				anchors.leftMargin:		8
+			}
+
+			TextField
+			{
+				id:						findText
+				font:					dataTableView.font
+				width:					200 * ppiScale
+				anchors.left:			findLabel.right
+				anchors.verticalCenter:	parent.verticalCenter
+				anchors.leftMargin:		8
+
+				onTextChanged:			__myRoot.foundRow = -1
+				onAccepted:				__myRoot.findNext()
+				Keys.onEscapePressed:	findBar.visible = false
+			}
+
+			Text
+			{
+				text:					"\u2715"
+				font:					dataTableView.font
+				anchors.right:			parent.right
+				anchors.verticalCenter:	parent.verticalCenter
+				anchors.rightMargin:	8
+
+				MouseArea
+				{
+					anchors.fill:	parent
+					onClicked:		findBar.visible = false
+					cursorShape:	Qt.PointingHandCursor
+				}
+			}
+		}
+
 		Rectangle
 		{
 			id:				dataStatusBar
@@ -35,6 +35,11 @@ FocusScope
 
 	signal doubleClicked()
 
+	function scrollToRow(row) //Puts the row right under the header, as far as the view can be scrolled
+	{
+		myFlickable.contentY = Math.max(0, Math.min(row * theView.headerHeight, myFlickable.contentHeight - myFlickable.height))
+	}
+
 	Flickable
 	{
 		id: myFlickable
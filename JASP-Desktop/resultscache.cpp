@@ -0,0 +1,436 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "resultscache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <vector>
+
+#include "appinfo.h"
+#include "jsonredirect.h"
+#include "qutils.h"
+#include "tempfiles.h"
+
+ResultsCache::ResultsCache() : _hasher(&ResultsCache::hashValues, this)
+{
+}
+
+ResultsCache::~ResultsCache()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+
+	_wake.notify_all();
+	_hasher.join();
+}
+
+bool ResultsCache::restore(Analysis *analysis, DataSet *dataSet)
+{
+	auto missed = _missedRevision.find(analysis->id());
+	if (missed != _missedRevision.end() && missed->second == analysis->revision())
+		return false;
+
+	storeWaiting();
+
+	bool		lost	= false;
+	std::string	key		= finish(this->key(analysis, dataSet), lost);
+
+	// While the values of a column are being hashed this is looked up again next time.
+	if (key == "")
+	{
+		if (lost)
+			_missedRevision[analysis->id()] = analysis->revision();
+
+		return false;
+	}
+
+	_missedRevision[analysis->id()] = analysis->revision();
+
+	QString	dir = entryDir(analysis->id(), key);
+	QFile	resultsFile(dir + "/results.json");
+
+	if (!resultsFile.open(QIODevice::ReadOnly))
+		return false;
+
+	Json::Value results;
+	if (!Json::Reader().parse(resultsFile.readAll().toStdString(), results))
+		return false;
+
+	// The files of whatever ran last make way for the ones that belong with these results
+	std::string	root, resources;
+	tempfiles_deleteList(tempfiles_retrieveList(analysis->id()));
+	tempfiles_createSpecific("", analysis->id(), root, resources);
+
+	for (const QFileInfo &file : QDir(dir + "/files").entryInfoList(QDir::Files))
+		QFile::copy(file.absoluteFilePath(), tq(root + "/" + resources) + file.fileName());
+
+	used(analysis->id(), key);
+
+	analysis->setStatus(Analysis::Complete);
+	analysis->setResults(results);
+
+	return true;
+}
+
+void ResultsCache::dispatched(Analysis *analysis, DataSet *dataSet)
+{
+	_dispatched[analysis->id()] = { analysis->revision(), key(analysis, dataSet) };
+}
+
+void ResultsCache::completed(Analysis *analysis)
+{
+	auto run = _dispatched.find(analysis->id());
+	if (run == _dispatched.end())
+		return;
+
+	DispatchedRun dispatched = run->second;
+	_dispatched.erase(run);
+
+	if (dispatched.revision == analysis->revision())
+		store(analysis, dispatched.key);
+}
+
+void ResultsCache::store(Analysis *analysis, DataSet *dataSet)
+{
+	store(analysis, key(analysis, dataSet));
+}
+
+void ResultsCache::store(Analysis *analysis, const Key &key)
+{
+	storeWaiting();
+
+	bool		lost		= false;
+	std::string	finished	= finish(key, lost);
+
+	if (lost)
+		return;
+
+	// Results whose key isn't finished yet are kept aside, storeWaiting moves them under their key later.
+	QString	dir		= finished != "" ? entryDir(analysis->id(), finished) : tq(tempfiles_sessionDirName() + "/resultscache/waiting/" + std::to_string(++_waitingDirs)),
+			files	= dir + "/files";
+
+	QDir(dir).removeRecursively();
+
+	if (!QDir().mkpath(files))
+		return;
+
+	// Whatever the engine has not cleaned up from the previous run yet is copied as well, which does no harm.
+	for (const std::string &file : tempfiles_retrieveList(analysis->id()))
+	{
+		QFileInfo fileInfo(tq(tempfiles_sessionDirName() + "/" + file));
+		QFile::copy(fileInfo.absoluteFilePath(), files + "/" + fileInfo.fileName());
+	}
+
+	QFile resultsFile(dir + "/results.json");
+
+	if (!resultsFile.open(QIODevice::WriteOnly) || resultsFile.write(Json::FastWriter().write(analysis->results()).c_str()) < 0)
+	{
+		QDir(dir).removeRecursively();
+		return;
+	}
+
+	if (finished != "")	used(analysis->id(), finished);
+	else				_waitingStores.push_back({ analysis->id(), key, dir });
+}
+
+void ResultsCache::storeWaiting()
+{
+	for (auto waiting = _waitingStores.begin(); waiting != _waitingStores.end(); )
+	{
+		bool		lost	= false;
+		std::string	key		= finish(waiting->key, lost);
+
+		if (key == "" && !lost)
+		{
+			waiting++;
+			continue;
+		}
+
+		QString dir = key != "" ? entryDir(waiting->analysisId, key) : "";
+
+		if (key != "")
+		{
+			QDir(dir).removeRecursively();
+			QDir().mkpath(QFileInfo(dir).path());
+		}
+
+		if (key != "" && QDir().rename(waiting->dir, dir))
+			used(waiting->analysisId, key);
+		else
+			QDir(waiting->dir).removeRecursively();
+
+		waiting = _waitingStores.erase(waiting);
+	}
+}
+
+void ResultsCache::clear()
+{
+	QDir(tq(tempfiles_sessionDirName() + "/resultscache")).removeRecursively();
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_valuesFingerprints.clear();
+		_hashing.clear();
+		_jobs.clear();
+		_queuedBytes = 0;
+	}
+
+	_filterFingerprint.clear();
+	_keysPerAnalysis.clear();
+	_missedRevision.clear();
+	_dispatched.clear();
+	_waitingStores.clear();
+}
+
+ResultsCache::Key ResultsCache::key(Analysis *analysis, DataSet *dataSet)
+{
+	Key key;
+
+	// Columns created by an analysis are filled by its run, so it cannot be skipped.
+	if (!analysis->columnsCreated().empty() || analysis->version().asString() != AppInfo::version.asString())
+		return key;
+
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+
+	hash.addData(QByteArray::number(analysis->id()));
+	hash.addData(QByteArray::number(_ppi));
+
+	for (const std::string &part : { analysis->module(), analysis->name(), analysis->title(), AppInfo::version.asString(), Json::FastWriter().write(analysis->options()->asJSON()) })
+	{
+		hash.addData(part.c_str(), part.size());
+		hash.addData("", 1);
+	}
+
+	if (analysis->useData() && dataSet != NULL)
+	{
+		unsigned long			dataVersion = dataSet->version();
+		std::vector<HashJob>	jobs;
+
+		if (dataSet->synchingData())
+			return key;
+
+		auto addColumn = [&](Column &column, const std::string &name)
+		{
+			hash.addData(name.c_str(), name.size() + 1);
+			hash.addData(labelsFingerprint(column));
+			key.columns.push_back(ColumnRevision(column.id(), column.revision()));
+			copyValues(column, jobs);
+		};
+
+		try
+		{
+			if (analysis->readsOnlyUsedVariables())
+				for (const std::string &variable : analysis->usedVariables())
+					addColumn(dataSet->column(variable), variable);
+			else // It might read any column, so all of them are part of the key
+				for (Column &column : dataSet->columns())
+					addColumn(column, column.name());
+		}
+		catch (columnNotFound &)
+		{
+			return key;
+		}
+
+		hash.addData(filterFingerprint(dataSet->filter()));
+
+		// Values that were copied while the data changed might be torn, so they aren't hashed.
+		if (dataSet->changedSince(dataVersion))
+			return key;
+
+		if (!jobs.empty())
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			for (HashJob &job : jobs)
+				if (_hashing.insert(job.column).second)
+				{
+					_queuedBytes += job.bytes.size();
+					_jobs.push_back(std::move(job));
+				}
+
+			_wake.notify_one();
+		}
+	}
+
+	key.cacheable	= true;
+	key.partial		= hash.result();
+
+	return key;
+}
+
+std::string ResultsCache::finish(const Key &key, bool &lost)
+{
+	lost = !key.cacheable;
+
+	if (lost)
+		return "";
+
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(key.partial);
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	for (const ColumnRevision &column : key.columns)
+	{
+		auto fingerprint = _valuesFingerprints.find(column.first);
+
+		if (fingerprint == _valuesFingerprints.end() || fingerprint->second.revision != column.second)
+		{
+			// Unless it is still being hashed it never will be: a newer revision replaced it, clear() was called or the queue was too full to add it.
+			lost = _hashing.count(column) == 0;
+			return "";
+		}
+
+		hash.addData(fingerprint->second.values);
+	}
+
+	return hash.result().toHex().toStdString();
+}
+
+// The values are copied here and hashed on the hasher thread, because the data set can move or go away while that runs.
+void ResultsCache::copyValues(Column &column, std::vector<HashJob> &jobs)
+{
+	ColumnRevision columnRevision(column.id(), column.revision());
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		auto fingerprint = _valuesFingerprints.find(columnRevision.first);
+
+		if (_hashing.count(columnRevision) > 0 || (fingerprint != _valuesFingerprints.end() && fingerprint->second.revision == columnRevision.second))
+			return;
+
+		if (!_jobs.empty() && _queuedBytes >= _maxQueuedBytes)
+			return;
+	}
+
+	int		columnType	= column.columnType();
+	size_t	rowCount	= column.rowCount(),
+			valueSize	= columnType == Column::ColumnTypeScale ? sizeof(double) : sizeof(int);
+
+	jobs.push_back(HashJob{ columnRevision, std::vector<char>() });
+
+	std::vector<char> &bytes = jobs.back().bytes;
+	bytes.reserve(sizeof(columnType) + sizeof(rowCount) + rowCount * valueSize);
+
+	auto append = [&bytes](const void *data, size_t size) { bytes.insert(bytes.end(), static_cast<const char *>(data), static_cast<const char *>(data) + size); };
+
+	append(&columnType,	sizeof(columnType));
+	append(&rowCount,	sizeof(rowCount));
+
+	if (columnType == Column::ColumnTypeScale)
+		for (double value : column.AsDoubles)
+			append(&value, sizeof(value));
+	else
+		for (int value : column.AsInts)
+			append(&value, sizeof(value));
+}
+
+void ResultsCache::hashValues()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	for (;;)
+	{
+		_wake.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+
+		if (_stopping)
+			return;
+
+		HashJob job = std::move(_jobs.front());
+		_jobs.pop_front();
+		_queuedBytes -= job.bytes.size();
+
+		lock.unlock();
+		QByteArray values = QCryptographicHash::hash(QByteArray::fromRawData(job.bytes.data(), int(job.bytes.size())), QCryptographicHash::Sha1);
+		lock.lock();
+
+		// Unless clear() was called meanwhile
+		if (_hashing.erase(job.column) > 0)
+		{
+			ValuesFingerprint &fingerprint = _valuesFingerprints[job.column.first];
+
+			if (fingerprint.values.isEmpty() || fingerprint.revision < job.column.second)
+				fingerprint = ValuesFingerprint{ job.column.second, values };
+		}
+	}
+}
+
+// The labels are few and can change without the values changing, so they are always hashed.
+QByteArray ResultsCache::labelsFingerprint(Column &column)
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+
+	for (const Label &label : column.labels())
+	{
+		int		value		= label.value();
+		char	allowed		= label.filterAllows();
+		std::string	text	= label.text();
+
+		hash.addData(reinterpret_cast<const char *>(&value), sizeof(value));
+		hash.addData(&allowed, 1);
+		hash.addData(text.c_str(), text.size() + 1);
+	}
+
+	return hash.result();
+}
+
+QByteArray ResultsCache::filterFingerprint(const FilterBitset &filter)
+{
+	if (_filterFingerprint.isEmpty() || _filterGeneration != filter.generation())
+	{
+		FilterBitset::Pin				pin(filter); // The generation and the rows have to be of the same selection
+		const FilterBitset::Selection	&selection	= pin.selection();
+		size_t							rowCount	= selection.rowCount();
+
+		QCryptographicHash hash(QCryptographicHash::Sha1);
+		hash.addData(reinterpret_cast<const char *>(&rowCount), sizeof(rowCount));
+		hash.addData(reinterpret_cast<const char *>(selection.selectedRows()), selection.selectedCount() * sizeof(int));
+
+		_filterGeneration	= pin.generation();
+		_filterFingerprint	= hash.result();
+	}
+
+	return _filterFingerprint;
+}
+
+QString ResultsCache::entryDir(int analysisId, const std::string &key) const
+{
+	return tq(tempfiles_sessionDirName() + "/resultscache/" + std::to_string(analysisId) + "/" + key);
+}
+
+void ResultsCache::used(int analysisId, const std::string &key)
+{
+	std::list<std::string> &keys = _keysPerAnalysis[analysisId];
+
+	keys.remove(key);
+	keys.push_front(key);
+
+	while (keys.size() > _maxEntriesPerAnalysis)
+	{
+		QDir(entryDir(analysisId, keys.back())).removeRecursively();
+		keys.pop_back();
+	}
+}
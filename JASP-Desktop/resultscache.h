@@ -0,0 +1,138 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef RESULTSCACHE_H
+#define RESULTSCACHE_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "analysis.h"
+#include "dataset.h"
+
+/*
+ * The ResultsCache remembers what completed analyses produced, so an analysis that is refreshed or set back
+ * to options it already ran with, on the same data, gets those results without going through an engine again.
+ *
+ * An entry is keyed by a hash of the analysis (id, module, name, title and JASP version), its options, the ppi,
+ * the contents of the columns it reads and the rows that pass the filter. It lives in the session's temp dir
+ * and holds the results plus a copy of the analysis' temp files (plots, state and jaspResults.json),
+ * because those are deleted or overwritten by the next run.
+ *
+ * The key of a run is computed when it is dispatched, because that is the data it reads, and the results are stored under it
+ * when it completes (as long as it is still that revision). Only for an analysis that says it readsOnlyUsedVariables() (in its json)
+ * the data part of the key is limited to usedVariables() and the filter, for any other analysis it covers all columns.
+ *
+ * Hashing the values of a column takes a while for a large data set, so that is done on a thread of its own and remembered per column revision.
+ * Until the values of a column are hashed, the keys that need them can't be finished: a lookup misses and results that are stored
+ * wait in a directory of their own until they can be moved under their key.
+ */
+class ResultsCache
+{
+public:
+			ResultsCache();
+			~ResultsCache();
+
+	void	setPPI(int ppi)	{ _ppi = ppi; }
+
+	bool	restore(Analysis *analysis, DataSet *dataSet);	///< If the analysis ran like this before its files and results are put back and it is complete, returns whether that happened.
+	void	dispatched(Analysis *analysis, DataSet *dataSet);	///< Remembers the key of the data the run is about to read.
+	void	completed(Analysis *analysis);						///< Keeps the results and files of the run under the key remembered at dispatch.
+	void	store(Analysis *analysis, DataSet *dataSet);		///< Keeps the results and files of a complete analysis under the key of the current data.
+	void	clear();
+
+private:
+	typedef std::pair<int, size_t> ColumnRevision; ///< Column::id() and Column::revision()
+
+	// Everything but the values of the columns is hashed right away, the hashes of their values are added once the hasher thread has them.
+	struct Key
+	{
+		bool						cacheable	= false;
+		QByteArray					partial;
+		std::vector<ColumnRevision>	columns;
+	};
+
+	struct ValuesFingerprint
+	{
+		size_t		revision;
+		QByteArray	values;
+	};
+
+	struct HashJob
+	{
+		ColumnRevision		column;
+		std::vector<char>	bytes;
+	};
+
+	struct DispatchedRun
+	{
+		int			revision;
+		Key			key;
+	};
+
+	struct WaitingStore
+	{
+		int			analysisId;
+		Key			key;
+		QString		dir;
+	};
+
+	Key			key(Analysis *analysis, DataSet *dataSet);
+	std::string	finish(const Key &key, bool &lost);				///< The key as a hex string, or "" while the values of one of its columns are still being hashed. lost tells it never will be finished.
+	void		store(Analysis *analysis, const Key &key);
+	void		storeWaiting();
+	void		copyValues(Column &column, std::vector<HashJob> &jobs);
+	void		hashValues();
+	QByteArray	labelsFingerprint(Column &column);
+	QByteArray	filterFingerprint(const FilterBitset &filter);
+	QString		entryDir(int analysisId, const std::string &key)	const;
+	void		used(int analysisId, const std::string &key);
+
+	int												_ppi					= 96;
+	unsigned long									_filterGeneration		= 0;
+	QByteArray										_filterFingerprint;
+	std::map<int, std::list<std::string>>			_keysPerAnalysis;		///< Most recently used first
+	std::map<int, int>								_missedRevision;		///< So an analysis that is waiting for an engine is not looked up over and over
+	std::map<int, DispatchedRun>					_dispatched;			///< Per analysis id
+	std::list<WaitingStore>							_waitingStores;
+	int												_waitingDirs			= 0;
+
+	// Shared with the hasher thread
+	std::map<int, ValuesFingerprint>				_valuesFingerprints;	///< Per Column::id(), of its last hashed revision
+	std::set<ColumnRevision>						_hashing;
+	std::deque<HashJob>								_jobs;
+	size_t											_queuedBytes			= 0;
+	bool											_stopping				= false;
+	std::mutex										_mutex;
+	std::condition_variable							_wake;
+	std::thread										_hasher;
+
+	static const size_t								_maxEntriesPerAnalysis	= 8,
+													_maxQueuedBytes			= 256 * 1024 * 1024;	///< The values are copied to be hashed, this bounds how much of that waits at once
+};
+
+#endif // RESULTSCACHE_H
@@ -20,8 +20,10 @@
 #include "ui_mainwindow.h"
 
 #include <QWebEngineHistory>
+#include <QWebEngineProfile>
 #include <QMessageBox>
 #include <QClipboard>
+#include <QDir>
 #include <QStringBuilder>
 
 #include "qutils.h"
@@ -31,6 +33,7 @@
 #include <functional>
 #include "settings.h"
 #include "timers.h"
+#include "tracing.h"
 
 ResultsJsInterface::ResultsJsInterface(QWidget *parent) : QObject(parent)
 {
@@ -44,6 +47,9 @@ ResultsJsInterface::ResultsJsInterface(QWidget *parent) : QObject(parent)
 	_channel->registerObject(QStringLiteral("jasp"), this);
 	_webViewResults->page()->setWebChannel(_channel);
 
+	_urlSchemeHandler = new ResultsUrlSchemeHandler(this);
+	_webViewResults->page()->profile()->installUrlSchemeHandler(ResultsUrlSchemeHandler::scheme(), _urlSchemeHandler);
+
 	_analysisMenu = new QMenu(_mainWindow);
 	connect(_analysisMenu, &QMenu::aboutToHide, this, &ResultsJsInterface::menuHidding);
 
@@ -341,7 +347,7 @@ void ResultsJsInterface::setGlobalJsValues()
 	bool exactPValues = Settings::value(Settings::EXACT_PVALUES).toBool();
 	QString exactPValueString = (exactPValues ? "true" : "false");
 	QString numDecimals = Settings::value(Settings::NUM_DECIMALS).toString();
-	QString tempFolder = "file:///" + tq(tempfiles_sessionDirName());
+	QString tempFolder = QString(ResultsUrlSchemeHandler::scheme()) + "://session";
 
 	QString js = "window.globSet.pExact = " + exactPValueString;
 	js += "; window.globSet.decimals = " + (numDecimals.isEmpty() ? "\"\"" : numDecimals);
@@ -425,17 +431,23 @@ void ResultsJsInterface::removeAnalysisRequest(int id)
 	_mainWindow->removeAnalysisRequestHandler(id);
 }
 
-void ResultsJsInterface::getImageInBase64(int id, const QString &path)
+///The path comes from the page, so just like ResultsUrlSchemeHandler::serveSessionFile only files in the session directory are read
+QString ResultsJsInterface::getImageInBase64(const QString &path)
 {
-	QString fullPath = tq(tempfiles_sessionDirName()) + "/" + path;
-	QFile *file = new QFile(fullPath);
-	file->open(QIODevice::ReadOnly);
-	QByteArray image = file->readAll();
-	QString result = QString(image.toBase64());
+	QDir	sessionDir(tq(tempfiles_sessionDirName()));
+	QString	fullPath	= QDir::cleanPath(sessionDir.absoluteFilePath(path));
+	QFile	file(fullPath);
 
-	QString eval = QString("window.convertToBase64Done({ id: %1, result: '%2'});").arg(id).arg(result);
-	runJavaScript(eval);
+	if (!fullPath.startsWith(sessionDir.absolutePath() + "/") || !file.open(QIODevice::ReadOnly))
+		return "";
+
+	return QString::fromLatin1(file.readAll().toBase64());
+}
 
+///For when the page could not load the results from the url scheme
+QString ResultsJsInterface::analysisResults(int id, int serial)
+{
+	return QString::fromUtf8(_urlSchemeHandler->takeAnalysisResults(id, serial));
 }
 
 void ResultsJsInterface::pushToClipboard(const QString &mimeType, const QString &data, const QString &html)
@@ -503,13 +515,14 @@ void ResultsJsInterface::exportSelected(const QString &filename)
 
 void ResultsJsInterface::analysisChanged(Analysis *analysis)
 {
+	JASPTRACE_SCOPE_ANALYSIS("ResultsJsInterface::analysisChanged", analysis->id(), analysis->revision());
+
 	Json::Value analysisJson = analysis->asJSON();
 	analysisJson["userdata"] = analysis->userData();
-	QString results = tq(analysisJson.toStyledString());
 
-	results = escapeJavascriptString(results);
-	results = "window.analysisChanged(JSON.parse('" + results + "'));";
-	runJavaScript(results);
+	// The page fetches the results from the url scheme, escaping them into a string literal takes long when there are many
+	int serial = _urlSchemeHandler->setAnalysisResults(analysis->id(), QByteArray::fromStdString(Json::FastWriter().write(analysisJson)));
+	runJavaScript("window.loadAnalysis(" % QString::number(analysis->id()) % ", " % QString::number(serial) % ")");
 }
 
 void ResultsJsInterface::setResultsMeta(QString str)
@@ -526,6 +539,7 @@ void ResultsJsInterface::unselect()
 
 void ResultsJsInterface::removeAnalysis(Analysis *analysis)
 {
+	_urlSchemeHandler->removeAnalysis(analysis->id());
 	runJavaScript("window.remove(" % QString::number(analysis->id()) % ")");
 }
 
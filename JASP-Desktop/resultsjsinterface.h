@@ -28,6 +28,7 @@
 #include <QNetworkReply>
 
 #include "mainwindow.h"
+#include "resultsurlschemehandler.h"
 
 class MainWindow;
 
@@ -80,7 +81,8 @@ public slots:
 	void displayMessageFromResults(QString path);
 
 	void exportSelected(const QString &filename);
-	void getImageInBase64(int id, const QString &path);
+	QString getImageInBase64(const QString &path);
+	QString analysisResults(int id, int serial);
 	void openFileTab();
 
 	void getDefaultPPI();
@@ -89,6 +91,7 @@ private:
 	MainWindow *_mainWindow;
 	QWebEngineView *_webViewResults;
 	QWebChannel *_channel;
+	ResultsUrlSchemeHandler *_urlSchemeHandler;
 
 	QMenu *_analysisMenu;
 	QMenu *_copySpecialMenu;
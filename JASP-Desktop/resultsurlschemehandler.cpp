@@ -0,0 +1,142 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "resultsurlschemehandler.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMimeDatabase>
+#include <QWebEngineUrlRequestJob>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QWebEngineUrlScheme>
+#endif
+
+#include "qutils.h"
+#include "tempfiles.h"
+#include "tracing.h"
+
+void ResultsUrlSchemeHandler::registerScheme()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+	QWebEngineUrlScheme resultsScheme(scheme());
+	resultsScheme.setSyntax(QWebEngineUrlScheme::Syntax::Host);
+	resultsScheme.setFlags(QWebEngineUrlScheme::SecureScheme | QWebEngineUrlScheme::LocalAccessAllowed);
+	QWebEngineUrlScheme::registerScheme(resultsScheme);
+#endif
+}
+
+int ResultsUrlSchemeHandler::setAnalysisResults(int analysisId, const QByteArray &json)
+{
+	_analysisResults[analysisId] = qMakePair(++_serial, json);
+
+	return _serial;
+}
+
+QByteArray ResultsUrlSchemeHandler::takeAnalysisResults(int analysisId, int serial)
+{
+	auto results = _analysisResults.find(analysisId);
+
+	if (results == _analysisResults.end() || results->first != serial)
+		return QByteArray();
+
+	QByteArray json = results->second;
+	_analysisResults.erase(results);
+
+	return json;
+}
+
+void ResultsUrlSchemeHandler::requestStarted(QWebEngineUrlRequestJob *job)
+{
+	QUrl	url		= job->requestUrl();
+	QString	path	= url.path().mid(1); // without the leading /
+
+	if		(url.host() == "session")	serveSessionFile(job, path);
+	else if	(url.host() == "results")	serveAnalysisResults(job, path);
+	else								job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+}
+
+void ResultsUrlSchemeHandler::serveSessionFile(QWebEngineUrlRequestJob *job, const QString &path)
+{
+	JASPTRACE_SCOPE("ResultsUrlSchemeHandler::serveSessionFile");
+
+	QDir		sessionDir(tq(tempfiles_sessionDirName()));
+	QString		fullPath	= QDir::cleanPath(sessionDir.absoluteFilePath(path));
+	QFileInfo	info(fullPath);
+
+	if (!fullPath.startsWith(sessionDir.absolutePath() + "/") || !info.isFile())
+	{
+		job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+		return;
+	}
+
+	CachedFile	*cached = _files.object(fullPath);
+	QByteArray	contents;
+
+	if (cached != NULL && cached->lastModified == info.lastModified() && cached->contents.size() == info.size())
+		contents = cached->contents;
+	else
+	{
+		QFile file(fullPath);
+
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			job->fail(QWebEngineUrlRequestJob::RequestFailed);
+			return;
+		}
+
+		contents = file.readAll();
+
+		// A file bigger than the whole cache isn't kept, QCache deletes it right away
+		_files.insert(fullPath, new CachedFile{ info.lastModified(), contents }, 1 + contents.size() / 1024);
+	}
+
+	reply(job, QMimeDatabase().mimeTypeForFile(info).name().toUtf8(), contents);
+}
+
+void ResultsUrlSchemeHandler::serveAnalysisResults(QWebEngineUrlRequestJob *job, const QString &name)
+{
+	JASPTRACE_SCOPE("ResultsUrlSchemeHandler::serveAnalysisResults");
+
+	QString	idAndSerial	= name.section(".", 0, 0);
+	int		analysisId	= idAndSerial.section("-", 0, 0).toInt(),
+			serial		= idAndSerial.section("-", 1, 1).toInt();
+
+	QByteArray json = takeAnalysisResults(analysisId, serial);
+
+	if (json.isEmpty())
+	{
+		reply(job, "application/javascript", "");
+		return;
+	}
+
+	// Json is valid javascript, except for these two line separators in strings (before ES2019)
+	json.replace("\xE2\x80\xA8", "\\u2028");
+	json.replace("\xE2\x80\xA9", "\\u2029");
+
+	reply(job, "application/javascript", "window.analysisLoaded(" + QByteArray::number(analysisId) + ", " + QByteArray::number(serial) + ", " + json + ");");
+}
+
+void ResultsUrlSchemeHandler::reply(QWebEngineUrlRequestJob *job, const QByteArray &mimeType, const QByteArray &contents)
+{
+	QBuffer *buffer = new QBuffer(job); // goes when the job does
+	buffer->setData(contents);
+	buffer->open(QIODevice::ReadOnly);
+
+	job->reply(mimeType, buffer);
+}
@@ -0,0 +1,67 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef RESULTSURLSCHEMEHANDLER_H
+#define RESULTSURLSCHEMEHANDLER_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QDateTime>
+#include <QMap>
+#include <QWebEngineUrlSchemeHandler>
+
+/*
+ * The ResultsUrlSchemeHandler serves the results page its big payloads, so they don't have to go through runJavaScript as string literals:
+ *  - jasp-temp://session/<path> is a file in the temp dir of the session, a plot for instance.
+ *    Those are kept in memory for as long as the file doesn't change, because the page asks for all of them again when it rerenders.
+ *  - jasp-temp://results/<id>-<serial>.js is a script that hands the results of analysis id to the page, the serial says which version of them.
+ *    It is served once, a superseded serial gets an empty script.
+ */
+class ResultsUrlSchemeHandler : public QWebEngineUrlSchemeHandler
+{
+	Q_OBJECT
+
+public:
+	explicit			ResultsUrlSchemeHandler(QObject *parent = NULL) : QWebEngineUrlSchemeHandler(parent) {}
+
+	static void			registerScheme(); ///< Has to be done before the application is created
+
+	static const char *	scheme()											{ return "jasp-temp"; }
+
+	int					setAnalysisResults(int analysisId, const QByteArray &json);	///< Returns the serial to ask for them with
+	QByteArray			takeAnalysisResults(int analysisId, int serial);			///< For when the script couldn't be loaded, empty if superseded
+	void				removeAnalysis(int analysisId)						{ _analysisResults.remove(analysisId); }
+
+	void				requestStarted(QWebEngineUrlRequestJob *job) override;
+
+private:
+	struct CachedFile
+	{
+		QDateTime	lastModified;
+		QByteArray	contents;
+	};
+
+	void				serveSessionFile(QWebEngineUrlRequestJob *job, const QString &path);
+	void				serveAnalysisResults(QWebEngineUrlRequestJob *job, const QString &name);
+	void				reply(QWebEngineUrlRequestJob *job, const QByteArray &mimeType, const QByteArray &contents);
+
+	QCache<QString, CachedFile>				_files			{ 64 * 1024 };	///< Cost is in kilobytes
+	QMap<int, QPair<int, QByteArray>>		_analysisResults;				///< Per analysis: serial and json
+	int										_serial			= 0;
+};
+
+#endif // RESULTSURLSCHEMEHANDLER_H
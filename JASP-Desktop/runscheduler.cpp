@@ -0,0 +1,117 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "runscheduler.h"
+
+using namespace std;
+
+void RunScheduler::seen(int analysisId, int revision)
+{
+	State &state = _analyses[analysisId];
+
+	if (state.revision == revision)
+		return;
+
+	if (state.revision == -1)
+	{
+		state.revision = revision; // A new analysis (or one that was loaded) hasn't been changing, it can run right away
+		return;
+	}
+
+	Clock::time_point now = _now();
+
+	_metrics.revisionsSeen++;
+
+	if (!state.pending)
+	{
+		state.pending		= true;
+		state.pendingSince	= now; // The first revision since the last run
+	}
+
+	state.revision	= revision;
+	state.changed	= now;
+}
+
+int RunScheduler::delayMs(int analysisId) const
+{
+	auto state = _analyses.find(analysisId);
+
+	if (state == _analyses.end() || state->second.runMs < 0)
+		return defaultDelayMs;
+
+	// A quarter of a run, so waiting never costs much compared to running for nothing
+	int delay = int(state->second.runMs / 4);
+
+	return delay < maxDelayMs ? delay : maxDelayMs;
+}
+
+bool RunScheduler::mayRun(int analysisId, int revision) const
+{
+	auto state = _analyses.find(analysisId);
+
+	// Not seen changing, like a new analysis, or the next step of a revision that already started, like running after the init
+	if (state == _analyses.end() || !state->second.pending || state->second.revision != revision)
+		return true;
+
+	int delay = delayMs(analysisId);
+
+	return millisecondsSince(state->second.changed) >= delay || millisecondsSince(state->second.pendingSince) >= 4 * delay;
+}
+
+void RunScheduler::dispatched(int analysisId, int revision)
+{
+	State &state = _analyses[analysisId];
+
+	if (state.dispatchedRevision == revision)
+		return;
+
+	if (state.dispatchedRevision != -1 && revision > state.dispatchedRevision + 1)
+		_metrics.revisionsCoalesced += revision - state.dispatchedRevision - 1;
+
+	_metrics.runsDispatched++;
+
+	state.revision				= revision;
+	state.dispatchedRevision	= revision;
+	state.dispatchedAt			= _now();
+	state.pending				= false;
+}
+
+void RunScheduler::completed(int analysisId, int revision)
+{
+	auto state = _analyses.find(analysisId);
+
+	if (state == _analyses.end() || state->second.dispatchedRevision != revision)
+		return; // Restored from the cache or loaded, it didn't run
+
+	double ms = millisecondsSince(state->second.dispatchedAt);
+
+	state->second.runMs = state->second.runMs < 0 ? ms : 0.7 * state->second.runMs + 0.3 * ms;
+}
+
+Json::Value RunScheduler::metrics() const
+{
+	Json::Value json			= Json::objectValue;
+
+	json["revisionsSeen"]		= Json::UInt(_metrics.revisionsSeen);
+	json["runsDispatched"]		= Json::UInt(_metrics.runsDispatched);
+	json["revisionsCoalesced"]	= Json::UInt(_metrics.revisionsCoalesced);
+	json["runsCancelled"]		= Json::UInt(_metrics.runsCancelled);
+	json["restoredFromCache"]	= Json::UInt(_metrics.restoredFromCache);
+	json["runsAvoided"]			= Json::UInt(_metrics.revisionsCoalesced + _metrics.restoredFromCache);
+
+	return json;
+}
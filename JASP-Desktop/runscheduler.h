@@ -0,0 +1,87 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef RUNSCHEDULER_H
+#define RUNSCHEDULER_H
+
+#include <chrono>
+#include <functional>
+#include <map>
+
+#include "jsonredirect.h"
+
+/* The RunScheduler decides when a changed analysis goes to an engine. Typing a number or dragging through a list changes
+ * the options many times in a row, each change is a new revision and only the last one is worth running.
+ * So a revision waits until the analysis stopped changing for a while, how long depends on how long its runs took so far:
+ * an analysis that is done in a few milliseconds runs right away, a slow one waits longer because a superseded run of it wastes more.
+ * An analysis that keeps changing still runs every so often, so there is something to look at while dragging.
+ * It also counts what that saved, see metrics().
+ */
+class RunScheduler
+{
+public:
+	typedef std::chrono::steady_clock				Clock;
+	typedef std::function<Clock::time_point ()>	Now;
+
+				RunScheduler(Now now = Clock::now) : _now(now) {}					///< now is only replaced by tests, so they needn't sleep
+
+	void		seen(int analysisId, int revision);								///< Called for every analysis on every round, notices when the revision changed.
+	bool		mayRun(int analysisId, int revision)					const;
+	int			delayMs(int analysisId)									const;
+
+	void		dispatched(int analysisId, int revision);
+	void		completed(int analysisId, int revision);						///< A revision that completes gives the run time its next delay is based on.
+	void		cancelled()														{ _metrics.runsCancelled++;		}
+	void		restoredFromCache()												{ _metrics.restoredFromCache++;	}
+	void		forget(int analysisId)											{ _analyses.erase(analysisId);	}
+	void		clear()															{ _analyses.clear();			}	///< Keeps the metrics
+
+	Json::Value	metrics()												const;
+
+	static const int	defaultDelayMs	= 100,	///< Until an analysis completed once
+						maxDelayMs		= 750;
+
+private:
+	struct State
+	{
+		int					revision			= -1,
+							dispatchedRevision	= -1;
+		Clock::time_point	changed,							///< When the revision was last seen to change
+							pendingSince,						///< When it first changed after the last dispatch
+							dispatchedAt;
+		double				runMs				= -1;			///< Moving average of the runs that completed, -1 if none did yet
+		bool				pending				= false;		///< Changed since it was last dispatched
+	};
+
+	struct Metrics
+	{
+		size_t	revisionsSeen		= 0,
+				runsDispatched		= 0,
+				revisionsCoalesced	= 0,	///< Revisions that were superseded before they got to an engine
+				runsCancelled		= 0,	///< Runs stopped on an engine because a newer revision came
+				restoredFromCache	= 0;
+	};
+
+	double		millisecondsSince(Clock::time_point since)				const	{ return std::chrono::duration<double, std::milli>(_now() - since).count(); }
+
+	Now						_now;
+	std::map<int, State>	_analyses;
+	Metrics					_metrics;
+};
+
+#endif // RUNSCHEDULER_H
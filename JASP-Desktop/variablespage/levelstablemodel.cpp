@@ -88,6 +88,15 @@ QVariant LevelsTableModel::data(const QModelIndex &index, int role) const
 	if(role == (int)Roles::ValueRole) return tq(labels.getValueFromRow(row));
 	if(role == (int)Roles::LabelRole) return tq(labels.getLabelFromRow(row));
 	if(role == (int)Roles::FilterRole) return QVariant(labels[row].filterAllows());
+	if(role == (int)Roles::CountRole)
+	{
+		ColumnStats stats; // Brings the counts of the labels up to date if the column changed
+
+		if(_dataSet != NULL && !_dataSet->columnStats(*_column, stats))
+			return QVariant("computing..."); // The data is being changed, the levels are refreshed when that is done
+
+		return QVariant(qulonglong(labels[row].count()));
+	}
 
 	if(role == Qt::DisplayRole)
 	{
@@ -107,6 +116,7 @@ QVariant LevelsTableModel::headerData(int section, Qt::Orientation orientation,
 	if(role == (int)Roles::ValueRole) return "Value";
 	if(role == (int)Roles::LabelRole) return "Label";
 	if(role == (int)Roles::FilterRole) return "Filter";
+	if(role == (int)Roles::CountRole) return "Count";
 
 	if (role != Qt::DisplayRole)
 		return QVariant();
@@ -206,7 +216,7 @@ bool LevelsTableModel::setData(const QModelIndex & index, const QVariant & value
 
 QHash<int, QByteArray> LevelsTableModel::roleNames() const
 {
-	static const QHash<int, QByteArray> roles = QHash<int, QByteArray> { {(int)Roles::ValueRole, "value"}, {(int)Roles::LabelRole, "label"}, {(int)Roles::FilterRole, "filter"} };
+	static const QHash<int, QByteArray> roles = QHash<int, QByteArray> { {(int)Roles::ValueRole, "value"}, {(int)Roles::LabelRole, "label"}, {(int)Roles::FilterRole, "filter"}, {(int)Roles::CountRole, "count"} };
 	return roles;
 }
 
@@ -18,7 +18,8 @@ public:
 	enum class Roles {
 		ValueRole = Qt::UserRole + 1,
 		LabelRole,
-		FilterRole
+		FilterRole,
+		CountRole
 	};
 	Q_ENUM(Roles)
 
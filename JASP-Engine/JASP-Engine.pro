@@ -78,7 +78,7 @@ macx:QMAKE_CXXFLAGS += -stdlib=libc++
 
 win32:QMAKE_CXXFLAGS += -DBOOST_USE_WINDOWS_H -DNOMINMAX -D__WIN32__ -DBOOST_INTERPROCESS_BOOTSTAMP_IS_SESSION_MANAGER_BASED
 
-win32:LIBS += -lole32 -loleaut32
+win32:LIBS += -lole32 -loleaut32 -lws2_32 -lmswsock -lbcrypt
 macx:LIBS += -L$$_R_HOME/lib -lR
 
 mkpath($$OUT_PWD/../R/library)
@@ -101,14 +101,18 @@ POST_TARGETDEPS     += InstallJASPRPackage
 QMAKE_CLEAN += $$OUT_PWD/../R/library/*
 
 SOURCES += main.cpp \
+	columncache.cpp \
 	engine.cpp \
     rbridge.cpp \
-    r_functionwhitelist.cpp
+    r_functionwhitelist.cpp \
+    r_lexer.cpp
 
 HEADERS += \
+	columncache.h \
 	engine.h \
     rbridge.h \
-    r_functionwhitelist.h
+    r_functionwhitelist.h \
+    r_lexer.h
 
 
 OTHER_FILES  += \
@@ -0,0 +1,129 @@
+//
+// Copyright (C) 2013-2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "columncache.h"
+#include <sstream>
+
+size_t ColumnCache::Entry::bytes() const
+{
+	size_t total = sizeof(Entry) + doubles.size() * sizeof(double) + ints.size() * sizeof(int);
+
+	for(const std::string & label : labels)
+		total += sizeof(std::string) + label.size();
+
+	return total;
+}
+
+bool ColumnCache::Key::operator<(const Key & other) const
+{
+	if(columnId			!= other.columnId)		return columnId			< other.columnId;
+	if(requestedType	!= other.requestedType)	return requestedType	< other.requestedType;
+	return obeyFilter < other.obeyFilter;
+}
+
+const ColumnCache::Entry & ColumnCache::get(const Column & column, int requestedType, bool obeyFilter, unsigned long filterGeneration, materializer materialize)
+{
+	Key key = { column.id(), requestedType, obeyFilter };
+
+	if(!obeyFilter)
+		filterGeneration = 0;
+
+	auto found = _slots.find(key);
+
+	if(found != _slots.end())
+	{
+		Slot & slot = found->second;
+
+		_lru.splice(_lru.begin(), _lru, slot.lru);
+
+		if(slot.revision == column.revision() && slot.filterGeneration == filterGeneration)
+		{
+			_hits++;
+			return slot.entry;
+		}
+
+		_bytes -= slot.entry.bytes();
+		slot.entry = Entry();
+	}
+	else
+	{
+		_lru.push_front(key);
+		found = _slots.insert(std::make_pair(key, Slot())).first;
+		found->second.lru = _lru.begin();
+	}
+
+	_misses++;
+
+	Slot & slot				= found->second;
+	slot.revision			= column.revision();
+	slot.filterGeneration	= filterGeneration;
+
+	materialize(slot.entry);
+
+	_bytes += slot.entry.bytes();
+
+	evictUntilWithinCap(key);
+
+	return slot.entry;
+}
+
+void ColumnCache::evictUntilWithinCap(const Key & keep)
+{
+	//The entry that was just asked for is never dropped, even if it is bigger than the cap on its own, because it is about to be used.
+	while(_bytes > _maxBytes && _lru.size() > 1)
+	{
+		Key oldest = _lru.back();
+
+		if(!(oldest < keep) && !(keep < oldest))
+			break;
+
+		auto slot = _slots.find(oldest);
+		_bytes -= slot->second.entry.bytes();
+		_slots.erase(slot);
+		_lru.pop_back();
+	}
+}
+
+void ColumnCache::clear()
+{
+	_slots.clear();
+	_lru.clear();
+	_bytes = 0;
+}
+
+void ColumnCache::setMaxBytes(size_t maxBytes)
+{
+	_maxBytes = maxBytes;
+
+	if(_lru.size() > 0)
+		evictUntilWithinCap(_lru.front());
+}
+
+std::string ColumnCache::statistics() const
+{
+	size_t				requests = _hits + _misses;
+	std::stringstream	out;
+
+	out << "ColumnCache: " << _hits << " hits and " << _misses << " misses";
+
+	if(requests > 0)
+		out << " (hit rate " << (100 * _hits / requests) << "%)";
+
+	out << ", " << _slots.size() << " columns using " << _bytes / 1024 << " KB of " << _maxBytes / 1024 << " KB";
+
+	return out.str();
+}
@@ -0,0 +1,91 @@
+//
+// Copyright (C) 2013-2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef COLUMNCACHE_H
+#define COLUMNCACHE_H
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include <functional>
+#include "../JASP-Common/column.h"
+
+/* ColumnCache keeps the columns rbridge_readDataSet materialized for R, filtered and coerced to the requested type,
+ * so that rerunning a bunch of analyses on the same variables doesn't read and convert them from shared memory every time.
+ * An entry is only reused when the revision of the column and the generation of the filter are the same as when it was made,
+ * and whenever the cache grows beyond its cap the least recently used entries are dropped.
+ */
+class ColumnCache
+{
+public:
+	struct Entry
+	{
+		bool						isScale		= false,
+									hasLabels	= false,
+									isOrdinal	= false;
+		std::vector<double>			doubles;
+		std::vector<int>			ints;
+		std::vector<std::string>	labels;
+
+		size_t bytes() const;
+	};
+
+	typedef std::function<void(Entry & entry)> materializer;
+
+				ColumnCache(size_t maxBytes = 128 * 1024 * 1024) : _maxBytes(maxBytes) {}
+
+	///Returns the entry for column read as requestedType, if it is missing or outdated it is (re)made by calling materialize.
+	const Entry &	get(const Column & column, int requestedType, bool obeyFilter, unsigned long filterGeneration, materializer materialize);
+
+	void			clear();
+	void			setMaxBytes(size_t maxBytes);
+
+	size_t			hits()		const { return _hits;	}
+	size_t			misses()	const { return _misses;	}
+	size_t			bytes()		const { return _bytes;	}
+	std::string		statistics() const;
+
+private:
+	struct Key
+	{
+		int		columnId,
+				requestedType;
+		bool	obeyFilter;
+
+		bool operator<(const Key & other) const;
+	};
+
+	struct Slot
+	{
+		Entry					entry;
+		size_t					revision;
+		unsigned long			filterGeneration;
+		std::list<Key>::iterator	lru;
+	};
+
+	void					evictUntilWithinCap(const Key & keep);
+
+	std::map<Key, Slot>		_slots;
+	std::list<Key>			_lru; ///< Most recently used at the front
+	size_t					_maxBytes,
+							_bytes	= 0,
+							_hits	= 0,
+							_misses	= 0;
+};
+
+#endif // COLUMNCACHE_H
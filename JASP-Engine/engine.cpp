@@ -21,14 +21,18 @@
 #include <cstdio>
 
 #include "../JASP-Common/analysisloader.h"
+#include "../JASP-Common/dirs.h"
+#include "../JASP-Common/ipcchannel.h"
 #include "../JASP-Common/tempfiles.h"
 #include "../JASP-Common/utils.h"
 #include "../JASP-Common/sharedmemory.h"
+#include "../JASP-Common/tracing.h"
 #include <csignal>
+#include <boost/filesystem.hpp>
 
 #include "rbridge.h"
 
-void SendFunctionForJaspresults(const char * msg) { Engine::theEngine()->sendString(msg); }
+void SendFunctionForJaspresults(const char * msg) { JASPTRACE_SCOPE("jaspResults::send"); Engine::theEngine()->sendString(msg); }
 bool PollMessagesFunctionForJaspResults()
 {
 	if(Engine::theEngine()->receiveMessages())
@@ -45,7 +49,7 @@ bool PollMessagesFunctionForJaspResults()
 
 Engine * Engine::_EngineInstance = NULL;
 
-Engine::Engine(int slaveNo, unsigned long parentPID) : _slaveNo(slaveNo), _parentPID(parentPID)
+Engine::Engine(int slaveNo, unsigned long parentPID, EngineChannel *channel) : _slaveNo(slaveNo), _channel(channel), _parentPID(parentPID)
 {
 	assert(_EngineInstance == NULL);
 	_EngineInstance = this;
@@ -66,6 +70,8 @@ Engine::Engine(int slaveNo, unsigned long parentPID) : _slaveNo(slaveNo), _paren
 
 	//usleep(10000000);
 
+	rbridge_setCallbackListener(boost::bind(&Engine::insideCallback, this, _1));
+
 	rbridge_init(SendFunctionForJaspresults, PollMessagesFunctionForJaspResults);
 }
 
@@ -84,13 +90,23 @@ void Engine::run()
 	}
 #endif
 
-	std::string memoryName = "JASP-IPC-" + std::to_string(_parentPID);
-	_channel = new IPCChannel(memoryName, _slaveNo, true);
+	std::string	memoryName	= "JASP-IPC-" + std::to_string(_parentPID);
+	bool		local		= _channel == NULL;
+
+	if (local)
+		_channel = new IPCChannel(memoryName, _slaveNo, true);
+	else
+		_channel->setDataSetReceiver([this](const std::string &shipment) { _pendingShipments.push_back(shipment); });
+
+	_cancelWatcher = std::thread(&Engine::watchForCancel, this);
 
-	while(ProcessInfo::isParentRunning())
+	while(local ? ProcessInfo::isParentRunning() : _channel->connected())
 	{
 		receiveMessages(100);
 
+		if (!applyShipments())
+			break;
+
 		switch(currentEngineState)
 		{
 		case engineState::idle:									break;
@@ -103,9 +119,107 @@ void Engine::run()
 		}
 
 		freeRBridgeColumns();
+
+		if (Tracing::enabled())
+			Tracing::flush(); // The desktop kills the engine when it closes, so there is no better moment later on
 	}
 
-	boost::interprocess::shared_memory_object::remove(memoryName.c_str());
+	_stopWatching = true;
+	_cancelWatcher.join();
+
+	if (local)
+		boost::interprocess::shared_memory_object::remove(memoryName.c_str());
+}
+
+///Returns false if a shipment made no sense, after that the copy of the data set can't be trusted and the engine stops.
+bool Engine::applyShipments()
+{
+	try
+	{
+		for (const std::string &shipment : _pendingShipments)
+			_shippedDataSet = _shipper.receive(shipment);
+	}
+	catch (std::runtime_error &e)
+	{
+		std::cout << "Could not apply a data set shipment: " << e.what() << std::endl;
+		return false;
+	}
+
+	_pendingShipments.clear();
+
+	return true;
+}
+
+// Runs on its own thread, so a cancel request from the desktop is noticed even while R is busy and never calls back.
+void Engine::watchForCancel()
+{
+	while(!_stopWatching)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+		int analysisId, revision;
+
+		if(!_channel->cancelRequested(analysisId, revision))
+			continue;
+
+		std::lock_guard<std::mutex> lock(_runMutex);
+
+		if(analysisId == _runningId && _runningRevision < revision)
+		{
+			// Only while R itself is busy: in a callback the engine might hold a lock and an R call it makes could jump out on the interrupt. The next check comes soon enough.
+			if(!_interrupted && !_insideCallback)
+			{
+#ifdef PRINT_ENGINE_MESSAGES
+				std::cout << "Interrupting analysis " << analysisId << " revision " << _runningRevision << std::endl;
+#endif
+				jaspRCPP_interrupt();
+				_interrupted = true;
+			}
+		}
+		else
+			_channel->clearCancel(); //Whatever it was about isn't running (anymore)
+	}
+}
+
+void Engine::startedRun(int analysisId, int revision)
+{
+	std::lock_guard<std::mutex> lock(_runMutex);
+
+	_runningId			= analysisId;
+	_runningRevision	= revision;
+	_interrupted		= false;
+
+	_channel->setKillable(!_insideCallback);
+}
+
+///Returns whether the run was interrupted, afterwards there is nothing left to interrupt and the cancel request is handled.
+bool Engine::finishedRun()
+{
+	std::lock_guard<std::mutex> lock(_runMutex);
+
+	bool interrupted = _interrupted;
+
+	if(interrupted)
+		_channel->clearCancel();
+
+	jaspRCPP_clearInterrupt();
+
+	_runningId		= -1;
+	_interrupted	= false;
+
+	_channel->setKillable(false);
+
+	return interrupted;
+}
+
+///R calls back into the engine, or returns to R from such a call. In between the engine reads or writes the shared memory, so then the desktop shouldn't kill it.
+void Engine::insideCallback(bool inside)
+{
+	std::lock_guard<std::mutex> lock(_runMutex);
+
+	_insideCallback = inside;
+
+	_channel->setKillable(_runningId != -1 && !inside);
 }
 
 
@@ -125,6 +239,12 @@ bool Engine::receiveMessages(int timeout)
 #ifdef PRINT_ENGINE_MESSAGES
 		std::cout << "received " << engineStateToString(typeRequest) <<" message" << std::endl << std::flush;
 #endif
+		if (!_channel->sharesMemory() && !allowedRemotely(typeRequest, jsonRequest))
+		{
+			std::cout << "Refused a " << jsonRequest.get("typeRequest", "").asString() << " request from a remote desktop." << std::endl;
+			return false;
+		}
+
 		switch(typeRequest)
 		{
 		case engineState::analysis:			receiveAnalysisMessage(jsonRequest);		return true;
@@ -138,6 +258,39 @@ bool Engine::receiveMessages(int timeout)
 	return false;
 }
 
+///Whatever comes over the network can only run the analyses that are installed, not R code of its own (filters, computed columns and the R console are that).
+bool Engine::allowedRemotely(engineState typeRequest, const Json::Value &jsonRequest) const
+{
+	if (typeRequest != engineState::analysis)
+		return false;
+
+	std::string perform = jsonRequest.get("perform", "run").asString();
+
+	if (perform != "init" && perform != "run" && perform != "abort")
+		return false;
+
+	// The name is parsed and evaluated in R, so only the names of the analyses in the library get through
+	return perform == "abort" || installedAnalyses().count(jsonRequest.get("name", "").asString()) > 0;
+}
+
+///The names of the analyses in Resources/Library, compared exactly so a file system that ignores case doesn't let other names through.
+const std::set<std::string> & Engine::installedAnalyses()
+{
+	static std::set<std::string> names;
+	static std::once_flag listed;
+
+	std::call_once(listed, []()
+	{
+		boost::system::error_code error;
+
+		for (boost::filesystem::directory_iterator it(Dirs::libraryDir(), error), end; !error && it != end; it.increment(error))
+			if (it->path().extension() == ".json")
+				names.insert(it->path().stem().string());
+	});
+
+	return names;
+}
+
 void Engine::receiveFilterMessage(Json::Value jsonRequest)
 {
 	currentEngineState = engineState::filter;
@@ -174,6 +327,8 @@ void Engine::receiveAnalysisMessage(Json::Value jsonRequest)
 	int analysisId		= jsonRequest.get("id", -1).asInt();
 	performType perform	= performTypeFromString(jsonRequest.get("perform", "run").asString());
 
+	JASPTRACE_SCOPE_ANALYSIS("Engine::receiveAnalysisMessage", analysisId, jsonRequest.get("revision", -1).asInt());
+
 	if (analysisId == _analysisId && _status == running)
 	{
 		// if the current running analysis has changed
@@ -224,7 +379,7 @@ void Engine::runAnalysis()
 #ifdef JASP_DEBUG
 	std::cout << "Engine::runAnalysis()" << std::endl;
 #endif
-	//waitForDatasetSync(); For SummaryStats, there is no data!!!
+	// What the analysis reads of the data set is pinned to a single version of it by rbridge_readDataSet
 
 	if (_status == saveImg)	{ saveImage(); return; }
 	if (_status == editImg)	{ editImage(); return; }
@@ -241,20 +396,30 @@ void Engine::runAnalysis()
 	RCallback callback					= boost::bind(&Engine::callback, this, _1, _2);
 
 	_currentAnalysisKnowsAboutChange	= false;
-	_analysisResultsString				= rbridge_run(_analysisName, _analysisTitle, _analysisRequiresInit, _analysisDataKey, _analysisOptions, _analysisResultsMeta, _analysisStateKey, _analysisId, _analysisRevision, perform, _ppi, callback, _analysisJaspResults);
+
+	startedRun(_analysisId, _analysisRevision);
+	{
+		JASPTRACE_SCOPE_ANALYSIS("rbridge_run", _analysisId, _analysisRevision);
+		_analysisResultsString			= rbridge_run(_analysisName, _analysisTitle, _analysisRequiresInit, _analysisDataKey, _analysisOptions, _analysisResultsMeta, _analysisStateKey, _analysisId, _analysisRevision, perform, _ppi, callback, _analysisJaspResults);
+	}
+	bool interrupted					= finishedRun();
 
 	if (_status == initing || _status == running)  // if status hasn't changed
 		receiveMessages();
 
+	// The desktop only interrupts after it sent the newer revision (or the abort), so that should have been received just now.
+	if (interrupted && (_status == initing || _status == running))
+		_status = aborted;
+
 	if (_status == toInit || _status == aborted || _status == error || _status == exception)
 	{
 		// analysis was aborted, and we shouldn't send the results
 		return;
 	}
-	else if (_status == changed && (_currentAnalysisKnowsAboutChange == false || _analysisResultsString == "null"))
+	else if (_status == changed && (interrupted || _currentAnalysisKnowsAboutChange == false || _analysisResultsString == "null"))
 	{
 		// analysis was changed, and the analysis either did not know about the change (because it did not call a callback),
-		// or it could not incorporate the changes (returned null). In both cases it needs to be re-run, and results should not be sent
+		// or it could not incorporate the changes (returned null), or it was interrupted. In all cases it needs to be re-run, and results should not be sent
 
 		_status = toInit;
 
@@ -332,6 +497,8 @@ analysisResultStatus Engine::getStatusToAnalysisStatus()
 
 void Engine::sendAnalysisResults()
 {
+	JASPTRACE_SCOPE_ANALYSIS("Engine::sendAnalysisResults", _analysisId, _analysisRevision);
+
 	Json::Value response = Json::Value(Json::objectValue);
 
 	response["typeRequest"]	= engineStateToString(engineState::analysis);
@@ -354,14 +521,18 @@ void Engine::runFilter()
 #ifdef JASP_DEBUG
 	std::cout << "Engine::runFilter()" << std::endl;
 #endif
-	waitForDatasetSync();
-
 	try
 	{
-		std::vector<bool> filterResult	= rbridge_applyFilter(_filter, _generatedFilter);
-		std::string RPossibleWarning	= jaspRCPP_getLastErrorMsg();
+		std::vector<bool>	filterResult;
+		std::string			RPossibleWarning;
+
+		// Run once, the data it reads is pinned to a single version of the data set by rbridge_readDataSet
+		filterResult		= rbridge_applyFilter(_filter, _generatedFilter);
+		RPossibleWarning	= jaspRCPP_getLastErrorMsg();
 
-		sendFilterResult(filterResult, RPossibleWarning);
+		bool staged = provideDataSet()->filter().stage(filterResult, _filterRequestId);
+
+		sendFilterResult(staged, RPossibleWarning);
 
 	}
 	catch(filterException & e)
@@ -372,15 +543,14 @@ void Engine::runFilter()
 	currentEngineState = engineState::idle;
 }
 
-void Engine::sendFilterResult(std::vector<bool> filterResult, std::string warning)
+void Engine::sendFilterResult(bool staged, std::string warning)
 {
 	Json::Value filterResponse(Json::objectValue);
 
 	filterResponse["typeRequest"]	= engineStateToString(engineState::filter);
-	filterResponse["filterResult"]	= Json::arrayValue;
+	filterResponse["filterStaged"]	= staged; //The result itself is already in shared memory
 	filterResponse["requestId"]		= _filterRequestId;
 
-	for(bool f : filterResult)	filterResponse["filterResult"].append(f);
 	if(warning != "")			filterResponse["filterError"] = warning;
 
 	sendString(filterResponse.toStyledString());
@@ -404,8 +574,7 @@ void Engine::runRCode()
 #ifdef JASP_DEBUG
 	std::cout << "Engine::runRCode()" << std::endl;
 #endif
-	waitForDatasetSync();
-
+	// Only evaluated once, it may have side effects. Whatever data it reads is pinned to a single version of the data set by rbridge_readDataSet.
 	std::string rCodeResult = jaspRCPP_evalRCode(_rCode.c_str());
 	
 	if (rCodeResult == "null")	sendRCodeError();
@@ -450,7 +619,8 @@ void Engine::runComputeColumn()
 #ifdef JASP_DEBUG
 	std::cout << "Engine::runComputeColumn()" << std::endl;
 #endif
-	waitForDatasetSync();
+	// Not run again if the data changes, because this writes the column itself. It does wait for a change that is being made.
+	provideDataSet()->stableVersion();
 
 	static const std::map<Column::ColumnType, std::string> setColumnFunction = {
 		{Column::ColumnTypeScale,		".setColumnDataAsScale"},
@@ -503,7 +673,20 @@ void Engine::removeNonKeepFiles(Json::Value filesToKeepValue)
 
 DataSet * Engine::provideDataSet()
 {
-	return SharedMemory::retrieveDataSet(_parentPID);
+	if (!_channel->sharesMemory())
+		return _shippedDataSet;
+
+	DataSet			*dataSet	= SharedMemory::retrieveDataSet(_parentPID);
+	unsigned long	version		= dataSet->version();
+
+	// The desktop only enlarges the memory while changing the data set, so it only has to be looked at once per version
+	if (version != _mappedVersion)
+	{
+		dataSet			= SharedMemory::followGrowth(_parentPID);
+		_mappedVersion	= version;
+	}
+
+	return dataSet;
 }
 
 void Engine::provideStateFileName(std::string &root, std::string &relativePath)
@@ -565,9 +748,10 @@ std::string Engine::callback(const std::string &results, int progress)
 	return "{ \"status\" : \"ok\" }";
 }
 
-void Engine::waitForDatasetSync()
+bool Engine::changeColumn(std::string columnName, std::function<bool(Column &)> change)
 {
-	while(SharedMemory::retrieveDataSet(_parentPID)->synchingData())
-		Utils::sleep(10);
+	DataSet			*dataSet = provideDataSet();
+	DataSetChange	dataSetChange(dataSet);
 
+	return change(dataSet->columns()[columnName]);
 }
@@ -20,10 +20,17 @@
 
 #include "enginedefinitions.h"
 #include "dataset.h"
-#include "ipcchannel.h"
+#include "enginechannel.h"
+#include "datasetshipper.h"
 #include "processinfo.h"
 #include "jsonredirect.h"
 
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+
 /* The Engine represents the background processes.
  * It's job is pretty straight forward; it reads analysis
  * requests from shared memory (a semaphore is set when there
@@ -37,13 +44,16 @@
  *
  * Additionally: an engine can run a filter and return the result of that to the dataset.
  *
+ * A remote engine (JASPEngine --listen [address:]<port>) gets its messages over a SocketChannel instead, and a copy of the data set along with them (see DataSetShipper).
+ * It only runs (or inits, or aborts) analyses, anything else that comes over the network is refused, and it applies the shipments between runs so R never reads a column that is being rewritten.
+ *
  * Since 2018-06 (JCG): This is getting less and less accurate of a description but i am not about to change it right now.
  */
 
 class Engine
 {
 public:
-	explicit Engine(int slaveNo, unsigned long parentPID);
+	explicit Engine(int slaveNo, unsigned long parentPID, EngineChannel *channel = NULL); ///< Without a channel it opens the IPCChannel of the desktop that started it
 	static Engine * theEngine() { return _EngineInstance; } //There is only ever one engine in a process so we might as well have a static pointer to it.
 
 
@@ -57,10 +67,10 @@ public:
 	analysisResultStatus getStatusToAnalysisStatus();
 
 	//return true if changed:
-	bool setColumnDataAsScale(std::string columnName, std::vector<double> scalarData)										{	return provideDataSet()->columns()[columnName].overwriteDataWithScale(scalarData);				}
-	bool setColumnDataAsOrdinal(std::string columnName, std::vector<int> ordinalData, std::map<int, std::string> levels)	{	return provideDataSet()->columns()[columnName].overwriteDataWithOrdinal(ordinalData, levels);	}
-	bool setColumnDataAsNominal(std::string columnName, std::vector<int> nominalData, std::map<int, std::string> levels)	{	return provideDataSet()->columns()[columnName].overwriteDataWithNominal(nominalData, levels);	}
-	bool setColumnDataAsNominalText(std::string columnName, std::vector<std::string> nominalData)							{	return provideDataSet()->columns()[columnName].overwriteDataWithNominal(nominalData);			}
+	bool setColumnDataAsScale(std::string columnName, std::vector<double> scalarData)										{	return changeColumn(columnName, [&](Column & column) { return column.overwriteDataWithScale(scalarData);				}); }
+	bool setColumnDataAsOrdinal(std::string columnName, std::vector<int> ordinalData, std::map<int, std::string> levels)	{	return changeColumn(columnName, [&](Column & column) { return column.overwriteDataWithOrdinal(ordinalData, levels);	}); }
+	bool setColumnDataAsNominal(std::string columnName, std::vector<int> nominalData, std::map<int, std::string> levels)	{	return changeColumn(columnName, [&](Column & column) { return column.overwriteDataWithNominal(nominalData, levels);	}); }
+	bool setColumnDataAsNominalText(std::string columnName, std::vector<std::string> nominalData)							{	return changeColumn(columnName, [&](Column & column) { return column.overwriteDataWithNominal(nominalData);			}); }
 
 	int dataSetRowCount()	{ return static_cast<int>(provideDataSet()->rowCount()); }
 
@@ -76,7 +86,16 @@ private:
 	void runFilter();
 	void runComputeColumn();
 
-	void waitForDatasetSync();
+	bool allowedRemotely(engineState typeRequest, const Json::Value &jsonRequest) const;
+	static const std::set<std::string> & installedAnalyses();
+	bool applyShipments();
+
+	void watchForCancel();
+	void startedRun(int analysisId, int revision);
+	bool finishedRun();
+	void insideCallback(bool inside);
+
+	bool changeColumn(std::string columnName, std::function<bool(Column &)> change);
 
 	void removeNonKeepFiles(Json::Value filesToKeepValue);
 	void saveImage();
@@ -84,7 +103,7 @@ private:
 
 	void sendAnalysisResults();
 
-	void sendFilterResult(std::vector<bool> filterResult, std::string warning = "");
+	void sendFilterResult(bool staged, std::string warning = "");
 	void sendFilterError(std::string errorMessage);
 
 
@@ -135,10 +154,22 @@ private:
 	Json::Value _imageOptions,
 				_analysisResults;
 
-	IPCChannel *_channel = NULL;
+	EngineChannel	*_channel			= NULL;
+	DataSetShipper	_shipper;							///< Only used when the channel doesn't share memory with the desktop
+	DataSet			*_shippedDataSet	= NULL;
+	std::vector<std::string>	_pendingShipments;		///< Received while R might be reading the data set, applied by run() between runs
+	unsigned long				_mappedVersion		= 0;	///< Of the data set when it was last checked whether the memory grew
 
 	unsigned long _parentPID = 0;
 
+	std::thread			_cancelWatcher;
+	std::atomic<bool>	_stopWatching		{ false };
+	std::mutex			_runMutex;						///< Guards the four below, they are shared with _cancelWatcher
+	int					_runningId			= -1,
+						_runningRevision	= -1;
+	bool				_interrupted		= false,
+						_insideCallback		= false;	///< R called back into the engine, which is no moment to interrupt (or kill) it
+
 	engineState currentEngineState = engineState::idle;
 };
 
@@ -16,16 +16,48 @@
 //
 
 #include "engine.h"
+#include "../JASP-Common/socketchannel.h"
+#include "../JASP-Common/tracing.h"
+#include <iostream>
 
 int main(int argc, char *argv[])
 {
-	if(argc > 2)
+	if(argc > 2 && std::string(argv[1]) == "--listen")
+	{
+		// [address:]port [--allow-unencrypted], only on loopback unless an address is given and only on another address if unencrypted traffic is explicitly allowed
+		std::string	where				= argv[2];
+		size_t		colon				= where.rfind(':');
+		std::string	address				= colon == std::string::npos ? "127.0.0.1" : where.substr(0, colon);
+		int			port				= atoi(where.substr(colon == std::string::npos ? 0 : colon + 1).c_str());
+		bool		allowUnencrypted	= argc > 3 && std::string(argv[3]) == "--allow-unencrypted";
+
+		Tracing::enableFromEnvironment("JASPEngine :" + std::to_string(port));
+
+		// Serves one desktop, when it disconnects the engine is done
+		SocketChannel *channel = nullptr;
+
+		try
+		{
+			channel = SocketChannel::listen(address, port, SocketChannel::secretFromEnvironment(), allowUnencrypted);
+		}
+		catch (std::exception &e)
+		{
+			std::cerr << "JASPEngine cannot listen on " << where << ": " << e.what() << std::endl;
+			return 1;
+		}
+
+		Engine *e = new Engine(channel->channelNumber(), channel->peerProcessId(), channel);
+		e->run();
+	}
+	else if(argc > 2)
 	{
 		unsigned long slaveNo	= strtoul(argv[1], NULL, 10);
 		unsigned long parentPID = strtoul(argv[2], NULL, 10);
 
 		//sleep(10000000);
 
+		Tracing::enableFromEnvironment("JASPEngine " + std::to_string(slaveNo));
+
 		Engine *e = new Engine(slaveNo, parentPID);
 		e->run();
 	}
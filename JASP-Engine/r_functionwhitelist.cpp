@@ -1,4 +1,5 @@
 #include "r_functionwhitelist.h"
+#include <unordered_set>
 
 	//The following functions (and keywords that can be followed by a '(') will be allowed in user-entered R-code, such as filters or computed columns. This is for security because otherwise JASP-files could become a vector of attack and that doesn't refer to an R-datatype.
 const std::set<std::string> R_FunctionWhiteList::functionWhiteList {
@@ -210,76 +211,107 @@ std::string R_FunctionWhiteList::returnOrderedWhiteList()
 	return out.str();
 }
 
-const std::string	R_FunctionWhiteList::functionStartDelimit("(?:[;\\s\\(\"\\[\\+\\-\\=\\*\\%\\/\\{\\|&!]|^)"); //These should be all possible non-funtion-name-characters that could be right in front of any function-name in R.
-const std::string	R_FunctionWhiteList::functionNameStart("(?:\\.?[[:alpha:]])");
-const std::string	R_FunctionWhiteList::functionNameBody("(?:\\w|\\.|::)+");
-const std::regex	R_FunctionWhiteList::functionNameMatcher(functionStartDelimit + "(" + functionNameStart + functionNameBody + ")(?=\\s*\\()");
+bool R_FunctionWhiteList::isWhiteListed(const std::string & name)
+{
+	static const std::unordered_set<std::string> lookup(functionWhiteList.begin(), functionWhiteList.end());
+
+	return lookup.count(name) > 0;
+}
 
 std::set<std::string> R_FunctionWhiteList::findIllegalFunctions(std::string const & script)
 {
-	std::set<std::string> blackListedFunctionsFound;
+	return findIllegalFunctions(R_Lexer::tokenize(script));
+}
 
-	auto foundFunctionsBegin	= std::sregex_iterator(script.begin(), script.end(), functionNameMatcher);
-	auto foundFunctionsEnd		= std::sregex_iterator();
+std::set<std::string> R_FunctionWhiteList::findIllegalFunctions(const std::vector<R_Lexer::Token> & tokens)
+{
+	std::set<std::string> blackListedFunctionsFound;
 
-	for(auto foundFunctionIter = foundFunctionsBegin; foundFunctionIter != foundFunctionsEnd; foundFunctionIter++ )
+	//Anything that is directly followed by a "(" gets called, and in R that can also be a string or a `name`
+	for(size_t i=0; i + 1 < tokens.size(); i++)
 	{
-		std::string foundFunction((*foundFunctionIter)[1].str());
-		bool whiteListed = functionWhiteList.count(foundFunction) > 0;
+		const R_Lexer::Token & token = tokens[i];
 
-		if(!whiteListed && blackListedFunctionsFound.count(foundFunction) == 0)
-			blackListedFunctionsFound.insert(foundFunction);
-	}
+		if(tokens[i + 1].type != R_Lexer::tokenType::open || tokens[i + 1].text != "(")
+			continue;
 
+		if(token.type == R_Lexer::tokenType::name || token.type == R_Lexer::tokenType::backtickName || token.type == R_Lexer::tokenType::string)
+			if(!isWhiteListed(token.text))
+				blackListedFunctionsFound.insert(token.text);
+	}
 
 	return blackListedFunctionsFound;
 }
 
-const std::string	R_FunctionWhiteList::operatorsR("`(?:\\+|-|\\*|/|%(?:/|\\*|in)?%|\\^|<=?|>=?|==?|!=?|<?<-|->>?|\\|\\|?|&&?|:|\\$)`");
-
-const std::regex	R_FunctionWhiteList::assignmentWhiteListedRightMatcher(	"(" +				functionNameStart + functionNameBody +	")\\s*(?:<?<-|=)");
-const std::regex	R_FunctionWhiteList::assignmentWhiteListedLeftMatcher(	"(?:->>?)\\s*(" +	functionNameStart + functionNameBody +	")");
-const std::regex	R_FunctionWhiteList::assignmentOperatorRightMatcher(	"(" +				operatorsR +							")\\s*(?:<?<-|=)");
-const std::regex	R_FunctionWhiteList::assignmentOperatorLeftMatcher(		"(?:->>?)\\s*(" +	operatorsR +							")");
-
 std::set<std::string> R_FunctionWhiteList::findIllegalFunctionsAliases(std::string const & script)
 {
-	//std::cout << "findIllegalFunctionsAliases with " << script << std::endl << std::flush;
+	return findIllegalFunctionsAliases(R_Lexer::tokenize(script));
+}
 
+std::set<std::string> R_FunctionWhiteList::findIllegalFunctionsAliases(const std::vector<R_Lexer::Token> & tokens)
+{
 	std::set<std::string> illegalAliasesFound;
 
-	auto aliasSearcher = [&illegalAliasesFound, &script](std::regex aliasAssignmentMatcher, bool (*lambdaMatchChecker)(std::string) )
+	//Assigning to a whitelisted function (like: "mean <- system") is not allowed and neither is assigning to operators or keywords (like: "`+` <- system" or "`(` <- system"), which can only be done through backticks or strings
+	auto checkAssignedTo = [&illegalAliasesFound](const R_Lexer::Token & target)
 	{
-		auto foundAliasesBegin	= std::sregex_iterator(script.begin(), script.end(), aliasAssignmentMatcher);
-		auto foundAliasesEnd	= std::sregex_iterator();
-
-		for(auto foundAliasesIter = foundAliasesBegin; foundAliasesIter != foundAliasesEnd; foundAliasesIter++ )
+		switch(target.type)
 		{
-			std::string foundAlias((*foundAliasesIter)[1].str());
-			bool allowed = (*lambdaMatchChecker)(foundAlias);
+		case R_Lexer::tokenType::name:
+			if(isWhiteListed(target.text))
+				illegalAliasesFound.insert(target.text);
+			break;
 
-			//std::cout << "I found alias assignment: " << foundAlias << " which is " << (allowed ? "allowed" : "not allowed") << ".." << std::endl;
+		case R_Lexer::tokenType::backtickName:
+		case R_Lexer::tokenType::string:
+			if(isWhiteListed(target.text) || !R_Lexer::isSyntacticName(target.text))
+				illegalAliasesFound.insert("`" + target.text + "`");
+			break;
 
-			if(!allowed)
-				illegalAliasesFound.insert(foundAlias);
+		default:
+			break;
 		}
 	};
 
-	aliasSearcher(assignmentOperatorLeftMatcher,		[](std::string alias) { return false; }); //operators are never allowed
-	aliasSearcher(assignmentOperatorRightMatcher,		[](std::string alias) { return false; });
-	aliasSearcher(assignmentWhiteListedLeftMatcher,		[](std::string alias) { return functionWhiteList.count(alias) == 0; }); //only allowed when the token being assigned to is not in whitelist
-	aliasSearcher(assignmentWhiteListedRightMatcher,	[](std::string alias) { return functionWhiteList.count(alias) == 0; });
+	for(size_t i=0; i<tokens.size(); i++)
+	{
+		const R_Lexer::Token & token = tokens[i];
+
+		if(token.type != R_Lexer::tokenType::op)
+			continue;
 
-	//std::cout << std::flush;
+		if((token.text == "<-" || token.text == "<<-" || token.text == "=") && i > 0)
+			checkAssignedTo(tokens[i - 1]);
+		else if((token.text == "->" || token.text == "->>") && i + 1 < tokens.size())
+			checkAssignedTo(tokens[i + 1]);
+	}
 
 	return illegalAliasesFound;
 }
 
+std::unordered_map<std::string, std::string> R_FunctionWhiteList::_verdicts;
+
 void R_FunctionWhiteList::scriptIsSafe(const std::string &script)
 {
 	static std::string errorMsg;
 
-	std::set<std::string> blackListedFunctions = findIllegalFunctions(script);
+	auto verdict = _verdicts.find(script);
+
+	if(verdict != _verdicts.end())
+	{
+		if(verdict->second == "")
+			return;
+
+		errorMsg = verdict->second;
+		throw filterException(errorMsg);
+	}
+
+	if(_verdicts.size() > 1000) //Just to make sure this doesn't keep on growing in a long session
+		_verdicts.clear();
+
+	std::vector<R_Lexer::Token> tokens = R_Lexer::tokenize(script);
+
+	std::set<std::string> blackListedFunctions = findIllegalFunctions(tokens);
 
 	if(blackListedFunctions.size() > 0)
 	{
@@ -290,10 +322,11 @@ void R_FunctionWhiteList::scriptIsSafe(const std::string &script)
 			ssm << black << "\n";
 		errorMsg = ssm.str();
 
+		_verdicts[script] = errorMsg;
 		throw filterException(errorMsg);
 	}
 
-	std::set<std::string> illegalAliasesFound = findIllegalFunctionsAliases(script);
+	std::set<std::string> illegalAliasesFound = findIllegalFunctionsAliases(tokens);
 
 	if(illegalAliasesFound.size() > 0)
 	{
@@ -304,6 +337,9 @@ void R_FunctionWhiteList::scriptIsSafe(const std::string &script)
 			ssm << alias << "\n";
 		errorMsg = ssm.str();
 
+		_verdicts[script] = errorMsg;
 		throw filterException(errorMsg);
 	}
+
+	_verdicts[script] = "";
 }
@@ -2,18 +2,25 @@
 #define R_FUNCTIONWHITELIST_H
 
 #include <set>
-#include <regex>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
 #include "../JASP-R-Interface/jasprcpp_interface.h"
+#include "r_lexer.h"
 
 class R_FunctionWhiteList
 {
 private:
 	///The following functions (and keywords that can be followed by a '(') will be allowed in user-entered R-code, such as filters or computed columns. This is for security because otherwise JASP-files could become a attack-vector (which doesn't refer to an R-datatype).
 	static const std::set<std::string> functionWhiteList;
-	static const std::string functionPrecedingCharacter, functionStartDelimit, functionNameStart, functionNameBody, operatorsR;
-	static const std::regex functionNameMatcher, functionNamePrecederMatcher, assignmentWhiteListedRightMatcher, assignmentWhiteListedLeftMatcher, assignmentOperatorRightMatcher, assignmentOperatorLeftMatcher;
+
+	static bool isWhiteListed(const std::string & name);
+
+	static std::set<std::string> findIllegalFunctions(		const std::vector<R_Lexer::Token> & tokens);
+	static std::set<std::string> findIllegalFunctionsAliases(	const std::vector<R_Lexer::Token> & tokens);
+
+	///The scripts that were checked before and the error they gave (or "" if they were safe), filters and computed columns tend to be checked again and again without changing.
+	static std::unordered_map<std::string, std::string> _verdicts;
 
 public:
 	///throws a filterexception if the script is not legal for some reason
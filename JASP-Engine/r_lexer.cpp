@@ -0,0 +1,211 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "r_lexer.h"
+#include <set>
+#include <cctype>
+#include <algorithm>
+
+bool R_Lexer::isNameStart(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '.' || static_cast<unsigned char>(c) >= 0x80; //Anything non-ascii is considered part of a letter in utf-8
+}
+
+bool R_Lexer::isNameChar(char c)
+{
+	return isNameStart(c) || (c >= '0' && c <= '9') || c == '_';
+}
+
+bool R_Lexer::isSyntacticName(const std::string & name)
+{
+	static const std::set<std::string> reserved { "if", "else", "repeat", "while", "function", "for", "next", "break", "in", "TRUE", "FALSE", "NULL", "Inf", "NaN", "NA", "NA_integer_", "NA_real_", "NA_character_", "NA_complex_" };
+
+	if(name.empty() || !isNameStart(name[0]) || (name[0] == '.' && name.size() > 1 && name[1] >= '0' && name[1] <= '9'))
+		return false;
+
+	for(char c : name)
+		if(!isNameChar(c))
+			return false;
+
+	return reserved.count(name) == 0;
+}
+
+std::vector<R_Lexer::Token> R_Lexer::tokenize(const std::string & script)
+{
+	static const std::vector<std::string> multiCharOperators { "<<-", "->>", "<-", "->", "<=", ">=", "==", "!=", "&&", "||", "|>" };
+
+	std::vector<Token>	tokens;
+	size_t				pos = 0,
+						end	= script.size();
+
+	//Reads everything up to the closing quote, skipping escaped characters, and leaves pos right after it.
+	auto readQuoted = [&](char quote)
+	{
+		std::string content;
+
+		for(pos++; pos < end && script[pos] != quote; pos++)
+		{
+			if(script[pos] == '\\' && pos + 1 < end)
+				content += script[pos++];
+			content += script[pos];
+		}
+
+		pos++;
+		return content;
+	};
+
+	while(pos < end)
+	{
+		char c = script[pos];
+
+		if(c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v')
+			pos++;
+		else if(c == '#')
+			while(pos < end && script[pos] != '\n')
+				pos++;
+		else if(c == '"' || c == '\'')
+			tokens.push_back({ tokenType::string, readQuoted(c) });
+		else if(c == '`')
+			tokens.push_back({ tokenType::backtickName, readQuoted(c) });
+		else if((c >= '0' && c <= '9') || (c == '.' && pos + 1 < end && script[pos + 1] >= '0' && script[pos + 1] <= '9'))
+		{
+			size_t	start	= pos;
+			bool	hex		= c == '0' && pos + 1 < end && (script[pos + 1] == 'x' || script[pos + 1] == 'X');
+
+			auto isDigit	= [&](char d) { return (d >= '0' && d <= '9') || (hex && ((d >= 'a' && d <= 'f') || (d >= 'A' && d <= 'F'))); };
+			auto digits		= [&]() { while(pos < end && isDigit(script[pos])) pos++; };
+
+			if(hex)
+				pos += 2;
+
+			digits();
+
+			if(pos < end && script[pos] == '.')
+			{
+				pos++;
+				digits();
+			}
+
+			char exponent = hex ? 'p' : 'e';
+
+			if(pos < end && (script[pos] == exponent || script[pos] == toupper(exponent)))
+			{
+				pos++;
+
+				if(pos < end && (script[pos] == '+' || script[pos] == '-'))
+					pos++;
+
+				hex = false; //the exponent is always decimal
+				digits();
+			}
+
+			if(pos < end && (script[pos] == 'L' || script[pos] == 'i'))
+				pos++;
+
+			//Whatever follows is a new token, even if R wouldn't accept that anyway
+			tokens.push_back({ tokenType::number, script.substr(start, pos - start) });
+		}
+		else if(isNameStart(c))
+		{
+			size_t start = pos;
+
+			for(; pos < end && isNameChar(script[pos]); pos++);
+
+			std::string name = script.substr(start, pos - start);
+
+			if((name == "r" || name == "R") && pos < end && (script[pos] == '"' || script[pos] == '\''))
+			{
+				//A raw string (R >= 4.0) like r"(...)" or r"--[...]--" is closed by the matching bracket, dashes and quote, and can contain anything else.
+				char	quote	= script[pos];
+				size_t	dashes	= script.find_first_not_of('-', pos + 1);
+
+				if(dashes != std::string::npos && (script[dashes] == '(' || script[dashes] == '[' || script[dashes] == '{'))
+				{
+					char		open		= script[dashes],
+								close		= open == '(' ? ')' : open == '[' ? ']' : '}';
+					std::string	closing		= close + script.substr(pos + 1, dashes - pos - 1) + quote;
+					size_t		contentFrom	= dashes + 1,
+								closedAt	= script.find(closing, contentFrom);
+
+					if(closedAt == std::string::npos)
+						closedAt = end;
+
+					tokens.push_back({ tokenType::string, script.substr(contentFrom, closedAt - contentFrom) });
+					pos = std::min(end, closedAt + closing.size());
+					continue;
+				}
+			}
+
+			//Something like base::mean or stats:::sd is a single name for us, just like the regexes used to consider it
+			while(pos + 1 < end && script[pos] == ':' && script[pos + 1] == ':')
+			{
+				size_t colons = pos + 2 < end && script[pos + 2] == ':' ? 3 : 2;
+
+				if(pos + colons < end && script[pos + colons] == '`')
+				{
+					name	+= script.substr(pos, colons);
+					pos		+= colons;
+					name	+= readQuoted('`');
+				}
+				else if(pos + colons < end && isNameStart(script[pos + colons]))
+				{
+					name	+= script.substr(pos, colons);
+					pos		+= colons;
+					start	 = pos;
+
+					for(; pos < end && isNameChar(script[pos]); pos++);
+
+					name += script.substr(start, pos - start);
+				}
+				else
+					break;
+			}
+
+			tokens.push_back({ tokenType::name, name });
+		}
+		else if(c == '(' || c == '[' || c == '{')
+			tokens.push_back({ tokenType::open,		std::string(1, script[pos++]) });
+		else if(c == ')' || c == ']' || c == '}')
+			tokens.push_back({ tokenType::close,	std::string(1, script[pos++]) });
+		else if(c == '%')
+		{
+			size_t closing = script.find('%', pos + 1);
+
+			if(closing == std::string::npos)
+				closing = end - 1;
+
+			tokens.push_back({ tokenType::op, script.substr(pos, closing + 1 - pos) });
+			pos = closing + 1;
+		}
+		else
+		{
+			std::string op(1, c);
+
+			for(const std::string & multi : multiCharOperators)
+				if(script.compare(pos, multi.size(), multi) == 0)
+				{
+					op = multi;
+					break;
+				}
+
+			tokens.push_back({ tokenType::op, op });
+			pos += op.size();
+		}
+	}
+
+	return tokens;
+}
@@ -0,0 +1,47 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef R_LEXER_H
+#define R_LEXER_H
+
+#include <string>
+#include <vector>
+
+///A small lexer for R code, just enough to see what is a name, a string, an operator or a bracket. Used by R_FunctionWhiteList to find calls and assignments without running regexes over the script.
+class R_Lexer
+{
+public:
+	enum class tokenType { name, backtickName, string, number, op, open, close };
+
+	struct Token
+	{
+		tokenType	type;
+		std::string	text;	///< For backtickName and string this is the content without the quotes
+	};
+
+	///Splits script into tokens in one pass, skips whitespace and comments.
+	static std::vector<Token> tokenize(const std::string & script);
+
+	///Checks if name can be used in R without backticks, so doesn't need them to be a function or a variable.
+	static bool isSyntacticName(const std::string & name);
+
+private:
+	static bool isNameStart(char c);
+	static bool isNameChar(char c);
+};
+
+#endif // R_LEXER_H
@@ -16,11 +16,14 @@
 //
 
 #include "rbridge.h"
+#include "columncache.h"
+#include "columnnamematcher.h"
 #include "base64.h"
 #include "jsonredirect.h"
 #include "sharedmemory.h"
 #include "appinfo.h"
 #include "tempfiles.h"
+#include "tracing.h"
 #include <iostream>
 
 DataSet		*rbridge_dataSet = NULL;
@@ -31,6 +34,8 @@ boost::function<void(std::string &, std::string &)>							rbridge_stateFileSourc
 boost::function<DataSet *()>	rbridge_dataSetSource = NULL;
 std::unordered_set<std::string> filterColumnsUsed;
 std::vector<std::string>		columnNamesInDataSet;
+ColumnNameMatcher				columnNameEncoder,
+								columnNameDecoder(false); //the encoded names are unique enough to not need checking their boundaries
 boost::function<int()>			rbridge_getDataSetRowCount = NULL;
 
 boost::function<bool(std::string&, std::vector<double>&)>										rbridge_setColumnDataAsScaleEngine			= NULL;
@@ -38,12 +43,46 @@ boost::function<bool(std::string&, std::vector<int>&,			std::map<int, std::strin
 boost::function<bool(std::string&, std::vector<int>&,			std::map<int, std::string>&)>	rbridge_setColumnDataAsNominalEngine		= NULL;
 boost::function<bool(std::string&, std::vector<std::string>&)>									rbridge_setColumnDataAsNominalTextEngine	= NULL;
 
+boost::function<void(bool)>		rbridge_callbackListener	= NULL;
+sendFuncDef						rbridge_sendToDesktop		= NULL;
+pollMessagesFuncDef				rbridge_pollMessages		= NULL;
+
 char** rbridge_getLabels(const Labels &levels, int &nbLevels);
 char** rbridge_getLabels(const std::vector<std::string> &levels, int &nbLevels);
 
+int RBridgeCallbackScope::_depth = 0;
+
+RBridgeCallbackScope::RBridgeCallbackScope()
+{
+	if (_depth++ == 0 && rbridge_callbackListener)
+		rbridge_callbackListener(true);
+}
+
+RBridgeCallbackScope::~RBridgeCallbackScope()
+{
+	if (--_depth == 0 && rbridge_callbackListener)
+		rbridge_callbackListener(false);
+}
+
+void rbridge_setCallbackListener(boost::function<void(bool)> listener) { rbridge_callbackListener = listener; }
+
+void rbridge_sendToDesktopScoped(const char * msg)
+{
+	RBridgeCallbackScope scope;
+	rbridge_sendToDesktop(msg);
+}
+
+bool rbridge_pollMessagesScoped()
+{
+	RBridgeCallbackScope scope;
+	return rbridge_pollMessages();
+}
 
 void rbridge_init(sendFuncDef sendToDesktopFunction, pollMessagesFuncDef pollMessagesFunction)
 {
+	rbridge_sendToDesktop	= sendToDesktopFunction;
+	rbridge_pollMessages	= pollMessagesFunction;
+
 	RBridgeCallBacks callbacks = {
 		rbridge_readDataSet,
 		rbridge_readDataColumnNames,
@@ -62,7 +101,7 @@ void rbridge_init(sendFuncDef sendToDesktopFunction, pollMessagesFuncDef pollMes
 		rbridge_dataSetRowCount
 	};
 
-	jaspRCPP_init(AppInfo::getBuildYear().c_str(), AppInfo::version.asString().c_str(), &callbacks, sendToDesktopFunction, pollMessagesFunction);
+	jaspRCPP_init(AppInfo::getBuildYear().c_str(), AppInfo::version.asString().c_str(), &callbacks, rbridge_sendToDesktopScoped, rbridge_pollMessagesScoped);
 }
 
 void rbridge_setDataSetSource(			boost::function<DataSet* ()> source)												{	rbridge_dataSetSource			= source; }
@@ -133,6 +172,8 @@ extern "C" const char* STDCALL rbridge_requestTempRootName()
 
 extern "C" bool STDCALL rbridge_runCallback(const char* in, int progress, const char** out)
 {
+	RBridgeCallbackScope scope;
+
 	if (!rbridge_callback)
 		return false;
 
@@ -146,9 +187,7 @@ extern "C" bool STDCALL rbridge_runCallback(const char* in, int progress, const
 std::string rbridge_run(const std::string &name, const std::string &title, bool &requiresInit, const std::string &dataKey, const std::string &options, const std::string &resultsMeta, const std::string &stateKey, int analysisID, int analysisRevision, const std::string &perform, int ppi, RCallback callback, bool useJaspResults)
 {
 	rbridge_callback = callback;
-	if (rbridge_dataSet != NULL) {
-		rbridge_dataSet = rbridge_dataSetSource();
-	}
+	rbridge_dataSet = rbridge_dataSetSource();
 
 
 	const char* results = jaspRCPP_run(name.c_str(), title.c_str(), requiresInit, dataKey.c_str(), options.c_str(), resultsMeta.c_str(), stateKey.c_str(), perform.c_str(), ppi, analysisID, analysisRevision, useJaspResults);
@@ -160,8 +199,9 @@ std::string rbridge_run(const std::string &name, const std::string &title, bool
 
 extern "C" RBridgeColumn* STDCALL rbridge_readFullDataSet(int * colMax)
 {
-	if (rbridge_dataSet == NULL)
-		rbridge_dataSet = rbridge_dataSetSource();
+	RBridgeCallbackScope scope;
+
+	rbridge_dataSet = rbridge_dataSetSource();
 
 	if(rbridge_dataSet == NULL)
 		return NULL;
@@ -189,8 +229,9 @@ extern "C" RBridgeColumn* STDCALL rbridge_readFullDataSet(int * colMax)
 
 extern "C" RBridgeColumn* STDCALL rbridge_readDataSetForFiltering(int * colMax)
 {
-	if (rbridge_dataSet == NULL)
-		rbridge_dataSet = rbridge_dataSetSource();
+	RBridgeCallbackScope scope;
+
+	rbridge_dataSet = rbridge_dataSetSource();
 
 	Columns &columns = rbridge_dataSet->columns();
 
@@ -218,186 +259,235 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSetForFiltering(int * colMax)
 
 static RBridgeColumn*	datasetStatic = NULL;
 static int				datasetColMax = 0;
+static ColumnCache		columnCache;
 
-extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHeaders, int colMax, bool obeyFilter)
+///Copies the first rowCount values of a column to out, converting each, and when a filter is given only the rows passing it.
+template<typename Iterator, typename Output, typename Convert>
+void rbridge_copyRows(Iterator from, Iterator to, Output * out, int rowCount, const FilterBitset::Selection * filter, Convert convert)
 {
-	if (colHeaders == NULL)
-		return NULL;
+	if(filter != NULL)
+		filter->gather(from, to, out, rowCount, convert);
+	else
+		for(int row = 0; row < rowCount && from != to; row++, ++from)
+			out[row] = convert(*from);
+}
 
-	//if (rbridge_dataSet == NULL)
-		rbridge_dataSet = rbridge_dataSetSource();
+void rbridge_materializeColumn(Column & column, Column::ColumnType requestedType, int filteredRowCount, const FilterBitset::Selection * filter, ColumnCache::Entry & result)
+{
+	Column::ColumnType columnType = column.columnType();
 
-	Columns &columns = rbridge_dataSet->columns();
+	if (requestedType == Column::ColumnTypeScale)
+	{
+		if (columnType == Column::ColumnTypeScale)
+		{
+			result.isScale		= true;
+			result.hasLabels	= false;
+			result.doubles.resize(filteredRowCount);
 
-	if (datasetStatic != NULL)
-		freeRBridgeColumns(datasetStatic, datasetColMax);
+			rbridge_copyRows(column.AsDoubles.begin(), column.AsDoubles.end(), result.doubles.data(), filteredRowCount, filter, [](double value) { return value; });
+		}
+		else if (columnType == Column::ColumnTypeOrdinal || columnType == Column::ColumnTypeNominal)
+		{
+			result.isScale		= false;
+			result.hasLabels	= false;
+			result.ints.resize(filteredRowCount);
 
-	datasetColMax = colMax;
-	datasetStatic = static_cast<RBridgeColumn*>(calloc(datasetColMax + 1, sizeof(RBridgeColumn)));
+			rbridge_copyRows(column.AsInts.begin(), column.AsInts.end(), result.ints.data(), filteredRowCount, filter, [](int value) { return value; });
+		}
+		else // columnType == Column::ColumnTypeNominalText
+		{
+			result.isScale		= false;
+			result.hasLabels	= true;
+			result.isOrdinal	= false;
+			result.ints.resize(filteredRowCount);
 
-	int filteredRowCount = obeyFilter ? rbridge_dataSet->filteredRowCount() : rbridge_dataSet->rowCount();
+			rbridge_copyRows(column.AsInts.begin(), column.AsInts.end(), result.ints.data(), filteredRowCount, filter, [](int value)
+			{
+				return value == INT_MIN ? INT_MIN : value + 1;
+			});
 
-	// lets make some rownumbers/names for R that takes into account being filtered or not!
-	datasetStatic[colMax].ints		= static_cast<int*>(calloc(filteredRowCount, sizeof(int)));
-	datasetStatic[colMax].nbRows	= filteredRowCount;
-	int filteredRow					= 0;
+			for(const Label &label : column.labels())
+				result.labels.push_back(label.text());
+		}
+	}
+	else // if (requestedType != Column::ColumnTypeScale)
+	{
+		result.isScale		= false;
+		result.hasLabels	= true;
+		result.isOrdinal	= (requestedType == Column::ColumnTypeOrdinal);
+		result.ints.resize(filteredRowCount);
 
-	for(size_t i=0; i<rbridge_dataSet->rowCount(); i++)
-		if(!obeyFilter || (rbridge_dataSet->filterVector().size() > i && rbridge_dataSet->filterVector()[i]))
-			datasetStatic[colMax].ints[filteredRow++] = i + 1; //R needs 1-based index
+		if (columnType != Column::ColumnTypeScale)
+		{
+			std::map<int, int> indices;
+			int i = 1; // R starts indices from 1
 
+			for(const Label &label : column.labels())
+			{
+				indices[label.value()] = i++;
+				result.labels.push_back(label.text());
+			}
 
-	for (int colNo = 0; colNo < colMax; colNo++)
-	{
-		RBridgeColumnType& columnInfo	= colHeaders[colNo];
-		RBridgeColumn& resultCol		= datasetStatic[colNo];
+			rbridge_copyRows(column.AsInts.begin(), column.AsInts.end(), result.ints.data(), filteredRowCount, filter, [&indices](int value)
+			{
+				return value == INT_MIN ? INT_MIN : indices.at(value);
+			});
+		}
+		else
+		{
+			// scale to nominal or ordinal (doesn't really make sense, but we have to do something)
+			result.isOrdinal = false;
 
-		std::string columnName			= columnInfo.name;
-		resultCol.name					= strdup(Base64::encode("X", columnName, Base64::RVarEncoding).c_str());
+			std::set<int> uniqueValues;
 
-		Column &column					= columns.get(columnName);
-		Column::ColumnType columnType	= column.columnType();
+			for(double value : column.AsDoubles)
+			{
 
-		Column::ColumnType requestedType = (Column::ColumnType)columnInfo.type;
-		if (requestedType == Column::ColumnTypeUnknown)
-			requestedType = columnType;
+				if (std::isnan(value))
+					continue;
 
-		//int rowCount = column.rowCount();
-		resultCol.nbRows = filteredRowCount;
-		int rowNo = 0, dataSetRowNo = 0;
+				int intValue;
 
-		if (requestedType == Column::ColumnTypeScale)
-		{
-			if (columnType == Column::ColumnTypeScale)
-			{
-				resultCol.isScale	= true;
-				resultCol.hasLabels	= false;
-				resultCol.doubles	= (double*)calloc(filteredRowCount, sizeof(double));
+				if (std::isfinite(value))	intValue = (int)(value * 1000);
+				else if (value < 0)			intValue = INT_MIN;
+				else						intValue = INT_MAX;
 
-				for(double value : column.AsDoubles)
-					if(rowNo < filteredRowCount && (!obeyFilter || rbridge_dataSet->filterVector()[dataSetRowNo++]))
-						resultCol.doubles[rowNo++] = value;
+				uniqueValues.insert(intValue);
 			}
-			else if (columnType == Column::ColumnTypeOrdinal || columnType == Column::ColumnTypeNominal)
+
+			int index = 0;
+			std::map<int, int> valueToIndex;
+
+			for(int value : uniqueValues)
 			{
-				resultCol.isScale	= false;
-				resultCol.hasLabels	= false;
-				resultCol.ints		= (int*)calloc(filteredRowCount, sizeof(int));
+				valueToIndex[value] = index++;
 
-				for(int value : column.AsInts)
-					if(rowNo < filteredRowCount && (!obeyFilter || rbridge_dataSet->filterVector()[dataSetRowNo++]))
-						resultCol.ints[rowNo++] = value;
+				if (value == INT_MAX)		result.labels.push_back("Inf");
+				else if (value == INT_MIN)	result.labels.push_back("-Inf");
+				else
+				{
+					std::stringstream ss;
+					ss << ((double)value / 1000);
+					result.labels.push_back(ss.str());
+				}
 			}
-			else // columnType == Column::ColumnTypeNominalText
+
+			rbridge_copyRows(column.AsDoubles.begin(), column.AsDoubles.end(), result.ints.data(), filteredRowCount, filter, [&valueToIndex](double value)
 			{
-				resultCol.isScale	= false;
-				resultCol.hasLabels = true;
-				resultCol.isOrdinal = false;
-				resultCol.ints		= (int*)calloc(filteredRowCount, sizeof(int));
+				if (std::isnan(value))			return INT_MIN;
+				else if (std::isfinite(value))	return valueToIndex[(int)(value * 1000)] + 1;
+				else if (value > 0)				return valueToIndex[INT_MAX] + 1;
+				else							return valueToIndex[INT_MIN] + 1;
+			});
+		}
+	}
+}
 
-				for(int value : column.AsInts)
-					if(rowNo < filteredRowCount && (!obeyFilter || rbridge_dataSet->filterVector()[dataSetRowNo++]))
-					{
-						if (value == INT_MIN)	resultCol.ints[rowNo++] = INT_MIN;
-						else					resultCol.ints[rowNo++] = value + 1;
-					}
+///Runs read, which only copies from the data set and so can be done again, on a single version of it: a read that overlapped a change of the desktop is done over.
+template<typename Read> static void rbridge_readStable(Read read)
+{
+	for(int tries = 1; ; tries++)
+	{
+		unsigned long pinned	= rbridge_dataSetSource()->stableVersion();
+		rbridge_dataSet			= rbridge_dataSetSource(); // After the change that was waited for, the memory might have grown and the data set moved
 
-				resultCol.labels = rbridge_getLabels(column.labels(), resultCol.nbLabels);
-			}
-		}
-		else // if (requestedType != Column::ColumnTypeScale)
-		{
-			resultCol.isScale	= false;
-			resultCol.hasLabels	= true;
-			resultCol.ints		= (int*)calloc(filteredRowCount, sizeof(int));
-			resultCol.isOrdinal = (requestedType == Column::ColumnTypeOrdinal);
+		read();
 
-			if (columnType != Column::ColumnTypeScale)
-			{
-				std::map<int, int> indices;
-				int i = 1; // R starts indices from 1
+		if(!rbridge_dataSet->changedSince(pinned) || (pinned & 1)) // Odd if the change never finished, then there is nothing better to read
+			return;
 
-				const Labels &labels = column.labels();
+		columnCache.clear(); // What it kept from this try might be torn as well
 
-				for(const Label &label : labels)
-					indices[label.value()] = i++;
+		if(tries % 5 == 0)
+			std::cout << "rbridge: the data set keeps changing while it is read, tried " << tries << " times." << std::endl;
+	}
+}
 
-				for(int value : column.AsInts)
-					if(rowNo < filteredRowCount && (!obeyFilter || rbridge_dataSet->filterVector()[dataSetRowNo++]))
-					{
-						if (value == INT_MIN)	resultCol.ints[rowNo++] = INT_MIN;
-						else					resultCol.ints[rowNo++] = indices.at(value);
-					}
+extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHeaders, int colMax, bool obeyFilter)
+{
+	RBridgeCallbackScope scope;
 
-				resultCol.labels = rbridge_getLabels(labels, resultCol.nbLabels);
-			}
-			else
-			{
-				// scale to nominal or ordinal (doesn't really make sense, but we have to do something)
-				resultCol.isScale	= false;
-				resultCol.hasLabels = true;
-				resultCol.isOrdinal = false;
-				resultCol.ints		= (int*)calloc(filteredRowCount, sizeof(int));
+	if (colHeaders == NULL)
+		return NULL;
 
-				std::set<int> uniqueValues;
+	JASPTRACE_SCOPE("rbridge_readDataSet"); // Nested in the rbridge_run of the analysis that asked
 
-				for(double value : column.AsDoubles)
-				{
+	rbridge_readStable([&]()
+	{
+		Columns &columns = rbridge_dataSet->columns();
 
-					if (std::isnan(value))
-						continue;
+		if (datasetStatic != NULL)
+			freeRBridgeColumns(datasetStatic, datasetColMax);
 
-					int intValue;
+		datasetColMax = colMax;
+		datasetStatic = static_cast<RBridgeColumn*>(calloc(datasetColMax + 1, sizeof(RBridgeColumn)));
 
-					if (std::isfinite(value))	intValue = (int)(value * 1000);
-					else if (value < 0)			intValue = INT_MIN;
-					else						intValue = INT_MAX;
+		FilterBitset::Pin				pin(rbridge_dataSet->filter()); // So the desktop doesn't stage the next filter into it while it is read
+		const FilterBitset::Selection * filter		= obeyFilter ? &pin.selection() : NULL;
+		unsigned long					generation	= pin.generation();
 
-					uniqueValues.insert(intValue);
-				}
+		int filteredRowCount = obeyFilter ? filter->selectedCount() : rbridge_dataSet->rowCount();
 
-				int index = 0;
-				std::map<int, int> valueToIndex;
-				std::vector<std::string> labels;
+		// lets make some rownumbers/names for R that takes into account being filtered or not!
+		datasetStatic[colMax].ints		= static_cast<int*>(calloc(filteredRowCount, sizeof(int)));
+		datasetStatic[colMax].nbRows	= filteredRowCount;
 
-				for(int value : uniqueValues)
-				{
-					valueToIndex[value] = index++;
+		for(int i=0; i<filteredRowCount; i++)
+			datasetStatic[colMax].ints[i] = (obeyFilter ? filter->selectedRows()[i] : i) + 1; //R needs 1-based index
 
-					if (value == INT_MAX)		labels.push_back("Inf");
-					else if (value == INT_MIN)	labels.push_back("-Inf");
-					else
-					{
-						std::stringstream ss;
-						ss << ((double)value / 1000);
-						labels.push_back(ss.str());
-					}
-				}
 
-				for(double value : column.AsDoubles)
-					if(rowNo < filteredRowCount && (!obeyFilter || rbridge_dataSet->filterVector()[dataSetRowNo++]))
-					{
+		for (int colNo = 0; colNo < colMax; colNo++)
+		{
+			RBridgeColumnType& columnInfo	= colHeaders[colNo];
+			RBridgeColumn& resultCol		= datasetStatic[colNo];
 
-						if (std::isnan(value))			resultCol.ints[rowNo] = INT_MIN;
-						else if (std::isfinite(value))	resultCol.ints[rowNo] = valueToIndex[(int)(value * 1000)] + 1;
-						else if (value > 0)				resultCol.ints[rowNo] = valueToIndex[INT_MAX] + 1;
-						else							resultCol.ints[rowNo] = valueToIndex[INT_MIN] + 1;
+			std::string columnName			= columnInfo.name;
+			resultCol.name					= strdup(Base64::encode("X", columnName, Base64::RVarEncoding).c_str());
 
-						rowNo++;
-					}
+			Column &column					= columns.get(columnName);
 
-				resultCol.labels = rbridge_getLabels(labels, resultCol.nbLabels);
+			Column::ColumnType requestedType = (Column::ColumnType)columnInfo.type;
+			if (requestedType == Column::ColumnTypeUnknown)
+				requestedType = column.columnType();
+
+			const ColumnCache::Entry & cached = columnCache.get(column, requestedType, obeyFilter, generation, [&](ColumnCache::Entry & entry)
+			{
+				rbridge_materializeColumn(column, requestedType, filteredRowCount, filter, entry);
+			});
+
+			resultCol.nbRows	= filteredRowCount;
+			resultCol.isScale	= cached.isScale;
+			resultCol.hasLabels	= cached.hasLabels;
+			resultCol.isOrdinal	= cached.isOrdinal;
+
+			if (cached.isScale)
+			{
+				resultCol.doubles	= (double*)calloc(filteredRowCount, sizeof(double));
+				std::copy(cached.doubles.begin(), cached.doubles.end(), resultCol.doubles);
+			}
+			else
+			{
+				resultCol.ints		= (int*)calloc(filteredRowCount, sizeof(int));
+				std::copy(cached.ints.begin(), cached.ints.end(), resultCol.ints);
 			}
+
+			if (cached.hasLabels)
+				resultCol.labels = rbridge_getLabels(cached.labels, resultCol.nbLabels);
 		}
-	}
+	});
+
+#ifdef JASP_DEBUG
+	std::cout << columnCache.statistics() << std::endl;
+#endif
 
 	return datasetStatic;
 }
 
 extern "C" char** STDCALL rbridge_readDataColumnNames(int *colMax)
 {
-	if (rbridge_dataSet == NULL)
-			rbridge_dataSet = rbridge_dataSetSource();
+	RBridgeCallbackScope scope;
+
+	rbridge_dataSet = rbridge_dataSetSource();
 
 	Columns &columns = rbridge_dataSet->columns();
 	static int staticColMax = 0;
@@ -421,106 +511,111 @@ extern "C" char** STDCALL rbridge_readDataColumnNames(int *colMax)
 
 extern "C" RBridgeColumnDescription* STDCALL rbridge_readDataSetDescription(RBridgeColumnType* columnsType, int colMax)
 {
+	RBridgeCallbackScope scope;
+
 	if (!columnsType)
 		return NULL;
 
 	static int lastColMax = 0;
 	static RBridgeColumnDescription* resultCols = NULL;
-	if (resultCols != NULL)
-		freeRBridgeColumnDescription(resultCols, lastColMax);
-	lastColMax = colMax;
-	resultCols = (RBridgeColumnDescription*)calloc(colMax, sizeof(RBridgeColumnDescription));
 
-	if (rbridge_dataSet == NULL)
-		rbridge_dataSet = rbridge_dataSetSource();
+	rbridge_readStable([&]()
+	{
+		if (resultCols != NULL)
+			freeRBridgeColumnDescription(resultCols, lastColMax);
+		lastColMax = colMax;
+		resultCols = (RBridgeColumnDescription*)calloc(colMax, sizeof(RBridgeColumnDescription));
 
-	Columns &columns = rbridge_dataSet->columns();
+		Columns &columns = rbridge_dataSet->columns();
 
-	for (int colNo = 0; colNo < colMax; colNo++)
-	{
-		RBridgeColumnType& columnInfo = columnsType[colNo];
-		RBridgeColumnDescription& resultCol = resultCols[colNo];
+		for (int colNo = 0; colNo < colMax; colNo++)
+		{
+			RBridgeColumnType& columnInfo = columnsType[colNo];
+			RBridgeColumnDescription& resultCol = resultCols[colNo];
 
-		std::string columnName = columnInfo.name;
-		resultCol.name = strdup(Base64::encode("X", columnName, Base64::RVarEncoding).c_str());
+			std::string columnName = columnInfo.name;
+			resultCol.name = strdup(Base64::encode("X", columnName, Base64::RVarEncoding).c_str());
 
-		Column &column = columns.get(columnName);
-		Column::ColumnType columnType = column.columnType();
+			Column &column = columns.get(columnName);
+			Column::ColumnType columnType = column.columnType();
 
-		Column::ColumnType requestedType = (Column::ColumnType)columnInfo.type;
+			Column::ColumnType requestedType = (Column::ColumnType)columnInfo.type;
 
-		if (requestedType == Column::ColumnTypeUnknown)
-			requestedType = columnType;
+			if (requestedType == Column::ColumnTypeUnknown)
+				requestedType = columnType;
 
-		if (requestedType == Column::ColumnTypeScale)
-		{
-			if (columnType == Column::ColumnTypeScale)
+			if (requestedType == Column::ColumnTypeScale)
 			{
-				resultCol.isScale = true;
-				resultCol.hasLabels = false;
-			}
-			else if (columnType == Column::ColumnTypeOrdinal || columnType == Column::ColumnTypeNominal)
-			{
-				resultCol.isScale = false;
-				resultCol.hasLabels = false;
+				if (columnType == Column::ColumnTypeScale)
+				{
+					resultCol.isScale = true;
+					resultCol.hasLabels = false;
+				}
+				else if (columnType == Column::ColumnTypeOrdinal || columnType == Column::ColumnTypeNominal)
+				{
+					resultCol.isScale = false;
+					resultCol.hasLabels = false;
+				}
+				else
+				{
+					resultCol.isScale = false;
+					resultCol.hasLabels = true;
+					resultCol.isOrdinal = false;
+					resultCol.labels = rbridge_getLabels(column.labels(), resultCol.nbLabels);
+				}
 			}
 			else
 			{
 				resultCol.isScale = false;
 				resultCol.hasLabels = true;
-				resultCol.isOrdinal = false;
-				resultCol.labels = rbridge_getLabels(column.labels(), resultCol.nbLabels);
-			}
-		}
-		else
-		{
-			resultCol.isScale = false;
-			resultCol.hasLabels = true;
-			resultCol.isOrdinal = (requestedType == Column::ColumnTypeOrdinal);
-			if (columnType != Column::ColumnTypeScale)
-			{
-				resultCol.labels = rbridge_getLabels(column.labels(), resultCol.nbLabels);
-			}
-			else
-			{
-				// scale to nominal or ordinal (doesn't really make sense, but we have to do something)
-				std::set<int> uniqueValues;
-
-				for (double value: column.AsDoubles)
+				resultCol.isOrdinal = (requestedType == Column::ColumnTypeOrdinal);
+				if (columnType != Column::ColumnTypeScale)
+				{
+					resultCol.labels = rbridge_getLabels(column.labels(), resultCol.nbLabels);
+				}
+				else
 				{
-					if (std::isnan(value))
-						continue;
+					// scale to nominal or ordinal (doesn't really make sense, but we have to do something)
+					std::set<int> uniqueValues;
 
-					int intValue;
+					for (double value: column.AsDoubles)
+					{
+						if (std::isnan(value))
+							continue;
 
-					if (std::isfinite(value))	intValue = (int)(value * 1000);
-					else if (value < 0)			intValue = INT_MIN;
-					else						intValue = INT_MAX;
+						int intValue;
 
-					uniqueValues.insert(intValue);
-				}
+						if (std::isfinite(value))	intValue = (int)(value * 1000);
+						else if (value < 0)			intValue = INT_MIN;
+						else						intValue = INT_MAX;
 
-				std::vector<std::string> labels;
+						uniqueValues.insert(intValue);
+					}
 
-				for (int value: uniqueValues)
-				{
-					if (value == INT_MAX)			labels.push_back("Inf");
-					else if (value == INT_MIN)		labels.push_back("-Inf");
-					else							labels.push_back(std::to_string((double)value / 1000.0f));
-				}
+					std::vector<std::string> labels;
 
-				resultCol.labels = rbridge_getLabels(labels, resultCol.nbLabels);
+					for (int value: uniqueValues)
+					{
+						if (value == INT_MAX)			labels.push_back("Inf");
+						else if (value == INT_MIN)		labels.push_back("-Inf");
+						else							labels.push_back(std::to_string((double)value / 1000.0f));
+					}
 
-			}
+					resultCol.labels = rbridge_getLabels(labels, resultCol.nbLabels);
 
+				}
+
+			}
 		}
-	}
+	});
 
 	return resultCols;
 }
 
 extern "C" bool STDCALL rbridge_setColumnAsScale(const char* columnName, double * scalarData, size_t length)
 {
+	RBridgeCallbackScope scope;
+
 	std::string colName(rbridge_decodeColumnNamesFromBase64(columnName));
 	std::vector<double> scalars(scalarData, scalarData + length);
 
@@ -529,6 +624,8 @@ extern "C" bool STDCALL rbridge_setColumnAsScale(const char* columnName, double
 
 extern "C" bool STDCALL rbridge_setColumnAsOrdinal(const char* columnName, int * ordinalData, size_t length, const char ** levels, size_t numLevels)
 {
+	RBridgeCallbackScope scope;
+
 	std::string colName(rbridge_decodeColumnNamesFromBase64(columnName));
 	std::vector<int> ordinals(ordinalData, ordinalData + length);
 
@@ -541,6 +638,8 @@ extern "C" bool STDCALL rbridge_setColumnAsOrdinal(const char* columnName, int *
 
 extern "C" bool STDCALL rbridge_setColumnAsNominal(const char* columnName, int * nominalData, size_t length, const char ** levels, size_t numLevels)
 {
+	RBridgeCallbackScope scope;
+
 	std::string colName(rbridge_decodeColumnNamesFromBase64(columnName));
 	std::vector<int> nominals(nominalData, nominalData + length);
 
@@ -553,6 +652,8 @@ extern "C" bool STDCALL rbridge_setColumnAsNominal(const char* columnName, int *
 
 extern "C" bool STDCALL rbridge_setColumnAsNominalText(const char* columnName, const char ** nominalData, size_t length)
 {
+	RBridgeCallbackScope scope;
+
 	std::string colName(rbridge_decodeColumnNamesFromBase64(columnName));
 	std::vector<std::string> nominals(nominalData, nominalData + length);
 
@@ -561,6 +662,8 @@ extern "C" bool STDCALL rbridge_setColumnAsNominalText(const char* columnName, c
 
 extern "C" int	STDCALL rbridge_dataSetRowCount()
 {
+	RBridgeCallbackScope scope;
+
 	return rbridge_getDataSetRowCount();
 }
 
@@ -665,76 +768,47 @@ bool rbridge_columnUsedInFilter(const char * columnName)
 
 std::string	rbridge_encodeColumnNamesToBase64(std::string & filterCode)
 {
-	//std::cout << " rbridge_encodeColumnNamesToBase64 starts with: "<<filterCode << std::endl << std::flush;
-
-	std::string filterBase64 = filterCode;
-
 	rbridge_findColumnsUsedInDataSet();
 	filterColumnsUsed.clear();
 
-	static std::regex nonNameChar("[^\\.A-Za-z0-9]");
+	std::set<std::string> namesFound;
+	std::string filterBase64 = columnNameEncoder.replaceAll(filterCode, &namesFound);
 
-	//for now we simply replace any found columnname by its Base64 variant if found
-	size_t foundPos = -1;
-	for(std::string col : columnNamesInDataSet)
-	{
-		std::string columnName64 = Base64::encode("X", col, Base64::RVarEncoding);
-
-		while((foundPos = filterBase64.find(col, foundPos + 1)) != std::string::npos)
-		{
-			size_t foundPosEnd = foundPos + col.length();
-			//First check if it is a "free columnname" aka is there some space or a kind in front of it. We would not want to replace a part of another term (Imagine what happens when you use a columname such as "E" and a filter that includes the term TRUE, it does not end well..)
-			bool startIsFree	= foundPos == 0							|| std::regex_match(filterBase64.substr(foundPos - 1, 1),	nonNameChar);
-			bool endIsFree		= foundPosEnd == filterBase64.length()	|| (std::regex_match(filterBase64.substr(foundPosEnd, 1),	nonNameChar) && filterBase64[foundPosEnd] != '('); //Check for "(" as well because maybe someone has a columnname such as rep or if or something weird like that
-
-			if(startIsFree && endIsFree)
-			{
-				filterBase64.replace(foundPos, col.length(), columnName64);
-
-				if(filterColumnsUsed.count(col) == 0)
-					filterColumnsUsed.insert(col);
-			}
-		}
-	}
-
-	//std::cout << " rbridge_encodeColumnNamesToBase64 results in: "<<filterBase64 << std::endl << std::flush;
+	filterColumnsUsed.insert(namesFound.begin(), namesFound.end());
 
 	return filterBase64;
 }
 
 std::string	rbridge_decodeColumnNamesFromBase64(std::string messageBase64)
 {
-	std::string messageNormal = messageBase64;
-
 	rbridge_findColumnsUsedInDataSet();
 
-	//for now we simply replace any found columnname in its Base64 variant by its normal version
-	size_t foundPos = 0;
-	for(std::string columnName : columnNamesInDataSet)
-	{
-		std::string col64 = Base64::encode("X", columnName, Base64::RVarEncoding);
-
-		while((foundPos = messageNormal.find(col64, 0)) != std::string::npos)
-			messageNormal.replace(foundPos, col64.length(), columnName);
-
-	}
-
-	return messageNormal;
+	return columnNameDecoder.replaceAll(messageBase64);
 }
 
 void rbridge_findColumnsUsedInDataSet()
 {
-	if (rbridge_dataSet == NULL)
-		rbridge_dataSet = rbridge_dataSetSource();
+	rbridge_dataSet = rbridge_dataSetSource();
 
 	Columns &columns = rbridge_dataSet->columns();
 
-	columnNamesInDataSet.clear();
+	std::vector<std::string> names;
 
 	for(Column & col : columns)
-		columnNamesInDataSet.push_back(col.name());
+		names.push_back(col.name());
+
+	if(names == columnNamesInDataSet) //The matchers are only rebuilt when the columns change
+		return;
+
+	columnNamesInDataSet = names;
+
+	std::vector<std::string> encodedNames;
+
+	for(const std::string & name : columnNamesInDataSet)
+		encodedNames.push_back(Base64::encode("X", name, Base64::RVarEncoding));
 
-	std::sort(columnNamesInDataSet.begin(), columnNamesInDataSet.end(), [](std::string & a, std::string & b) { return a.size() > b.size(); }); //from longer to shorter length columnNames to avoid problems with columnanems such as "Height Ratio" and "Height"
+	columnNameEncoder.setNames(columnNamesInDataSet, encodedNames);
+	columnNameDecoder.setNames(encodedNames, columnNamesInDataSet);
 }
 
 std::vector<bool> rbridge_applyFilter(std::string & filterCode, std::string & generatedFilterCode)
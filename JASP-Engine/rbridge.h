@@ -66,6 +66,19 @@ extern "C" {
 
 	void rbridge_init(sendFuncDef sendToDesktopFunction, pollMessagesFuncDef pollMessagesFunction);
 
+	///Lives for as long as R has called back into JASP, the callbacks that use shared memory (or the channel to the desktop) open one.
+	class RBridgeCallbackScope
+	{
+	public:
+		RBridgeCallbackScope();
+		~RBridgeCallbackScope();
+
+	private:
+		static int _depth;
+	};
+
+	void rbridge_setCallbackListener(boost::function<void(bool inside)> listener); ///< Told when R calls back into JASP and when it is back in R, in between the engine might hold a lock that the desktop shares.
+
 
 	void rbridge_setFileNameSource(			boost::function<void(const std::string &, std::string &, std::string &)> source);
 	void rbridge_setStateFileSource(		boost::function<void(std::string &, std::string &)> source);
@@ -23,6 +23,15 @@
 RInside_ConsoleLogging *rinside_consoleLog;
 #endif
 
+// The flag R itself checks in R_CheckUserInterrupt, on unix a SIGINT sets it and on windows pressing escape.
+extern "C" {
+#ifdef __WIN32__
+LibExtern int UserBreak;
+#else
+LibExtern int R_interrupts_pending;
+#endif
+}
+
 static const	std::string NullString = "null";
 static			std::string lastErrorMessage = "";
 static			cetype_t Encoding = CE_UTF8;
@@ -145,20 +154,23 @@ const char* STDCALL jaspRCPP_run(const char* name, const char* title, bool requi
 	rinside_consoleLog->clearConsoleBuffer();
 #endif
 	
+	int evalError;
+
 	if(usesJaspResults)
 	{
 		///Some stuff for jaspResults etc
 		jaspResults::setResponseData(analysisID, analysisRevision);
 		jaspResults::setSaveLocation(jaspRCPP_requestJaspResultsRelativeFilePath());
 
-		rInside.parseEval("runJaspResults(name=name, title=title, dataKey=dataKey, options=options, stateKey=stateKey)", results);
+		evalError = rInside.parseEval("runJaspResults(name=name, title=title, dataKey=dataKey, options=options, stateKey=stateKey)", results);
 	}
 	else
-		rInside.parseEval("run(name=name, title=title, requiresInit=requiresInit, dataKey=dataKey, options=options, resultsMeta=resultsMeta, stateKey=stateKey, perform=perform)", results);
+		evalError = rInside.parseEval("run(name=name, title=title, requiresInit=requiresInit, dataKey=dataKey, options=options, resultsMeta=resultsMeta, stateKey=stateKey, perform=perform)", results);
 
+	//An interrupt isn't caught by the tryCatch in run or runJaspResults, so then there are no results at all.
 	static std::string str;
-	if(Rcpp::is<std::string>(results))	str = Rcpp::as<std::string>(results);
-	else								str = "error!";
+	if(evalError == 0 && Rcpp::is<std::string>(results))	str = Rcpp::as<std::string>(results);
+	else													str = "error!";
 
 	if(usesJaspResults)
 	{
@@ -242,6 +254,25 @@ void STDCALL jaspRCPP_freeArrayPointer(bool ** arrayPointer)
     free(*arrayPointer);
 }
 
+// This is the same single store R's own SIGINT handler makes, R only acts on it at its next check. The engine does it from its cancel watcher while R is evaluating, under the lock that also guards when runs start and finish.
+void STDCALL jaspRCPP_interrupt()
+{
+#ifdef __WIN32__
+	UserBreak = 1;
+#else
+	R_interrupts_pending = 1;
+#endif
+}
+
+void STDCALL jaspRCPP_clearInterrupt()
+{
+#ifdef __WIN32__
+	UserBreak = 0;
+#else
+	R_interrupts_pending = 0;
+#endif
+}
+
 const char* STDCALL jaspRCPP_saveImage(const char *name, const char *type, const int height, const int width, const int ppi)
 {
 	RInside &rInside = rinside->instance();
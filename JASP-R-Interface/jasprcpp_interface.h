@@ -116,6 +116,8 @@ RBRIDGE_TO_JASP_INTERFACE const char*	STDCALL jaspRCPP_getLastErrorMsg();
 RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_resetErrorMsg();
 RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_setErrorMsg(const char* msg);
 RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_freeArrayPointer(bool ** arrayPointer);
+RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_interrupt();		///< Can be called from another thread while R evaluates (not while it is in a callback), R stops what it is doing the next time it checks for a user interrupt.
+RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_clearInterrupt();	///< In case R finished before it noticed the interrupt.
 
 #ifndef __WIN32__
 RBRIDGE_TO_JASP_INTERFACE const char*	STDCALL jaspRCPP_getRConsoleOutput();
@@ -39,9 +39,10 @@ LIBS += -L.. -lJASP-Common
 
 windows:LIBS += -lboost_filesystem-mgw48-mt-1_64 -lboost_system-mgw48-mt-1_64 -larchive.dll
    macx:LIBS += -lboost_filesystem-clang-mt-1_64 -lboost_system-clang-mt-1_64 -larchive -lz
-  linux:LIBS += -lboost_filesystem    -lboost_system    -larchive
+  linux:LIBS += -lboost_filesystem    -lboost_system    -larchive -lz
 
-windows:LIBS += -lole32 -loleaut32
+windows:LIBS += -lole32 -loleaut32 -lbcrypt
+windows:INCLUDEPATH += $$[QT_INSTALL_HEADERS]/QtZlib
   linux:LIBS += -lrt
 
 QMAKE_CXXFLAGS_WARN_ON += -Wno-unused-parameter -Wno-unused-local-typedef
@@ -31,10 +31,11 @@ LIBS += -L.. -lJASP-Common
 
 windows:LIBS += -lboost_filesystem-mgw48-mt-1_64 -lboost_system-mgw48-mt-1_64 -larchive.dll
    macx:LIBS += -lboost_filesystem-clang-mt-1_64 -lboost_system-clang-mt-1_64 -larchive -lz
-  linux:LIBS += -lboost_filesystem    -lboost_system    -larchive -lrt -ljsoncpp
+  linux:LIBS += -lboost_filesystem    -lboost_system    -larchive -lz -lrt -ljsoncpp
 
 
-windows:LIBS += -lole32 -loleaut32
+windows:LIBS += -lole32 -loleaut32 -lbcrypt
+windows:INCLUDEPATH += $$[QT_INSTALL_HEADERS]/QtZlib
 
 QMAKE_CXXFLAGS_WARN_ON += -Wno-unused-parameter -Wno-unused-local-typedef
 macx:QMAKE_CXXFLAGS += -Wno-c++11-extensions
@@ -60,7 +61,14 @@ SOURCES += \
     osf_test.cpp \
     spssimporter_test.cpp \
     csvimporter_test.cpp \
-    odsimporter_test.cpp
+    odsimporter_test.cpp \
+    runscheduler_test.cpp \
+    constructorevaluator_test.cpp \
+    arrowimporter_test.cpp \
+    dataexporter_test.cpp \
+    r_lexer_test.cpp \
+    zsavimporter_test.cpp \
+    ../JASP-Engine/r_lexer.cpp
 
 HEADERS += \
     AutomatedTests.h \
@@ -69,7 +77,13 @@ HEADERS += \
     csviterator.h \
     spssimporter_test.h \
     csvimporter_test.h \
-    odsimporter_test.h
+    odsimporter_test.h \
+    runscheduler_test.h \
+    constructorevaluator_test.h \
+    arrowimporter_test.h \
+    dataexporter_test.h \
+    r_lexer_test.h \
+    zsavimporter_test.h
 
 HELP_PATH = $${PWD}/../Docs/help
 RESOURCES_PATH = $${PWD}/../Resources
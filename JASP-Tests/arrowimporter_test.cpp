@@ -0,0 +1,227 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "arrowimporter_test.h"
+#include "importers/arrow/flatbuffer.h"
+#include "importers/arrowimporter.h"
+#include "exporters/arrowexporter.h"
+
+#include <boost/nowide/fstream.hpp>
+#include <climits>
+#include <cmath>
+
+using namespace arrowipc;
+
+namespace
+{
+	// Same layout as the struct in a schema, like arrowipc::Block
+	struct Pair
+	{
+		int64_t	first,
+				second;
+	};
+
+	void noProgress(const std::string &, int) {}
+}
+
+ArrowImporterTest::Cells ArrowImporterTest::cellsOf(DataSet *dataSet)
+{
+	Cells cells;
+
+	for (size_t col = 0; col < dataSet->columnCount(); col++)
+	{
+		Column &column = dataSet->column(col);
+
+		cells.push_back({ column.name(), Column::columnTypeToString(column.columnType()) });
+
+		for (size_t row = 0; row < dataSet->rowCount(); row++)
+			cells.back().push_back(column[row]);
+	}
+
+	return cells;
+}
+
+void ArrowImporterTest::flatBufferRoundTrip()
+{
+	FlatBufferBuilder builder;
+
+	FlatBufferBuilder::Ref name = builder.createString("a name");
+
+	std::vector<FlatBufferBuilder::Ref> children;
+	for (int32_t i = 0; i < 3; i++)
+	{
+		builder.startTable();
+		builder.addScalar<int32_t>(0, i * 10);
+		children.push_back(builder.endTable());
+	}
+
+	FlatBufferBuilder::Ref childVector	= builder.createVector(children);
+	FlatBufferBuilder::Ref pairs		= builder.createStructVector<Pair>({ { 1, 2 }, { -3, 1LL << 40 } });
+
+	builder.startTable();
+	builder.addScalar<int64_t>(0, -1234567890123LL);
+	builder.addRef(1, name);
+	builder.addScalar<uint8_t>(2, 7);
+	builder.addRef(3, childVector);
+	builder.addRef(5, pairs);
+	builder.addScalar<double>(6, 0.25);
+
+	std::string		buffer	= builder.finish(builder.endTable());
+	FlatBufferTable	root(buffer.data(), buffer.size());
+
+	QCOMPARE(buffer.size() % 8, size_t(0));
+
+	QCOMPARE(root.scalar<int64_t>(0, 0),	int64_t(-1234567890123LL));
+	QCOMPARE(root.string(1),				std::string("a name"));
+	QCOMPARE(root.scalar<uint8_t>(2, 0),	uint8_t(7));
+	QCOMPARE(root.scalar<double>(6, 0),		0.25);
+
+	QCOMPARE(root.vectorLength(3), size_t(3));
+	for (size_t i = 0; i < 3; i++)
+		QCOMPARE(root.tableAt(3, i).scalar<int32_t>(0, -1), int32_t(i * 10));
+
+	QCOMPARE(root.vectorLength(5), size_t(2));
+	QCOMPARE(root.structAt<Pair>(5, 0).second,	int64_t(2));
+	QCOMPARE(root.structAt<Pair>(5, 1).first,	int64_t(-3));
+	QCOMPARE(root.structAt<Pair>(5, 1).second,	int64_t(1LL << 40));
+}
+
+void ArrowImporterTest::flatBufferDefaults()
+{
+	FlatBufferBuilder builder;
+
+	builder.startTable();
+	builder.addScalar<int16_t>(1, 5);
+
+	std::string		buffer	= builder.finish(builder.endTable());
+	FlatBufferTable	root(buffer.data(), buffer.size());
+
+	// Fields that were not added, before and after the last one in the vtable, have their defaults
+	QVERIFY(!root.has(0));
+	QVERIFY(root.has(1));
+	QVERIFY(!root.has(9));
+	QCOMPARE(root.scalar<int16_t>(0, -1),	int16_t(-1));
+	QCOMPARE(root.scalar<int16_t>(1, -1),	int16_t(5));
+	QCOMPARE(root.string(9),				std::string());
+	QCOMPARE(root.vectorLength(9),			size_t(0));
+	QVERIFY_EXCEPTION_THROWN(root.table(9), std::runtime_error);
+}
+
+void ArrowImporterTest::flatBufferDamaged()
+{
+	FlatBufferBuilder builder;
+
+	FlatBufferBuilder::Ref name = builder.createString("a string that is long enough to be cut off.");
+
+	builder.startTable();
+	builder.addRef(0, name);
+
+	std::string buffer = builder.finish(builder.endTable());
+
+	// Every read is checked against the size, whatever was cut off. The string comes last, only its terminating zero is never read.
+	for (size_t size = 0; size + 1 < buffer.size(); size++)
+		QVERIFY_EXCEPTION_THROWN(FlatBufferTable(buffer.data(), size).string(0), std::runtime_error);
+}
+
+void ArrowImporterTest::exportTestData(const std::string &path, Cells &exported)
+{
+	DataSetPackage	package;
+	DataSet			*dataSet = SharedMemory::createDataSet();
+
+	package.setDataSet(dataSet);
+	dataSet->setColumnCount(3);
+	dataSet->setRowCount(5);
+
+	dataSet->column(0).setName("scale");
+	dataSet->column(0).setColumnAsScale({ 1.5, NAN, -3, 1e10, 0.1 });
+
+	dataSet->column(1).setName("nominal");
+	dataSet->column(1).setColumnAsNominalOrOrdinal({ 1, 2, INT_MIN, 1, 3 });
+
+	dataSet->column(2).setName("text");
+	dataSet->column(2).setColumnAsNominalText({ "b", "a", "", "b", "c d" });
+
+	ArrowExporter(true).saveDataSet(path, &package, &noProgress);
+
+	exported = cellsOf(dataSet);
+	SharedMemory::deleteDataSet(dataSet);
+}
+
+void ArrowImporterTest::exportThenImport()
+{
+	std::string		path = QDir(QDir::tempPath()).filePath("arrowimporter_test.arrow").toStdString();
+	Cells			exported;
+
+	exportTestData(path, exported);
+
+	DataSetPackage package;
+
+	ArrowImporter(&package).loadDataSet(path, &noProgress);
+
+	Cells imported = cellsOf(package.dataSet());
+
+	SharedMemory::deleteDataSet(package.dataSet());
+	QFile::remove(QString::fromStdString(path));
+
+	QCOMPARE(package.warningMessage(), std::string());
+	QVERIFY(imported == exported);
+}
+
+void ArrowImporterTest::selectedColumns()
+{
+	std::string		path = QDir(QDir::tempPath()).filePath("arrowimporter_test.arrow").toStdString();
+	Cells			exported;
+
+	exportTestData(path, exported);
+
+	DataSetPackage	package;
+	ArrowImporter	importer(&package);
+
+	importer.setColumns({ "text", "scale" });
+	importer.loadDataSet(path, &noProgress);
+
+	Cells imported = cellsOf(package.dataSet());
+
+	SharedMemory::deleteDataSet(package.dataSet());
+
+	// Only the selected columns are imported, in the order they were asked for
+	QVERIFY(imported == Cells({ exported[2], exported[0] }));
+
+	DataSetPackage	otherPackage;
+	ArrowImporter	otherImporter(&otherPackage);
+
+	otherImporter.setColumns({ "scale", "not there" });
+	QVERIFY_EXCEPTION_THROWN(otherImporter.loadDataSet(path, &noProgress), std::runtime_error);
+
+	QFile::remove(QString::fromStdString(path));
+}
+
+void ArrowImporterTest::notAnArrowFile()
+{
+	std::string path = QDir(QDir::tempPath()).filePath("arrowimporter_test.feather").toStdString();
+
+	{
+		boost::nowide::ofstream file(path.c_str(), std::ios::binary);
+		file << "a,b\n1,2\n3,4\n";
+	}
+
+	DataSetPackage package;
+
+	QVERIFY_EXCEPTION_THROWN(ArrowImporter(&package).loadDataSet(path, &noProgress), std::runtime_error);
+
+	QFile::remove(QString::fromStdString(path));
+}
@@ -0,0 +1,52 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ARROWIMPORTERTEST_H
+#define ARROWIMPORTERTEST_H
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include "AutomatedTests.h"
+#include "sharedmemory.h"
+#include "datasetpackage.h"
+
+
+class ArrowImporterTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::vector<std::vector<std::string>> Cells;
+
+    static Cells    cellsOf(DataSet *dataSet);
+    static void     exportTestData(const std::string &path, Cells &exported);
+
+private slots:
+    void flatBufferRoundTrip();
+    void flatBufferDefaults();
+    void flatBufferDamaged();
+    void exportThenImport();
+    void selectedColumns();
+    void notAnArrowFile();
+};
+
+
+DECLARE_TEST(ArrowImporterTest)
+
+#endif // ARROWIMPORTERTEST_H
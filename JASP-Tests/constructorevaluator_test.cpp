@@ -0,0 +1,156 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "constructorevaluator_test.h"
+#include <cmath>
+
+//The expected values are what R gives for the code the constructor generates, so with na.rm=TRUE for the aggregates.
+
+void ConstructorEvaluatorTest::init()
+{
+	dataSet = SharedMemory::createDataSet();
+	dataSet->setColumnCount(3);
+	dataSet->setRowCount(4);
+
+	dataSet->column(0).setName("x");
+	dataSet->column(0).setColumnAsScale({ 1, NAN, 3, 6 });
+
+	dataSet->column(1).setName("missing");
+	dataSet->column(1).setColumnAsScale({ NAN, NAN, NAN, NAN });
+
+	dataSet->column(2).setName("out");
+	dataSet->column(2).setColumnType(Column::ColumnTypeScale);
+}
+
+void ConstructorEvaluatorTest::cleanup()
+{
+	SharedMemory::deleteDataSet(dataSet);
+}
+
+Json::Value ConstructorEvaluatorTest::column(std::string name)
+{
+	Json::Value node(Json::objectValue);
+	node["nodeType"]	= "Column";
+	node["columnName"]	= name;
+	return node;
+}
+
+Json::Value ConstructorEvaluatorTest::number(double value)
+{
+	Json::Value node(Json::objectValue);
+	node["nodeType"]	= "Number";
+	node["value"]		= value;
+	return node;
+}
+
+Json::Value ConstructorEvaluatorTest::function(std::string name, std::vector<Json::Value> arguments)
+{
+	Json::Value node(Json::objectValue);
+	node["nodeType"]		= "Function";
+	node["functionName"]	= name;
+	node["arguments"]		= Json::arrayValue;
+
+	for(const Json::Value & argument : arguments)
+	{
+		Json::Value wrapped(Json::objectValue);
+		wrapped["argument"] = argument;
+		node["arguments"].append(wrapped);
+	}
+
+	return node;
+}
+
+double ConstructorEvaluatorTest::evaluateScale(const Json::Value & formula, size_t row)
+{
+	Json::Value constructorJson(Json::objectValue);
+	constructorJson["formulas"] = Json::arrayValue;
+	constructorJson["formulas"].append(formula);
+
+	ConstructorEvaluator evaluator(dataSet->columns());
+	evaluator.evaluateInto(constructorJson, dataSet->column("out"));
+
+	return dataSet->column("out").AsDoubles[row];
+}
+
+void ConstructorEvaluatorTest::aggregatesDropMissingValues()
+{
+	QCOMPARE(evaluateScale(function("sum",		{ column("x") })), 10.0);
+	QCOMPARE(evaluateScale(function("prod",		{ column("x") })), 18.0);
+	QCOMPARE(evaluateScale(function("min",		{ column("x") })), 1.0);
+	QCOMPARE(evaluateScale(function("max",		{ column("x") })), 6.0);
+	QCOMPARE(evaluateScale(function("median",	{ column("x") })), 3.0);
+	QCOMPARE(evaluateScale(function("mean",		{ column("x") })), 10.0 / 3.0);
+	QCOMPARE(evaluateScale(function("var",		{ column("x") })), 19.0 / 3.0);
+	QCOMPARE(evaluateScale(function("sd",		{ column("x") })), std::sqrt(19.0 / 3.0));
+}
+
+void ConstructorEvaluatorTest::aggregatesOfOnlyMissingValues()
+{
+	QCOMPARE(evaluateScale(function("sum",		{ column("missing") })), 0.0);
+	QCOMPARE(evaluateScale(function("prod",		{ column("missing") })), 1.0);
+
+	//R warns for min and max and the other ones are left to R as well
+	for(std::string name : { "min", "max", "mean", "median", "var", "sd" })
+		QVERIFY_EXCEPTION_THROWN(evaluateScale(function(name, { column("missing") })), ConstructorEvaluator::notNative);
+}
+
+void ConstructorEvaluatorTest::lengthCountsMissingValues()
+{
+	QCOMPARE(evaluateScale(function("length", { column("x") })), 4.0);
+}
+
+void ConstructorEvaluatorTest::roundLikeR()
+{
+	//round(x, 0) rounds half to even, like R does
+	dataSet->column("x").setColumnAsScale({ 2.5, NAN, -1.5, 0.5 });
+
+	QCOMPARE(evaluateScale(function("round", { column("x"), number(0) }), 0), 2.0);
+	QVERIFY(std::isnan(evaluateScale(function("round", { column("x"), number(0) }), 1)));
+	QCOMPARE(evaluateScale(function("round", { column("x"), number(0) }), 2), -2.0);
+	QCOMPARE(evaluateScale(function("round", { column("x"), number(0) }), 3), 0.0);
+
+	dataSet->column("x").setColumnAsScale({ 1.234, 5.678, 10, NAN });
+
+	QCOMPARE(evaluateScale(function("round", { column("x"), number(2) }), 0), 1.23);
+	QCOMPARE(evaluateScale(function("round", { column("x"), number(2) }), 1), 5.68);
+	QCOMPARE(evaluateScale(function("round", { column("x"), number(-1) }), 2), 10.0);
+	QVERIFY(std::isnan(evaluateScale(function("round", { column("x"), number(2) }), 3)));
+}
+
+void ConstructorEvaluatorTest::roundWithExtremeDigits()
+{
+	//R clamps the digits to +-308, so a scale of 10^digits doesn't overflow into Inf or NaN
+	dataSet->column("x").setColumnAsScale({ 1.5, 123.456, -2.5, INFINITY });
+
+	QCOMPARE(evaluateScale(function("round", { column("x"), number(400) }), 0), 1.5);
+	QCOMPARE(evaluateScale(function("round", { column("x"), number(-400) }), 1), 0.0);
+	QCOMPARE(evaluateScale(function("round", { column("x"), number(1000) }), 2), -2.5);
+	QCOMPARE(evaluateScale(function("round", { column("x"), number(2) }), 3), double(INFINITY));
+}
+
+void ConstructorEvaluatorTest::arithmeticPropagatesMissingValues()
+{
+	Json::Value plusOne(Json::objectValue);
+	plusOne["nodeType"]			= "Operator";
+	plusOne["operator"]			= "+";
+	plusOne["leftArgument"]		= column("x");
+	plusOne["rightArgument"]	= number(1);
+
+	QCOMPARE(evaluateScale(plusOne, 0), 2.0);
+	QVERIFY(std::isnan(evaluateScale(plusOne, 1)));
+	QCOMPARE(evaluateScale(plusOne, 3), 7.0);
+}
@@ -0,0 +1,55 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef CONSTRUCTOREVALUATORTEST_H
+#define CONSTRUCTOREVALUATORTEST_H
+
+#pragma once
+
+#include "AutomatedTests.h"
+#include "constructorevaluator.h"
+#include "sharedmemory.h"
+#include "dataset.h"
+
+
+class ConstructorEvaluatorTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    DataSet *dataSet;
+
+    double          evaluateScale(const Json::Value & formula, size_t row = 0);
+    static Json::Value  column(std::string name);
+    static Json::Value  number(double value);
+    static Json::Value  function(std::string name, std::vector<Json::Value> arguments);
+
+private slots:
+    void init();
+    void cleanup();
+    void aggregatesDropMissingValues();
+    void aggregatesOfOnlyMissingValues();
+    void lengthCountsMissingValues();
+    void roundLikeR();
+    void roundWithExtremeDigits();
+    void arithmeticPropagatesMissingValues();
+};
+
+
+DECLARE_TEST(ConstructorEvaluatorTest)
+
+#endif // CONSTRUCTOREVALUATORTEST_H
@@ -0,0 +1,112 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "dataexporter_test.h"
+
+#include <boost/nowide/fstream.hpp>
+#include <climits>
+#include <cmath>
+#include <iterator>
+
+namespace
+{
+	void noProgress(const std::string &, int) {}
+}
+
+void DataExporterTest::init()
+{
+	_path		= QDir(QDir::tempPath()).filePath("dataexporter_test.csv").toStdString();
+	_package	= new DataSetPackage();
+
+	DataSet *dataSet = SharedMemory::createDataSet();
+
+	_package->setDataSet(dataSet);
+	dataSet->setColumnCount(3);
+	dataSet->setRowCount(4);
+
+	dataSet->column(0).setName("scale");
+	dataSet->column(0).setColumnAsScale({ 1.5, NAN, -3, 10 });
+
+	dataSet->column(1).setName("nominal");
+	dataSet->column(1).setColumnAsNominalOrOrdinal({ 1, 2, INT_MIN, 1 });
+
+	dataSet->column(2).setName("text");
+	dataSet->column(2).setColumnAsNominalText({ "b", "a, c", "", "d" });
+}
+
+void DataExporterTest::cleanup()
+{
+	SharedMemory::deleteDataSet(_package->dataSet());
+	delete _package;
+
+	QFile::remove(QString::fromStdString(_path));
+}
+
+std::string DataExporterTest::export_(DataExporter &exporter)
+{
+	exporter.setFileType(Utils::csv);
+	exporter.saveDataSet(_path, _package, &noProgress);
+
+	boost::nowide::ifstream file(_path.c_str(), std::ios::binary);
+
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Empty cells are exported as "", like they always were
+void DataExporterTest::allRowsAndColumns()
+{
+	DataExporter exporter(true);
+
+	QCOMPARE(export_(exporter), std::string("scale,nominal,text\n1.5,1,b\n\"\",2,\"a, c\"\n-3,\"\",\"\"\n10,1,d"));
+}
+
+void DataExporterTest::rowRange()
+{
+	DataExporter exporter(true);
+	exporter.setRowRange(1, 3);
+
+	QCOMPARE(export_(exporter), std::string("scale,nominal,text\n\"\",2,\"a, c\"\n-3,\"\",\"\""));
+}
+
+void DataExporterTest::rowRangePastTheEnd()
+{
+	DataExporter exporter(true);
+
+	exporter.setRowRange(3, 100);
+	QCOMPARE(export_(exporter), std::string("scale,nominal,text\n10,1,d"));
+
+	// Nothing but the header is left when the range starts after the last row
+	exporter.setRowRange(10, 20);
+	QCOMPARE(export_(exporter), std::string("scale,nominal,text\n"));
+}
+
+void DataExporterTest::columns()
+{
+	DataExporter exporter(true);
+	exporter.setColumns({ "text", "scale" });
+	exporter.setRowRange(0, 2);
+
+	QCOMPARE(export_(exporter), std::string("text,scale\nb,1.5\n\"a, c\",\"\""));
+}
+
+void DataExporterTest::unknownColumn()
+{
+	DataExporter exporter(true);
+	exporter.setColumns({ "scale", "missing" });
+
+	QVERIFY_EXCEPTION_THROWN(export_(exporter), std::runtime_error);
+}
@@ -0,0 +1,55 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef DATAEXPORTERTEST_H
+#define DATAEXPORTERTEST_H
+
+#pragma once
+
+#include <string>
+#include "AutomatedTests.h"
+#include "sharedmemory.h"
+#include "datasetpackage.h"
+#include "exporters/dataexporter.h"
+
+
+class DataExporterTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    std::string export_(DataExporter &exporter);
+
+private slots:
+    void init();
+    void cleanup();
+
+    void allRowsAndColumns();
+    void rowRange();
+    void rowRangePastTheEnd();
+    void columns();
+    void unknownColumn();
+
+private:
+    DataSetPackage  *_package;
+    std::string     _path;
+};
+
+
+DECLARE_TEST(DataExporterTest)
+
+#endif // DATAEXPORTERTEST_H
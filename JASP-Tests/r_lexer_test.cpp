@@ -0,0 +1,103 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "r_lexer_test.h"
+
+
+std::string RLexerTest::tokens(const std::string &script)
+{
+	std::string out;
+
+	for(const R_Lexer::Token & token : R_Lexer::tokenize(script))
+	{
+		switch(token.type)
+		{
+		case R_Lexer::tokenType::name:			out += "name:";		break;
+		case R_Lexer::tokenType::backtickName:	out += "backtick:";	break;
+		case R_Lexer::tokenType::string:		out += "string:";	break;
+		case R_Lexer::tokenType::number:		out += "number:";	break;
+		case R_Lexer::tokenType::op:			out += "op:";		break;
+		case R_Lexer::tokenType::open:			out += "open:";		break;
+		case R_Lexer::tokenType::close:			out += "close:";	break;
+		}
+
+		out += token.text + " ";
+	}
+
+	return out;
+}
+
+void RLexerTest::strings()
+{
+	QCOMPARE(tokens("x <- \"system('rm')\"; y <- 'a # b'"),	std::string("name:x op:<- string:system('rm') op:; name:y op:<- string:a # b "));
+	QCOMPARE(tokens("f(\"\", '')"),							std::string("name:f open:( string: op:, string: close:) "));
+
+	// An unterminated string runs to the end of the script
+	QCOMPARE(tokens("print(\"oops)"),						std::string("name:print open:( string:oops) "));
+}
+
+// Escapes are kept in the content, but an escaped quote never closes the string
+void RLexerTest::escapedQuotes()
+{
+	QCOMPARE(tokens("\"a\\\"b\" x"),			std::string("string:a\\\"b name:x "));
+	QCOMPARE(tokens("'it\\'s' y"),				std::string("string:it\\'s name:y "));
+	QCOMPARE(tokens("\"ends in \\\\\" z"),		std::string("string:ends in \\\\ name:z "));
+	QCOMPARE(tokens("`a\\`b` w"),				std::string("backtick:a\\`b name:w "));
+}
+
+void RLexerTest::rawStrings()
+{
+	QCOMPARE(tokens("r\"(say \"hi\")\" x"),		std::string("string:say \"hi\" name:x "));
+	QCOMPARE(tokens("R'-[a)]'b]-' y"),			std::string("string:a)]'b name:y "));
+}
+
+void RLexerTest::backticks()
+{
+	QCOMPARE(tokens("`my var` <- 1"),			std::string("backtick:my var op:<- number:1 "));
+	QCOMPARE(tokens("`system`(\"ls\")"),		std::string("backtick:system open:( string:ls close:) "));
+	QCOMPARE(tokens("`#not a comment`"),		std::string("backtick:#not a comment "));
+}
+
+void RLexerTest::comments()
+{
+	QCOMPARE(tokens("a # system(\"ls\")\nb"),	std::string("name:a name:b "));
+	QCOMPARE(tokens("# only a comment"),		std::string(""));
+	QCOMPARE(tokens("\"# a string\" # a comment"), std::string("string:# a string "));
+}
+
+// A namespaced name is a single token, however many colons
+void RLexerTest::namespaces()
+{
+	QCOMPARE(tokens("base::mean(x)"),			std::string("name:base::mean open:( name:x close:) "));
+	QCOMPARE(tokens("stats:::sd"),				std::string("name:stats:::sd "));
+	QCOMPARE(tokens("pkg::`odd name`"),			std::string("name:pkg::odd name "));
+	QCOMPARE(tokens("a:b"),						std::string("name:a op:: name:b "));
+	QCOMPARE(tokens("pkg::(1)"),				std::string("name:pkg op:: op:: open:( number:1 close:) "));
+}
+
+void RLexerTest::syntacticNames()
+{
+	QVERIFY( R_Lexer::isSyntacticName("mean"));
+	QVERIFY( R_Lexer::isSyntacticName(".hidden"));
+	QVERIFY( R_Lexer::isSyntacticName("a_b.c1"));
+	QVERIFY(!R_Lexer::isSyntacticName(""));
+	QVERIFY(!R_Lexer::isSyntacticName("1a"));
+	QVERIFY(!R_Lexer::isSyntacticName(".1a"));
+	QVERIFY(!R_Lexer::isSyntacticName("_a"));
+	QVERIFY(!R_Lexer::isSyntacticName("my var"));
+	QVERIFY(!R_Lexer::isSyntacticName("function"));
+}
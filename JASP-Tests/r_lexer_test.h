@@ -0,0 +1,48 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef RLEXERTEST_H
+#define RLEXERTEST_H
+
+#pragma once
+
+#include <string>
+#include "AutomatedTests.h"
+#include "r_lexer.h"
+
+
+class RLexerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    std::string tokens(const std::string &script);	///< The tokens of script as "type:text" separated by spaces
+
+private slots:
+    void strings();
+    void escapedQuotes();
+    void rawStrings();
+    void backticks();
+    void comments();
+    void namespaces();
+    void syntacticNames();
+};
+
+
+DECLARE_TEST(RLexerTest)
+
+#endif // RLEXERTEST_H
@@ -0,0 +1,165 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "runscheduler_test.h"
+
+
+void RunSchedulerTest::init()
+{
+	now = RunScheduler::Clock::time_point();
+}
+
+RunScheduler RunSchedulerTest::scheduler()
+{
+	return RunScheduler([this]() { return now; });
+}
+
+void RunSchedulerTest::advance(int ms)
+{
+	now += std::chrono::milliseconds(ms);
+}
+
+int RunSchedulerTest::elapsedMs(RunScheduler::Clock::time_point since)
+{
+	return int(std::chrono::duration_cast<std::chrono::milliseconds>(now - since).count());
+}
+
+void RunSchedulerTest::newAnalysisRunsRightAway()
+{
+	RunScheduler scheduler = this->scheduler();
+
+	QVERIFY(scheduler.mayRun(1, 0));	// never seen
+
+	scheduler.seen(1, 0);
+	QVERIFY(scheduler.mayRun(1, 0));	// seen, but not changing
+
+	scheduler.seen(2, 7);				// loaded with a later revision
+	QVERIFY(scheduler.mayRun(2, 7));
+}
+
+void RunSchedulerTest::changingAnalysisWaits()
+{
+	RunScheduler scheduler = this->scheduler();
+
+	scheduler.seen(1, 0);
+	scheduler.dispatched(1, 0);
+	scheduler.seen(1, 1);
+
+	QVERIFY(!scheduler.mayRun(1, 1));
+	QVERIFY(scheduler.mayRun(1, 0));	// the next step of the revision that was dispatched already
+
+	advance(RunScheduler::defaultDelayMs - 1);
+	QVERIFY(!scheduler.mayRun(1, 1));
+
+	advance(1);
+	QVERIFY(scheduler.mayRun(1, 1));
+
+	scheduler.dispatched(1, 1);
+	QVERIFY(scheduler.mayRun(1, 1));
+}
+
+void RunSchedulerTest::keepsChangingButStillRuns()
+{
+	RunScheduler						scheduler	= this->scheduler();
+	RunScheduler::Clock::time_point		start		= now;
+	int									revision	= 0;
+
+	scheduler.seen(1, revision);
+	scheduler.dispatched(1, revision);
+
+	do
+	{
+		scheduler.seen(1, ++revision);
+		advance(20);
+	}
+	while (!scheduler.mayRun(1, revision) && elapsedMs(start) < 20 * RunScheduler::defaultDelayMs);
+
+	// It never stood still for defaultDelayMs, so it ran because it had been changing for four times that
+	QVERIFY(scheduler.mayRun(1, revision));
+	QCOMPARE(elapsedMs(start), 4 * int(RunScheduler::defaultDelayMs));
+}
+
+void RunSchedulerTest::delayFollowsRunTime()
+{
+	RunScheduler scheduler = this->scheduler();
+
+	QCOMPARE(scheduler.delayMs(1), int(RunScheduler::defaultDelayMs));
+
+	scheduler.seen(1, 0);
+	scheduler.dispatched(1, 0);
+	advance(40);
+	scheduler.completed(1, 0);
+
+	QCOMPARE(scheduler.delayMs(1), 10);
+
+	scheduler.seen(1, 1);
+	scheduler.dispatched(1, 1);
+	advance(20 * RunScheduler::maxDelayMs);
+	scheduler.completed(1, 1);
+
+	QCOMPARE(scheduler.delayMs(1), int(RunScheduler::maxDelayMs));
+
+	scheduler.completed(2, 3);			// restored from the cache, it didn't run
+	QCOMPARE(scheduler.delayMs(2), int(RunScheduler::defaultDelayMs));
+}
+
+void RunSchedulerTest::countsWhatWasSaved()
+{
+	RunScheduler scheduler = this->scheduler();
+
+	scheduler.seen(1, 0);
+	scheduler.dispatched(1, 0);
+
+	for (int revision = 1; revision <= 3; revision++)
+		scheduler.seen(1, revision);
+
+	scheduler.dispatched(1, 3);
+	scheduler.dispatched(1, 3);			// the run after the init of the same revision
+	scheduler.cancelled();
+	scheduler.restoredFromCache();
+
+	Json::Value metrics = scheduler.metrics();
+
+	QCOMPARE(metrics["revisionsSeen"].asUInt(),			3u);
+	QCOMPARE(metrics["runsDispatched"].asUInt(),		2u);
+	QCOMPARE(metrics["revisionsCoalesced"].asUInt(),	2u);
+	QCOMPARE(metrics["runsCancelled"].asUInt(),			1u);
+	QCOMPARE(metrics["restoredFromCache"].asUInt(),		1u);
+	QCOMPARE(metrics["runsAvoided"].asUInt(),			3u);
+}
+
+void RunSchedulerTest::forgetAndClear()
+{
+	RunScheduler scheduler = this->scheduler();
+
+	scheduler.seen(1, 0);
+	scheduler.dispatched(1, 0);
+	scheduler.seen(1, 1);
+	QVERIFY(!scheduler.mayRun(1, 1));
+
+	scheduler.forget(1);
+	QVERIFY(scheduler.mayRun(1, 1));
+
+	scheduler.seen(2, 0);
+	scheduler.dispatched(2, 0);
+	scheduler.seen(2, 1);
+	QVERIFY(!scheduler.mayRun(2, 1));
+
+	scheduler.clear();
+	QVERIFY(scheduler.mayRun(2, 1));
+	QCOMPARE(scheduler.metrics()["runsDispatched"].asUInt(), 2u);	// the metrics stay
+}
@@ -0,0 +1,51 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef RUNSCHEDULERTEST_H
+#define RUNSCHEDULERTEST_H
+
+#pragma once
+
+#include "AutomatedTests.h"
+#include "runscheduler.h"
+
+
+class RunSchedulerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    RunScheduler::Clock::time_point now;	///< The clock of the schedulers, advance() moves it
+
+    RunScheduler    scheduler();
+    void            advance(int ms);
+    int             elapsedMs(RunScheduler::Clock::time_point since);
+
+private slots:
+    void init();
+    void newAnalysisRunsRightAway();
+    void changingAnalysisWaits();
+    void keepsChangingButStillRuns();
+    void delayFollowsRunTime();
+    void countsWhatWasSaved();
+    void forgetAndClear();
+};
+
+
+DECLARE_TEST(RunSchedulerTest)
+
+#endif // RUNSCHEDULERTEST_H
@@ -0,0 +1,162 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zsavimporter_test.h"
+
+#include <boost/nowide/fstream.hpp>
+#include <boost/filesystem.hpp>
+#include <stdexcept>
+#include <vector>
+#include <zlib.h>
+
+using namespace spss;
+
+namespace
+{
+	template<typename T> void put(std::string &out, T value) { out.append(reinterpret_cast<const char *>(&value), sizeof(T)); }
+}
+
+void ZSavImporterTest::init()
+{
+	_path	= QDir(QDir::tempPath()).filePath("zsavimporter_test.zsav").toStdString();
+	_prefix	= std::string(176, '@');
+}
+
+void ZSavImporterTest::cleanup()
+{
+	QFile::remove(QString::fromStdString(_path));
+}
+
+/* Bytes that look a bit like bytecode, so zlib has something to do but can't make them vanish */
+std::string ZSavImporterTest::testData(size_t size)
+{
+	std::string data(size, '\0');
+
+	for (size_t i = 0; i < size; i++)
+		data[i] = char(i % 8 == 0 ? 253 : (i * 7919) % 13);
+
+	return data;
+}
+
+/* Writes _prefix, a ZHEADER, data cut into blocks of blockSize compressed with zlib and a ZTRAILER (see "System File Format", PSPP developer's Guide).
+ * All numbers are written little endian, like any machine JASP runs on does. If shortenBlock is a block number, that block misses its last bytes, while the trailer agrees with its size.
+ */
+void ZSavImporterTest::writeZSav(const std::string &data, size_t blockSize, size_t shortenBlock)
+{
+	const int64_t	zheaderOfs	= _prefix.size(),
+					entrySize	= 24;
+	std::string		blocks,
+					entries;
+	int32_t			numBlocks	= 0;
+
+	for (size_t offset = 0; offset < data.size(); offset += blockSize, numBlocks++)
+	{
+		uLong				size			= std::min(blockSize, data.size() - offset);
+		uLongf				compressedSize	= compressBound(size);
+		std::vector<char>	compressed(compressedSize);
+
+		QCOMPARE(compress(reinterpret_cast<Bytef *>(compressed.data()), &compressedSize, reinterpret_cast<const Bytef *>(data.data() + offset), size), Z_OK);
+
+		if (size_t(numBlocks) == shortenBlock)
+			compressedSize -= 4;
+
+		put<int64_t>(entries, zheaderOfs + offset);
+		put<int64_t>(entries, zheaderOfs + entrySize + blocks.size());
+		put<int32_t>(entries, int32_t(size));
+		put<int32_t>(entries, int32_t(compressedSize));
+
+		blocks.append(compressed.data(), compressedSize);
+	}
+
+	std::string file = _prefix;
+
+	put<int64_t>(file, zheaderOfs);
+	put<int64_t>(file, zheaderOfs + entrySize + blocks.size());
+	put<int64_t>(file, entrySize * (numBlocks + 1));
+
+	file += blocks;
+
+	put<int64_t>(file, -100);
+	put<int64_t>(file, 0);
+	put<int32_t>(file, int32_t(blockSize));
+	put<int32_t>(file, numBlocks);
+
+	file += entries;
+
+	boost::nowide::ofstream out(_path.c_str(), std::ios::binary);
+	out.write(file.data(), file.size());
+}
+
+/* Reads the data of the .zsav at _path through ZLibDataBlocks, bufferSize bytes at a time like DataRecords does */
+std::string ZSavImporterTest::readZSav(size_t bufferSize)
+{
+	SPSSStream stream(_path.c_str(), std::ios::in | std::ios::binary);
+	stream.seekg(_prefix.size());
+
+	NumericConverter fixer;
+	fixer.setEndian(NumericConverter::mach_littleEndian);
+
+	ZLibDataBlocks		blocks(fixer, stream);
+	std::string			data;
+	std::vector<char>	buffer(bufferSize);
+
+	for (size_t read; (read = blocks.read(buffer.data(), buffer.size())) > 0;)
+		data.append(buffer.data(), read);
+
+	return data;
+}
+
+void ZSavImporterTest::singleBlock()
+{
+	std::string data = testData(10000);
+
+	writeZSav(data, 0x3ff000);
+	QVERIFY(readZSav() == data);
+	QVERIFY(readZSav(1) == data);
+}
+
+// Many more blocks than there are inflating threads, and a last one that is shorter than the others
+void ZSavImporterTest::multipleBlocks()
+{
+	std::string data = testData(1000 * 1000 + 17);
+
+	writeZSav(data, 4096);
+	QVERIFY(readZSav() == data);
+	QVERIFY(readZSav(4096) == data);
+	QVERIFY(readZSav(3 * 1000 * 1000) == data);
+}
+
+void ZSavImporterTest::truncatedBlock()
+{
+	std::string data = testData(100 * 1000);
+
+	writeZSav(data, 4096, 10);
+	QVERIFY_EXCEPTION_THROWN(readZSav(), std::runtime_error);
+
+	writeZSav(data, 4096, 0);
+	QVERIFY_EXCEPTION_THROWN(readZSav(), std::runtime_error);
+}
+
+// A file cut off in the middle of its blocks lost its trailer as well, so it should not get as far as reading them
+void ZSavImporterTest::truncatedFile()
+{
+	writeZSav(testData(100 * 1000), 4096);
+
+	boost::filesystem::resize_file(_path, boost::filesystem::file_size(_path) / 2);
+
+	QVERIFY_EXCEPTION_THROWN(readZSav(), std::runtime_error);
+}
@@ -0,0 +1,56 @@
+//
+// Copyright (C) 2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ZSAVIMPORTERTEST_H
+#define ZSAVIMPORTERTEST_H
+
+#pragma once
+
+#include <string>
+#include "AutomatedTests.h"
+#include "importers/spss/zlibdatablocks.h"
+
+
+/* The data of a .zsav is read by ZLibDataBlocks, these tests write the zlib part of a .zsav around some data and check that exactly that data comes back out.
+ */
+class ZSavImporterTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    void        writeZSav(const std::string &data, size_t blockSize, size_t shortenBlock = std::string::npos);
+    std::string readZSav(size_t bufferSize = 1000);
+    std::string testData(size_t size);
+
+private slots:
+    void init();
+    void cleanup();
+
+    void singleBlock();
+    void multipleBlocks();
+    void truncatedBlock();
+    void truncatedFile();
+
+private:
+    std::string _path;
+    std::string _prefix;    ///< Stands in for the dictionary, the zlib header follows it
+};
+
+
+DECLARE_TEST(ZSavImporterTest)
+
+#endif // ZSAVIMPORTERTEST_H
@@ -9,12 +9,15 @@ DESTDIR = .
 SUBDIRS += \
 	JASP-Common \
         JASP-Engine \
-        JASP-Desktop
+        JASP-Desktop \
+        JASP-Batch
 #	JASP-Tests
+#	JASP-Benchmarks
 
 unix: SUBDIRS += $$JASP_R_INTERFACE_TARGET
 
 JASP-Desktop.depends = JASP-Common
 JASP-Engine.depends = JASP-Common
+JASP-Batch.depends = JASP-Common
 
 unix: JASP-Engine.depends += $$JASP_R_INTERFACE_TARGET